@@ -0,0 +1,474 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <stdio.h>
+
+#include <cstring>
+
+#include "graph/node_binary.h"
+
+#include "scene/attribute.h"
+#include "scene/background.h"
+#include "scene/camera.h"
+#include "scene/film.h"
+#include "scene/hair.h"
+#include "scene/integrator.h"
+#include "scene/light.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/pointcloud.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+#include "scene/shader_graph.h"
+#include "scene/shader_nodes.h"
+#include "scene/volume.h"
+
+#include "util/foreach.h"
+#include "util/mapped_file.h"
+#include "util/path.h"
+
+#include "app/cycles_binary.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* File layout:
+ *
+ * - Header, see BinaryWriter::write_header().
+ * - Table with the type and role of every node, so that nodes can refer to each other
+ *   independent of their order.
+ * - Sockets of every node, followed by the shader graph for shaders and the attributes for
+ *   geometry. */
+
+static const char BINARY_SCENE_MAGIC[8] = {'C', 'Y', 'C', 'S', 'C', 'E', 'N', 'E'};
+
+/* Nodes owned by the scene, that are filled in instead of created. */
+enum BinarySceneRole {
+  BINARY_ROLE_NONE = 0,
+  BINARY_ROLE_CAMERA,
+  BINARY_ROLE_FILM,
+  BINARY_ROLE_INTEGRATOR,
+  BINARY_ROLE_BACKGROUND,
+  BINARY_ROLE_DEFAULT_SURFACE,
+  BINARY_ROLE_DEFAULT_VOLUME,
+  BINARY_ROLE_DEFAULT_LIGHT,
+  BINARY_ROLE_DEFAULT_BACKGROUND,
+  BINARY_ROLE_DEFAULT_EMPTY,
+};
+
+static BinarySceneRole binary_shader_role(Scene *scene, const Shader *shader)
+{
+  if (shader == scene->default_surface) {
+    return BINARY_ROLE_DEFAULT_SURFACE;
+  }
+  if (shader == scene->default_volume) {
+    return BINARY_ROLE_DEFAULT_VOLUME;
+  }
+  if (shader == scene->default_light) {
+    return BINARY_ROLE_DEFAULT_LIGHT;
+  }
+  if (shader == scene->default_background) {
+    return BINARY_ROLE_DEFAULT_BACKGROUND;
+  }
+  if (shader == scene->default_empty) {
+    return BINARY_ROLE_DEFAULT_EMPTY;
+  }
+  return BINARY_ROLE_NONE;
+}
+
+static Node *binary_role_node(Scene *scene, const uint8_t role)
+{
+  switch (role) {
+    case BINARY_ROLE_CAMERA:
+      return scene->camera;
+    case BINARY_ROLE_FILM:
+      return scene->film;
+    case BINARY_ROLE_INTEGRATOR:
+      return scene->integrator;
+    case BINARY_ROLE_BACKGROUND:
+      return scene->background;
+    case BINARY_ROLE_DEFAULT_SURFACE:
+      return scene->default_surface;
+    case BINARY_ROLE_DEFAULT_VOLUME:
+      return scene->default_volume;
+    case BINARY_ROLE_DEFAULT_LIGHT:
+      return scene->default_light;
+    case BINARY_ROLE_DEFAULT_BACKGROUND:
+      return scene->default_background;
+    case BINARY_ROLE_DEFAULT_EMPTY:
+      return scene->default_empty;
+  }
+  return NULL;
+}
+
+static Node *binary_create_node(Scene *scene, const NodeType *type)
+{
+  if (type == Shader::get_node_type()) {
+    return scene->create_node<Shader>();
+  }
+  if (type == Mesh::get_node_type()) {
+    return scene->create_node<Mesh>();
+  }
+  if (type == Hair::get_node_type()) {
+    return scene->create_node<Hair>();
+  }
+  if (type == PointCloud::get_node_type()) {
+    return scene->create_node<PointCloud>();
+  }
+  if (type == Volume::get_node_type()) {
+    return scene->create_node<Volume>();
+  }
+  if (type == Object::get_node_type()) {
+    return scene->create_node<Object>();
+  }
+  if (type == Light::get_node_type()) {
+    return scene->create_node<Light>();
+  }
+  return NULL;
+}
+
+/* Shader Graph
+ *
+ * The output node comes first, links refer to nodes by their index. */
+
+static void binary_write_shader_graph(BinaryWriter &writer, ShaderGraph *graph)
+{
+  vector<ShaderNode *> nodes;
+  map<const ShaderNode *, uint32_t> node_index;
+
+  nodes.push_back(graph->output());
+  foreach (ShaderNode *node, graph->nodes) {
+    if (node == graph->output()) {
+      continue;
+    }
+    if (node->special_type == SHADER_SPECIAL_TYPE_OSL ||
+        NodeType::find(node->type->name) != node->type)
+    {
+      fprintf(stderr,
+              "Shader node \"%s\" can not be written to a binary file.\n",
+              node->name.c_str());
+      continue;
+    }
+    node_index[node] = nodes.size();
+    nodes.push_back(node);
+  }
+  node_index[graph->output()] = 0;
+
+  writer.write_uint32(nodes.size());
+  foreach (ShaderNode *node, nodes) {
+    writer.write_string(node->type->name);
+    binary_write_node(writer, node);
+  }
+
+  vector<ShaderInput *> links;
+  foreach (ShaderNode *node, nodes) {
+    foreach (ShaderInput *input, node->inputs) {
+      if (input->link && node_index.count(input->link->parent)) {
+        links.push_back(input);
+      }
+    }
+  }
+
+  writer.write_uint32(links.size());
+  foreach (ShaderInput *input, links) {
+    writer.write_uint32(node_index[input->link->parent]);
+    writer.write_string(input->link->socket_type.name);
+    writer.write_uint32(node_index[input->parent]);
+    writer.write_string(input->socket_type.name);
+  }
+}
+
+static bool binary_read_shader_graph(BinaryReader &reader, Scene *scene, Shader *shader)
+{
+  ShaderGraph *graph = new ShaderGraph();
+  vector<ShaderNode *> nodes;
+
+  const uint32_t num_nodes = reader.read_uint32();
+  for (uint32_t i = 0; i < num_nodes && reader.ok(); i++) {
+    const ustring type_name = reader.read_ustring();
+    ShaderNode *snode = NULL;
+
+    if (i == 0) {
+      snode = graph->output();
+    }
+    else {
+      const NodeType *node_type = NodeType::find(type_name);
+      if (!node_type || node_type->type != NodeType::SHADER || node_type->create == NULL) {
+        fprintf(stderr, "Unknown shader node \"%s\".\n", type_name.c_str());
+        delete graph;
+        return false;
+      }
+
+      snode = (ShaderNode *)node_type->create(node_type);
+      snode->set_owner(graph);
+      graph->add(snode);
+    }
+
+    binary_read_node(reader, snode);
+    nodes.push_back(snode);
+  }
+
+  const uint32_t num_links = reader.read_uint32();
+  for (uint32_t i = 0; i < num_links && reader.ok(); i++) {
+    const uint32_t from_index = reader.read_uint32();
+    const ustring from_socket_name = reader.read_ustring();
+    const uint32_t to_index = reader.read_uint32();
+    const ustring to_socket_name = reader.read_ustring();
+
+    ShaderOutput *output = (from_index < nodes.size()) ?
+                               nodes[from_index]->output(from_socket_name) :
+                               NULL;
+    ShaderInput *input = (to_index < nodes.size()) ? nodes[to_index]->input(to_socket_name) :
+                                                     NULL;
+
+    if (output && input) {
+      graph->connect(output, input);
+    }
+    else {
+      fprintf(stderr, "Invalid link in shader \"%s\".\n", shader->name.c_str());
+    }
+  }
+
+  if (!reader.ok()) {
+    delete graph;
+    return false;
+  }
+
+  shader->set_graph(graph);
+  shader->tag_update(scene);
+  return true;
+}
+
+/* Attributes
+ *
+ * Attribute data is stored as a blob, voxel data is not supported. */
+
+static void binary_write_attributes(BinaryWriter &writer, const AttributeSet &attributes)
+{
+  vector<const Attribute *> write_attributes;
+  foreach (const Attribute &attr, attributes.attributes) {
+    if (attr.element == ATTR_ELEMENT_VOXEL) {
+      fprintf(stderr,
+              "Volume attribute \"%s\" can not be written to a binary file.\n",
+              attr.name.c_str());
+      continue;
+    }
+    write_attributes.push_back(&attr);
+  }
+
+  writer.write_uint32(write_attributes.size());
+  foreach (const Attribute *attr, write_attributes) {
+    writer.write_string(attr->name);
+    writer.write_uint32(attr->std);
+    writer.write_uint8(attr->type.basetype);
+    writer.write_uint8(attr->type.aggregate);
+    writer.write_uint8(attr->type.vecsemantics);
+    writer.write_uint32(attr->type.arraylen);
+    writer.write_uint32(attr->element);
+    writer.write_uint32(attr->flags);
+    writer.write_blob(attr->buffer.data(), attr->buffer.size());
+  }
+}
+
+static void binary_read_attributes(BinaryReader &reader, AttributeSet &attributes)
+{
+  const uint32_t num_attributes = reader.read_uint32();
+  for (uint32_t i = 0; i < num_attributes && reader.ok(); i++) {
+    const ustring name = reader.read_ustring();
+    const AttributeStandard std = (AttributeStandard)reader.read_uint32();
+    TypeDesc type;
+    type.basetype = reader.read_uint8();
+    type.aggregate = reader.read_uint8();
+    type.vecsemantics = reader.read_uint8();
+    type.arraylen = (int)reader.read_uint32();
+    const AttributeElement element = (AttributeElement)reader.read_uint32();
+    const uint flags = reader.read_uint32();
+    size_t size;
+    const void *data = reader.read_blob(size);
+
+    if (!reader.ok()) {
+      break;
+    }
+
+    Attribute *attr = attributes.add(name, type, element);
+    attr->std = std;
+    attr->flags = flags;
+    attr->buffer.resize(size);
+    if (size) {
+      memcpy(attr->buffer.data(), data, size);
+    }
+  }
+}
+
+/* File */
+
+bool binary_is_file(const char *filepath)
+{
+  FILE *file = path_fopen(filepath, "rb");
+  if (!file) {
+    return false;
+  }
+
+  char magic[sizeof(BINARY_SCENE_MAGIC)];
+  const bool is_binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                         memcmp(magic, BINARY_SCENE_MAGIC, sizeof(magic)) == 0;
+  fclose(file);
+  return is_binary;
+}
+
+bool binary_write_file(Scene *scene, const char *filepath)
+{
+  /* Node table. */
+  vector<Node *> nodes;
+  vector<uint8_t> roles;
+
+  nodes.push_back(scene->camera);
+  roles.push_back(BINARY_ROLE_CAMERA);
+  nodes.push_back(scene->film);
+  roles.push_back(BINARY_ROLE_FILM);
+  nodes.push_back(scene->integrator);
+  roles.push_back(BINARY_ROLE_INTEGRATOR);
+  nodes.push_back(scene->background);
+  roles.push_back(BINARY_ROLE_BACKGROUND);
+
+  foreach (Shader *shader, scene->shaders) {
+    nodes.push_back(shader);
+    roles.push_back(binary_shader_role(scene, shader));
+  }
+  foreach (Geometry *geom, scene->geometry) {
+    nodes.push_back(geom);
+    roles.push_back(BINARY_ROLE_NONE);
+  }
+  foreach (Object *object, scene->objects) {
+    nodes.push_back(object);
+    roles.push_back(BINARY_ROLE_NONE);
+  }
+  foreach (Light *light, scene->lights) {
+    nodes.push_back(light);
+    roles.push_back(BINARY_ROLE_NONE);
+  }
+
+  if (!scene->procedurals.empty() || !scene->particle_systems.empty()) {
+    fprintf(stderr, "Procedurals and particle systems can not be written to a binary file.\n");
+  }
+
+  /* Write to a temporary file first, to not leave a partial file behind. */
+  const string tmp_filepath = string(filepath) + ".tmp";
+  FILE *file = path_fopen(tmp_filepath, "wb");
+  if (!file) {
+    fprintf(stderr, "Failed to open \"%s\" for writing.\n", tmp_filepath.c_str());
+    return false;
+  }
+
+  BinaryWriter writer(file);
+  writer.write_header(BINARY_SCENE_MAGIC);
+
+  writer.write_uint32(nodes.size());
+  for (size_t i = 0; i < nodes.size(); i++) {
+    writer.write_string(nodes[i]->type->name);
+    writer.write_uint8(roles[i]);
+    writer.node_index[nodes[i]] = i;
+  }
+
+  foreach (Node *node, nodes) {
+    binary_write_node(writer, node);
+
+    if (node->is_a(Shader::get_node_type())) {
+      Shader *shader = static_cast<Shader *>(node);
+      writer.write_uint8(shader->graph != NULL);
+      if (shader->graph) {
+        binary_write_shader_graph(writer, shader->graph);
+      }
+    }
+    else if (node->is_a(Geometry::get_node_base_type())) {
+      Geometry *geom = static_cast<Geometry *>(node);
+      binary_write_attributes(writer, geom->attributes);
+      if (geom->is_mesh() || geom->is_volume()) {
+        binary_write_attributes(writer, static_cast<Mesh *>(geom)->subd_attributes);
+      }
+    }
+  }
+
+  const bool success = writer.ok() && fclose(file) == 0;
+  if (!success) {
+    fprintf(stderr, "Failed to write \"%s\".\n", tmp_filepath.c_str());
+    path_remove(tmp_filepath);
+    return false;
+  }
+
+  path_remove(filepath);
+  if (rename(tmp_filepath.c_str(), filepath) != 0) {
+    fprintf(stderr, "Failed to rename \"%s\" to \"%s\".\n", tmp_filepath.c_str(), filepath);
+    return false;
+  }
+
+  return true;
+}
+
+bool binary_read_file(Scene *scene, const char *filepath)
+{
+  MappedFile file;
+  if (!file.open(filepath)) {
+    fprintf(stderr, "Failed to open \"%s\".\n", filepath);
+    return false;
+  }
+
+  BinaryReader reader(file.data(), file.size());
+  if (!reader.read_header(BINARY_SCENE_MAGIC)) {
+    fprintf(stderr,
+            "\"%s\" is not a binary scene written by this version of Cycles.\n",
+            filepath);
+    return false;
+  }
+
+  /* Create all nodes first, so that nodes can refer to nodes later in the file. */
+  const uint32_t num_nodes = reader.read_uint32();
+  for (uint32_t i = 0; i < num_nodes && reader.ok(); i++) {
+    const ustring type_name = reader.read_ustring();
+    const uint8_t role = reader.read_uint8();
+    const NodeType *type = NodeType::find(type_name);
+
+    Node *node = (role != BINARY_ROLE_NONE) ? binary_role_node(scene, role) :
+                                              binary_create_node(scene, type);
+    if (node == NULL || node->type != type) {
+      fprintf(stderr, "Unknown node type \"%s\".\n", type_name.c_str());
+      return false;
+    }
+    reader.nodes.push_back(node);
+  }
+
+  foreach (Node *node, reader.nodes) {
+    if (!binary_read_node(reader, node)) {
+      break;
+    }
+
+    if (node->is_a(Shader::get_node_type())) {
+      Shader *shader = static_cast<Shader *>(node);
+      if (reader.read_uint8() && !binary_read_shader_graph(reader, scene, shader)) {
+        break;
+      }
+    }
+    else if (node->is_a(Geometry::get_node_base_type())) {
+      Geometry *geom = static_cast<Geometry *>(node);
+      binary_read_attributes(reader, geom->attributes);
+      if (geom->is_mesh() || geom->is_volume()) {
+        binary_read_attributes(reader, static_cast<Mesh *>(geom)->subd_attributes);
+      }
+    }
+  }
+
+  if (!reader.ok()) {
+    fprintf(stderr, "Failed to read \"%s\", the file is corrupt.\n", filepath);
+    return false;
+  }
+
+  Camera *cam = scene->camera;
+  cam->need_flags_update = true;
+  cam->update(scene);
+
+  scene->params.bvh_type = BVH_TYPE_STATIC;
+
+  return true;
+}
+
+CCL_NAMESPACE_END
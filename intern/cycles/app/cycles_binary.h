@@ -0,0 +1,21 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __CYCLES_BINARY_H__
+#define __CYCLES_BINARY_H__
+
+CCL_NAMESPACE_BEGIN
+
+class Scene;
+
+/* Binary scene cache, to avoid parsing large XML scenes every time they are rendered. The cache
+ * is only valid for the build of Cycles that wrote it. */
+
+bool binary_is_file(const char *filepath);
+bool binary_read_file(Scene *scene, const char *filepath);
+bool binary_write_file(Scene *scene, const char *filepath);
+
+CCL_NAMESPACE_END
+
+#endif /* __CYCLES_BINARY_H__ */
@@ -28,6 +28,7 @@
 #  include "hydra/file_reader.h"
 #endif
 
+#include "app/cycles_binary.h"
 #include "app/cycles_xml.h"
 #include "app/oiio_output_driver.h"
 
@@ -49,6 +50,10 @@ struct Options {
   bool show_help, interactive, pause;
   string output_filepath;
   string output_pass;
+  string write_cache_filepath;
+  int seed_offset;
+  /* Region of the image to render, from the top left corner. Zero size to render all. */
+  int region_x, region_y, region_width, region_height;
 } options;
 
 static void session_print(const string &str)
@@ -86,32 +91,61 @@ static void session_print_status()
   session_print(status);
 }
 
+static bool use_region()
+{
+  return options.region_width > 0 && options.region_height > 0;
+}
+
 static BufferParams &session_buffer_params()
 {
   static BufferParams buffer_params;
-  buffer_params.width = options.width;
-  buffer_params.height = options.height;
+  if (use_region()) {
+    /* Render buffers have their origin at the bottom left. */
+    buffer_params.width = options.region_width;
+    buffer_params.height = options.region_height;
+    buffer_params.full_x = options.region_x;
+    buffer_params.full_y = options.height - options.region_y - options.region_height;
+  }
+  else {
+    buffer_params.width = options.width;
+    buffer_params.height = options.height;
+    buffer_params.full_x = 0;
+    buffer_params.full_y = 0;
+  }
   buffer_params.full_width = options.width;
   buffer_params.full_height = options.height;
 
   return buffer_params;
 }
 
-static void scene_init()
+static void scene_read()
 {
   options.scene = options.session->scene;
 
-  /* Read XML or USD */
+  const double start_time = time_dt();
+
+  /* Read binary scene cache, XML or USD */
+  if (binary_is_file(options.filepath.c_str())) {
+    if (!binary_read_file(options.scene, options.filepath.c_str())) {
+      exit(EXIT_FAILURE);
+    }
+  }
 #ifdef WITH_USD
-  if (!string_endswith(string_to_lower(options.filepath), ".xml")) {
+  else if (!string_endswith(string_to_lower(options.filepath), ".xml")) {
     HD_CYCLES_NS::HdCyclesFileReader::read(options.session, options.filepath.c_str());
   }
-  else
 #endif
-  {
+  else {
     xml_read_file(options.scene, options.filepath.c_str());
   }
 
+  VLOG_INFO << "Scene loaded in " << time_dt() - start_time << " seconds.";
+}
+
+static void scene_init()
+{
+  scene_read();
+
   /* Camera width/height override? */
   if (!(options.width == 0 || options.height == 0)) {
     options.scene->camera->set_full_width(options.width);
@@ -122,8 +156,24 @@ static void scene_init()
     options.height = options.scene->camera->get_full_height();
   }
 
+  if (use_region() && (options.region_x + options.region_width > options.width ||
+                       options.region_y + options.region_height > options.height))
+  {
+    fprintf(stderr,
+            "Region does not fit in image of %dx%d pixels\n",
+            options.width,
+            options.height);
+    exit(EXIT_FAILURE);
+  }
+
   /* Calculate Viewplane */
   options.scene->camera->compute_auto_viewplane();
+
+  /* Decorrelate renders of the same samples, to combine them afterwards. */
+  if (options.seed_offset != 0) {
+    Integrator *integrator = options.scene->integrator;
+    integrator->set_seed(integrator->get_seed() + options.seed_offset);
+  }
 }
 
 static void session_init()
@@ -138,9 +188,12 @@ static void session_init()
   }
 #endif
 
+  OIIOOutputDriver *output_driver = nullptr;
   if (!options.output_filepath.empty()) {
-    options.session->set_output_driver(make_unique<OIIOOutputDriver>(
-        options.output_filepath, options.output_pass, session_print));
+    unique_ptr<OIIOOutputDriver> driver = make_unique<OIIOOutputDriver>(
+        options.output_filepath, options.output_pass, session_print);
+    output_driver = driver.get();
+    options.session->set_output_driver(std::move(driver));
   }
 
   if (options.session_params.background && !options.quiet) {
@@ -154,6 +207,16 @@ static void session_init()
   /* load scene */
   scene_init();
 
+  if (output_driver) {
+    if (use_region()) {
+      output_driver->set_region(make_int2(options.region_x, options.region_y),
+                                make_int2(options.width, options.height));
+    }
+    output_driver->set_samples(options.session_params.samples,
+                               options.session_params.sample_offset,
+                               options.scene->integrator->get_seed());
+  }
+
   /* add pass for output. */
   Pass *pass = options.scene->create_node<Pass>();
   pass->set_name(ustring(options.output_pass.c_str()));
@@ -163,6 +226,19 @@ static void session_init()
   options.session->start();
 }
 
+static int scene_cache_write()
+{
+  options.session = new Session(options.session_params, options.scene_params);
+  scene_read();
+
+  const bool success = binary_write_file(options.scene, options.write_cache_filepath.c_str());
+
+  delete options.session;
+  options.session = NULL;
+
+  return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 static void session_exit()
 {
   if (options.session) {
@@ -366,6 +442,11 @@ static void options_parse(int argc, const char **argv)
   options.quiet = false;
   options.session_params.use_auto_tile = false;
   options.session_params.tile_size = 0;
+  options.seed_offset = 0;
+  options.region_x = 0;
+  options.region_y = 0;
+  options.region_width = 0;
+  options.region_height = 0;
 
   /* device names */
   string device_names = "";
@@ -389,6 +470,7 @@ static void options_parse(int argc, const char **argv)
   ArgParse ap;
   bool help = false, profile = false, debug = false, version = false;
   int verbosity = 1;
+  int texture_cache_size = 0;
 
   ap.options("Usage: cycles [options] file.xml",
              "%*",
@@ -411,9 +493,20 @@ static void options_parse(int argc, const char **argv)
              "--samples %d",
              &options.session_params.samples,
              "Number of samples to render",
+             "--sample-offset %d",
+             &options.session_params.sample_offset,
+             "Number of samples to skip, to render a range of samples that can be merged with "
+             "other renders",
+             "--seed-offset %d",
+             &options.seed_offset,
+             "Offset added to the seed of the scene",
              "--output %s",
              &options.output_filepath,
              "File path to write output image",
+             "--write-cache %s",
+             &options.write_cache_filepath,
+             "Write the scene to a binary cache file that loads faster than the scene file, "
+             "and exit without rendering. The cache can be rendered like a scene file",
              "--threads %d",
              &options.session_params.threads,
              "CPU Rendering Threads",
@@ -423,9 +516,19 @@ static void options_parse(int argc, const char **argv)
              "--height %d",
              &options.height,
              "Window height in pixel",
+             "--region %d %d %d %d",
+             &options.region_x,
+             &options.region_y,
+             &options.region_width,
+             &options.region_height,
+             "Render only a region of the image, given by X, Y, width and height in pixels from "
+             "the top left corner. The output image has the region as data window",
              "--tile-size %d",
              &options.session_params.tile_size,
              "Tile size in pixels",
+             "--texture-cache-size %d",
+             &texture_cache_size,
+             "Load image textures on demand, with a cache of this size in megabytes (CPU only)",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -498,6 +601,10 @@ static void options_parse(int argc, const char **argv)
     options.session_params.use_auto_tile = true;
   }
 
+  if (texture_cache_size > 0) {
+    options.scene_params.texture_cache_size = size_t(texture_cache_size) * 1024 * 1024;
+  }
+
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
   vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
@@ -529,6 +636,16 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "Invalid number of samples: %d\n", options.session_params.samples);
     exit(EXIT_FAILURE);
   }
+  else if (options.session_params.sample_offset < 0) {
+    fprintf(stderr, "Invalid sample offset: %d\n", options.session_params.sample_offset);
+    exit(EXIT_FAILURE);
+  }
+  else if (options.region_width < 0 || options.region_height < 0 || options.region_x < 0 ||
+           options.region_y < 0)
+  {
+    fprintf(stderr, "Invalid region\n");
+    exit(EXIT_FAILURE);
+  }
   else if (options.filepath == "") {
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
@@ -545,6 +662,10 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (!options.write_cache_filepath.empty()) {
+    return scene_cache_write();
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
@@ -20,6 +20,19 @@ OIIOOutputDriver::OIIOOutputDriver(const string_view filepath,
 
 OIIOOutputDriver::~OIIOOutputDriver() {}
 
+void OIIOOutputDriver::set_region(const int2 offset, const int2 full_size)
+{
+  region_offset_ = offset;
+  full_size_ = full_size;
+}
+
+void OIIOOutputDriver::set_samples(const int samples, const int sample_offset, const int seed)
+{
+  samples_ = samples;
+  sample_offset_ = sample_offset;
+  seed_ = seed;
+}
+
 void OIIOOutputDriver::write_render_tile(const Tile &tile)
 {
   /* Only write the full buffer, no intermediate tiles. */
@@ -39,6 +52,22 @@ void OIIOOutputDriver::write_render_tile(const Tile &tile)
   const int height = tile.size.y;
 
   ImageSpec spec(width, height, 4, TypeDesc::FLOAT);
+  if (full_size_.x > 0 && full_size_.y > 0) {
+    spec.x = region_offset_.x;
+    spec.y = region_offset_.y;
+    spec.full_width = full_size_.x;
+    spec.full_height = full_size_.y;
+  }
+
+  if (samples_ > 0) {
+    /* Same metadata as Blender writes for render layers. */
+    const string prefix = "cycles." + (tile.layer.empty() ? string("RenderLayer") : tile.layer) +
+                          ".";
+    spec.attribute(prefix + "samples", TypeDesc::STRING, to_string(samples_));
+    spec.attribute(prefix + "sample_offset", TypeDesc::STRING, to_string(sample_offset_));
+    spec.attribute(prefix + "seed", TypeDesc::STRING, to_string(seed_));
+  }
+
   if (!image_output->open(filepath_, spec)) {
     log_("Failed to create image file");
     return;
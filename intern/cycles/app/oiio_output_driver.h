@@ -19,12 +19,27 @@ class OIIOOutputDriver : public OutputDriver {
   OIIOOutputDriver(const string_view filepath, const string_view pass, LogFunction log);
   virtual ~OIIOOutputDriver();
 
+  /* Region of the full image that is rendered, with the offset from the top left corner. Written
+   * as data window of the image, for file formats that support it. */
+  void set_region(const int2 offset, const int2 full_size);
+
+  /* Range of samples and seed the image is rendered with, written as metadata for merging
+   * partial renders with ImageMerger. */
+  void set_samples(const int samples, const int sample_offset, const int seed);
+
   void write_render_tile(const Tile &tile) override;
 
  protected:
   string filepath_;
   string pass_;
   LogFunction log_;
+
+  int2 region_offset_ = make_int2(0, 0);
+  int2 full_size_ = make_int2(0, 0);
+
+  int samples_ = 0;
+  int sample_offset_ = 0;
+  int seed_ = 0;
 };
 
 CCL_NAMESPACE_END
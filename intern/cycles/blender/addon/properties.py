@@ -1041,6 +1041,21 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=8, max=8192,
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Load image textures in tiles and at the resolution needed, on demand while rendering. "
+                    "Images are converted to tiled and mip-mapped files in the cache directory first. "
+                    "Only supported on the CPU with SVM shading",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Memory budget for the texture cache in megabytes, tiles that were not used recently are "
+                    "freed to stay within it",
+        default=4096,
+        min=64,
+    )
+
     # Various fine-tuning debug flags
 
     def _devices_update_callback(self, context):
@@ -1050,6 +1065,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
 
     debug_use_cpu_avx2: BoolProperty(name="AVX2", default=True)
     debug_use_cpu_sse42: BoolProperty(name="SSE42", default=True)
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Render batches of paths one kernel at a time, sorted by shader",
+        default=False,
+    )
     debug_bvh_layout: EnumProperty(
         name="BVH Layout",
         items=enum_bvh_layouts,
@@ -860,6 +860,9 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
   params.use_bvh_compact_structure = RNA_boolean_get(&cscene, "debug_use_compact_bvh");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  /* Renders of animations that keep the scene between frames can refit the BVH of deforming
+   * geometry. */
+  params.use_bvh_refit = background && b_scene.render().use_persistent_data();
 
   PointerRNA csscene = RNA_pointer_get(&b_scene.ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
@@ -880,6 +883,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
     params.texture_limit = 0;
   }
 
+  if (get_boolean(cscene, "use_texture_cache")) {
+    params.texture_cache_size = size_t(get_int(cscene, "texture_cache_size")) * 1024 * 1024;
+  }
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -14,6 +14,13 @@
 #include "bvh/multi.h"
 #include "bvh/optix.h"
 
+#include "scene/hair.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/pointcloud.h"
+
+#include "util/boundbox.h"
+#include "util/foreach.h"
 #include "util/log.h"
 #include "util/progress.h"
 
@@ -139,4 +146,67 @@ BVH *BVH::create(const BVHParams &params,
   return NULL;
 }
 
+/* BVH Cost Estimate */
+
+float bvh_estimate_sah_cost(const BVHParams &params, const vector<Object *> &objects)
+{
+  /* Leaves of a few vertices each, in the order of the geometry. */
+  const int leaf_size = 4;
+  const int node_width = 4;
+
+  vector<BoundBox> bounds;
+  foreach (Object *ob, objects) {
+    Geometry *geom = ob->get_geometry();
+    const array<float3> *positions = NULL;
+    if (geom->is_mesh() || geom->is_volume()) {
+      positions = &static_cast<Mesh *>(geom)->get_verts();
+    }
+    else if (geom->is_hair()) {
+      positions = &static_cast<Hair *>(geom)->get_curve_keys();
+    }
+    else if (geom->is_pointcloud()) {
+      positions = &static_cast<PointCloud *>(geom)->get_points();
+    }
+    if (positions == NULL) {
+      continue;
+    }
+
+    for (size_t start = 0; start < positions->size(); start += leaf_size) {
+      const size_t end = min(start + leaf_size, positions->size());
+      BoundBox leaf = BoundBox::empty;
+      for (size_t i = start; i < end; i++) {
+        leaf.grow((*positions)[i]);
+      }
+      bounds.push_back(leaf);
+    }
+  }
+
+  if (bounds.empty()) {
+    return 0.0f;
+  }
+
+  float sah_cost = 0.0f;
+  foreach (const BoundBox &leaf, bounds) {
+    sah_cost += leaf.safe_area() * params.cost(0, leaf_size);
+  }
+
+  /* Merge groups of nodes into their parent until only the root is left. */
+  while (bounds.size() > 1) {
+    size_t num_parents = 0;
+    for (size_t start = 0; start < bounds.size(); start += node_width) {
+      const size_t end = min(start + node_width, bounds.size());
+      BoundBox parent = BoundBox::empty;
+      for (size_t i = start; i < end; i++) {
+        parent.grow(bounds[i]);
+      }
+      sah_cost += parent.safe_area() * params.cost((int)(end - start), 0);
+      bounds[num_parents++] = parent;
+    }
+    bounds.resize(num_parents);
+  }
+
+  const float root_area = bounds[0].safe_area();
+  return (root_area > 0.0f) ? sah_cost / root_area : 0.0f;
+}
+
 CCL_NAMESPACE_END
@@ -82,12 +82,26 @@ class BVH {
     this->objects = objects;
   }
 
+  /* Whether the last refit degraded the BVH so much that it is better to build it again, see
+   * BVHParams::max_refit_cost_ratio. */
+  virtual bool need_rebuild_after_refit() const
+  {
+    return false;
+  }
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
       const vector<Object *> &objects);
 };
 
+/* Estimate of the SAH cost of a BVH over the geometry of the objects, for BVH types that don't
+ * expose their nodes. It is the cost of an implicit tree over the vertices in the order they are
+ * stored in, where neighbors are mostly close together like the primitives in the nodes of a
+ * built BVH. Like the cost of a refitted BVH, it goes up when neighbors move apart, even when the
+ * bounds of the geometry stay the same. */
+float bvh_estimate_sah_cost(const BVHParams &params, const vector<Object *> &objects);
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_H__ */
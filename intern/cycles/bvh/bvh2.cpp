@@ -83,6 +83,11 @@ void BVH2::build(Progress &progress, Stats *)
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root);
 
+  if (!params.top_level) {
+    build_sah_cost = root->computeSubtreeSAHCost(params);
+    refit_sah_cost = build_sah_cost;
+  }
+
   /* free build nodes */
   root->deleteSubtree();
 }
@@ -100,6 +105,12 @@ void BVH2::refit(Progress &progress)
   refit_nodes();
 }
 
+bool BVH2::need_rebuild_after_refit() const
+{
+  return params.max_refit_cost_ratio > 0.0f &&
+         refit_sah_cost > build_sah_cost * params.max_refit_cost_ratio;
+}
+
 BVHNode *BVH2::widen_children_nodes(const BVHNode *root)
 {
   return const_cast<BVHNode *>(root);
@@ -309,10 +320,16 @@ void BVH2::refit_nodes()
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah_cost = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, sah_cost);
+
+  /* Same as BVHNode::computeSubtreeSAHCost(), which weights nodes by their area relative to the
+   * root. */
+  const float area = bbox.safe_area();
+  refit_sah_cost = (area > 0.0f) ? sah_cost / area : build_sah_cost;
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah_cost)
 {
   if (leaf) {
     /* refit leaf node */
@@ -322,6 +339,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c1 = data[0].y;
 
     refit_primitives(c0, c1, bbox, visibility);
+    sah_cost += bbox.safe_area() * params.cost(0, c1 - c0);
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -342,8 +360,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
     uint visibility0 = 0, visibility1 = 0;
 
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0, sah_cost);
+    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1, sah_cost);
 
     if (is_unaligned) {
       Transform aligned_space = transform_identity();
@@ -357,6 +375,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    sah_cost += bbox.safe_area() * params.cost(2, 0);
   }
 }
 
@@ -100,7 +100,9 @@ BVHEmbree::BVHEmbree(const BVHParams &params_,
     : BVH(params_, geometry_, objects_),
       scene(NULL),
       rtc_device(NULL),
-      build_quality(RTC_BUILD_QUALITY_REFIT)
+      build_quality(RTC_BUILD_QUALITY_REFIT),
+      build_sah_cost(0.0f),
+      refit_sah_cost(0.0f)
 {
   SIMD_SET_FLUSH_TO_ZERO;
 }
@@ -133,9 +135,13 @@ void BVHEmbree::build(Progress &progress,
 
   const bool dynamic = params.bvh_type == BVH_TYPE_DYNAMIC;
   const bool compact = params.use_compact_structure;
+  /* Embree only refits geometry in scenes with the dynamic flag, building them with the
+   * requested quality still. */
+  const bool use_refit = !params.top_level && params.max_refit_cost_ratio > 0.0f;
 
   scene = rtcNewScene(rtc_device);
-  const RTCSceneFlags scene_flags = (dynamic ? RTC_SCENE_FLAG_DYNAMIC : RTC_SCENE_FLAG_NONE) |
+  const RTCSceneFlags scene_flags = (dynamic || use_refit ? RTC_SCENE_FLAG_DYNAMIC :
+                                                            RTC_SCENE_FLAG_NONE) |
                                     (compact ? RTC_SCENE_FLAG_COMPACT : RTC_SCENE_FLAG_NONE) |
                                     RTC_SCENE_FLAG_ROBUST
 #  if EMBREE_MAJOR_VERSION >= 4
@@ -176,6 +182,11 @@ void BVHEmbree::build(Progress &progress,
 
   rtcSetSceneProgressMonitorFunction(scene, rtc_progress_func, &progress);
   rtcCommitScene(scene);
+
+  if (use_refit) {
+    build_sah_cost = bvh_estimate_sah_cost(params, objects);
+    refit_sah_cost = build_sah_cost;
+  }
 }
 
 const char *BVHEmbree::get_last_error_message()
@@ -684,6 +695,10 @@ void BVHEmbree::refit(Progress &progress)
 {
   progress.set_substatus("Refitting BVH nodes");
 
+  /* Keep the topology of the BVH of static renders, rather than building it again with the
+   * quality it was created with. */
+  const bool use_refit = !params.top_level && params.max_refit_cost_ratio > 0.0f;
+
   /* Update all vertex buffers, then tell Embree to rebuild/-fit the BVHs. */
   unsigned geom_id = 0;
   foreach (Object *ob, objects) {
@@ -695,6 +710,9 @@ void BVHEmbree::refit(Progress &progress)
         if (mesh->num_triangles() > 0) {
           RTCGeometry geom = rtcGetGeometry(scene, geom_id);
           set_tri_vertex_buffer(geom, mesh, true);
+          if (use_refit) {
+            rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+          }
           rtcSetGeometryUserData(geom, (void *)mesh->prim_offset);
           rtcCommitGeometry(geom);
         }
@@ -704,6 +722,9 @@ void BVHEmbree::refit(Progress &progress)
         if (hair->num_curves() > 0) {
           RTCGeometry geom = rtcGetGeometry(scene, geom_id + 1);
           set_curve_vertex_buffer(geom, hair, true);
+          if (use_refit) {
+            rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+          }
           rtcSetGeometryUserData(geom, (void *)hair->curve_segment_offset);
           rtcCommitGeometry(geom);
         }
@@ -713,6 +734,9 @@ void BVHEmbree::refit(Progress &progress)
         if (pointcloud->num_points() > 0) {
           RTCGeometry geom = rtcGetGeometry(scene, geom_id);
           set_point_vertex_buffer(geom, pointcloud, true);
+          if (use_refit) {
+            rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+          }
           rtcCommitGeometry(geom);
         }
       }
@@ -721,6 +745,18 @@ void BVHEmbree::refit(Progress &progress)
   }
 
   rtcCommitScene(scene);
+
+  if (use_refit) {
+    refit_sah_cost = bvh_estimate_sah_cost(params, objects);
+  }
+}
+
+bool BVHEmbree::need_rebuild_after_refit() const
+{
+  /* Embree does not expose its nodes to compute the SAH cost like BVH2 does, so it is estimated
+   * from the geometry instead. */
+  return params.max_refit_cost_ratio > 0.0f &&
+         refit_sah_cost > build_sah_cost * params.max_refit_cost_ratio;
 }
 
 CCL_NAMESPACE_END
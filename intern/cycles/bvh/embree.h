@@ -37,6 +37,8 @@ class BVHEmbree : public BVH {
              const bool isSyclEmbreeDevice = false);
   void refit(Progress &progress);
 
+  bool need_rebuild_after_refit() const;
+
 #  if defined(WITH_EMBREE_GPU) && RTC_VERSION >= 40302
   bool offload_scenes_to_gpu(const vector<RTCScene> &scenes);
 #  endif
@@ -68,6 +70,10 @@ class BVHEmbree : public BVH {
   RTCDevice rtc_device;
   bool rtc_device_is_sycl;
   enum RTCBuildQuality build_quality;
+
+  /* Estimated SAH cost right after building and after the last refit. */
+  float build_sah_cost;
+  float refit_sah_cost;
 };
 
 CCL_NAMESPACE_END
@@ -30,4 +30,14 @@ void BVHMulti::replace_geometry(const vector<Geometry *> &geometry,
   }
 }
 
+bool BVHMulti::need_rebuild_after_refit() const
+{
+  foreach (BVH *bvh, sub_bvhs) {
+    if (bvh->need_rebuild_after_refit()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 CCL_NAMESPACE_END
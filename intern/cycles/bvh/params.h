@@ -108,6 +108,11 @@ class BVHParams {
   /* These are needed for Embree. */
   int curve_subdivisions;
 
+  /* Refitting keeps the topology of the tree, which gets slower to traverse as primitives move
+   * away from where they were when it was built. Rebuild when the estimated traversal cost after
+   * refitting exceeds the cost after building by this factor, zero to always refit. */
+  float max_refit_cost_ratio;
+
   /* fixed parameters */
   enum { MAX_DEPTH = 64, MAX_SPATIAL_DEPTH = 48, NUM_SPATIAL_BINS = 32 };
 
@@ -143,6 +148,8 @@ class BVHParams {
     bvh_type = 0;
 
     curve_subdivisions = 4;
+
+    max_refit_cost_ratio = 0.0f;
   }
 
   /* SAH costs */
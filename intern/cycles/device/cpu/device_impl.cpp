@@ -243,7 +243,12 @@ void CPUDevice::tex_alloc(device_texture &mem)
   const uint slot = mem.slot;
   if (slot >= texture_info.size()) {
     /* Allocate some slots in advance, to reduce amount of re-allocations. */
+    const size_t old_size = texture_info.size();
     texture_info.resize(slot + 128);
+    /* Clear new slots, so that unused ones don't point to any image. */
+    for (size_t i = old_size; i < texture_info.size(); i++) {
+      texture_info[i] = TextureInfo();
+    }
   }
 
   texture_info[slot] = mem.info;
@@ -257,6 +262,9 @@ void CPUDevice::tex_free(device_texture &mem)
     mem.device_pointer = 0;
     stats.mem_free(mem.device_size);
     mem.device_size = 0;
+    if (mem.slot < texture_info.size()) {
+      texture_info[mem.slot] = TextureInfo();
+    }
     need_texture_info = true;
   }
 }
@@ -326,6 +334,11 @@ void *CPUDevice::get_cpu_osl_memory()
 #endif
 }
 
+void CPUDevice::set_cpu_texture_cache(TextureCache *texture_cache)
+{
+  kernel_globals.texture_cache = texture_cache;
+}
+
 bool CPUDevice::load_kernels(const uint /*kernel_features*/)
 {
   return true;
@@ -32,6 +32,8 @@ CPUKernels::CPUKernels()
       REGISTER_KERNEL(integrator_shade_volume),
       REGISTER_KERNEL(integrator_shade_dedicated_light),
       REGISTER_KERNEL(integrator_megakernel),
+      REGISTER_KERNEL(integrator_wavefront_shadow),
+      REGISTER_KERNEL(integrator_wavefront_path),
       /* Shader evaluation. */
       REGISTER_KERNEL(shader_eval_displace),
       REGISTER_KERNEL(shader_eval_background),
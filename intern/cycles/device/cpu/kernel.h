@@ -42,6 +42,8 @@ class CPUKernels {
   IntegratorShadeFunction integrator_shade_volume;
   IntegratorShadeFunction integrator_shade_dedicated_light;
   IntegratorShadeFunction integrator_megakernel;
+  IntegratorShadeFunction integrator_wavefront_shadow;
+  IntegratorShadeFunction integrator_wavefront_path;
 
   /* Shader evaluation. */
 
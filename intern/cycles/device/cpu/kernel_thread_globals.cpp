@@ -7,6 +7,7 @@
 #include "kernel/osl/globals.h"
 
 #include "util/profiling.h"
+#include "util/texture_cache.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -88,4 +89,12 @@ void CPUKernelThreadGlobals::stop_profiling()
   cpu_profiler_.remove_state(&profiler);
 }
 
+void CPUKernelThreadGlobals::flush_texture_cache_statistics()
+{
+  if (texture_cache && texture_cache_tile_requests) {
+    texture_cache->add_tile_requests(texture_cache_tile_requests);
+  }
+  texture_cache_tile_requests = 0;
+}
+
 CCL_NAMESPACE_END
@@ -37,6 +37,9 @@ class CPUKernelThreadGlobals : public KernelGlobalsCPU {
   void start_profiling();
   void stop_profiling();
 
+  /* Add the texture cache statistics gathered by this thread to the cache. */
+  void flush_texture_cache_statistics();
+
  protected:
   void clear_runtime_pointers();
 
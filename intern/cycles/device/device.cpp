@@ -489,6 +489,8 @@ void *Device::get_cpu_osl_memory()
   return nullptr;
 }
 
+void Device::set_cpu_texture_cache(TextureCache * /*texture_cache*/) {}
+
 GPUDevice::~GPUDevice() noexcept(false) {}
 
 bool GPUDevice::load_texture_info()
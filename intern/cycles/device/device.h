@@ -31,6 +31,7 @@ class Progress;
 class CPUKernels;
 class CPUKernelThreadGlobals;
 class Scene;
+class TextureCache;
 
 /* Device Types */
 
@@ -220,6 +221,8 @@ class Device {
       vector<CPUKernelThreadGlobals> & /*kernel_thread_globals*/);
   /* Get OpenShadingLanguage memory buffer. */
   virtual void *get_cpu_osl_memory();
+  /* Set the cache of images loaded on demand, which kernel threads report statistics to. */
+  virtual void set_cpu_texture_cache(TextureCache *texture_cache);
 
   /* Acceleration structure building. */
   virtual void build_bvh(BVH *bvh, Progress &progress, bool refit);
@@ -0,0 +1,537 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "graph/node_binary.h"
+
+#include <cstring>
+
+#include "util/foreach.h"
+#include "util/log.h"
+#include "util/transform.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Increment when the layout of the file or of any serialized node changes. */
+#define BINARY_FORMAT_VERSION 1
+#define BINARY_BYTE_ORDER_MARK 0x01020304u
+
+/* Writer */
+
+BinaryWriter::BinaryWriter(FILE *file) : file_(file), offset_(0), ok_(file != nullptr) {}
+
+void BinaryWriter::write(const void *data, const size_t size)
+{
+  if (!ok_ || size == 0) {
+    return;
+  }
+  if (fwrite(data, 1, size, file_) != size) {
+    ok_ = false;
+    return;
+  }
+  offset_ += size;
+}
+
+void BinaryWriter::write_uint8(const uint8_t value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_uint32(const uint32_t value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_uint64(const uint64_t value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_string(const string &value)
+{
+  write_uint32(value.size());
+  write(value.data(), value.size());
+}
+
+void BinaryWriter::write_string(ustring value)
+{
+  write_uint32(value.size());
+  write(value.c_str(), value.size());
+}
+
+void BinaryWriter::write_blob(const void *data, const size_t size)
+{
+  write_uint64(size);
+
+  const uint8_t padding[BINARY_BLOB_ALIGNMENT] = {0};
+  write(padding, align_up(offset_, BINARY_BLOB_ALIGNMENT) - offset_);
+  write(data, size);
+}
+
+void BinaryWriter::write_header(const char magic[8])
+{
+  write(magic, 8);
+  write_uint32(BINARY_FORMAT_VERSION);
+  write_uint32(BINARY_BYTE_ORDER_MARK);
+  write_uint32(sizeof(float3));
+  write_uint32(sizeof(Transform));
+}
+
+/* Reader */
+
+BinaryReader::BinaryReader(const uint8_t *data, const size_t size)
+    : data_(data), size_(size), offset_(0), ok_(data != nullptr)
+{
+}
+
+bool BinaryReader::read(void *data, const size_t size)
+{
+  if (!ok_ || size > size_ - offset_) {
+    ok_ = false;
+    memset(data, 0, size);
+    return false;
+  }
+  memcpy(data, data_ + offset_, size);
+  offset_ += size;
+  return true;
+}
+
+uint8_t BinaryReader::read_uint8()
+{
+  uint8_t value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+uint32_t BinaryReader::read_uint32()
+{
+  uint32_t value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+uint64_t BinaryReader::read_uint64()
+{
+  uint64_t value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+string BinaryReader::read_string()
+{
+  const uint32_t size = read_uint32();
+  if (!ok_ || size > size_ - offset_) {
+    ok_ = false;
+    return string();
+  }
+  string value((const char *)data_ + offset_, size);
+  offset_ += size;
+  return value;
+}
+
+ustring BinaryReader::read_ustring()
+{
+  const uint32_t size = read_uint32();
+  if (!ok_ || size > size_ - offset_) {
+    ok_ = false;
+    return ustring();
+  }
+  ustring value((const char *)data_ + offset_, size);
+  offset_ += size;
+  return value;
+}
+
+const void *BinaryReader::read_blob(size_t &size)
+{
+  size = read_uint64();
+  if (!ok_) {
+    size = 0;
+    return nullptr;
+  }
+
+  const size_t offset = align_up(offset_, BINARY_BLOB_ALIGNMENT);
+  if (offset > size_ || size > size_ - offset) {
+    ok_ = false;
+    size = 0;
+    return nullptr;
+  }
+
+  offset_ = offset + size;
+  return data_ + offset;
+}
+
+bool BinaryReader::read_header(const char magic[8])
+{
+  char file_magic[8];
+  read(file_magic, sizeof(file_magic));
+  const uint32_t version = read_uint32();
+  const uint32_t byte_order_mark = read_uint32();
+  const uint32_t float3_size = read_uint32();
+  const uint32_t transform_size = read_uint32();
+
+  if (!ok_ || memcmp(file_magic, magic, sizeof(file_magic)) != 0) {
+    VLOG_WARNING << "Not a binary file of the expected type.";
+    ok_ = false;
+  }
+  else if (version != BINARY_FORMAT_VERSION) {
+    VLOG_WARNING << "Binary file version " << version << " does not match version "
+                 << BINARY_FORMAT_VERSION << ".";
+    ok_ = false;
+  }
+  else if (byte_order_mark != BINARY_BYTE_ORDER_MARK || float3_size != sizeof(float3) ||
+           transform_size != sizeof(Transform))
+  {
+    VLOG_WARNING << "Binary file was written on a platform with a different data layout.";
+    ok_ = false;
+  }
+
+  return ok_;
+}
+
+/* Nodes */
+
+template<typename T> static void binary_write_array(BinaryWriter &writer, const array<T> &value)
+{
+  writer.write_blob(value.data(), value.size() * sizeof(T));
+}
+
+template<typename T>
+static void binary_read_array(BinaryReader &reader, Node *node, const SocketType *socket)
+{
+  size_t size;
+  const void *data = reader.read_blob(size);
+  if (socket == nullptr || !reader.ok()) {
+    return;
+  }
+  if (size % sizeof(T) != 0) {
+    VLOG_WARNING << "Invalid array size for socket " << socket->name << " of " << node->name
+                 << ".";
+    return;
+  }
+
+  /* The socket takes ownership of the array, so this is the only copy. */
+  array<T> value;
+  value.resize(size / sizeof(T));
+  if (size) {
+    memcpy(value.data(), data, size);
+  }
+  node->set(*socket, value);
+}
+
+static uint32_t binary_node_index(const BinaryWriter &writer, const Node *value)
+{
+  if (value == nullptr) {
+    return 0;
+  }
+  map<const Node *, uint32_t>::const_iterator it = writer.node_index.find(value);
+  if (it == writer.node_index.end()) {
+    VLOG_WARNING << "Node " << value->name << " is not part of the binary file.";
+    return 0;
+  }
+  return it->second + 1;
+}
+
+static Node *binary_index_node(const BinaryReader &reader,
+                               const uint32_t index,
+                               const SocketType &socket)
+{
+  if (index == 0 || index > reader.nodes.size()) {
+    return nullptr;
+  }
+  Node *value = reader.nodes[index - 1];
+  return (value && value->is_a(socket.node_type)) ? value : nullptr;
+}
+
+void binary_write_node(BinaryWriter &writer, const Node *node)
+{
+  vector<const SocketType *> sockets;
+  foreach (const SocketType &socket, node->type->inputs) {
+    if (socket.type == SocketType::CLOSURE || socket.type == SocketType::UNDEFINED) {
+      continue;
+    }
+    if (socket.flags & SocketType::INTERNAL) {
+      continue;
+    }
+    if (node->has_default_value(socket)) {
+      continue;
+    }
+    sockets.push_back(&socket);
+  }
+
+  writer.write_string(node->name);
+  writer.write_uint32(sockets.size());
+
+  foreach (const SocketType *socket, sockets) {
+    writer.write_string(socket->name);
+    writer.write_uint8(socket->type);
+
+    switch (socket->type) {
+      case SocketType::BOOLEAN: {
+        writer.write_uint8(node->get_bool(*socket));
+        break;
+      }
+      case SocketType::FLOAT: {
+        const float value = node->get_float(*socket);
+        writer.write(&value, sizeof(value));
+        break;
+      }
+      case SocketType::INT:
+      case SocketType::ENUM: {
+        writer.write_uint32(node->get_int(*socket));
+        break;
+      }
+      case SocketType::UINT: {
+        writer.write_uint32(node->get_uint(*socket));
+        break;
+      }
+      case SocketType::UINT64: {
+        writer.write_uint64(node->get_uint64(*socket));
+        break;
+      }
+      case SocketType::COLOR:
+      case SocketType::VECTOR:
+      case SocketType::POINT:
+      case SocketType::NORMAL: {
+        const float3 value = node->get_float3(*socket);
+        const float values[3] = {value.x, value.y, value.z};
+        writer.write(values, sizeof(values));
+        break;
+      }
+      case SocketType::POINT2: {
+        const float2 value = node->get_float2(*socket);
+        const float values[2] = {value.x, value.y};
+        writer.write(values, sizeof(values));
+        break;
+      }
+      case SocketType::STRING: {
+        writer.write_string(node->get_string(*socket));
+        break;
+      }
+      case SocketType::TRANSFORM: {
+        const Transform value = node->get_transform(*socket);
+        writer.write(&value, sizeof(value));
+        break;
+      }
+      case SocketType::NODE: {
+        writer.write_uint32(binary_node_index(writer, node->get_node(*socket)));
+        break;
+      }
+      case SocketType::BOOLEAN_ARRAY: {
+        binary_write_array(writer, node->get_bool_array(*socket));
+        break;
+      }
+      case SocketType::FLOAT_ARRAY: {
+        binary_write_array(writer, node->get_float_array(*socket));
+        break;
+      }
+      case SocketType::INT_ARRAY: {
+        binary_write_array(writer, node->get_int_array(*socket));
+        break;
+      }
+      case SocketType::COLOR_ARRAY:
+      case SocketType::VECTOR_ARRAY:
+      case SocketType::POINT_ARRAY:
+      case SocketType::NORMAL_ARRAY: {
+        binary_write_array(writer, node->get_float3_array(*socket));
+        break;
+      }
+      case SocketType::POINT2_ARRAY: {
+        binary_write_array(writer, node->get_float2_array(*socket));
+        break;
+      }
+      case SocketType::TRANSFORM_ARRAY: {
+        binary_write_array(writer, node->get_transform_array(*socket));
+        break;
+      }
+      case SocketType::STRING_ARRAY: {
+        const array<ustring> &value = node->get_string_array(*socket);
+        writer.write_uint32(value.size());
+        for (size_t i = 0; i < value.size(); i++) {
+          writer.write_string(value[i]);
+        }
+        break;
+      }
+      case SocketType::NODE_ARRAY: {
+        const array<Node *> &value = node->get_node_array(*socket);
+        writer.write_uint32(value.size());
+        for (size_t i = 0; i < value.size(); i++) {
+          writer.write_uint32(binary_node_index(writer, value[i]));
+        }
+        break;
+      }
+      case SocketType::CLOSURE:
+      case SocketType::UNDEFINED:
+      case SocketType::NUM_TYPES:
+        break;
+    }
+  }
+}
+
+bool binary_read_node(BinaryReader &reader, Node *node)
+{
+  node->name = reader.read_ustring();
+  const uint32_t num_sockets = reader.read_uint32();
+
+  for (uint32_t i = 0; i < num_sockets && reader.ok(); i++) {
+    const ustring name = reader.read_ustring();
+    const SocketType::Type type = (SocketType::Type)reader.read_uint8();
+
+    /* Values of sockets that no longer exist are read but not used. */
+    const SocketType *socket = node->type->find_input(name);
+    if (socket && (socket->type != type || (socket->flags & SocketType::INTERNAL))) {
+      socket = nullptr;
+    }
+
+    switch (type) {
+      case SocketType::BOOLEAN: {
+        const bool value = reader.read_uint8() != 0;
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::FLOAT: {
+        float value;
+        reader.read(&value, sizeof(value));
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::INT:
+      case SocketType::ENUM: {
+        const int value = (int)reader.read_uint32();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::UINT: {
+        const uint value = reader.read_uint32();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::UINT64: {
+        const uint64_t value = reader.read_uint64();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::COLOR:
+      case SocketType::VECTOR:
+      case SocketType::POINT:
+      case SocketType::NORMAL: {
+        float values[3];
+        reader.read(values, sizeof(values));
+        if (socket) {
+          node->set(*socket, make_float3(values[0], values[1], values[2]));
+        }
+        break;
+      }
+      case SocketType::POINT2: {
+        float values[2];
+        reader.read(values, sizeof(values));
+        if (socket) {
+          node->set(*socket, make_float2(values[0], values[1]));
+        }
+        break;
+      }
+      case SocketType::STRING: {
+        const ustring value = reader.read_ustring();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::TRANSFORM: {
+        Transform value;
+        reader.read(&value, sizeof(value));
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::NODE: {
+        const uint32_t index = reader.read_uint32();
+        if (socket) {
+          node->set(*socket, binary_index_node(reader, index, *socket));
+        }
+        break;
+      }
+      case SocketType::BOOLEAN_ARRAY: {
+        binary_read_array<bool>(reader, node, socket);
+        break;
+      }
+      case SocketType::FLOAT_ARRAY: {
+        binary_read_array<float>(reader, node, socket);
+        break;
+      }
+      case SocketType::INT_ARRAY: {
+        binary_read_array<int>(reader, node, socket);
+        break;
+      }
+      case SocketType::COLOR_ARRAY:
+      case SocketType::VECTOR_ARRAY:
+      case SocketType::POINT_ARRAY:
+      case SocketType::NORMAL_ARRAY: {
+        binary_read_array<float3>(reader, node, socket);
+        break;
+      }
+      case SocketType::POINT2_ARRAY: {
+        binary_read_array<float2>(reader, node, socket);
+        break;
+      }
+      case SocketType::TRANSFORM_ARRAY: {
+        binary_read_array<Transform>(reader, node, socket);
+        break;
+      }
+      case SocketType::STRING_ARRAY: {
+        const uint32_t size = reader.read_uint32();
+        array<ustring> value;
+        for (uint32_t j = 0; j < size && reader.ok(); j++) {
+          value.push_back_slow(reader.read_ustring());
+        }
+        if (socket && reader.ok()) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::NODE_ARRAY: {
+        const uint32_t size = reader.read_uint32();
+        array<Node *> value;
+        bool valid = true;
+        for (uint32_t j = 0; j < size && reader.ok(); j++) {
+          const uint32_t index = reader.read_uint32();
+          if (socket) {
+            Node *value_node = binary_index_node(reader, index, *socket);
+            valid &= (value_node != nullptr);
+            value.push_back_slow(value_node);
+          }
+        }
+        /* Node arrays can not contain null pointers. */
+        if (socket && !valid) {
+          VLOG_WARNING << "Invalid node in socket " << name << " of " << node->name << ".";
+        }
+        else if (socket && reader.ok()) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::CLOSURE:
+      case SocketType::UNDEFINED:
+      case SocketType::NUM_TYPES:
+      default: {
+        /* The size of the value is unknown, so the rest of the file can not be read. */
+        VLOG_WARNING << "Invalid type of socket " << name << " of " << node->name << ".";
+        return false;
+      }
+    }
+  }
+
+  return reader.ok();
+}
+
+CCL_NAMESPACE_END
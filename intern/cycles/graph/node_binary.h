@@ -0,0 +1,91 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#pragma once
+
+#include <stdio.h>
+
+#include "graph/node.h"
+
+#include "util/map.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Binary Node Serialization
+ *
+ * Compact alternative to the XML serialization, meant for caching scenes. Values are stored in
+ * their in-memory representation and arrays as blobs aligned to BINARY_BLOB_ALIGNMENT from the
+ * start of the file, so a memory-mapped file can be read without any parsing. Files can only be
+ * read by a build with the same format version, byte order and vector type layout, which is
+ * verified by the header. */
+
+#define BINARY_BLOB_ALIGNMENT 64
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(FILE *file);
+
+  void write(const void *data, size_t size);
+  void write_uint8(uint8_t value);
+  void write_uint32(uint32_t value);
+  void write_uint64(uint64_t value);
+  void write_string(const string &value);
+  void write_string(ustring value);
+  /* Size followed by the data, aligned to BINARY_BLOB_ALIGNMENT. */
+  void write_blob(const void *data, size_t size);
+
+  /* Header identifying the format, written at the start of the file. */
+  void write_header(const char magic[8]);
+
+  bool ok() const
+  {
+    return ok_;
+  }
+
+  /* Nodes that node sockets may refer to, mapped to their index in the file. */
+  map<const Node *, uint32_t> node_index;
+
+ protected:
+  FILE *file_;
+  uint64_t offset_;
+  bool ok_;
+};
+
+class BinaryReader {
+ public:
+  BinaryReader(const uint8_t *data, size_t size);
+
+  bool read(void *data, size_t size);
+  uint8_t read_uint8();
+  uint32_t read_uint32();
+  uint64_t read_uint64();
+  string read_string();
+  ustring read_ustring();
+  /* Pointer to the data of a blob, without copying it. */
+  const void *read_blob(size_t &size);
+
+  bool read_header(const char magic[8]);
+
+  /* Errors are sticky, reading after an error returns zero values. */
+  bool ok() const
+  {
+    return ok_;
+  }
+
+  /* Nodes that node sockets may refer to, by their index in the file. */
+  vector<Node *> nodes;
+
+ protected:
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_;
+  bool ok_;
+};
+
+void binary_write_node(BinaryWriter &writer, const Node *node);
+bool binary_read_node(BinaryReader &reader, Node *node);
+
+CCL_NAMESPACE_END
@@ -16,7 +16,9 @@
 #include "scene/scene.h"
 #include "session/buffers.h"
 
+#include "util/algorithm.h"
 #include "util/atomic.h"
+#include "util/debug.h"
 #include "util/log.h"
 #include "util/tbb.h"
 
@@ -42,6 +44,11 @@ static inline CPUKernelThreadGlobals *kernel_thread_globals_get(
   return &kernel_thread_globals[thread_index];
 }
 
+/* Number of paths every thread renders together in wavefront mode. The CPU path state reserves
+ * room for many transparent shadow intersections, so this is a trade-off between coherence and
+ * the memory used by the states. */
+static constexpr int WAVEFRONT_NUM_PATHS = 512;
+
 PathTraceWorkCPU::PathTraceWorkCPU(Device *device,
                                    Film *film,
                                    DeviceScene *device_scene,
@@ -73,37 +80,71 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
     }
   }
 
+  KernelWorkTile work_tile_template;
+  work_tile_template.w = 1;
+  work_tile_template.h = 1;
+  work_tile_template.start_sample = start_sample;
+  work_tile_template.sample_offset = sample_offset;
+  work_tile_template.num_samples = 1;
+  work_tile_template.offset = effective_buffer_params_.offset;
+  work_tile_template.stride = effective_buffer_params_.stride;
+
+  bool use_wavefront = DebugFlags().cpu.wavefront;
+#ifdef WITH_PATH_GUIDING
+  /* Guiding records the segments of a single path at a time for every thread. */
+  if (device_scene_->data.integrator.use_guiding) {
+    use_wavefront = false;
+  }
+#endif
+
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
-  local_arena.execute([&]() {
-    parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
-      if (is_cancel_requested()) {
-        return;
-      }
+  if (use_wavefront) {
+    const int num_threads = kernel_thread_globals_.size();
+    wavefront_states_.resize(num_threads);
+
+    uint64_t next_pixel_index = 0;
+    local_arena.execute([&]() {
+      /* Every task renders pixels until there are none left, so that the batch of paths in flight
+       * stays full across chunks of pixels. */
+      parallel_for(0, num_threads, [&](int /*task_index*/) {
+        const int thread_index = tbb::this_task_arena::current_thread_index();
+        render_samples_wavefront(&kernel_thread_globals_[thread_index],
+                                 wavefront_states_[thread_index],
+                                 work_tile_template,
+                                 samples_num,
+                                 &next_pixel_index);
+      });
+    });
+  }
+  else {
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
 
-      const int y = work_index / image_width;
-      const int x = work_index - y * image_width;
+        const int y = work_index / image_width;
+        const int x = work_index - y * image_width;
 
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
-
-      CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(kernel_thread_globals_);
-
-      render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+        KernelWorkTile work_tile = work_tile_template;
+        work_tile.x = effective_buffer_params_.full_x + x;
+        work_tile.y = effective_buffer_params_.full_y + y;
+
+        CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
+
+        render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+      });
     });
-  });
+  }
   if (device_->profiler.active()) {
     for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
       kernel_globals.stop_profiling();
     }
   }
+  for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
+    kernel_globals.flush_texture_cache_statistics();
+  }
 
   statistics.occupancy = 1.0f;
 }
@@ -164,6 +205,145 @@ void PathTraceWorkCPU::render_samples_full_pipeline(KernelGlobalsCPU *kernel_glo
   }
 }
 
+static bool wavefront_state_is_active(const IntegratorStateCPU &state)
+{
+  return state.path.queued_kernel || state.shadow.shadow_path.queued_kernel ||
+         state.ao.shadow_path.queued_kernel;
+}
+
+/* Order paths by the kernel they are queued for, and by shader for the shading kernels. Other
+ * kernels keep the paths in pixel order, which keeps rays coherent. */
+static uint64_t wavefront_sort_key(const IntegratorStateCPU &state, const int index)
+{
+  const uint32_t kernel = state.path.queued_kernel;
+  const bool sort_by_shader = (kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE ||
+                               kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE ||
+                               kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE);
+  const uint64_t shader = (sort_by_shader) ? (state.sort_key & 0xFFFFFF) : 0;
+  return (uint64_t(kernel) << 48) | (shader << 24) | uint64_t(index);
+}
+
+void PathTraceWorkCPU::render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                                array<IntegratorStateCPU> &states,
+                                                const KernelWorkTile &work_tile_template,
+                                                const int samples_num,
+                                                uint64_t *next_pixel_index)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+  /* The shadow catcher splits a path into the state that follows it. */
+  const int states_per_path = (device_scene_->data.integrator.has_shadow_catcher) ? 2 : 1;
+  const int num_states = WAVEFRONT_NUM_PATHS * states_per_path;
+
+  const int64_t image_width = effective_buffer_params_.width;
+  const uint64_t total_pixels_num = image_width * effective_buffer_params_.height;
+  const uint64_t chunk_pixels_num = max(WAVEFRONT_NUM_PATHS / samples_num, 1);
+
+  float *render_buffer = buffers_->buffer.data();
+
+  states.resize(num_states);
+  for (int i = 0; i < num_states; i++) {
+    path_state_init_queues(&states[i]);
+  }
+
+  /* Pixels of the current chunk that remain to be started, and the next sample to start. */
+  uint64_t pixel_index = 0;
+  uint64_t pixel_end = 0;
+  int sample = 0;
+
+  auto next_work_tile = [&](KernelWorkTile &work_tile) {
+    if (is_cancel_requested()) {
+      return false;
+    }
+    if (pixel_index == pixel_end) {
+      pixel_index = atomic_fetch_and_add_uint64(next_pixel_index, chunk_pixels_num);
+      if (pixel_index >= total_pixels_num) {
+        pixel_index = pixel_end = total_pixels_num;
+        return false;
+      }
+      pixel_end = min(pixel_index + chunk_pixels_num, total_pixels_num);
+      sample = 0;
+    }
+
+    const int y = pixel_index / image_width;
+    const int x = pixel_index - y * image_width;
+
+    work_tile = work_tile_template;
+    work_tile.x = effective_buffer_params_.full_x + x;
+    work_tile.y = effective_buffer_params_.full_y + y;
+    work_tile.start_sample += sample;
+
+    if (++sample == samples_num) {
+      sample = 0;
+      pixel_index++;
+    }
+    return true;
+  };
+
+  vector<uint64_t> sort_keys;
+  sort_keys.reserve(num_states);
+
+  bool has_work = true;
+  while (true) {
+    /* Start new paths in place of the ones that finished. */
+    for (int i = 0; i < num_states && has_work; i += states_per_path) {
+      if (wavefront_state_is_active(states[i]) ||
+          (states_per_path == 2 && wavefront_state_is_active(states[i + 1])))
+      {
+        continue;
+      }
+
+      KernelWorkTile work_tile;
+      while ((has_work = next_work_tile(work_tile))) {
+        const bool started = (has_bake) ? kernels_.integrator_init_from_bake(
+                                              kernel_globals, &states[i], &work_tile, render_buffer) :
+                                          kernels_.integrator_init_from_camera(
+                                              kernel_globals, &states[i], &work_tile, render_buffer);
+        if (started) {
+          break;
+        }
+        /* Like the megakernel, skip the remaining samples of the pixel. */
+        if (sample != 0) {
+          sample = 0;
+          pixel_index++;
+        }
+      }
+    }
+
+    /* Finish shadow paths before the main paths may create new ones. */
+    bool has_shadow_paths = true;
+    while (has_shadow_paths) {
+      has_shadow_paths = false;
+      for (int i = 0; i < num_states; i++) {
+        if (states[i].shadow.shadow_path.queued_kernel || states[i].ao.shadow_path.queued_kernel) {
+          kernels_.integrator_wavefront_shadow(kernel_globals, &states[i], render_buffer);
+          has_shadow_paths = true;
+        }
+      }
+    }
+
+    /* Advance all main paths by one kernel, with paths queued for the same kernel and shader
+     * executed one after the other. */
+    sort_keys.clear();
+    for (int i = 0; i < num_states; i++) {
+      if (states[i].path.queued_kernel) {
+        sort_keys.push_back(wavefront_sort_key(states[i], i));
+      }
+    }
+    if (sort_keys.empty()) {
+      if (!has_work) {
+        break;
+      }
+      continue;
+    }
+
+    std::sort(sort_keys.begin(), sort_keys.end());
+    for (const uint64_t key : sort_keys) {
+      kernels_.integrator_wavefront_path(
+          kernel_globals, &states[key & 0xFFFFFF], render_buffer);
+    }
+  }
+}
+
 void PathTraceWorkCPU::copy_to_display(PathTraceDisplay *display,
                                        PassMode pass_mode,
                                        int num_samples)
@@ -11,6 +11,7 @@
 
 #include "integrator/path_trace_work.h"
 
+#include "util/array.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -74,6 +75,15 @@ class PathTraceWorkCPU : public PathTraceWork {
                                     const KernelWorkTile &work_tile,
                                     const int samples_num);
 
+  /* Wavefront rendering: every thread keeps a batch of paths in flight, and executes one kernel
+   * for all of them at a time with paths ordered by kernel and shader. Pixels are taken from the
+   * shared next_pixel_index in chunks, with all samples of a pixel rendered by the same thread. */
+  void render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                array<IntegratorStateCPU> &states,
+                                const KernelWorkTile &work_tile_template,
+                                const int samples_num,
+                                uint64_t *next_pixel_index);
+
   /* CPU kernels. */
   const CPUKernels &kernels_;
 
@@ -83,6 +93,9 @@ class PathTraceWorkCPU : public PathTraceWork {
    * accessing it, but some "localization" is required to decouple from kernel globals stored
    * on the device level. */
   vector<CPUKernelThreadGlobals> kernel_thread_globals_;
+
+  /* Path states of every thread for wavefront rendering, allocated on first use. */
+  vector<array<IntegratorStateCPU>> wavefront_states_;
 };
 
 CCL_NAMESPACE_END
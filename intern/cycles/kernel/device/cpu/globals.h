@@ -19,6 +19,8 @@ CCL_NAMESPACE_BEGIN
  * these are really just standard arrays. We can't use actually globals because
  * multiple renders may be running inside the same process. */
 
+class TextureCache;
+
 #ifdef __OSL__
 struct OSLGlobals;
 struct OSLThreadData;
@@ -66,6 +68,11 @@ typedef struct KernelGlobalsCPU {
   /* **** Run-time data ****  */
 
   ProfilingState profiler;
+
+  /* Cache of images loaded on demand, shared by all threads. */
+  TextureCache *texture_cache = nullptr;
+  /* Number of texture cache tiles looked up by this thread, see TextureCache. */
+  uint64_t texture_cache_tile_requests = 0;
 } KernelGlobalsCPU;
 
 typedef const KernelGlobalsCPU *ccl_restrict KernelGlobals;
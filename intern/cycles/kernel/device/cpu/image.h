@@ -8,6 +8,8 @@
 #  include "kernel/util/nanovdb.h"
 #endif
 
+#include "util/texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -91,14 +93,23 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
     return read(data[y * width + x]);
   }
 
+  /* Read 2D Texture Data from the Texture Cache
+   * Does not check if data request is in bounds. */
+  static ccl_always_inline OutT
+  read(const TextureCacheTexels &texels, int x, int y, int width, int height)
+  {
+    return read(texels.fetch<TexT>(x, y));
+  }
+
   /* Read 2D Texture Data Clip
    * Returns transparent black if data request is out of bounds. */
-  static ccl_always_inline OutT read_clip(const TexT *data, int x, int y, int width, int height)
+  template<typename Data>
+  static ccl_always_inline OutT read_clip(const Data &data, int x, int y, int width, int height)
   {
     if (x < 0 || x >= width || y < 0 || y >= height) {
       return zero();
     }
-    return read(data[y * width + x]);
+    return read(data, x, y, width, height);
   }
 
   /* Read 3D Texture Data
@@ -211,14 +222,15 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
 
   /* ********  2D interpolation ******** */
 
-  static ccl_always_inline OutT interp_closest(const TextureInfo &info, float x, float y)
+  /* The 2D interpolation reads texels from either a plain array or the texture cache. */
+  template<typename Data>
+  static ccl_always_inline OutT interp_closest(
+      const Data &data, const int width, const int height, const uint extension, float x, float y)
   {
-    const int width = info.width;
-    const int height = info.height;
     int ix, iy;
     frac(x * (float)width, &ix);
     frac(y * (float)height, &iy);
-    switch (info.extension) {
+    switch (extension) {
       case EXTENSION_REPEAT:
         ix = wrap_periodic(ix, width);
         iy = wrap_periodic(iy, height);
@@ -242,23 +254,20 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
         return zero();
     }
 
-    const TexT *data = (const TexT *)info.data;
-    return read((const TexT *)data, ix, iy, width, height);
+    return read(data, ix, iy, width, height);
   }
 
-  static ccl_always_inline OutT interp_linear(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp_linear(
+      const Data &data, const int width, const int height, const uint extension, float x, float y)
   {
-    const int width = info.width;
-    const int height = info.height;
-
     /* A -0.5 offset is used to center the linear samples around the sample point. */
     int ix, iy;
     int nix, niy;
     const float tx = frac(x * (float)width - 0.5f, &ix);
     const float ty = frac(y * (float)height - 0.5f, &iy);
-    const TexT *data = (const TexT *)info.data;
 
-    switch (info.extension) {
+    switch (extension) {
       case EXTENSION_REPEAT:
         ix = wrap_periodic(ix, width);
         nix = wrap_periodic(ix + 1, width);
@@ -300,11 +309,10 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
            ty * tx * read(data, nix, niy, width, height);
   }
 
-  static ccl_always_inline OutT interp_cubic(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp_cubic(
+      const Data &data, const int width, const int height, const uint extension, float x, float y)
   {
-    const int width = info.width;
-    const int height = info.height;
-
     /* A -0.5 offset is used to center the cubic samples around the sample point. */
     int ix, iy;
     const float tx = frac(x * (float)width - 0.5f, &ix);
@@ -314,7 +322,7 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
     int nix, niy;
     int nnix, nniy;
 
-    switch (info.extension) {
+    switch (extension) {
       case EXTENSION_REPEAT:
         ix = wrap_periodic(ix, width);
         pix = wrap_periodic(ix - 1, width);
@@ -367,7 +375,6 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
         return zero();
     }
 
-    const TexT *data = (const TexT *)info.data;
     const int xc[4] = {pix, ix, nix, nnix};
     const int yc[4] = {piy, iy, niy, nniy};
     float u[4], v[4];
@@ -389,18 +396,49 @@ template<typename TexT, typename OutT = float4> struct TextureInterpolator {
 #undef DATA
   }
 
-  static ccl_always_inline OutT interp(const TextureInfo &info, float x, float y)
+  template<typename Data>
+  static ccl_always_inline OutT interp(const Data &data,
+                                      const int width,
+                                      const int height,
+                                      const uint interpolation,
+                                      const uint extension,
+                                      float x,
+                                      float y)
   {
-    switch (info.interpolation) {
+    switch (interpolation) {
       case INTERPOLATION_CLOSEST:
-        return interp_closest(info, x, y);
+        return interp_closest(data, width, height, extension, x, y);
       case INTERPOLATION_LINEAR:
-        return interp_linear(info, x, y);
+        return interp_linear(data, width, height, extension, x, y);
       default:
-        return interp_cubic(info, x, y);
+        return interp_cubic(data, width, height, extension, x, y);
     }
   }
 
+  static ccl_always_inline OutT interp(const TextureInfo &info, float x, float y)
+  {
+    return interp((const TexT *)info.data,
+                  info.width,
+                  info.height,
+                  info.interpolation,
+                  info.extension,
+                  x,
+                  y);
+  }
+
+  /* Sample the mip-map level of a cached image that matches the filter width. */
+  static ccl_always_inline OutT interp_cached(
+      KernelGlobals kg, const TextureInfo &info, float x, float y, const float filter_width)
+  {
+    TextureCacheImage &image = *(TextureCacheImage *)info.cache;
+    /* Requests are counted per thread, like the profiler writes to the thread globals. */
+    uint64_t &tile_requests = ((KernelGlobalsCPU *)kg)->texture_cache_tile_requests;
+    const TextureCacheTexels texels(
+        image, image.level_for_filter_width(filter_width), tile_requests);
+    return interp(
+        texels, texels.width, texels.height, info.interpolation, info.extension, x, y);
+  }
+
   /* ********  3D interpolation ******** */
 
   static ccl_always_inline OutT interp_3d_closest(const TextureInfo &info,
@@ -811,7 +849,20 @@ template<typename TexT, typename OutT> struct NanoVDBInterpolator {
 
 #undef SET_CUBIC_SPLINE_WEIGHTS
 
-ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, float y)
+template<typename TexT, typename OutT>
+ccl_device_inline OutT kernel_tex_image_interp_typed(
+    KernelGlobals kg, const TextureInfo &info, float x, float y, const float filter_width)
+{
+  if (info.cache) {
+    return TextureInterpolator<TexT, OutT>::interp_cached(kg, info, x, y, filter_width);
+  }
+  return TextureInterpolator<TexT, OutT>::interp(info, x, y);
+}
+
+/* The filter width is the size of the footprint of the lookup in texture coordinates, it is
+ * used to choose the mip-map level of images in the texture cache. */
+ccl_device float4 kernel_tex_image_interp_filtered(
+    KernelGlobals kg, int id, float x, float y, const float filter_width)
 {
   const TextureInfo &info = kernel_data_fetch(texture_info, id);
 
@@ -821,29 +872,30 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
 
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF: {
-      const float f = TextureInterpolator<half, float>::interp(info, x, y);
+      const float f = kernel_tex_image_interp_typed<half, float>(kg, info, x, y, filter_width);
       return make_float4(f, f, f, 1.0f);
     }
     case IMAGE_DATA_TYPE_BYTE: {
-      const float f = TextureInterpolator<uchar, float>::interp(info, x, y);
+      const float f = kernel_tex_image_interp_typed<uchar, float>(kg, info, x, y, filter_width);
       return make_float4(f, f, f, 1.0f);
     }
     case IMAGE_DATA_TYPE_USHORT: {
-      const float f = TextureInterpolator<uint16_t, float>::interp(info, x, y);
+      const float f = kernel_tex_image_interp_typed<uint16_t, float>(
+          kg, info, x, y, filter_width);
       return make_float4(f, f, f, 1.0f);
     }
     case IMAGE_DATA_TYPE_FLOAT: {
-      const float f = TextureInterpolator<float, float>::interp(info, x, y);
+      const float f = kernel_tex_image_interp_typed<float, float>(kg, info, x, y, filter_width);
       return make_float4(f, f, f, 1.0f);
     }
     case IMAGE_DATA_TYPE_HALF4:
-      return TextureInterpolator<half4>::interp(info, x, y);
+      return kernel_tex_image_interp_typed<half4, float4>(kg, info, x, y, filter_width);
     case IMAGE_DATA_TYPE_BYTE4:
-      return TextureInterpolator<uchar4>::interp(info, x, y);
+      return kernel_tex_image_interp_typed<uchar4, float4>(kg, info, x, y, filter_width);
     case IMAGE_DATA_TYPE_USHORT4:
-      return TextureInterpolator<ushort4>::interp(info, x, y);
+      return kernel_tex_image_interp_typed<ushort4, float4>(kg, info, x, y, filter_width);
     case IMAGE_DATA_TYPE_FLOAT4:
-      return TextureInterpolator<float4>::interp(info, x, y);
+      return kernel_tex_image_interp_typed<float4, float4>(kg, info, x, y, filter_width);
     default:
       assert(0);
       return make_float4(
@@ -851,6 +903,11 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
   }
 }
 
+ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, float y)
+{
+  return kernel_tex_image_interp_filtered(kg, id, x, y, 0.0f);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
                                              int id,
                                              float3 P,
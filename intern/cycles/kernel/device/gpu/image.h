@@ -283,6 +283,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
   }
 }
 
+/* Only images in the CPU texture cache have mip-maps to choose from with the filter width. */
+ccl_device float4 kernel_tex_image_interp_filtered(
+    KernelGlobals kg, int id, float x, float y, const float /*filter_width*/)
+{
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
                                              int id,
                                              float3 P,
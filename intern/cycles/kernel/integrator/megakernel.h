@@ -19,6 +19,79 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Execute the kernel queued for a shadow path, if any. Returns false when the path was not queued
+ * for any kernel. */
+ccl_device_forceinline bool integrator_megakernel_shadow_path(
+    KernelGlobals kg, IntegratorShadowState state, ccl_global float *ccl_restrict render_buffer)
+{
+  const uint32_t queued_kernel = INTEGRATOR_STATE(state, shadow_path, queued_kernel);
+  switch (queued_kernel) {
+    case 0:
+      return false;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW:
+      integrator_intersect_shadow(kg, state);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW:
+      integrator_shade_shadow(kg, state, render_buffer);
+      break;
+    default:
+      kernel_assert(0);
+      break;
+  }
+  return true;
+}
+
+/* Execute the kernel queued for the main path, if any. Returns false when the path was not queued
+ * for any kernel. */
+ccl_device_forceinline bool integrator_megakernel_path(KernelGlobals kg,
+                                                       IntegratorState state,
+                                                       ccl_global float *ccl_restrict
+                                                           render_buffer)
+{
+  const uint32_t queued_kernel = INTEGRATOR_STATE(state, path, queued_kernel);
+  switch (queued_kernel) {
+    case 0:
+      return false;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST:
+      integrator_intersect_closest(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_BACKGROUND:
+      integrator_shade_background(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
+      integrator_shade_surface(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_VOLUME:
+      integrator_shade_volume(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
+      integrator_shade_surface_raytrace(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE:
+      integrator_shade_surface_mnee(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_LIGHT:
+      integrator_shade_light(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_DEDICATED_LIGHT:
+      integrator_shade_dedicated_light(kg, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SUBSURFACE:
+      integrator_intersect_subsurface(kg, state);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_VOLUME_STACK:
+      integrator_intersect_volume_stack(kg, state);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_DEDICATED_LIGHT:
+      integrator_intersect_dedicated_light(kg, state);
+      break;
+    default:
+      kernel_assert(0);
+      break;
+  }
+  return true;
+}
+
 ccl_device void integrator_megakernel(KernelGlobals kg,
                                       IntegratorState state,
                                       ccl_global float *ccl_restrict render_buffer)
@@ -27,81 +100,17 @@ ccl_device void integrator_megakernel(KernelGlobals kg,
    * have to check what that kernel is and execute it. */
   while (true) {
     /* Handle any shadow paths before we potentially create more shadow paths. */
-    const uint32_t shadow_queued_kernel = INTEGRATOR_STATE(
-        &state->shadow, shadow_path, queued_kernel);
-    if (shadow_queued_kernel) {
-      switch (shadow_queued_kernel) {
-        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW:
-          integrator_intersect_shadow(kg, &state->shadow);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW:
-          integrator_shade_shadow(kg, &state->shadow, render_buffer);
-          break;
-        default:
-          kernel_assert(0);
-          break;
-      }
+    if (integrator_megakernel_shadow_path(kg, &state->shadow, render_buffer)) {
       continue;
     }
 
     /* Handle any AO paths before we potentially create more AO paths. */
-    const uint32_t ao_queued_kernel = INTEGRATOR_STATE(&state->ao, shadow_path, queued_kernel);
-    if (ao_queued_kernel) {
-      switch (ao_queued_kernel) {
-        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW:
-          integrator_intersect_shadow(kg, &state->ao);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW:
-          integrator_shade_shadow(kg, &state->ao, render_buffer);
-          break;
-        default:
-          kernel_assert(0);
-          break;
-      }
+    if (integrator_megakernel_shadow_path(kg, &state->ao, render_buffer)) {
       continue;
     }
 
     /* Then handle regular path kernels. */
-    const uint32_t queued_kernel = INTEGRATOR_STATE(state, path, queued_kernel);
-    if (queued_kernel) {
-      switch (queued_kernel) {
-        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST:
-          integrator_intersect_closest(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_BACKGROUND:
-          integrator_shade_background(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
-          integrator_shade_surface(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_VOLUME:
-          integrator_shade_volume(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
-          integrator_shade_surface_raytrace(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE:
-          integrator_shade_surface_mnee(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_LIGHT:
-          integrator_shade_light(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_SHADE_DEDICATED_LIGHT:
-          integrator_shade_dedicated_light(kg, state, render_buffer);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SUBSURFACE:
-          integrator_intersect_subsurface(kg, state);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_VOLUME_STACK:
-          integrator_intersect_volume_stack(kg, state);
-          break;
-        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_DEDICATED_LIGHT:
-          integrator_intersect_dedicated_light(kg, state);
-          break;
-        default:
-          kernel_assert(0);
-          break;
-      }
+    if (integrator_megakernel_path(kg, state, render_buffer)) {
       continue;
     }
 
@@ -109,4 +118,26 @@ ccl_device void integrator_megakernel(KernelGlobals kg,
   }
 }
 
+/* Wavefront rendering on the CPU: instead of following a single path until it terminates, the
+ * host executes one kernel for a whole batch of paths at a time, with paths ordered by the kernel
+ * they are queued for and the shader they hit. */
+
+/* Advance the shadow and AO paths by one kernel. Shadow paths must be finished before the main
+ * path continues, as it may create new ones. */
+ccl_device void integrator_wavefront_shadow(KernelGlobals kg,
+                                           IntegratorState state,
+                                           ccl_global float *ccl_restrict render_buffer)
+{
+  integrator_megakernel_shadow_path(kg, &state->shadow, render_buffer);
+  integrator_megakernel_shadow_path(kg, &state->ao, render_buffer);
+}
+
+/* Execute the single kernel the main path is queued for. */
+ccl_device void integrator_wavefront_path(KernelGlobals kg,
+                                         IntegratorState state,
+                                         ccl_global float *ccl_restrict render_buffer)
+{
+  integrator_megakernel_path(kg, state, render_buffer);
+}
+
 CCL_NAMESPACE_END
@@ -93,6 +93,10 @@ typedef struct IntegratorStateCPU {
 
   IntegratorShadowStateCPU shadow;
   IntegratorShadowStateCPU ao;
+
+  /* Key of the last sorted kernel the path was queued for, used to order paths by shader when
+   * rendering in wavefront mode. */
+  uint32_t sort_key;
 } IntegratorStateCPU;
 
 /* Path Queue
@@ -163,7 +163,7 @@ ccl_device_forceinline void integrator_path_init_sorted(KernelGlobals kg,
                                                         const uint32_t key)
 {
   INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel;
-  (void)key;
+  state->sort_key = key;
 }
 
 ccl_device_forceinline void integrator_path_next(KernelGlobals kg,
@@ -190,7 +190,7 @@ ccl_device_forceinline void integrator_path_next_sorted(KernelGlobals kg,
                                                         const uint32_t key)
 {
   INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel;
-  (void)key;
+  state->sort_key = key;
   (void)current_kernel;
 }
 
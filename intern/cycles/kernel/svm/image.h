@@ -6,14 +6,15 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals kg, int id, float x, float y, uint flags)
+ccl_device float4 svm_image_texture(
+    KernelGlobals kg, int id, float x, float y, uint flags, float filter_width)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
-  float4 r = kernel_tex_image_interp(kg, id, x, y);
+  float4 r = kernel_tex_image_interp_filtered(kg, id, x, y, filter_width);
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -34,6 +35,35 @@ ccl_device_inline float3 texco_remap_square(float3 co)
   return (co - make_float3(0.5f, 0.5f, 0.5f)) * 2.0f;
 }
 
+ccl_device_inline float2 svm_image_texco(float3 co, const uint projection)
+{
+  if (projection == NODE_IMAGE_PROJ_SPHERE) {
+    co = texco_remap_square(co);
+    return map_to_sphere(co);
+  }
+  if (projection == NODE_IMAGE_PROJ_TUBE) {
+    co = texco_remap_square(co);
+    return map_to_tube(co);
+  }
+  return make_float2(co.x, co.y);
+}
+
+/* Size of the footprint of a lookup, from the texture coordinates of the neighboring pixels. */
+ccl_device_inline float svm_image_filter_width(const float2 tex_co,
+                                               float2 dx,
+                                               float2 dy,
+                                               const uint projection)
+{
+  dx = dx - tex_co;
+  dy = dy - tex_co;
+  if (projection == NODE_IMAGE_PROJ_SPHERE || projection == NODE_IMAGE_PROJ_TUBE) {
+    /* Don't blur along the seam where U wraps around. */
+    dx.x -= floorf(dx.x + 0.5f);
+    dy.x -= floorf(dy.x + 0.5f);
+  }
+  return sqrtf(max(len_squared(dx), len_squared(dy)));
+}
+
 ccl_device_noinline int svm_node_tex_image(
     KernelGlobals kg, ccl_private ShaderData *sd, ccl_private float *stack, uint4 node, int offset)
 {
@@ -41,18 +71,15 @@ ccl_device_noinline int svm_node_tex_image(
 
   svm_unpack_node_uchar4(node.z, &co_offset, &out_offset, &alpha_offset, &flags);
 
-  float3 co = stack_load_float3(stack, co_offset);
-  float2 tex_co;
-  if (node.w == NODE_IMAGE_PROJ_SPHERE) {
-    co = texco_remap_square(co);
-    tex_co = map_to_sphere(co);
-  }
-  else if (node.w == NODE_IMAGE_PROJ_TUBE) {
-    co = texco_remap_square(co);
-    tex_co = map_to_tube(co);
-  }
-  else {
-    tex_co = make_float2(co.x, co.y);
+  const float3 co = stack_load_float3(stack, co_offset);
+  float2 tex_co = svm_image_texco(co, node.w);
+
+  float filter_width = 0.0f;
+  if (flags & NODE_IMAGE_USE_FOOTPRINT) {
+    const uint4 footprint_node = read_node(kg, &offset);
+    const float2 tex_co_dx = svm_image_texco(stack_load_float3(stack, footprint_node.x), node.w);
+    const float2 tex_co_dy = svm_image_texco(stack_load_float3(stack, footprint_node.y), node.w);
+    filter_width = svm_image_filter_width(tex_co, tex_co_dx, tex_co_dy, node.w);
   }
 
   /* TODO(lukas): Consider moving tile information out of the SVM node.
@@ -98,7 +125,7 @@ ccl_device_noinline int svm_node_tex_image(
     id = -num_nodes;
   }
 
-  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags, filter_width);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -192,15 +219,15 @@ ccl_device_noinline void svm_node_tex_image_box(KernelGlobals kg,
   /* Map so that no textures are flipped, rotation is somewhat arbitrary. */
   if (weight.x > 0.0f) {
     float2 uv = make_float2((signed_N.x < 0.0f) ? 1.0f - co.y : co.y, co.z);
-    f += weight.x * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.x * svm_image_texture(kg, id, uv.x, uv.y, flags, 0.0f);
   }
   if (weight.y > 0.0f) {
     float2 uv = make_float2((signed_N.y > 0.0f) ? 1.0f - co.x : co.x, co.z);
-    f += weight.y * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.y * svm_image_texture(kg, id, uv.x, uv.y, flags, 0.0f);
   }
   if (weight.z > 0.0f) {
     float2 uv = make_float2((signed_N.z > 0.0f) ? 1.0f - co.y : co.y, co.x);
-    f += weight.z * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.z * svm_image_texture(kg, id, uv.x, uv.y, flags, 0.0f);
   }
 
   if (stack_valid(out_offset))
@@ -230,7 +257,7 @@ ccl_device_noinline void svm_node_tex_environment(KernelGlobals kg,
   else
     uv = direction_to_mirrorball(co);
 
-  float4 f = svm_image_texture(kg, id, uv.x, uv.y, flags);
+  float4 f = svm_image_texture(kg, id, uv.x, uv.y, flags, 0.0f);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
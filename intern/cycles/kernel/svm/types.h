@@ -364,6 +364,8 @@ typedef enum NodeImageProjection {
 typedef enum NodeImageFlags {
   NODE_IMAGE_COMPRESS_AS_SRGB = 1,
   NODE_IMAGE_ALPHA_UNASSOCIATE = 2,
+  /* Texture coordinate differentials follow in an extra node, to choose a mip-map level. */
+  NODE_IMAGE_USE_FOOTPRINT = 4,
 } NodeImageFlags;
 
 typedef enum NodeEnvironmentProjection {
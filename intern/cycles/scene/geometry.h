@@ -99,6 +99,12 @@ class Geometry : public Node {
   /* Maximum number of motion steps supported (due to Embree). */
   static const uint MAX_MOTION_STEPS = 129;
 
+  /* With SceneParams::use_bvh_refit, geometry with fewer primitives is still included in the
+   * scene BVH, since building it again is cheap. */
+  static const size_t BVH_REFIT_MIN_PRIMITIVES = 4096;
+  /* Same as BVHParams::max_refit_cost_ratio. */
+  static constexpr float BVH_REFIT_MAX_COST_RATIO = 1.5f;
+
   /* BVH */
   BVH *bvh;
   size_t attr_map_offset;
@@ -71,14 +71,22 @@ void Geometry::compute_bvh(Device *device,
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    bool rebuild = !bvh || need_update_rebuild;
+
+    if (!rebuild) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->replace_geometry(geometry, objects);
 
       device->build_bvh(bvh, *progress, true);
+
+      if (bvh->need_rebuild_after_refit()) {
+        VLOG_WORK << "Rebuilding BVH of " << name << ", refitting degraded it too much.";
+        rebuild = true;
+      }
     }
-    else {
+
+    if (rebuild) {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
@@ -92,6 +100,9 @@ void Geometry::compute_bvh(Device *device,
       bparams.num_motion_point_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
       bparams.curve_subdivisions = params->curve_subdivisions();
+      if (params->use_bvh_refit) {
+        bparams.max_refit_cost_ratio = Geometry::BVH_REFIT_MAX_COST_RATIO;
+      }
 
       delete bvh;
       bvh = BVH::create(bparams, geometry, objects, device);
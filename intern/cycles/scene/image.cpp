@@ -18,6 +18,7 @@
 #include "util/progress.h"
 #include "util/task.h"
 #include "util/texture.h"
+#include "util/texture_cache.h"
 #include "util/unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -311,6 +312,24 @@ bool ImageLoader::equals(const ImageLoader *a, const ImageLoader *b)
   }
 }
 
+bool ImageLoader::load_mip_levels(const ImageMetaData & /*metadata*/,
+                                  vector<int2> & /*r_level_sizes*/)
+{
+  return false;
+}
+
+bool ImageLoader::load_pixels_region(const ImageMetaData & /*metadata*/,
+                                     const int /*level*/,
+                                     const int /*x*/,
+                                     const int /*y*/,
+                                     const int /*width*/,
+                                     const int /*height*/,
+                                     void * /*pixels*/,
+                                     const bool /*associate_alpha*/)
+{
+  return false;
+}
+
 bool ImageLoader::is_vdb_loader() const
 {
   return false;
@@ -326,6 +345,8 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   features.has_nanovdb = info.has_nanovdb;
+
+  texture_cache = NULL;
 }
 
 ImageManager::~ImageManager()
@@ -333,6 +354,27 @@ ImageManager::~ImageManager()
   for (size_t slot = 0; slot < images.size(); slot++) {
     assert(!images[slot]);
   }
+
+  delete texture_cache;
+}
+
+void ImageManager::enable_texture_cache(Device *device, const size_t memory_budget)
+{
+  assert(texture_cache == NULL);
+  texture_cache = new TextureCache(memory_budget);
+  device->set_cpu_texture_cache(texture_cache);
+}
+
+bool ImageManager::use_texture_cache() const
+{
+  return texture_cache != NULL;
+}
+
+void ImageManager::texture_cache_collect_garbage()
+{
+  if (texture_cache) {
+    texture_cache->collect_garbage();
+  }
 }
 
 void ImageManager::set_osl_texture_system(void *texture_system)
@@ -488,6 +530,7 @@ size_t ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_image = NULL;
 
   images[slot] = img;
 
@@ -522,7 +565,7 @@ void ImageManager::remove_image_user(size_t slot)
   }
 }
 
-static bool image_associate_alpha(ImageManager::Image *img)
+static bool image_associate_alpha(const ImageManager::Image *img)
 {
   /* For typical RGBA images we let OIIO convert to associated alpha,
    * but some types we want to leave the RGB channels untouched. */
@@ -531,54 +574,22 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
-template<TypeDesc::BASETYPE FileFormat, typename StorageType>
-bool ImageManager::file_load_image(Image *img, int texture_limit)
+static bool image_is_rgba(const ImageDataType type)
 {
-  /* Ignore empty images. */
-  if (!(img->metadata.channels > 0)) {
-    return false;
-  }
-
-  /* Get metadata. */
-  int width = img->metadata.width;
-  int height = img->metadata.height;
-  int depth = img->metadata.depth;
-  int components = img->metadata.channels;
-
-  /* Read pixels. */
-  vector<StorageType> pixels_storage;
-  StorageType *pixels;
-  const size_t max_size = max(max(width, height), depth);
-  if (max_size == 0) {
-    /* Don't bother with empty images. */
-    return false;
-  }
-
-  /* Allocate memory as needed, may be smaller to resize down. */
-  if (texture_limit > 0 && max_size > texture_limit) {
-    pixels_storage.resize(((size_t)width) * height * depth * 4);
-    pixels = &pixels_storage[0];
-  }
-  else {
-    thread_scoped_lock device_lock(device_mutex);
-    pixels = (StorageType *)img->mem->alloc(width, height, depth);
-  }
-
-  if (pixels == NULL) {
-    /* Could be that we've run out of memory. */
-    return false;
-  }
-
-  const size_t num_pixels = ((size_t)width) * height * depth;
-  img->loader->load_pixels(
-      img->metadata, pixels, num_pixels * components, image_associate_alpha(img));
-
   /* The kernel can handle 1 and 4 channel images. Anything that is not a single
    * channel image is converted to RGBA format. */
-  bool is_rgba = (img->metadata.type == IMAGE_DATA_TYPE_FLOAT4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_HALF4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_BYTE4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_USHORT4);
+  return (type == IMAGE_DATA_TYPE_FLOAT4 || type == IMAGE_DATA_TYPE_HALF4 ||
+          type == IMAGE_DATA_TYPE_BYTE4 || type == IMAGE_DATA_TYPE_USHORT4);
+}
+
+/* Convert pixels as loaded by the image loader to the format used by the kernel. */
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static void image_process_pixels(const ImageManager::Image *img,
+                                 StorageType *pixels,
+                                 const size_t num_pixels,
+                                 const int components)
+{
+  const bool is_rgba = image_is_rgba(img->metadata.type);
 
   if (is_rgba) {
     const StorageType one = util_image_cast_from_float<StorageType>(1.0f);
@@ -654,6 +665,52 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
       }
     }
   }
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+bool ImageManager::file_load_image(Image *img, int texture_limit)
+{
+  /* Ignore empty images. */
+  if (!(img->metadata.channels > 0)) {
+    return false;
+  }
+
+  /* Get metadata. */
+  int width = img->metadata.width;
+  int height = img->metadata.height;
+  int depth = img->metadata.depth;
+  int components = img->metadata.channels;
+
+  /* Read pixels. */
+  vector<StorageType> pixels_storage;
+  StorageType *pixels;
+  const size_t max_size = max(max(width, height), depth);
+  if (max_size == 0) {
+    /* Don't bother with empty images. */
+    return false;
+  }
+
+  /* Allocate memory as needed, may be smaller to resize down. */
+  if (texture_limit > 0 && max_size > texture_limit) {
+    pixels_storage.resize(((size_t)width) * height * depth * 4);
+    pixels = &pixels_storage[0];
+  }
+  else {
+    thread_scoped_lock device_lock(device_mutex);
+    pixels = (StorageType *)img->mem->alloc(width, height, depth);
+  }
+
+  if (pixels == NULL) {
+    /* Could be that we've run out of memory. */
+    return false;
+  }
+
+  const size_t num_pixels = ((size_t)width) * height * depth;
+  img->loader->load_pixels(
+      img->metadata, pixels, num_pixels * components, image_associate_alpha(img));
+
+  const bool is_rgba = image_is_rgba(img->metadata.type);
+  image_process_pixels<FileFormat>(img, pixels, num_pixels, components);
 
   /* Scale image down if needed. */
   if (pixels_storage.size() > 0) {
@@ -689,6 +746,115 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+/* Load a tile for the texture cache, see TextureCacheImage::LoadTileFunction. */
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static bool image_load_tile(const ImageManager::Image *img,
+                            const int level,
+                            const int x,
+                            const int y,
+                            const int width,
+                            const int height,
+                            StorageType *tile_pixels)
+{
+  const int components = min(img->metadata.channels, 4);
+  const int num_channels = image_is_rgba(img->metadata.type) ? 4 : 1;
+  const size_t num_pixels = ((size_t)width) * height;
+
+  vector<StorageType> pixels(num_pixels * num_channels);
+  if (!img->loader->load_pixels_region(img->metadata,
+                                       level,
+                                       x,
+                                       y,
+                                       width,
+                                       height,
+                                       pixels.data(),
+                                       image_associate_alpha(img)))
+  {
+    return false;
+  }
+
+  image_process_pixels<FileFormat>(img, pixels.data(), num_pixels, components);
+
+  const size_t row_size = width * num_channels;
+  for (int row = 0; row < height; row++) {
+    memcpy(tile_pixels + row * TEXTURE_CACHE_TILE_SIZE * num_channels,
+           pixels.data() + row * row_size,
+           row_size * sizeof(StorageType));
+  }
+  return true;
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static TextureCacheImage::LoadTileFunction image_load_tile_function(const ImageManager::Image *img)
+{
+  return [img](const int level,
+               const int x,
+               const int y,
+               const int width,
+               const int height,
+               void *pixels) {
+    return image_load_tile<FileFormat, StorageType>(
+        img, level, x, y, width, height, (StorageType *)pixels);
+  };
+}
+
+bool ImageManager::texture_cache_load_image(Image *img, int texture_limit)
+{
+  const ImageMetaData &metadata = img->metadata;
+  if (!(metadata.channels > 0) || metadata.depth > 1) {
+    return false;
+  }
+
+  TextureCacheImage::LoadTileFunction load_tile;
+  switch (metadata.type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+    case IMAGE_DATA_TYPE_FLOAT:
+      load_tile = image_load_tile_function<TypeDesc::FLOAT, float>(img);
+      break;
+    case IMAGE_DATA_TYPE_BYTE4:
+    case IMAGE_DATA_TYPE_BYTE:
+      load_tile = image_load_tile_function<TypeDesc::UINT8, uchar>(img);
+      break;
+    case IMAGE_DATA_TYPE_HALF4:
+    case IMAGE_DATA_TYPE_HALF:
+      load_tile = image_load_tile_function<TypeDesc::HALF, half>(img);
+      break;
+    case IMAGE_DATA_TYPE_USHORT4:
+    case IMAGE_DATA_TYPE_USHORT:
+      load_tile = image_load_tile_function<TypeDesc::USHORT, uint16_t>(img);
+      break;
+    default:
+      return false;
+  }
+
+  vector<int2> level_sizes;
+  if (!img->loader->load_mip_levels(metadata, level_sizes) || level_sizes.empty()) {
+    return false;
+  }
+
+  /* Skip the levels above the texture limit. */
+  int min_level = 0;
+  if (texture_limit > 0) {
+    while (min_level < (int)level_sizes.size() - 1 &&
+           max(level_sizes[min_level].x, level_sizes[min_level].y) > texture_limit)
+    {
+      min_level++;
+    }
+  }
+
+  const size_t texel_size = img->mem->data_elements * datatype_size(img->mem->data_type);
+  img->cache_image = new TextureCacheImage(
+      texture_cache, img->loader->name(), texel_size, level_sizes, min_level, load_tile);
+
+  /* The kernel reads the pixels from the cache, the device texture only holds a placeholder. */
+  thread_scoped_lock device_lock(device_mutex);
+  void *pixels = img->mem->alloc(1, 1);
+  memset(pixels, 0, texel_size);
+  img->mem->info.cache = (uint64_t)img->cache_image;
+
+  return true;
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -713,6 +879,8 @@ void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot,
     delete img->mem;
     img->mem = NULL;
   }
+  delete img->cache_image;
+  img->cache_image = NULL;
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
@@ -720,7 +888,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot,
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache && texture_cache_load_image(img, texture_limit)) {
+    /* Pixels are loaded on demand. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -847,6 +1018,7 @@ void ImageManager::device_free_image(Device *, size_t slot)
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
   }
+  delete img->cache_image;
 
   delete img->loader;
   delete img;
@@ -934,6 +1106,10 @@ void ImageManager::device_free(Device *device)
     device_free_image(device, slot);
   }
   images.clear();
+
+  if (texture_cache) {
+    device->set_cpu_texture_cache(NULL);
+  }
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
@@ -945,6 +1121,22 @@ void ImageManager::collect_statistics(RenderStats *stats)
     }
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
+    if (image->cache_image) {
+      stats->image.texture_cache.loaded.add_entry(
+          NamedSizeEntry(image->loader->name(), image->cache_image->bytes_loaded()));
+    }
+  }
+
+  if (texture_cache) {
+    const TextureCache::Statistics cache_stats = texture_cache->get_statistics();
+    TextureCacheStats &texture_cache_stats = stats->image.texture_cache;
+    texture_cache_stats.enabled = true;
+    texture_cache_stats.memory_budget = texture_cache->memory_budget();
+    texture_cache_stats.peak_memory = cache_stats.peak_memory;
+    texture_cache_stats.tile_requests = cache_stats.tile_requests;
+    texture_cache_stats.tile_loads = cache_stats.tile_loads;
+    texture_cache_stats.tile_evictions = cache_stats.tile_evictions;
+    texture_cache_stats.hit_rate = cache_stats.hit_rate();
   }
 }
 
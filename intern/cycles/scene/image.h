@@ -27,6 +27,8 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+class TextureCache;
+class TextureCacheImage;
 class VDBImageLoader;
 
 /* Image Parameters */
@@ -117,6 +119,21 @@ class ImageLoader {
   /* Optional for tiled textures loaded externally. */
   virtual int get_tile_number() const;
 
+  /* Optional for the texture cache: resolution of all mip-map levels, starting with the full
+   * resolution. Returns false if the image can't be loaded in parts. */
+  virtual bool load_mip_levels(const ImageMetaData &metadata, vector<int2> &r_level_sizes);
+
+  /* Optional for the texture cache: load a region of a mip-map level, with the same channels as
+   * load_pixels(). Unlike load_pixels(), rows are ordered from the top to the bottom. */
+  virtual bool load_pixels_region(const ImageMetaData &metadata,
+                                  const int level,
+                                  const int x,
+                                  const int y,
+                                  const int width,
+                                  const int height,
+                                  void *pixels,
+                                  const bool associate_alpha);
+
   /* Free any memory used for loading metadata and pixels. */
   virtual void cleanup(){};
 
@@ -189,6 +206,12 @@ class ImageManager {
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
+  /* Load images in tiles on demand instead of all at once, CPU only. */
+  void enable_texture_cache(Device *device, const size_t memory_budget);
+  bool use_texture_cache() const;
+  /* Free tiles over the memory budget, must not be called while rendering. */
+  void texture_cache_collect_garbage();
+
   void collect_statistics(RenderStats *stats);
 
   void tag_update();
@@ -207,6 +230,7 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    TextureCacheImage *cache_image;
 
     int users;
     thread_mutex mutex;
@@ -223,6 +247,7 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  TextureCache *texture_cache;
 
   size_t add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(size_t slot);
@@ -232,6 +257,7 @@ class ImageManager {
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
+  bool texture_cache_load_image(Image *img, int texture_limit);
 
   void device_load_image(Device *device, Scene *scene, size_t slot, Progress *progress);
   void device_free_image(Device *device, size_t slot);
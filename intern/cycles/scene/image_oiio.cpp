@@ -6,11 +6,19 @@
 
 #include "util/image.h"
 #include "util/log.h"
+#include "util/md5.h"
 #include "util/path.h"
+#include "util/texture_cache.h"
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/imagebufalgo.h>
 
 CCL_NAMESPACE_BEGIN
 
-OIIOImageLoader::OIIOImageLoader(const string &filepath) : filepath(filepath) {}
+OIIOImageLoader::OIIOImageLoader(const string &filepath)
+    : filepath(filepath), texture_associate_alpha(false)
+{
+}
 
 OIIOImageLoader::~OIIOImageLoader() {}
 
@@ -164,6 +172,31 @@ static void oiio_load_pixels(const ImageMetaData &metadata,
   }
 }
 
+/* Whether pixels read from the file still need to be converted to associated alpha. */
+static bool oiio_needs_associate_alpha(const unique_ptr<ImageInput> &in, const ImageSpec &spec)
+{
+  bool do_associate_alpha = spec.get_int_attribute("oiio:UnassociatedAlpha", 0);
+
+  if (!do_associate_alpha && spec.alpha_channel != -1) {
+    /* Workaround OIIO not detecting TGA file alpha the same as Blender (since #3019).
+     * We want anything not marked as premultiplied alpha to get associated. */
+    if (strcmp(in->format_name(), "targa") == 0) {
+      do_associate_alpha = spec.get_int_attribute("targa:alpha_type", -1) != 4;
+    }
+    /* OIIO DDS reader never sets UnassociatedAlpha attribute. */
+    if (strcmp(in->format_name(), "dds") == 0) {
+      do_associate_alpha = true;
+    }
+    /* Workaround OIIO bug that sets oiio:UnassociatedAlpha on the last layer
+     * but not composite image that we read. */
+    if (strcmp(in->format_name(), "psd") == 0) {
+      do_associate_alpha = true;
+    }
+  }
+
+  return do_associate_alpha;
+}
+
 bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
                                   void *pixels,
                                   const size_t,
@@ -194,27 +227,7 @@ bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
     return false;
   }
 
-  bool do_associate_alpha = false;
-  if (associate_alpha) {
-    do_associate_alpha = spec.get_int_attribute("oiio:UnassociatedAlpha", 0);
-
-    if (!do_associate_alpha && spec.alpha_channel != -1) {
-      /* Workaround OIIO not detecting TGA file alpha the same as Blender (since #3019).
-       * We want anything not marked as premultiplied alpha to get associated. */
-      if (strcmp(in->format_name(), "targa") == 0) {
-        do_associate_alpha = spec.get_int_attribute("targa:alpha_type", -1) != 4;
-      }
-      /* OIIO DDS reader never sets UnassociatedAlpha attribute. */
-      if (strcmp(in->format_name(), "dds") == 0) {
-        do_associate_alpha = true;
-      }
-      /* Workaround OIIO bug that sets oiio:UnassociatedAlpha on the last layer
-       * but not composite image that we read. */
-      if (strcmp(in->format_name(), "psd") == 0) {
-        do_associate_alpha = true;
-      }
-    }
-  }
+  const bool do_associate_alpha = associate_alpha && oiio_needs_associate_alpha(in, spec);
 
   switch (metadata.type) {
     case IMAGE_DATA_TYPE_BYTE:
@@ -246,6 +259,172 @@ bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
   return true;
 }
 
+/* Whether the file can be used by the texture cache as is. */
+static bool oiio_is_cache_texture(const unique_ptr<ImageInput> &in, const ImageSpec &spec)
+{
+  if (spec.tile_width != TEXTURE_CACHE_TILE_SIZE || spec.tile_height != TEXTURE_CACHE_TILE_SIZE) {
+    return false;
+  }
+  ImageSpec level_spec;
+  return in->seek_subimage(0, 1, level_spec);
+}
+
+bool OIIOImageLoader::load_mip_levels(const ImageMetaData &metadata, vector<int2> &r_level_sizes)
+{
+  if (!texture_in) {
+    if (metadata.depth > 1 || !path_exists(filepath.string())) {
+      return false;
+    }
+
+    unique_ptr<ImageInput> in(ImageInput::create(filepath.string()));
+    ImageSpec spec;
+    if (!in || !in->open(filepath.string(), spec)) {
+      return false;
+    }
+    /* CMYK is converted after reading, which does not survive conversion to a texture. */
+    if (strcmp(in->format_name(), "jpeg") == 0 && spec.nchannels == 4) {
+      return false;
+    }
+
+    if (oiio_is_cache_texture(in, spec)) {
+      texture_filepath = filepath.string();
+    }
+    else {
+      /* Convert to a tiled and mip-mapped file once, and keep it in the cache directory. The
+       * modification time is part of the name, so edited images are converted again. */
+      const string source = filepath.string();
+      const string hash = util_md5_string(
+          string_printf("%s:%llu", source.c_str(), (unsigned long long)path_modified_time(source)));
+      texture_filepath = path_cache_get(path_join("textures", hash + ".tx"));
+
+      if (!path_exists(texture_filepath)) {
+        VLOG_INFO << "Converting " << source << " to tiled texture " << texture_filepath;
+        path_create_directories(texture_filepath);
+
+        /* Keep unassociated alpha, it is associated after reading like for other images. */
+        ImageSpec input_config;
+        input_config.attribute("oiio:UnassociatedAlpha", 1);
+        const ImageBuf input(source, 0, 0, nullptr, &input_config);
+
+        ImageSpec config;
+        config.tile_width = TEXTURE_CACHE_TILE_SIZE;
+        config.tile_height = TEXTURE_CACHE_TILE_SIZE;
+        config.tile_depth = 1;
+        /* Write to a temporary file first, renders running in parallel may convert as well. */
+        const string temp_filepath = texture_filepath + ".tmp-" + OIIO::Filesystem::unique_path() +
+                                     ".tx";
+        string rename_error;
+        if (!ImageBufAlgo::make_texture(
+                ImageBufAlgo::MakeTxTexture, input, temp_filepath, config) ||
+            !OIIO::Filesystem::rename(temp_filepath, texture_filepath, rename_error))
+        {
+          VLOG_WARNING << "Failed to convert " << source << " to tiled texture: "
+                       << OIIO::geterror() << rename_error;
+          OIIO::Filesystem::remove(temp_filepath);
+          return false;
+        }
+      }
+    }
+
+    ImageSpec config;
+    config.attribute("oiio:UnassociatedAlpha", 1);
+    texture_in = unique_ptr<ImageInput>(ImageInput::create(texture_filepath));
+    if (!texture_in || !texture_in->open(texture_filepath, spec, config)) {
+      texture_in.reset();
+      return false;
+    }
+    texture_associate_alpha = oiio_needs_associate_alpha(texture_in, spec);
+  }
+
+  r_level_sizes.clear();
+  ImageSpec spec;
+  for (int level = 0; texture_in->seek_subimage(0, level, spec); level++) {
+    if (spec.tile_width != TEXTURE_CACHE_TILE_SIZE || spec.tile_height != TEXTURE_CACHE_TILE_SIZE)
+    {
+      return false;
+    }
+    r_level_sizes.push_back(make_int2(spec.width, spec.height));
+  }
+
+  return !r_level_sizes.empty() && r_level_sizes[0].x == metadata.width &&
+         r_level_sizes[0].y == metadata.height;
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static bool oiio_load_pixels_region(const unique_ptr<ImageInput> &in,
+                                    const int level,
+                                    const int x,
+                                    const int y,
+                                    const int width,
+                                    const int height,
+                                    const int components,
+                                    const bool associate_alpha,
+                                    StorageType *pixels)
+{
+  if (!in->read_tiles(
+          0, level, x, x + width, y, y + height, 0, 1, 0, components, FileFormat, pixels))
+  {
+    return false;
+  }
+
+  if (components == 4 && associate_alpha) {
+    const size_t num_pixels = ((size_t)width) * height;
+    for (size_t i = 0; i < num_pixels; i++) {
+      const StorageType alpha = pixels[i * 4 + 3];
+      pixels[i * 4 + 0] = util_image_multiply_native(pixels[i * 4 + 0], alpha);
+      pixels[i * 4 + 1] = util_image_multiply_native(pixels[i * 4 + 1], alpha);
+      pixels[i * 4 + 2] = util_image_multiply_native(pixels[i * 4 + 2], alpha);
+    }
+  }
+  return true;
+}
+
+bool OIIOImageLoader::load_pixels_region(const ImageMetaData &metadata,
+                                         const int level,
+                                         const int x,
+                                         const int y,
+                                         const int width,
+                                         const int height,
+                                         void *pixels,
+                                         const bool associate_alpha)
+{
+  if (!texture_in) {
+    return false;
+  }
+
+  /* Like load_pixels(), only the first 4 channels are used. */
+  const int components = min(metadata.channels, 4);
+  const bool do_associate_alpha = associate_alpha && texture_associate_alpha;
+
+  switch (metadata.type) {
+    case IMAGE_DATA_TYPE_BYTE:
+    case IMAGE_DATA_TYPE_BYTE4:
+      return oiio_load_pixels_region<TypeDesc::UINT8, uchar>(
+          texture_in, level, x, y, width, height, components, do_associate_alpha, (uchar *)pixels);
+    case IMAGE_DATA_TYPE_USHORT:
+    case IMAGE_DATA_TYPE_USHORT4:
+      return oiio_load_pixels_region<TypeDesc::USHORT, uint16_t>(texture_in,
+                                                                 level,
+                                                                 x,
+                                                                 y,
+                                                                 width,
+                                                                 height,
+                                                                 components,
+                                                                 do_associate_alpha,
+                                                                 (uint16_t *)pixels);
+    case IMAGE_DATA_TYPE_HALF:
+    case IMAGE_DATA_TYPE_HALF4:
+      return oiio_load_pixels_region<TypeDesc::HALF, half>(
+          texture_in, level, x, y, width, height, components, do_associate_alpha, (half *)pixels);
+    case IMAGE_DATA_TYPE_FLOAT:
+    case IMAGE_DATA_TYPE_FLOAT4:
+      return oiio_load_pixels_region<TypeDesc::FLOAT, float>(
+          texture_in, level, x, y, width, height, components, do_associate_alpha, (float *)pixels);
+    default:
+      return false;
+  }
+}
+
 string OIIOImageLoader::name() const
 {
   return path_filename(filepath.string());
@@ -7,6 +7,8 @@
 
 #include "scene/image.h"
 
+#include "util/image.h"
+
 CCL_NAMESPACE_BEGIN
 
 class OIIOImageLoader : public ImageLoader {
@@ -21,6 +23,17 @@ class OIIOImageLoader : public ImageLoader {
                    const size_t pixels_size,
                    const bool associate_alpha) override;
 
+  bool load_mip_levels(const ImageMetaData &metadata, vector<int2> &r_level_sizes) override;
+
+  bool load_pixels_region(const ImageMetaData &metadata,
+                          const int level,
+                          const int x,
+                          const int y,
+                          const int width,
+                          const int height,
+                          void *pixels,
+                          const bool associate_alpha) override;
+
   string name() const override;
 
   ustring osl_filepath() const override;
@@ -29,6 +42,11 @@ class OIIOImageLoader : public ImageLoader {
 
  protected:
   ustring filepath;
+
+  /* Tiled and mip-mapped file for the texture cache, kept open while loading tiles. */
+  string texture_filepath;
+  unique_ptr<ImageInput> texture_in;
+  bool texture_associate_alpha;
 };
 
 CCL_NAMESPACE_END
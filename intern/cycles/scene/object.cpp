@@ -1045,15 +1045,27 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
     bool apply = (geometry_users[geom] == 1) && !geom->has_surface_bssrdf &&
                  !geom->has_true_displacement();
 
+    size_t num_primitives = 0;
     if (geom->geometry_type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
       apply = apply && mesh->get_subdivision_type() == Mesh::SUBDIVISION_NONE;
+      num_primitives = mesh->num_triangles();
     }
     else if (geom->geometry_type == Geometry::HAIR) {
       /* Can't apply non-uniform scale to curves, this can't be represented by
        * control points and radius alone. */
       float scale;
       apply = apply && transform_uniform_scale(object->tfm, scale);
+      num_primitives = static_cast<Hair *>(geom)->num_segments();
+    }
+    else if (geom->geometry_type == Geometry::POINTCLOUD) {
+      num_primitives = static_cast<PointCloud *>(geom)->num_points();
+    }
+
+    /* Keep large geometry in its own BVH, so that it can be refitted when only positions
+     * change instead of building the scene BVH over all primitives again. */
+    if (scene->params.use_bvh_refit && num_primitives >= Geometry::BVH_REFIT_MIN_PRIMITIVES) {
+      apply = false;
     }
 
     if (apply) {
@@ -60,6 +60,12 @@ Scene::Scene(const SceneParams &params_, Device *device)
   geometry_manager = new GeometryManager();
   object_manager = new ObjectManager();
   image_manager = new ImageManager(device->info);
+  /* Tiles are sampled directly from host memory, and OSL has its own texture system. */
+  if (params.texture_cache_size > 0 && device->info.type == DEVICE_CPU &&
+      !shader_manager->use_osl())
+  {
+    image_manager->enable_texture_cache(device, params.texture_cache_size);
+  }
   particle_system_manager = new ParticleSystemManager();
   bake_manager = new BakeManager();
   procedural_manager = new ProceduralManager();
@@ -68,9 +68,14 @@ class SceneParams {
   bool use_bvh_compact_structure;
   bool use_bvh_unaligned_nodes;
   int num_bvh_time_steps;
+  /* Keep BVHs of large geometry across updates of a static BVH, refitting them when only
+   * positions changed. Useful for animation renders that keep the scene between frames. */
+  bool use_bvh_refit;
   int hair_subdivisions;
   CurveShapeType hair_shape;
   int texture_limit;
+  /* Memory budget in bytes of the texture cache, zero to load images entirely. */
+  size_t texture_cache_size;
 
   bool background;
 
@@ -83,9 +88,11 @@ class SceneParams {
     use_bvh_compact_structure = true;
     use_bvh_unaligned_nodes = true;
     num_bvh_time_steps = 0;
+    use_bvh_refit = false;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    texture_cache_size = 0;
     background = true;
   }
 
@@ -97,8 +104,10 @@ class SceneParams {
              use_bvh_compact_structure == params.use_bvh_compact_structure &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
+             use_bvh_refit == params.use_bvh_refit &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
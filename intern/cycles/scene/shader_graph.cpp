@@ -5,6 +5,7 @@
 #include "scene/shader_graph.h"
 #include "scene/attribute.h"
 #include "scene/constant_fold.h"
+#include "scene/image.h"
 #include "scene/scene.h"
 #include "scene/shader.h"
 #include "scene/shader_nodes.h"
@@ -383,6 +384,10 @@ void ShaderGraph::finalize(Scene *scene, bool do_bump, bool bump_in_object_space
       bump_from_displacement(bump_in_object_space);
     }
 
+    if (scene->image_manager->use_texture_cache()) {
+      refine_image_texture_footprints();
+    }
+
     ShaderInput *surface_in = output()->input("Surface");
     ShaderInput *volume_in = output()->input("Volume");
 
@@ -987,6 +992,57 @@ void ShaderGraph::refine_bump_nodes()
   }
 }
 
+void ShaderGraph::refine_image_texture_footprints()
+{
+  /* Like for bump nodes, we copy the sub-graph defined by the "Vector" input of image textures
+   * to the inputs "VectorDX" and "VectorDY", to evaluate it at the neighboring pixels. The
+   * difference gives the footprint of the lookup, from which the texture cache chooses a
+   * mip-map level. Nodes that are themselves used for bump computation keep the full
+   * resolution, so that all their samples come from the same level. */
+
+  vector<ShaderNode *> image_nodes;
+  foreach (ShaderNode *node, nodes) {
+    if (node->type != ImageTextureNode::get_node_type() || node->bump != SHADER_BUMP_NONE) {
+      continue;
+    }
+    const ImageTextureNode *image_node = static_cast<const ImageTextureNode *>(node);
+    if (image_node->get_interpolation() == INTERPOLATION_CLOSEST ||
+        image_node->get_projection() == NODE_IMAGE_PROJ_BOX || !node->input("Vector")->link)
+    {
+      continue;
+    }
+    image_nodes.push_back(node);
+  }
+
+  foreach (ShaderNode *node, image_nodes) {
+    ShaderInput *vector_input = node->input("Vector");
+    ShaderNodeSet nodes_vector;
+
+    /* Make 2 extra copies of the subgraph defined in Vector input. */
+    ShaderNodeMap nodes_dx;
+    ShaderNodeMap nodes_dy;
+
+    find_dependencies(nodes_vector, vector_input);
+
+    copy_nodes(nodes_vector, nodes_dx);
+    copy_nodes(nodes_vector, nodes_dy);
+
+    foreach (NodePair &pair, nodes_dx)
+      pair.second->bump = SHADER_BUMP_DX;
+    foreach (NodePair &pair, nodes_dy)
+      pair.second->bump = SHADER_BUMP_DY;
+
+    ShaderOutput *out = vector_input->link;
+    connect(nodes_dx[out->parent]->output(out->name()), node->input("VectorDX"));
+    connect(nodes_dy[out->parent]->output(out->name()), node->input("VectorDY"));
+
+    foreach (NodePair &pair, nodes_dx)
+      add(pair.second);
+    foreach (NodePair &pair, nodes_dy)
+      add(pair.second);
+  }
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
   /* generate bump mapping automatically from displacement. bump mapping is
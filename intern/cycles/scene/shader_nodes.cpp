@@ -252,6 +252,8 @@ NODE_DEFINE(ImageTextureNode)
   SOCKET_BOOLEAN(animated, "Animated", false);
 
   SOCKET_IN_POINT(vector, "Vector", zero_float3(), SocketType::LINK_TEXTURE_UV);
+  SOCKET_IN_POINT(vector_dx, "VectorDX", zero_float3(), SocketType::SVM_INTERNAL);
+  SOCKET_IN_POINT(vector_dy, "VectorDY", zero_float3(), SocketType::SVM_INTERNAL);
 
   SOCKET_OUT_COLOR(color, "Color");
   SOCKET_OUT_FLOAT(alpha, "Alpha");
@@ -381,6 +383,18 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
   int vector_offset = tex_mapping.compile_begin(compiler, vector_in);
   uint flags = 0;
 
+  ShaderInput *vector_dx_in = input("VectorDX");
+  ShaderInput *vector_dy_in = input("VectorDY");
+  const bool use_footprint = projection != NODE_IMAGE_PROJ_BOX && vector_dx_in->link &&
+                             vector_dy_in->link;
+  int vector_dx_offset = SVM_STACK_INVALID;
+  int vector_dy_offset = SVM_STACK_INVALID;
+  if (use_footprint) {
+    vector_dx_offset = tex_mapping.compile_begin(compiler, vector_dx_in);
+    vector_dy_offset = tex_mapping.compile_begin(compiler, vector_dy_in);
+    flags |= NODE_IMAGE_USE_FOOTPRINT;
+  }
+
   if (compress_as_srgb) {
     flags |= NODE_IMAGE_COMPRESS_AS_SRGB;
   }
@@ -412,6 +426,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                              flags),
                       projection);
 
+    if (use_footprint) {
+      compiler.add_node(vector_dx_offset, vector_dy_offset, 0, 0);
+    }
+
     if (num_nodes > 0) {
       for (int i = 0; i < num_nodes; i++) {
         int4 node;
@@ -440,6 +458,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                       __float_as_int(projection_blend));
   }
 
+  if (use_footprint) {
+    tex_mapping.compile_end(compiler, vector_dy_in, vector_dy_offset);
+    tex_mapping.compile_end(compiler, vector_dx_in, vector_dx_offset);
+  }
   tex_mapping.compile_end(compiler, vector_in, vector_offset);
 }
 
@@ -114,6 +114,9 @@ class ImageTextureNode : public ImageSlotTextureNode {
   NODE_SOCKET_API(float, projection_blend)
   NODE_SOCKET_API(bool, animated)
   NODE_SOCKET_API(float3, vector)
+  /* Vector at the neighboring pixels, linked when the texture cache needs the footprint. */
+  NODE_SOCKET_API(float3, vector_dx)
+  NODE_SOCKET_API(float3, vector_dy)
   NODE_SOCKET_API_ARRAY(array<int>, tiles)
 
  protected:
@@ -210,6 +210,43 @@ string MeshStats::full_report(int indent_level)
   return result;
 }
 
+/* Texture cache statistics. */
+
+TextureCacheStats::TextureCacheStats()
+    : enabled(false),
+      memory_budget(0),
+      peak_memory(0),
+      tile_requests(0),
+      tile_loads(0),
+      tile_evictions(0),
+      hit_rate(0.0)
+{
+}
+
+string TextureCacheStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  string result = "";
+  result += string_printf("%sMemory budget: %s\n",
+                          indent.c_str(),
+                          string_human_readable_size(memory_budget).c_str());
+  result += string_printf("%sPeak memory: %s\n",
+                          indent.c_str(),
+                          string_human_readable_size(peak_memory).c_str());
+  result += string_printf("%sTile requests: %s\n",
+                          indent.c_str(),
+                          string_human_readable_number(tile_requests).c_str());
+  result += string_printf("%sTiles loaded: %s\n",
+                          indent.c_str(),
+                          string_human_readable_number(tile_loads).c_str());
+  result += string_printf("%sTiles evicted: %s\n",
+                          indent.c_str(),
+                          string_human_readable_number(tile_evictions).c_str());
+  result += string_printf("%sHit rate: %.2f%%\n", indent.c_str(), hit_rate * 100.0);
+  result += indent + "Loaded:\n" + loaded.full_report(indent_level + 1);
+  return result;
+}
+
 /* Image statistics. */
 
 ImageStats::ImageStats() {}
@@ -219,6 +256,9 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (texture_cache.enabled) {
+    result += indent + "Texture cache:\n" + texture_cache.full_report(indent_level + 1);
+  }
   return result;
 }
 
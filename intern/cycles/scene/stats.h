@@ -150,6 +150,26 @@ class MeshStats {
   NamedSizeStats geometry;
 };
 
+/* Statistics about images loaded on demand by the texture cache. */
+class TextureCacheStats {
+ public:
+  TextureCacheStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  bool enabled;
+  size_t memory_budget;
+  size_t peak_memory;
+  uint64_t tile_requests;
+  uint64_t tile_loads;
+  uint64_t tile_evictions;
+  double hit_rate;
+
+  /* Bytes loaded for each image, including tiles that were evicted again. */
+  NamedSizeStats loaded;
+};
+
 /* Statistics about images held in memory. */
 class ImageStats {
  public:
@@ -159,6 +179,7 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+  TextureCacheStats texture_cache;
 };
 
 /* Render process statistics. */
@@ -6,6 +6,7 @@
 
 #include "util/array.h"
 #include "util/map.h"
+#include "util/math.h"
 #include "util/system.h"
 #include "util/time.h"
 #include "util/unique_ptr.h"
@@ -20,7 +21,6 @@ CCL_NAMESPACE_BEGIN
 /* Merge Image Layer */
 
 enum MergeChannelOp {
-  MERGE_CHANNEL_NOP,
   MERGE_CHANNEL_COPY,
   MERGE_CHANNEL_SUM,
   MERGE_CHANNEL_AVERAGE,
@@ -43,9 +43,9 @@ struct MergeImagePass {
 };
 
 struct SampleCount {
-  /* Total number of samples. */
+  /* Total number of samples, of all images that cover the same pixel. */
   int total;
-  /* Buffer for actual number of samples rendered per pixel. */
+  /* Actual number of samples rendered per pixel, for the current scanline. */
   array<float> per_pixel;
 };
 
@@ -71,6 +71,22 @@ struct MergeImage {
   string filepath;
   /* Render layers. */
   vector<MergeImageLayer> layers;
+  /* Pixels of the current scanline, empty if the image does not cover it. */
+  array<float> scanline;
+
+  /* Whether the data window of the image, which is a region of the full image for border
+   * renders, covers the scanline. */
+  bool covers_scanline(const int y) const
+  {
+    const ImageSpec &spec = in->spec();
+    return y >= spec.y && y < spec.y + spec.height;
+  }
+
+  bool covers_pixel(const int x, const int y) const
+  {
+    const ImageSpec &spec = in->spec();
+    return covers_scanline(y) && x >= spec.x && x < spec.x + spec.width;
+  }
 };
 
 /* Channel Parsing */
@@ -261,13 +277,19 @@ static bool open_images(const vector<string> &filepaths, vector<MergeImage> &ima
       return false;
     }
 
+    if (image.in->spec().depth != 1) {
+      error = "Merging volume images not supported.";
+      return false;
+    }
+
     if (images.size() > 0) {
+      /* Images may be renders of different regions of the same full image. */
       const ImageSpec &base_spec = images[0].in->spec();
       const ImageSpec &spec = image.in->spec();
 
-      if (base_spec.width != spec.width || base_spec.height != spec.height ||
-          base_spec.depth != spec.depth || base_spec.format != spec.format ||
-          base_spec.deep != spec.deep)
+      if (base_spec.full_x != spec.full_x || base_spec.full_y != spec.full_y ||
+          base_spec.full_width != spec.full_width || base_spec.full_height != spec.full_height ||
+          base_spec.format != spec.format || base_spec.deep != spec.deep)
       {
         error = "Images do not have matching size and data layout.";
         return false;
@@ -320,11 +342,61 @@ static void merge_layer_render_time(ImageSpec &spec,
   spec.attribute(name, TypeDesc::STRING, time_human_readable_from_seconds(time));
 }
 
-static void merge_channels_metadata(vector<MergeImage> &images, ImageSpec &out_spec)
+/* Total number of samples of a layer, for the pixels covered by most samples. When the images
+ * are renders of different regions, that is not the sum of the samples of all images. */
+static int layer_total_samples(const vector<MergeImage> &images, const string &layer_name)
+{
+  /* Overlapping data windows have their minimum X and Y coordinates in common, so only those
+   * pixels need to be checked. */
+  int total = 0;
+  for (const MergeImage &image_x : images) {
+    for (const MergeImage &image_y : images) {
+      const int x = image_x.in->spec().x;
+      const int y = image_y.in->spec().y;
+
+      int samples = 0;
+      for (const MergeImage &image : images) {
+        if (!image.covers_pixel(x, y)) {
+          continue;
+        }
+        for (const MergeImageLayer &layer : image.layers) {
+          if (layer.name == layer_name) {
+            samples += layer.samples;
+          }
+        }
+      }
+      total = max(total, samples);
+    }
+  }
+
+  return total;
+}
+
+static void merge_channels_metadata(vector<MergeImage> &images,
+                                    ImageSpec &out_spec,
+                                    unordered_map<string, SampleCount> &layer_samples)
 {
   /* Based on first image. */
   out_spec = images[0].in->spec();
 
+  /* Data window covering all images. */
+  int x_end = out_spec.x + out_spec.width;
+  int y_end = out_spec.y + out_spec.height;
+  for (const MergeImage &image : images) {
+    const ImageSpec &spec = image.in->spec();
+    out_spec.x = min(out_spec.x, spec.x);
+    out_spec.y = min(out_spec.y, spec.y);
+    x_end = max(x_end, spec.x + spec.width);
+    y_end = max(y_end, spec.y + spec.height);
+  }
+  out_spec.width = x_end - out_spec.x;
+  out_spec.height = y_end - out_spec.y;
+
+  /* Output is written one scanline at a time. */
+  out_spec.tile_width = 0;
+  out_spec.tile_height = 0;
+  out_spec.tile_depth = 0;
+
   /* Merge channels and compute offsets. */
   out_spec.nchannels = 0;
   out_spec.channelformats.clear();
@@ -342,11 +414,6 @@ static void merge_channels_metadata(vector<MergeImage> &images, ImageSpec &out_s
         if (channel != out_spec.channelnames.end()) {
           int index = distance(out_spec.channelnames.begin(), channel);
           pass.merge_offset = index;
-
-          /* First image wins for channels that can't be averaged or summed. */
-          if (pass.op == MERGE_CHANNEL_COPY) {
-            pass.op = MERGE_CHANNEL_NOP;
-          }
         }
         else {
           /* Add new channel. */
@@ -363,67 +430,122 @@ static void merge_channels_metadata(vector<MergeImage> &images, ImageSpec &out_s
   /* Merge metadata. */
   merge_render_time(out_spec, images, "RenderTime", false);
 
-  map<string, int> layer_num_samples;
   for (MergeImage &image : images) {
     for (MergeImageLayer &layer : image.layers) {
-      if (layer.name != "") {
-        layer_num_samples[layer.name] += layer.samples;
-      }
+      SampleCount &samples = layer_samples[layer.name];
+      samples.total = layer_total_samples(images, layer.name);
+      samples.per_pixel.resize(out_spec.width);
     }
   }
 
-  for (const auto &[layer_name, layer_samples] : layer_num_samples) {
+  for (const auto &[layer_name, samples] : layer_samples) {
+    if (layer_name == "") {
+      continue;
+    }
+
     string name = "cycles." + layer_name + ".samples";
-    out_spec.attribute(name, TypeDesc::STRING, to_string(layer_samples));
+    out_spec.attribute(name, TypeDesc::STRING, to_string(samples.total));
 
     merge_layer_render_time(out_spec, images, layer_name, "total_time", false);
     merge_layer_render_time(out_spec, images, layer_name, "render_time", false);
     merge_layer_render_time(out_spec, images, layer_name, "synchronization_time", true);
+
+    /* The sample range and seed of partial renders no longer apply. */
+    out_spec.erase_attribute("cycles." + layer_name + ".sample_offset");
+    out_spec.erase_attribute("cycles." + layer_name + ".seed");
   }
 }
 
-static void alloc_pixels(const ImageSpec &spec, array<float> &pixels)
+static bool read_scanline(vector<MergeImage> &images, const int y, string &error)
 {
-  const size_t width = spec.width;
-  const size_t height = spec.height;
-  const size_t num_channels = spec.nchannels;
+  for (MergeImage &image : images) {
+    if (!image.covers_scanline(y)) {
+      image.scanline.clear();
+      continue;
+    }
 
-  const size_t num_pixels = width * height;
-  pixels.resize(num_pixels * num_channels);
+    /* Read all channels at once, which is faster than individually due to interleaved EXR
+     * channel storage. */
+    const ImageSpec &spec = image.in->spec();
+    image.scanline.resize(size_t(spec.width) * spec.nchannels);
+    if (!image.in->read_scanlines(
+            0, 0, y, y + 1, 0, 0, spec.nchannels, TypeDesc::FLOAT, image.scanline.data()))
+    {
+      error = "Failed to read image: " + image.filepath;
+      return false;
+    }
+  }
+
+  return true;
 }
 
-static bool merge_pixels(const vector<MergeImage> &images,
-                         const ImageSpec &out_spec,
-                         const unordered_map<string, SampleCount> &layer_samples,
-                         array<float> &out_pixels,
-                         string &error)
+static void scanline_layer_samples(const vector<MergeImage> &images,
+                                   const ImageSpec &out_spec,
+                                   unordered_map<string, SampleCount> &layer_samples)
 {
-  alloc_pixels(out_spec, out_pixels);
-  memset(out_pixels.data(), 0, out_pixels.size() * sizeof(float));
+  for (auto &[layer_name, samples] : layer_samples) {
+    std::fill(samples.per_pixel.begin(), samples.per_pixel.end(), 0.0f);
+  }
 
   for (const MergeImage &image : images) {
-    /* Read all channels into buffer. Reading all channels at once is
-     * faster than individually due to interleaved EXR channel storage. */
-    array<float> pixels;
-    alloc_pixels(image.in->spec(), pixels);
-    const int num_channels = image.in->spec().nchannels;
-    if (!image.in->read_image(0, 0, 0, num_channels, TypeDesc::FLOAT, pixels.data())) {
-      error = "Failed to read image: " + image.filepath;
-      return false;
+    if (image.scanline.empty()) {
+      continue;
+    }
+
+    const ImageSpec &spec = image.in->spec();
+    const int stride = spec.nchannels;
+    const int out_x = spec.x - out_spec.x;
+
+    for (const MergeImageLayer &layer : image.layers) {
+      float *per_pixel = layer_samples.at(layer.name).per_pixel.data() + out_x;
+
+      if (layer.has_sample_pass) {
+        /* Use the "Debug Sample Count" pass to add the samples to the layer's sample count. */
+        const float *sample_pass = image.scanline.data() +
+                                   layer.passes[layer.sample_pass_offset].offset;
+        for (int i = 0; i < spec.width; i++) {
+          per_pixel[i] += sample_pass[i * stride] * layer.samples;
+        }
+      }
+      else {
+        /* Use sample count from metadata if there's no "Debug Sample Count" pass. */
+        for (int i = 0; i < spec.width; i++) {
+          per_pixel[i] += layer.samples;
+        }
+      }
     }
+  }
+}
+
+static void merge_scanline(const vector<MergeImage> &images,
+                           const ImageSpec &out_spec,
+                           const unordered_map<string, SampleCount> &layer_samples,
+                           array<float> &out_pixels)
+{
+  memset(out_pixels.data(), 0, out_pixels.size() * sizeof(float));
+
+  /* Channels that can't be averaged or summed are copied, with the first image that covers the
+   * pixel winning. So handle images in reverse order. */
+  for (auto image_it = images.rbegin(); image_it != images.rend(); ++image_it) {
+    const MergeImage &image = *image_it;
+    if (image.scanline.empty()) {
+      continue;
+    }
+
+    const array<float> &pixels = image.scanline;
+    const size_t stride = image.in->spec().nchannels;
+    const size_t out_stride = out_spec.nchannels;
+    const size_t num_pixels = pixels.size();
+    const size_t out_x = image.in->spec().x - out_spec.x;
 
     for (const MergeImageLayer &layer : image.layers) {
-      const size_t stride = image.in->spec().nchannels;
-      const size_t out_stride = out_spec.nchannels;
-      const size_t num_pixels = pixels.size();
+      const SampleCount &samples = layer_samples.at(layer.name);
 
       for (const MergeImagePass &pass : layer.passes) {
         size_t offset = pass.offset;
-        size_t out_offset = pass.merge_offset;
+        size_t out_offset = out_x * out_stride + pass.merge_offset;
 
         switch (pass.op) {
-          case MERGE_CHANNEL_NOP:
-            break;
           case MERGE_CHANNEL_COPY:
             for (; offset < num_pixels; offset += stride, out_offset += out_stride) {
               out_pixels[out_offset] = pixels[offset];
@@ -437,10 +559,11 @@ static bool merge_pixels(const vector<MergeImage> &images,
           case MERGE_CHANNEL_AVERAGE: {
             /* Weights based on sample count passes and sample metadata. Per channel since not
              * all files are guaranteed to have the same channels. */
-            size_t sample_pass_offset = layer.sample_pass_offset;
-            const auto &samples = layer_samples.at(layer.name);
+            size_t sample_pass_offset = layer.has_sample_pass ?
+                                            layer.passes[layer.sample_pass_offset].offset :
+                                            0;
 
-            for (size_t i = 0; offset < num_pixels;
+            for (size_t i = out_x; offset < num_pixels;
                  offset += stride, sample_pass_offset += stride, out_offset += out_stride, i++)
             {
               const float total_samples = samples.per_pixel[i];
@@ -458,8 +581,7 @@ static bool merge_pixels(const vector<MergeImage> &images,
             break;
           }
           case MERGE_CHANNEL_SAMPLES: {
-            const auto &samples = layer_samples.at(layer.name);
-            for (size_t i = 0; offset < num_pixels;
+            for (size_t i = out_x; offset < num_pixels;
                  offset += stride, out_offset += out_stride, i++)
             {
               out_pixels[out_offset] = 1.0f * samples.per_pixel[i] / samples.total;
@@ -470,14 +592,13 @@ static bool merge_pixels(const vector<MergeImage> &images,
       }
     }
   }
-
-  return true;
 }
 
-static bool save_output(const string &filepath,
-                        const ImageSpec &spec,
-                        const array<float> &pixels,
-                        string &error)
+static bool merge_images(vector<MergeImage> &images,
+                         const string &filepath,
+                         const ImageSpec &spec,
+                         unordered_map<string, SampleCount> &layer_samples,
+                         string &error)
 {
   /* Write to temporary file path, so we merge images in place and don't
    * risk destroying files when something goes wrong in file saving. */
@@ -497,10 +618,23 @@ static bool save_output(const string &filepath,
     return false;
   }
 
+  /* Merge one scanline at a time, so that memory usage does not depend on the image height. */
   bool ok = true;
-  if (!out->write_image(TypeDesc::FLOAT, pixels.data())) {
-    error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
-    ok = false;
+  array<float> pixels(size_t(spec.width) * spec.nchannels);
+  for (int y = spec.y; y < spec.y + spec.height; y++) {
+    if (!read_scanline(images, y, error)) {
+      ok = false;
+      break;
+    }
+
+    scanline_layer_samples(images, spec, layer_samples);
+    merge_scanline(images, spec, layer_samples, pixels);
+
+    if (!out->write_scanline(y, 0, TypeDesc::FLOAT, pixels.data())) {
+      error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
+      ok = false;
+      break;
+    }
   }
 
   if (!out->close()) {
@@ -510,6 +644,10 @@ static bool save_output(const string &filepath,
 
   out.reset();
 
+  /* We don't need input anymore at this point, and will possibly
+   * overwrite the same file. */
+  images.clear();
+
   /* Copy temporary file to output filepath. */
   string rename_error;
   if (ok && !OIIO::Filesystem::rename(tmp_filepath, filepath, rename_error)) {
@@ -524,50 +662,6 @@ static bool save_output(const string &filepath,
   return ok;
 }
 
-static void read_layer_samples(vector<MergeImage> &images,
-                               unordered_map<string, SampleCount> &layer_samples)
-{
-  for (auto &image : images) {
-    const ImageSpec &in_spec = image.in->spec();
-
-    for (auto &layer : image.layers) {
-      bool initialize = (layer_samples.count(layer.name) == 0);
-      auto &current_layer_samples = layer_samples[layer.name];
-
-      if (initialize) {
-        current_layer_samples.total = 0;
-        current_layer_samples.per_pixel.resize(in_spec.width * in_spec.height);
-        std::fill(
-            current_layer_samples.per_pixel.begin(), current_layer_samples.per_pixel.end(), 0.0f);
-      }
-
-      if (layer.has_sample_pass) {
-        /* Load the "Debug Sample Count" pass and add the samples to the layer's sample count. */
-        array<float> sample_count_buffer;
-        sample_count_buffer.resize(in_spec.width * in_spec.height);
-
-        image.in->read_image(0,
-                             0,
-                             layer.sample_pass_offset,
-                             layer.sample_pass_offset,
-                             TypeDesc::FLOAT,
-                             (void *)sample_count_buffer.data());
-
-        for (size_t i = 0; i < current_layer_samples.per_pixel.size(); i++) {
-          current_layer_samples.per_pixel[i] += sample_count_buffer[i] * layer.samples;
-        }
-      }
-      else {
-        /* Use sample count from metadata if there's no "Debug Sample Count" pass. */
-        for (size_t i = 0; i < current_layer_samples.per_pixel.size(); i++) {
-          current_layer_samples.per_pixel[i] += layer.samples;
-        }
-      }
-
-      current_layer_samples.total += layer.samples;
-    }
-  }
-}
 /* Image Merger */
 
 ImageMerger::ImageMerger() {}
@@ -589,26 +683,13 @@ bool ImageMerger::run()
     return false;
   }
 
-  /* Load and sum sample count for each render layer. */
-  unordered_map<string, SampleCount> layer_samples;
-  read_layer_samples(images, layer_samples);
-
-  /* Merge metadata and setup channels and offsets. */
+  /* Merge metadata and setup channels, offsets and sample counts. */
   ImageSpec out_spec;
-  merge_channels_metadata(images, out_spec);
-
-  /* Merge pixels. */
-  array<float> out_pixels;
-  if (!merge_pixels(images, out_spec, layer_samples, out_pixels, error)) {
-    return false;
-  }
-
-  /* We don't need input anymore at this point, and will possibly
-   * overwrite the same file. */
-  images.clear();
+  unordered_map<string, SampleCount> layer_samples;
+  merge_channels_metadata(images, out_spec, layer_samples);
 
-  /* Save output file. */
-  return save_output(output, out_spec, out_pixels, error);
+  /* Merge pixels and save output file. */
+  return merge_images(images, output, out_spec, layer_samples, error);
 }
 
 CCL_NAMESPACE_END
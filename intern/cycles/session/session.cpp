@@ -12,6 +12,7 @@
 #include "scene/background.h"
 #include "scene/bake.h"
 #include "scene/camera.h"
+#include "scene/image.h"
 #include "scene/integrator.h"
 #include "scene/light.h"
 #include "scene/mesh.h"
@@ -212,6 +213,9 @@ void Session::run_main_render_loop()
       /* render */
       path_trace_->render(render_work);
 
+      /* Evict texture tiles now that no kernels are running. */
+      scene->image_manager->texture_cache_collect_garbage();
+
       /* update status and timing */
       update_status_time();
 
@@ -0,0 +1,274 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <filesystem>
+
+#include "testing/testing.h"
+
+#include "app/cycles_binary.h"
+
+#include "device/device.h"
+
+#include "scene/attribute.h"
+#include "scene/background.h"
+#include "scene/camera.h"
+#include "scene/colorspace.h"
+#include "scene/film.h"
+#include "scene/integrator.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+#include "scene/shader_graph.h"
+#include "scene/shader_nodes.h"
+
+#include "util/path.h"
+#include "util/stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+template<typename T> T *find_node(const vector<T *> &nodes, const char *name)
+{
+  for (T *node : nodes) {
+    if (node->name == name) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+ShaderNode *find_shader_node(ShaderGraph *graph, const char *name)
+{
+  for (ShaderNode *node : graph->nodes) {
+    if (node->name == name) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+/* Diffuse shader with a value node that is linked both to the diffuse node and to an OSL node,
+ * which can't be written. */
+Shader *create_material(Scene *scene)
+{
+  ShaderGraph *graph = new ShaderGraph();
+
+  ValueNode *value = graph->create_node<ValueNode>();
+  value->name = ustring("value");
+  value->set_value(0.25f);
+  graph->add(value);
+
+  DiffuseBsdfNode *diffuse = graph->create_node<DiffuseBsdfNode>();
+  diffuse->name = ustring("diffuse");
+  diffuse->set_color(make_float3(0.1f, 0.2f, 0.3f));
+  graph->add(diffuse);
+
+  MathNode *math = graph->create_node<MathNode>();
+  math->name = ustring("math");
+  graph->add(math);
+
+  OSLNode *osl = OSLNode::create(graph, 1);
+  osl->name = ustring("osl");
+  osl->add_input(ustring("In"), SocketType::FLOAT);
+  osl->add_output(ustring("Out"), SocketType::FLOAT);
+  osl->create_inputs_outputs(osl->type);
+  graph->add(osl);
+
+  graph->connect(value->output("Value"), diffuse->input("Roughness"));
+  graph->connect(diffuse->output("BSDF"), graph->output()->input("Surface"));
+  graph->connect(value->output("Value"), osl->input("In"));
+  graph->connect(osl->output("Out"), math->input("Value1"));
+
+  Shader *shader = scene->create_node<Shader>();
+  shader->name = ustring("material");
+  shader->set_graph(graph);
+  return shader;
+}
+
+/* Quad made of two triangles that is also a subdivision face, with attributes on both. */
+Mesh *create_mesh(Scene *scene, Shader *shader)
+{
+  Mesh *mesh = scene->create_node<Mesh>();
+  mesh->name = ustring("mesh");
+
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(shader);
+  mesh->set_used_shaders(used_shaders);
+
+  mesh->reserve_mesh(4, 2);
+  mesh->add_vertex(make_float3(0.0f, 0.0f, 0.0f));
+  mesh->add_vertex(make_float3(1.0f, 0.0f, 0.0f));
+  mesh->add_vertex(make_float3(1.0f, 1.0f, 0.0f));
+  mesh->add_vertex(make_float3(0.0f, 1.0f, 0.0f));
+  mesh->add_triangle(0, 1, 2, 0, false);
+  mesh->add_triangle(0, 2, 3, 0, false);
+
+  mesh->set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+  mesh->reserve_subd_faces(1, 0, 4);
+  const int corners[4] = {0, 1, 2, 3};
+  mesh->add_subd_face(corners, 4, 0, false);
+
+  Attribute *weight = mesh->attributes.add(
+      ustring("weight"), TypeDesc::TypeFloat, ATTR_ELEMENT_VERTEX);
+  for (int i = 0; i < 4; i++) {
+    weight->data_float()[i] = i * 0.5f;
+  }
+  Attribute *uv = mesh->attributes.add(ATTR_STD_UV, ustring("UVMap"));
+  for (int i = 0; i < 6; i++) {
+    uv->data_float2()[i] = make_float2(i * 0.1f, i * 0.2f);
+  }
+
+  Attribute *subd_weight = mesh->subd_attributes.add(
+      ustring("subd_weight"), TypeDesc::TypeFloat, ATTR_ELEMENT_VERTEX);
+  for (int i = 0; i < 4; i++) {
+    subd_weight->data_float()[i] = i * 0.25f;
+  }
+
+  return mesh;
+}
+
+void expect_attributes_equal(const AttributeSet &attributes, const AttributeSet &read_attributes)
+{
+  EXPECT_EQ(read_attributes.attributes.size(), attributes.attributes.size());
+  for (const Attribute &attr : attributes.attributes) {
+    const Attribute *read_attr = read_attributes.find(attr.name);
+    ASSERT_NE(read_attr, nullptr) << attr.name;
+    EXPECT_EQ(read_attr->std, attr.std) << attr.name;
+    EXPECT_EQ(read_attr->type, attr.type) << attr.name;
+    EXPECT_EQ(read_attr->element, attr.element) << attr.name;
+    EXPECT_EQ(read_attr->buffer, attr.buffer) << attr.name;
+  }
+}
+
+}  // namespace
+
+class AppBinary : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  string filepath;
+
+  void SetUp() override
+  {
+    /* Avoid warnings about the missing OCIO configuration, see the render graph tests. */
+    ColorSpaceManager::init_fallback_config();
+    device_cpu = Device::create(device_info, stats, profiler, true);
+    filepath = path_join(std::filesystem::temp_directory_path().string(),
+                         "cycles_app_binary_test.bin");
+  }
+
+  void TearDown() override
+  {
+    path_remove(filepath);
+    delete device_cpu;
+  }
+};
+
+TEST_F(AppBinary, round_trip)
+{
+  Scene *scene = new Scene(scene_params, device_cpu);
+  scene->camera->set_fov(0.5f);
+  scene->film->set_exposure(2.0f);
+  scene->integrator->set_max_bounce(3);
+  scene->background->set_transparent(true);
+
+  Shader *material = create_material(scene);
+  Mesh *mesh = create_mesh(scene, material);
+  Object *object = scene->create_node<Object>();
+  object->name = ustring("object");
+  object->set_geometry(mesh);
+  object->set_tfm(transform_translate(1.0f, 2.0f, 3.0f));
+
+  ASSERT_TRUE(binary_write_file(scene, filepath.c_str()));
+
+  Scene *read_scene = new Scene(scene_params, device_cpu);
+  ASSERT_TRUE(binary_read_file(read_scene, filepath.c_str()));
+
+  /* Nodes owned by the scene are filled in instead of being added. */
+  EXPECT_EQ(read_scene->camera->get_fov(), 0.5f);
+  EXPECT_EQ(read_scene->film->get_exposure(), 2.0f);
+  EXPECT_EQ(read_scene->integrator->get_max_bounce(), 3);
+  EXPECT_TRUE(read_scene->background->get_transparent());
+  EXPECT_EQ(read_scene->shaders.size(), scene->shaders.size());
+  EXPECT_EQ(find_node(read_scene->shaders, "default_surface"), read_scene->default_surface);
+  EXPECT_EQ(read_scene->geometry.size(), 1);
+  EXPECT_EQ(read_scene->objects.size(), 1);
+
+  /* Node references point to the read nodes. */
+  Shader *read_material = find_node(read_scene->shaders, "material");
+  Mesh *read_mesh = static_cast<Mesh *>(find_node(read_scene->geometry, "mesh"));
+  Object *read_object = find_node(read_scene->objects, "object");
+  ASSERT_NE(read_material, nullptr);
+  ASSERT_NE(read_mesh, nullptr);
+  ASSERT_NE(read_object, nullptr);
+  EXPECT_EQ(read_object->get_geometry(), read_mesh);
+  EXPECT_EQ(read_object->get_tfm(), object->get_tfm());
+  ASSERT_EQ(read_mesh->get_used_shaders().size(), 1);
+  EXPECT_EQ(read_mesh->get_used_shaders()[0], read_material);
+
+  /* Shader graph without the OSL node and its links. */
+  ShaderGraph *read_graph = read_material->graph;
+  ASSERT_NE(read_graph, nullptr);
+  EXPECT_EQ(read_graph->nodes.size(), material->graph->nodes.size() - 1);
+  EXPECT_EQ(find_shader_node(read_graph, "osl"), nullptr);
+
+  ValueNode *read_value = static_cast<ValueNode *>(find_shader_node(read_graph, "value"));
+  DiffuseBsdfNode *read_diffuse = static_cast<DiffuseBsdfNode *>(
+      find_shader_node(read_graph, "diffuse"));
+  ShaderNode *read_math = find_shader_node(read_graph, "math");
+  ASSERT_NE(read_value, nullptr);
+  ASSERT_NE(read_diffuse, nullptr);
+  ASSERT_NE(read_math, nullptr);
+  EXPECT_EQ(read_value->get_value(), 0.25f);
+  EXPECT_EQ(read_diffuse->get_color(), make_float3(0.1f, 0.2f, 0.3f));
+  EXPECT_EQ(read_diffuse->input("Roughness")->link, read_value->output("Value"));
+  EXPECT_EQ(read_graph->output()->input("Surface")->link, read_diffuse->output("BSDF"));
+  EXPECT_EQ(read_math->input("Value1")->link, nullptr);
+  EXPECT_EQ(read_value->output("Value")->links.size(), 1);
+
+  /* Geometry and attributes. */
+  EXPECT_EQ(read_mesh->get_verts(), mesh->get_verts());
+  EXPECT_EQ(read_mesh->get_triangles(), mesh->get_triangles());
+  EXPECT_EQ(read_mesh->get_subdivision_type(), Mesh::SUBDIVISION_LINEAR);
+  EXPECT_EQ(read_mesh->get_subd_face_corners(), mesh->get_subd_face_corners());
+  expect_attributes_equal(mesh->attributes, read_mesh->attributes);
+  expect_attributes_equal(mesh->subd_attributes, read_mesh->subd_attributes);
+
+  delete read_scene;
+  delete scene;
+}
+
+TEST_F(AppBinary, invalid_file)
+{
+  Scene *scene = new Scene(scene_params, device_cpu);
+  create_mesh(scene, create_material(scene));
+  ASSERT_TRUE(binary_write_file(scene, filepath.c_str()));
+  EXPECT_TRUE(binary_is_file(filepath.c_str()));
+  delete scene;
+
+  /* Truncated file. */
+  {
+    FILE *file = path_fopen(filepath, "rb");
+    ASSERT_NE(file, nullptr);
+    vector<char> data(path_file_size(filepath));
+    ASSERT_EQ(fread(data.data(), 1, data.size(), file), data.size());
+    fclose(file);
+
+    file = path_fopen(filepath, "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(data.data(), 1, data.size() / 2, file);
+    fclose(file);
+  }
+
+  Scene *read_scene = new Scene(scene_params, device_cpu);
+  EXPECT_FALSE(binary_read_file(read_scene, filepath.c_str()));
+  delete read_scene;
+}
+
+CCL_NAMESPACE_END
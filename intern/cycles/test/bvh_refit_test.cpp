@@ -0,0 +1,174 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh.h"
+#include "bvh/bvh2.h"
+
+#include "scene/mesh.h"
+#include "scene/object.h"
+
+#include "util/boundbox.h"
+#include "util/progress.h"
+#include "util/unique_ptr.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const int GRID_SIZE = 32;
+
+/* Flat grid of quads in the XY plane, with rows of vertices stored one after the other. */
+void fill_grid_mesh(Mesh &mesh)
+{
+  mesh.reserve_mesh((GRID_SIZE + 1) * (GRID_SIZE + 1), GRID_SIZE * GRID_SIZE * 2);
+  for (int y = 0; y <= GRID_SIZE; y++) {
+    for (int x = 0; x <= GRID_SIZE; x++) {
+      mesh.add_vertex(make_float3(x, y, 0.0f));
+    }
+  }
+  for (int y = 0; y < GRID_SIZE; y++) {
+    for (int x = 0; x < GRID_SIZE; x++) {
+      const int v = y * (GRID_SIZE + 1) + x;
+      mesh.add_triangle(v, v + 1, v + GRID_SIZE + 2, 0, false);
+      mesh.add_triangle(v, v + GRID_SIZE + 2, v + GRID_SIZE + 1, 0, false);
+    }
+  }
+}
+
+/* Move all vertices a little, roughly keeping neighbors together. */
+void deform_slightly(Mesh &mesh)
+{
+  array<float3> verts = mesh.get_verts();
+  for (size_t i = 0; i < verts.size(); i++) {
+    verts[i] += make_float3(0.5f, 0.0f, 0.05f * sinf(verts[i].x));
+  }
+  mesh.set_verts(verts);
+}
+
+/* Swap vertices around, so that triangles stretch across the grid while its bounds stay the
+ * same. */
+void scramble(Mesh &mesh)
+{
+  const array<float3> verts = mesh.get_verts();
+  array<float3> scrambled_verts(verts.size());
+  for (size_t i = 0; i < verts.size(); i++) {
+    scrambled_verts[i] = verts[(i * 7919) % verts.size()];
+  }
+  mesh.set_verts(scrambled_verts);
+}
+
+BoundBox vertex_bounds(Mesh &mesh)
+{
+  BoundBox bounds = BoundBox::empty;
+  for (const float3 &vert : mesh.get_verts()) {
+    bounds.grow(vert);
+  }
+  return bounds;
+}
+
+/* Bounds of the root of a packed BVH2, from the bounds of its two children. */
+BoundBox bvh2_root_bounds(const BVH2 &bvh)
+{
+  const int4 *data = &bvh.pack.nodes[0];
+  return BoundBox(make_float3(min(__int_as_float(data[1].x), __int_as_float(data[1].y)),
+                              min(__int_as_float(data[2].x), __int_as_float(data[2].y)),
+                              min(__int_as_float(data[3].x), __int_as_float(data[3].y))),
+                  make_float3(max(__int_as_float(data[1].z), __int_as_float(data[1].w)),
+                              max(__int_as_float(data[2].z), __int_as_float(data[2].w)),
+                              max(__int_as_float(data[3].z), __int_as_float(data[3].w))));
+}
+
+}  // namespace
+
+class BVHRefit : public testing::Test {
+ protected:
+  Mesh mesh;
+  Object object;
+  vector<Geometry *> geometry;
+  vector<Object *> objects;
+  BVHParams params;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    fill_grid_mesh(mesh);
+    object.set_geometry(&mesh);
+    object.set_visibility(~0);
+    geometry.push_back(&mesh);
+    objects.push_back(&object);
+
+    params.bvh_layout = BVH_LAYOUT_BVH2;
+    params.max_refit_cost_ratio = 1.5f;
+  }
+
+  unique_ptr<BVH2> build_bvh2()
+  {
+    unique_ptr<BVH2> bvh(static_cast<BVH2 *>(BVH::create(params, geometry, objects, NULL)));
+    bvh->build(progress, NULL);
+    return bvh;
+  }
+};
+
+TEST_F(BVHRefit, bvh2_refit)
+{
+  unique_ptr<BVH2> bvh = build_bvh2();
+  EXPECT_FALSE(bvh->need_rebuild_after_refit());
+
+  /* Refitting without changes does not degrade the tree. */
+  bvh->refit(progress);
+  EXPECT_FALSE(bvh->need_rebuild_after_refit());
+
+  deform_slightly(mesh);
+  bvh->refit(progress);
+  EXPECT_FALSE(bvh->need_rebuild_after_refit());
+
+  const BoundBox expected_bounds = vertex_bounds(mesh);
+  const BoundBox bounds = bvh2_root_bounds(*bvh);
+  EXPECT_EQ(bounds.min, expected_bounds.min);
+  EXPECT_EQ(bounds.max, expected_bounds.max);
+}
+
+TEST_F(BVHRefit, bvh2_rebuild_after_scrambled_refit)
+{
+  unique_ptr<BVH2> bvh = build_bvh2();
+  const BoundBox build_bounds = bvh2_root_bounds(*bvh);
+
+  scramble(mesh);
+  bvh->refit(progress);
+
+  /* The bounds of the geometry did not change, but the tree degraded. */
+  const BoundBox bounds = bvh2_root_bounds(*bvh);
+  EXPECT_EQ(bounds.min, build_bounds.min);
+  EXPECT_EQ(bounds.max, build_bounds.max);
+  EXPECT_TRUE(bvh->need_rebuild_after_refit());
+}
+
+TEST_F(BVHRefit, bvh2_always_refit_without_cost_ratio)
+{
+  params.max_refit_cost_ratio = 0.0f;
+  unique_ptr<BVH2> bvh = build_bvh2();
+
+  scramble(mesh);
+  bvh->refit(progress);
+  EXPECT_FALSE(bvh->need_rebuild_after_refit());
+}
+
+/* The estimate used for BVHs of which the nodes are not accessible, like Embree. */
+TEST_F(BVHRefit, estimate_sah_cost)
+{
+  const float build_cost = bvh_estimate_sah_cost(params, objects);
+  EXPECT_GT(build_cost, 0.0f);
+
+  deform_slightly(mesh);
+  const float deformed_cost = bvh_estimate_sah_cost(params, objects);
+  EXPECT_LT(deformed_cost, build_cost * params.max_refit_cost_ratio);
+
+  scramble(mesh);
+  const float scrambled_cost = bvh_estimate_sah_cost(params, objects);
+  EXPECT_GT(scrambled_cost, build_cost * params.max_refit_cost_ratio);
+}
+
+CCL_NAMESPACE_END
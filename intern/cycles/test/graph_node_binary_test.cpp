@@ -0,0 +1,323 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <filesystem>
+#include <sstream>
+
+#include "testing/testing.h"
+
+#include "graph/node.h"
+#include "graph/node_binary.h"
+#include "graph/node_xml.h"
+
+#include "util/mapped_file.h"
+#include "util/path.h"
+#include "util/transform.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+struct BinaryTestNode : public Node {
+  NODE_DECLARE
+
+  BinaryTestNode() : Node(get_node_type()) {}
+
+  bool boolean_value;
+  int int_value;
+  uint uint_value;
+  uint64_t uint64_value;
+  float float_value;
+  float3 vector_value;
+  float2 point2_value;
+  ustring string_value;
+  int enum_value;
+  Transform transform_value;
+  Node *node_value;
+
+  array<bool> boolean_array;
+  array<int> int_array;
+  array<float> float_array;
+  array<float3> vector_array;
+  array<float2> point2_array;
+  array<ustring> string_array;
+  array<Transform> transform_array;
+  array<Node *> node_array;
+};
+
+NODE_DEFINE(BinaryTestNode)
+{
+  NodeType *type = NodeType::add("binary_test_node", create);
+
+  static NodeEnum test_enum;
+  test_enum.insert("first", 0);
+  test_enum.insert("second", 1);
+
+  SOCKET_BOOLEAN(boolean_value, "Boolean", false);
+  SOCKET_INT(int_value, "Int", 0);
+  SOCKET_UINT(uint_value, "UInt", 0);
+  SOCKET_UINT64(uint64_value, "UInt64", 0);
+  SOCKET_FLOAT(float_value, "Float", 0.0f);
+  SOCKET_VECTOR(vector_value, "Vector", zero_float3());
+  SOCKET_POINT2(point2_value, "Point2", zero_float2());
+  SOCKET_STRING(string_value, "String", ustring());
+  SOCKET_ENUM(enum_value, "Enum", test_enum, 0);
+  SOCKET_TRANSFORM(transform_value, "Transform", transform_identity());
+  SOCKET_NODE(node_value, "Node", type);
+
+  SOCKET_BOOLEAN_ARRAY(boolean_array, "Boolean Array", array<bool>());
+  SOCKET_INT_ARRAY(int_array, "Int Array", array<int>());
+  SOCKET_FLOAT_ARRAY(float_array, "Float Array", array<float>());
+  SOCKET_VECTOR_ARRAY(vector_array, "Vector Array", array<float3>());
+  SOCKET_POINT2_ARRAY(point2_array, "Point2 Array", array<float2>());
+  SOCKET_STRING_ARRAY(string_array, "String Array", array<ustring>());
+  SOCKET_TRANSFORM_ARRAY(transform_array, "Transform Array", array<Transform>());
+  SOCKET_NODE_ARRAY(node_array, "Node Array", type);
+
+  return type;
+}
+
+const char TEST_MAGIC[8] = {'C', 'Y', 'C', 'T', 'E', 'S', 'T', '\0'};
+
+class BinaryTestFile {
+ public:
+  explicit BinaryTestFile(const char *name)
+  {
+    path = path_join(std::filesystem::temp_directory_path().string(), name);
+  }
+
+  ~BinaryTestFile()
+  {
+    path_remove(path);
+  }
+
+  bool write(const vector<Node *> &nodes)
+  {
+    FILE *file = path_fopen(path, "wb");
+    BinaryWriter writer(file);
+    writer.write_header(TEST_MAGIC);
+    for (size_t i = 0; i < nodes.size(); i++) {
+      writer.node_index[nodes[i]] = i;
+    }
+    for (Node *node : nodes) {
+      binary_write_node(writer, node);
+    }
+    const bool ok = writer.ok();
+    return (file && fclose(file) == 0) && ok;
+  }
+
+  string path;
+};
+
+/* Mesh like node with vertices and triangles. */
+void fill_large_node(BinaryTestNode *node, const int num_verts)
+{
+  array<float3> verts;
+  array<int> triangles;
+  array<float> values;
+  for (int i = 0; i < num_verts; i++) {
+    verts.push_back_slow(make_float3(i * 0.25f, i * 0.5f, i * 0.75f));
+    values.push_back_slow(i * 0.125f);
+    triangles.push_back_slow(i);
+    triangles.push_back_slow((i + 1) % num_verts);
+    triangles.push_back_slow((i + 2) % num_verts);
+  }
+  node->set(*node->type->find_input(ustring("vector_array")), verts);
+  node->set(*node->type->find_input(ustring("int_array")), triangles);
+  node->set(*node->type->find_input(ustring("float_array")), values);
+}
+
+}  // namespace
+
+TEST(graph_node_binary, round_trip)
+{
+  BinaryTestNode a, b;
+  a.name = ustring("a");
+  b.name = ustring("b");
+
+  a.boolean_value = true;
+  a.int_value = -7;
+  a.uint_value = 7;
+  a.uint64_value = 0x123456789abcdefULL;
+  a.float_value = 0.1f;
+  a.vector_value = make_float3(1.0f, 2.0f, 3.0f);
+  a.point2_value = make_float2(4.0f, 5.0f);
+  a.string_value = ustring("string");
+  a.enum_value = 1;
+  a.transform_value = transform_translate(1.0f, 2.0f, 3.0f);
+  a.node_value = &b;
+  a.boolean_array.push_back_slow(true);
+  a.boolean_array.push_back_slow(false);
+  a.int_array.push_back_slow(1);
+  a.float_array.push_back_slow(0.5f);
+  a.vector_array.push_back_slow(make_float3(6.0f, 7.0f, 8.0f));
+  a.point2_array.push_back_slow(make_float2(9.0f, 10.0f));
+  a.string_array.push_back_slow(ustring("first"));
+  a.string_array.push_back_slow(ustring());
+  a.transform_array.push_back_slow(transform_scale(2.0f, 2.0f, 2.0f));
+  a.node_array.push_back_slow(&b);
+  a.node_array.push_back_slow(&a);
+
+  BinaryTestFile file("cycles_graph_node_binary_round_trip.bin");
+  ASSERT_TRUE(file.write({&a, &b}));
+
+  MappedFile mapped_file;
+  ASSERT_TRUE(mapped_file.open(file.path));
+
+  BinaryTestNode read_a, read_b;
+  BinaryReader reader(mapped_file.data(), mapped_file.size());
+  ASSERT_TRUE(reader.read_header(TEST_MAGIC));
+  reader.nodes = {&read_a, &read_b};
+  ASSERT_TRUE(binary_read_node(reader, &read_a));
+  ASSERT_TRUE(binary_read_node(reader, &read_b));
+
+  EXPECT_EQ(read_a.name, ustring("a"));
+  EXPECT_EQ(read_b.name, ustring("b"));
+  EXPECT_EQ(read_a.boolean_value, true);
+  EXPECT_EQ(read_a.int_value, -7);
+  EXPECT_EQ(read_a.uint_value, 7);
+  EXPECT_EQ(read_a.uint64_value, 0x123456789abcdefULL);
+  EXPECT_EQ(read_a.float_value, 0.1f);
+  EXPECT_EQ(read_a.vector_value, make_float3(1.0f, 2.0f, 3.0f));
+  EXPECT_EQ(read_a.point2_value, make_float2(4.0f, 5.0f));
+  EXPECT_EQ(read_a.string_value, ustring("string"));
+  EXPECT_EQ(read_a.enum_value, 1);
+  EXPECT_EQ(read_a.transform_value, a.transform_value);
+  EXPECT_EQ(read_a.node_value, &read_b);
+  EXPECT_EQ(read_a.boolean_array, a.boolean_array);
+  EXPECT_EQ(read_a.int_array, a.int_array);
+  EXPECT_EQ(read_a.float_array, a.float_array);
+  EXPECT_EQ(read_a.vector_array, a.vector_array);
+  EXPECT_EQ(read_a.point2_array, a.point2_array);
+  EXPECT_EQ(read_a.string_array, a.string_array);
+  EXPECT_EQ(read_a.transform_array, a.transform_array);
+  ASSERT_EQ(read_a.node_array.size(), 2);
+  EXPECT_EQ(read_a.node_array[0], &read_b);
+  EXPECT_EQ(read_a.node_array[1], &read_a);
+}
+
+TEST(graph_node_binary, invalid_file)
+{
+  BinaryTestNode a;
+  a.int_array.push_back_slow(1);
+
+  BinaryTestFile file("cycles_graph_node_binary_invalid_file.bin");
+  ASSERT_TRUE(file.write({&a}));
+
+  MappedFile mapped_file;
+  ASSERT_TRUE(mapped_file.open(file.path));
+
+  /* Wrong magic. */
+  const char other_magic[8] = {'O', 'T', 'H', 'E', 'R', '\0', '\0', '\0'};
+  BinaryReader other_reader(mapped_file.data(), mapped_file.size());
+  EXPECT_FALSE(other_reader.read_header(other_magic));
+
+  /* Truncated file. */
+  BinaryTestNode read_a;
+  BinaryReader truncated_reader(mapped_file.data(), mapped_file.size() - 1);
+  ASSERT_TRUE(truncated_reader.read_header(TEST_MAGIC));
+  EXPECT_FALSE(binary_read_node(truncated_reader, &read_a));
+}
+
+/* Loading from XML and from a binary file gives the same node. */
+TEST(graph_node_binary, same_as_xml)
+{
+  const int num_verts = 16;
+
+  BinaryTestNode node;
+  fill_large_node(&node, num_verts);
+
+  std::stringstream xml_stream;
+  {
+    xml_document doc;
+    xml_write_node(&node, doc);
+    doc.save(xml_stream);
+  }
+
+  BinaryTestNode xml_node;
+  {
+    xml_document doc;
+    ASSERT_TRUE(doc.load_string(xml_stream.str().c_str()));
+    XMLReader reader;
+    xml_read_node(reader, &xml_node, doc.first_child());
+  }
+
+  BinaryTestFile file("cycles_graph_node_binary_same_as_xml.bin");
+  ASSERT_TRUE(file.write({&node}));
+
+  BinaryTestNode binary_node;
+  {
+    MappedFile mapped_file;
+    ASSERT_TRUE(mapped_file.open(file.path));
+    BinaryReader reader(mapped_file.data(), mapped_file.size());
+    ASSERT_TRUE(reader.read_header(TEST_MAGIC));
+    ASSERT_TRUE(binary_read_node(reader, &binary_node));
+  }
+
+  EXPECT_EQ(xml_node.vector_array, node.vector_array);
+  EXPECT_EQ(xml_node.int_array, node.int_array);
+  EXPECT_EQ(xml_node.float_array, node.float_array);
+  EXPECT_EQ(binary_node.vector_array, xml_node.vector_array);
+  EXPECT_EQ(binary_node.int_array, xml_node.int_array);
+  EXPECT_EQ(binary_node.float_array, xml_node.float_array);
+}
+
+CCL_NAMESPACE_END
+
+/* Disable benchmark by default. */
+#if 0
+
+#  include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(graph_node_binary, benchmark_load_compared_to_xml)
+{
+  const int num_verts = 500000;
+
+  BinaryTestNode node;
+  fill_large_node(&node, num_verts);
+
+  std::stringstream xml_stream;
+  {
+    xml_document doc;
+    xml_write_node(&node, doc);
+    doc.save(xml_stream);
+  }
+  const string xml_string = xml_stream.str();
+
+  const double xml_start_time = time_dt();
+  BinaryTestNode xml_node;
+  {
+    xml_document doc;
+    doc.load_string(xml_string.c_str());
+    XMLReader reader;
+    xml_read_node(reader, &xml_node, doc.first_child());
+  }
+  const double xml_time = time_dt() - xml_start_time;
+
+  BinaryTestFile file("cycles_graph_node_binary_benchmark.bin");
+  file.write({&node});
+
+  const double binary_start_time = time_dt();
+  BinaryTestNode binary_node;
+  {
+    MappedFile mapped_file;
+    mapped_file.open(file.path);
+    BinaryReader reader(mapped_file.data(), mapped_file.size());
+    reader.read_header(TEST_MAGIC);
+    binary_read_node(reader, &binary_node);
+  }
+  const double binary_time = time_dt() - binary_start_time;
+
+  printf("Loading %d vertices and %d triangles: XML %.4fs, binary %.4fs\n",
+         num_verts,
+         num_verts,
+         xml_time,
+         binary_time);
+}
+
+CCL_NAMESPACE_END
+
+#endif
@@ -8,9 +8,12 @@
 #include "device/device.h"
 
 #include "scene/colorspace.h"
+#include "scene/image.h"
 #include "scene/scene.h"
+#include "scene/shader.h"
 #include "scene/shader_graph.h"
 #include "scene/shader_nodes.h"
+#include "scene/svm.h"
 
 #include "util/array.h"
 #include "util/log.h"
@@ -1537,4 +1540,35 @@ TEST_F(RenderGraph, constant_fold_convert_color_float_color)
   graph.finalize(scene);
 }
 
+/*
+ * Tests:
+ *  - SVM compilation of a world with an environment texture, with the texture cache enabled.
+ */
+TEST_F(RenderGraph, compile_world_environment_texture)
+{
+  EXPECT_ANY_MESSAGE(log);
+
+  scene->image_manager->enable_texture_cache(device_cpu, 64 * 1024 * 1024);
+
+  ShaderGraph *world_graph = new ShaderGraph();
+  ShaderGraphBuilder world_builder(world_graph);
+  world_builder.add_node(ShaderNodeBuilder<TextureCoordinateNode>(*world_graph, "TexCoord"))
+      .add_node(ShaderNodeBuilder<EnvironmentTextureNode>(*world_graph, "Environment"))
+      .add_node(ShaderNodeBuilder<BackgroundNode>(*world_graph, "Background"))
+      .add_connection("TexCoord::Generated", "Environment::Vector")
+      .add_connection("Environment::Color", "Background::Color")
+      .output_closure("Background::Background");
+
+  Shader *world = scene->create_node<Shader>();
+  world->set_graph(world_graph);
+  world->reference();
+
+  SVMCompiler compiler(scene);
+  array<int4> svm_nodes;
+  compiler.compile(world, svm_nodes, 0);
+
+  EXPECT_TRUE(world->has_surface);
+  EXPECT_GT(svm_nodes.size(), 1);
+}
+
 CCL_NAMESPACE_END
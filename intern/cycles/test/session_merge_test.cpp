@@ -0,0 +1,186 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <filesystem>
+
+#include "testing/testing.h"
+
+#include "session/merge.h"
+
+#include "util/array.h"
+#include "util/path.h"
+#include "util/unique_ptr.h"
+
+#include <OpenImageIO/imageio.h>
+
+OIIO_NAMESPACE_USING
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Size of the full image, of which the test images are regions. */
+const int FULL_WIDTH = 6;
+const int FULL_HEIGHT = 4;
+const int NUM_CHANNELS = 4;
+
+class MergeTestFile {
+ public:
+  explicit MergeTestFile(const char *name)
+  {
+    path = path_join(std::filesystem::temp_directory_path().string(), name);
+  }
+
+  ~MergeTestFile()
+  {
+    path_remove(path);
+  }
+
+  /* Write a render of a region of the full image, with the given number of samples and the same
+   * value in every channel. */
+  bool write(const int x,
+             const int y,
+             const int width,
+             const int height,
+             const int samples,
+             const float value)
+  {
+    ImageSpec spec(width, height, NUM_CHANNELS, TypeDesc::FLOAT);
+    spec.x = x;
+    spec.y = y;
+    spec.full_x = 0;
+    spec.full_y = 0;
+    spec.full_width = FULL_WIDTH;
+    spec.full_height = FULL_HEIGHT;
+    spec.channelnames = {"RenderLayer.Combined.R",
+                         "RenderLayer.Combined.G",
+                         "RenderLayer.Combined.B",
+                         "RenderLayer.Combined.A"};
+    spec.attribute("cycles.RenderLayer.samples", TypeDesc::STRING, to_string(samples));
+    spec.attribute("cycles.RenderLayer.sample_offset", TypeDesc::STRING, "0");
+
+    unique_ptr<ImageOutput> out(ImageOutput::create(path));
+    if (!out || !out->open(path, spec)) {
+      return false;
+    }
+
+    array<float> pixels(size_t(width) * height * NUM_CHANNELS);
+    std::fill(pixels.begin(), pixels.end(), value);
+    const bool ok = out->write_image(TypeDesc::FLOAT, pixels.data());
+    return out->close() && ok;
+  }
+
+  bool read(ImageSpec &spec, array<float> &pixels)
+  {
+    unique_ptr<ImageInput> in(ImageInput::open(path));
+    if (!in) {
+      return false;
+    }
+
+    spec = in->spec();
+    pixels.resize(size_t(spec.width) * spec.height * spec.nchannels);
+    return in->read_image(0, 0, 0, spec.nchannels, TypeDesc::FLOAT, pixels.data());
+  }
+
+  string path;
+};
+
+/* First channel of a pixel, with coordinates in the full image. */
+float pixel_value(const ImageSpec &spec, const array<float> &pixels, const int x, const int y)
+{
+  return pixels[(size_t(y - spec.y) * spec.width + (x - spec.x)) * spec.nchannels];
+}
+
+}  // namespace
+
+TEST(session_merge, sample_range_split)
+{
+  /* The same image rendered with two sample ranges. */
+  MergeTestFile a("cycles_session_merge_samples_a.exr");
+  MergeTestFile b("cycles_session_merge_samples_b.exr");
+  MergeTestFile merged("cycles_session_merge_samples.exr");
+  ASSERT_TRUE(a.write(0, 0, FULL_WIDTH, FULL_HEIGHT, 10, 1.0f));
+  ASSERT_TRUE(b.write(0, 0, FULL_WIDTH, FULL_HEIGHT, 30, 3.0f));
+
+  ImageMerger merger;
+  merger.input = {a.path, b.path};
+  merger.output = merged.path;
+  ASSERT_TRUE(merger.run()) << merger.error;
+
+  ImageSpec spec;
+  array<float> pixels;
+  ASSERT_TRUE(merged.read(spec, pixels));
+  EXPECT_EQ(spec.x, 0);
+  EXPECT_EQ(spec.y, 0);
+  EXPECT_EQ(spec.width, FULL_WIDTH);
+  EXPECT_EQ(spec.height, FULL_HEIGHT);
+  EXPECT_EQ(spec.nchannels, NUM_CHANNELS);
+
+  /* Average weighted by the number of samples. */
+  for (const float value : pixels) {
+    EXPECT_FLOAT_EQ(value, 2.5f);
+  }
+
+  EXPECT_EQ(spec.get_string_attribute("cycles.RenderLayer.samples"), "40");
+  EXPECT_EQ(spec.get_string_attribute("cycles.RenderLayer.sample_offset"), "");
+}
+
+TEST(session_merge, overlapping_regions)
+{
+  /* Two regions overlapping at pixels (2, 1) and (3, 1), and a third region next to them. Pixels
+   * (4, 0) and (5, 0) are not covered by any region. */
+  MergeTestFile a("cycles_session_merge_regions_a.exr");
+  MergeTestFile b("cycles_session_merge_regions_b.exr");
+  MergeTestFile c("cycles_session_merge_regions_c.exr");
+  MergeTestFile merged("cycles_session_merge_regions.exr");
+  ASSERT_TRUE(a.write(0, 0, 4, 2, 10, 1.0f));
+  ASSERT_TRUE(b.write(2, 1, 4, 3, 30, 3.0f));
+  ASSERT_TRUE(c.write(0, 2, 2, 2, 20, 2.0f));
+
+  ImageMerger merger;
+  merger.input = {a.path, b.path, c.path};
+  merger.output = merged.path;
+  ASSERT_TRUE(merger.run()) << merger.error;
+
+  ImageSpec spec;
+  array<float> pixels;
+  ASSERT_TRUE(merged.read(spec, pixels));
+
+  /* Data window is the union of all regions. */
+  EXPECT_EQ(spec.x, 0);
+  EXPECT_EQ(spec.y, 0);
+  EXPECT_EQ(spec.width, FULL_WIDTH);
+  EXPECT_EQ(spec.height, FULL_HEIGHT);
+  EXPECT_EQ(spec.full_width, FULL_WIDTH);
+  EXPECT_EQ(spec.full_height, FULL_HEIGHT);
+
+  for (int y = 0; y < FULL_HEIGHT; y++) {
+    for (int x = 0; x < FULL_WIDTH; x++) {
+      const bool in_a = x < 4 && y < 2;
+      const bool in_b = x >= 2 && y >= 1;
+      const bool in_c = x < 2 && y >= 2;
+
+      float expected = 0.0f;
+      if (in_a && in_b) {
+        expected = (1.0f * 10 + 3.0f * 30) / 40;
+      }
+      else if (in_a) {
+        expected = 1.0f;
+      }
+      else if (in_b) {
+        expected = 3.0f;
+      }
+      else if (in_c) {
+        expected = 2.0f;
+      }
+
+      EXPECT_FLOAT_EQ(pixel_value(spec, pixels, x, y), expected) << "pixel " << x << ", " << y;
+    }
+  }
+
+  /* Samples of the pixels covered by most samples, not the sum of all regions. */
+  EXPECT_EQ(spec.get_string_attribute("cycles.RenderLayer.samples"), "40");
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,186 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "util/texture_cache.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const size_t TILE_BYTES = sizeof(float) * TEXTURE_CACHE_TILE_SIZE * TEXTURE_CACHE_TILE_SIZE;
+
+/* Value of a texel, from its level and position in file order. */
+float texel_value(const int level, const int x, const int y)
+{
+  return level * 1000000.0f + y * 1000.0f + x;
+}
+
+/* Single channel float image, with a partial tile at the right and bottom of every level. */
+class TestImage {
+ public:
+  explicit TestImage(TextureCache &cache)
+      : image(&cache,
+              "test_image",
+              sizeof(float),
+              {make_int2(200, 130), make_int2(100, 65), make_int2(50, 32)},
+              0,
+              [this](int level, int x, int y, int width, int height, void *pixels) {
+                num_loads++;
+                float *texels = static_cast<float *>(pixels);
+                for (int j = 0; j < height; j++) {
+                  for (int i = 0; i < width; i++) {
+                    texels[j * TEXTURE_CACHE_TILE_SIZE + i] = texel_value(level, x + i, y + j);
+                  }
+                }
+                return true;
+              })
+  {
+  }
+
+  /* Texel with y pointing up, like in the kernel. */
+  float fetch(const int level, const int x, const int y)
+  {
+    TextureCacheTexels texels(image, level, tile_requests);
+    return texels.fetch<float>(x, y);
+  }
+
+  TextureCacheImage image;
+  int num_loads = 0;
+  uint64_t tile_requests = 0;
+};
+
+}  // namespace
+
+TEST(util_texture_cache, load_on_demand)
+{
+  TextureCache cache(64 * TILE_BYTES);
+  {
+    TestImage test(cache);
+    EXPECT_EQ(test.image.num_levels(), 3);
+    EXPECT_EQ(test.num_loads, 0);
+
+    /* Bottom left texel is in the last row of the file. */
+    EXPECT_EQ(test.fetch(0, 0, 0), texel_value(0, 0, 129));
+    EXPECT_EQ(test.fetch(0, 199, 129), texel_value(0, 199, 0));
+    EXPECT_EQ(test.fetch(2, 49, 31), texel_value(2, 49, 0));
+    EXPECT_EQ(test.num_loads, 3);
+
+    /* Loaded tiles are reused. */
+    EXPECT_EQ(test.fetch(0, 1, 1), texel_value(0, 1, 128));
+    EXPECT_EQ(test.num_loads, 3);
+
+    const TextureCache::Statistics stats = cache.get_statistics();
+    EXPECT_EQ(stats.tile_loads, 3);
+    EXPECT_EQ(stats.tile_evictions, 0);
+    EXPECT_EQ(stats.memory_used, 3 * TILE_BYTES);
+    EXPECT_EQ(stats.bytes_loaded, 3 * TILE_BYTES);
+    EXPECT_EQ(test.image.bytes_loaded(), 3 * TILE_BYTES);
+  }
+
+  /* Freeing the image frees its tiles. */
+  EXPECT_EQ(cache.get_statistics().memory_used, 0);
+}
+
+TEST(util_texture_cache, level_for_filter_width)
+{
+  TextureCache cache(64 * TILE_BYTES);
+  TestImage test(cache);
+
+  EXPECT_EQ(test.image.level_for_filter_width(0.0f), 0);
+  EXPECT_EQ(test.image.level_for_filter_width(1.0f / 200.0f), 0);
+  EXPECT_EQ(test.image.level_for_filter_width(3.0f / 200.0f), 1);
+  EXPECT_EQ(test.image.level_for_filter_width(5.0f / 200.0f), 2);
+  EXPECT_EQ(test.image.level_for_filter_width(1.0f), 2);
+}
+
+TEST(util_texture_cache, tile_requests)
+{
+  TextureCache cache(64 * TILE_BYTES);
+  TestImage test(cache);
+
+  /* Bilinear lookup within a tile. */
+  {
+    TextureCacheTexels texels(test.image, 0, test.tile_requests);
+    texels.fetch<float>(10, 10);
+    texels.fetch<float>(11, 10);
+    texels.fetch<float>(10, 11);
+    texels.fetch<float>(11, 11);
+  }
+  EXPECT_EQ(test.tile_requests, 1);
+
+  /* Bilinear lookup across the border of two tiles. */
+  {
+    TextureCacheTexels texels(test.image, 0, test.tile_requests);
+    texels.fetch<float>(63, 10);
+    texels.fetch<float>(64, 10);
+  }
+  EXPECT_EQ(test.tile_requests, 3);
+  EXPECT_EQ(test.num_loads, 2);
+
+  cache.add_tile_requests(test.tile_requests);
+  const TextureCache::Statistics stats = cache.get_statistics();
+  EXPECT_EQ(stats.tile_requests, 3);
+  EXPECT_EQ(stats.tile_loads, 2);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 1.0 / 3.0);
+}
+
+TEST(util_texture_cache, evict_to_budget)
+{
+  TextureCache cache(2 * TILE_BYTES);
+  TestImage test(cache);
+
+  /* Four tiles of the first level. */
+  const int2 tile_texels[4] = {
+      make_int2(0, 0), make_int2(64, 0), make_int2(128, 0), make_int2(0, 64)};
+  for (const int2 &texel : tile_texels) {
+    test.fetch(0, texel.x, texel.y);
+  }
+  EXPECT_EQ(cache.get_statistics().memory_used, 4 * TILE_BYTES);
+
+  /* Loading does not evict, only garbage collection does. */
+  cache.collect_garbage();
+  TextureCache::Statistics stats = cache.get_statistics();
+  EXPECT_EQ(stats.memory_used, 2 * TILE_BYTES);
+  EXPECT_EQ(stats.peak_memory, 4 * TILE_BYTES);
+  EXPECT_EQ(stats.tile_evictions, 2);
+
+  /* Evicted tiles are loaded again, with the same content. */
+  for (const int2 &texel : tile_texels) {
+    EXPECT_EQ(test.fetch(0, texel.x, texel.y), texel_value(0, texel.x, 129 - texel.y));
+  }
+  EXPECT_EQ(test.num_loads, 6);
+
+  cache.collect_garbage();
+  stats = cache.get_statistics();
+  EXPECT_EQ(stats.memory_used, 2 * TILE_BYTES);
+  EXPECT_EQ(stats.tile_evictions, 4);
+}
+
+TEST(util_texture_cache, keep_recently_used_tiles)
+{
+  TextureCache cache(2 * TILE_BYTES);
+  TestImage test(cache);
+
+  test.fetch(0, 0, 0);
+  test.fetch(0, 64, 0);
+  /* Within the budget, nothing is evicted. */
+  cache.collect_garbage();
+  EXPECT_EQ(cache.get_statistics().tile_evictions, 0);
+
+  /* Tiles used since the last garbage collection get a second chance, so they are kept. */
+  test.fetch(0, 128, 0);
+  cache.collect_garbage();
+  test.fetch(0, 0, 64);
+  test.fetch(0, 128, 0);
+  cache.collect_garbage();
+
+  const int num_loads = test.num_loads;
+  test.fetch(0, 128, 0);
+  EXPECT_EQ(test.num_loads, num_loads);
+  EXPECT_EQ(cache.get_statistics().memory_used, 2 * TILE_BYTES);
+}
+
+CCL_NAMESPACE_END
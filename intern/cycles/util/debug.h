@@ -46,6 +46,10 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout = BVH_LAYOUT_AUTO;
+
+    /* Render batches of paths one kernel at a time with paths sorted by shader, like on the GPU,
+     * instead of following every path from start to end with the megakernel. */
+    bool wavefront = false;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -0,0 +1,119 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "util/mapped_file.h"
+#include "util/windows.h"
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const string &path)
+{
+  close();
+
+  const wstring path_wc = string_to_wstring(path);
+  HANDLE file = CreateFileW(path_wc.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  file_handle_ = file;
+  mapping_handle_ = mapping;
+  data_ = (const uint8_t *)data;
+  size_ = (size_t)file_size.QuadPart;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (data_) {
+    UnmapViewOfFile(data_);
+    CloseHandle((HANDLE)mapping_handle_);
+    CloseHandle((HANDLE)file_handle_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  file_handle_ = nullptr;
+  mapping_handle_ = nullptr;
+}
+
+#else /* _WIN32 */
+
+bool MappedFile::open(const string &path)
+{
+  close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void *data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  /* The mapping keeps a reference to the file. */
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  data_ = (const uint8_t *)data;
+  size_ = (size_t)st.st_size;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (data_) {
+    munmap((void *)data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif /* _WIN32 */
+
+CCL_NAMESPACE_END
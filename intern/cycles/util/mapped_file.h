@@ -0,0 +1,48 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __UTIL_MAPPED_FILE_H__
+#define __UTIL_MAPPED_FILE_H__
+
+#include "util/string.h"
+#include "util/types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Read-only view of the contents of a file, mapped into memory. Pages are only read from disk
+ * when they are accessed, and stay in the operating system file cache after unmapping. */
+
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const string &path);
+  void close();
+
+  const uint8_t *data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+ protected:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void *file_handle_ = nullptr;
+  void *mapping_handle_ = nullptr;
+#endif
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_MAPPED_FILE_H__ */
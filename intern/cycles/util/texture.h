@@ -75,6 +75,8 @@ typedef enum ExtensionType {
 typedef struct TextureInfo {
   /* Pointer, offset or texture depending on device. */
   uint64_t data;
+  /* Pointer to the TextureCacheImage, for images loaded on demand on the CPU. */
+  uint64_t cache;
   /* Data Type */
   uint data_type;
   /* Interpolation and extension type. */
@@ -0,0 +1,230 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "util/texture_cache.h"
+
+#include <cstring>
+
+#include "util/aligned_malloc.h"
+#include "util/log.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Texture Cache Image */
+
+TextureCacheImage::TextureCacheImage(TextureCache *cache,
+                                     const string &name,
+                                     const size_t texel_size,
+                                     const vector<int2> &level_sizes,
+                                     const int min_level,
+                                     const LoadTileFunction &load_tile)
+    : cache(cache),
+      name(name),
+      num_tiles_(0),
+      texel_size_(texel_size),
+      min_level_(min(min_level, (int)level_sizes.size() - 1)),
+      load_tile_(load_tile),
+      bytes_loaded_(0)
+{
+  for (const int2 &size : level_sizes) {
+    Level level;
+    level.width = size.x;
+    level.height = size.y;
+    level.tiles_x = divide_up(size.x, TEXTURE_CACHE_TILE_SIZE);
+    level.first_tile = num_tiles_;
+    num_tiles_ += (size_t)level.tiles_x * divide_up(size.y, TEXTURE_CACHE_TILE_SIZE);
+    levels_.push_back(level);
+  }
+
+  tiles_.reset(new Tile[num_tiles_]);
+  for (size_t i = 0; i < num_tiles_; i++) {
+    tiles_[i].pixels.store(nullptr, std::memory_order_relaxed);
+    tiles_[i].referenced.store(false, std::memory_order_relaxed);
+  }
+}
+
+TextureCacheImage::~TextureCacheImage()
+{
+  cache->image_freed(this);
+}
+
+size_t TextureCacheImage::tile_size() const
+{
+  return texel_size_ * TEXTURE_CACHE_TILE_SIZE * TEXTURE_CACHE_TILE_SIZE;
+}
+
+const void *TextureCacheImage::load_tile(const int level, const int x, const int y)
+{
+  const Level &level_info = levels_[level];
+  const size_t tile_index = level_info.first_tile + (size_t)y * level_info.tiles_x + x;
+  Tile &tile = tiles_[tile_index];
+
+  thread_scoped_lock lock(mutex_);
+
+  /* Another thread may have loaded the tile while waiting for the lock. */
+  void *pixels = tile.pixels.load(std::memory_order_relaxed);
+  if (pixels) {
+    return pixels;
+  }
+
+  const size_t size = tile_size();
+  pixels = util_aligned_malloc(size, MIN_ALIGNMENT_CPU_DATA_TYPES);
+
+  const int tile_x = x * TEXTURE_CACHE_TILE_SIZE;
+  const int tile_y = y * TEXTURE_CACHE_TILE_SIZE;
+  const int width = min(TEXTURE_CACHE_TILE_SIZE, level_info.width - tile_x);
+  const int height = min(TEXTURE_CACHE_TILE_SIZE, level_info.height - tile_y);
+
+  if (!load_tile_(level, tile_x, tile_y, width, height, pixels)) {
+    /* Keep the empty tile, to avoid trying to load it over and over again. */
+    VLOG_WARNING << "Failed to load tile (" << tile_x << ", " << tile_y << ") of level "
+                 << level << " of image " << name << ".";
+    memset(pixels, 0, size);
+  }
+
+  bytes_loaded_ += size;
+
+  tile.pixels.store(pixels, std::memory_order_release);
+  cache->tile_loaded(this, tile_index, size);
+
+  return pixels;
+}
+
+uint64_t TextureCacheImage::bytes_loaded()
+{
+  thread_scoped_lock lock(mutex_);
+  return bytes_loaded_;
+}
+
+bool TextureCacheImage::evict_tile(const size_t tile_index)
+{
+  Tile &tile = tiles_[tile_index];
+  if (tile.referenced.load(std::memory_order_relaxed)) {
+    /* Second chance for tiles used since the last sweep. */
+    tile.referenced.store(false, std::memory_order_relaxed);
+    return false;
+  }
+
+  util_aligned_free(tile.pixels.exchange(nullptr, std::memory_order_relaxed));
+  return true;
+}
+
+/* Texture Cache */
+
+double TextureCache::Statistics::hit_rate() const
+{
+  if (tile_requests == 0) {
+    return 0.0;
+  }
+  return (double)(tile_requests - min(tile_loads, tile_requests)) / (double)tile_requests;
+}
+
+TextureCache::TextureCache(const size_t memory_budget)
+    : memory_budget_(memory_budget),
+      clock_hand_(0),
+      tile_requests_(0),
+      tile_loads_(0),
+      tile_evictions_(0),
+      bytes_loaded_(0),
+      memory_used_(0),
+      peak_memory_(0)
+{
+}
+
+TextureCache::~TextureCache()
+{
+  /* All images must have been freed before the cache. */
+  assert(resident_tiles_.empty());
+}
+
+void TextureCache::tile_loaded(TextureCacheImage *image, const size_t tile_index, size_t size)
+{
+  thread_scoped_lock lock(mutex_);
+
+  /* Insert behind the clock hand, so that the new tile is checked last. */
+  if (clock_hand_ >= resident_tiles_.size()) {
+    clock_hand_ = 0;
+  }
+  resident_tiles_.push_back({image, tile_index});
+  std::swap(resident_tiles_[clock_hand_], resident_tiles_.back());
+  clock_hand_++;
+
+  tile_loads_++;
+  bytes_loaded_ += size;
+  memory_used_ += size;
+  peak_memory_ = max(peak_memory_, memory_used_);
+}
+
+void TextureCache::image_freed(TextureCacheImage *image)
+{
+  thread_scoped_lock lock(mutex_);
+
+  size_t num_kept = 0;
+  for (size_t i = 0; i < resident_tiles_.size(); i++) {
+    const ResidentTile &resident = resident_tiles_[i];
+    if (resident.image == image) {
+      util_aligned_free(image->tiles_[resident.tile_index].pixels.exchange(nullptr));
+      memory_used_ -= image->tile_size();
+    }
+    else {
+      resident_tiles_[num_kept++] = resident;
+    }
+  }
+  resident_tiles_.resize(num_kept);
+  clock_hand_ = 0;
+}
+
+void TextureCache::collect_garbage()
+{
+  thread_scoped_lock lock(mutex_);
+
+  if (memory_used_ <= memory_budget_) {
+    return;
+  }
+
+  /* Clock eviction: every tile in use gets a second chance, so after two full sweeps enough
+   * tiles have been evicted. */
+  const size_t memory_before = memory_used_;
+  size_t num_steps = resident_tiles_.size() * 2;
+  while (memory_used_ > memory_budget_ && num_steps-- > 0 && !resident_tiles_.empty()) {
+    if (clock_hand_ >= resident_tiles_.size()) {
+      clock_hand_ = 0;
+    }
+
+    const ResidentTile resident = resident_tiles_[clock_hand_];
+    if (resident.image->evict_tile(resident.tile_index)) {
+      resident_tiles_[clock_hand_] = resident_tiles_.back();
+      resident_tiles_.pop_back();
+      memory_used_ -= resident.image->tile_size();
+      tile_evictions_++;
+    }
+    else {
+      clock_hand_++;
+    }
+  }
+
+  VLOG_WORK << "Texture cache evicted " << string_human_readable_size(memory_before - memory_used_)
+            << ", " << string_human_readable_size(memory_used_) << " in use.";
+}
+
+void TextureCache::add_tile_requests(const uint64_t num_requests)
+{
+  tile_requests_.fetch_add(num_requests, std::memory_order_relaxed);
+}
+
+TextureCache::Statistics TextureCache::get_statistics()
+{
+  thread_scoped_lock lock(mutex_);
+
+  Statistics stats;
+  stats.tile_requests = tile_requests_.load(std::memory_order_relaxed);
+  stats.tile_loads = tile_loads_;
+  stats.tile_evictions = tile_evictions_;
+  stats.bytes_loaded = bytes_loaded_;
+  stats.memory_used = memory_used_;
+  stats.peak_memory = peak_memory_;
+  return stats;
+}
+
+CCL_NAMESPACE_END
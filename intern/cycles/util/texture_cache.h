@@ -0,0 +1,241 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include <atomic>
+
+#include "util/function.h"
+#include "util/math.h"
+#include "util/string.h"
+#include "util/thread.h"
+#include "util/types.h"
+#include "util/unique_ptr.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Texture Cache
+ *
+ * Images of which the pixels are loaded on demand, in tiles of a fixed size and for every level
+ * of a mip-map pyramid. Only tiles that are actually sampled get loaded, at the resolution that
+ * matches the footprint of the lookup. This makes it possible to render scenes that use more
+ * texture data than fits in memory on the CPU device.
+ *
+ * Looking up a tile that is already loaded is lock-free. Tiles are only evicted again in
+ * TextureCache::collect_garbage(), which must not run concurrently with rendering. The memory
+ * budget may therefore be exceeded while rendering a single pass of samples. */
+
+#define TEXTURE_CACHE_TILE_SIZE_SHIFT 6
+#define TEXTURE_CACHE_TILE_SIZE (1 << TEXTURE_CACHE_TILE_SIZE_SHIFT)
+#define TEXTURE_CACHE_TILE_SIZE_MASK (TEXTURE_CACHE_TILE_SIZE - 1)
+
+class TextureCache;
+
+class TextureCacheImage {
+ public:
+  /* Load a region of a mip-map level into pixels, that has room for a full tile and rows of
+   * TEXTURE_CACHE_TILE_SIZE texels. Rows are ordered from the top of the image to the bottom,
+   * like in image files. */
+  using LoadTileFunction =
+      function<bool(int level, int x, int y, int width, int height, void *pixels)>;
+
+  TextureCacheImage(TextureCache *cache,
+                    const string &name,
+                    size_t texel_size,
+                    const vector<int2> &level_sizes,
+                    int min_level,
+                    const LoadTileFunction &load_tile);
+  ~TextureCacheImage();
+
+  TextureCacheImage(const TextureCacheImage &) = delete;
+  TextureCacheImage &operator=(const TextureCacheImage &) = delete;
+
+  int num_levels() const
+  {
+    return levels_.size();
+  }
+
+  int2 level_size(const int level) const
+  {
+    return make_int2(levels_[level].width, levels_[level].height);
+  }
+
+  /* Mip-map level with texels of the size of the filter width, which is relative to the size of
+   * the full resolution image. */
+  ccl_always_inline int level_for_filter_width(const float filter_width) const
+  {
+    const float texels = filter_width * (float)max(levels_[0].width, levels_[0].height);
+    /* Also handles NaN. */
+    if (!(texels > 1.0f)) {
+      return min_level_;
+    }
+    const int level = (int)log2f(texels);
+    return clamp(level, min_level_, num_levels() - 1);
+  }
+
+  /* Pixels of a tile, loading it first if needed. Tile coordinates are in file order, with the
+   * first row of tiles at the top of the image. */
+  ccl_always_inline const void *tile(const int level, const int x, const int y)
+  {
+    const Level &level_info = levels_[level];
+    Tile &tile = tiles_[level_info.first_tile + (size_t)y * level_info.tiles_x + x];
+
+    /* Avoid writing to the shared cache line when the tile is already marked. */
+    if (!tile.referenced.load(std::memory_order_relaxed)) {
+      tile.referenced.store(true, std::memory_order_relaxed);
+    }
+
+    const void *pixels = tile.pixels.load(std::memory_order_acquire);
+    if (UNLIKELY(pixels == nullptr)) {
+      pixels = load_tile(level, x, y);
+    }
+    return pixels;
+  }
+
+  /* Total size of all tiles loaded so far, including tiles that were evicted again. */
+  uint64_t bytes_loaded();
+
+  TextureCache *cache;
+  string name;
+
+ protected:
+  struct Level {
+    int width;
+    int height;
+    int tiles_x;
+    size_t first_tile;
+  };
+
+  struct Tile {
+    std::atomic<void *> pixels;
+    /* Set when the tile is used, and cleared again by the eviction sweep. */
+    std::atomic<bool> referenced;
+  };
+
+  const void *load_tile(int level, int x, int y);
+  size_t tile_size() const;
+  bool evict_tile(size_t tile_index);
+
+  vector<Level> levels_;
+  unique_ptr<Tile[]> tiles_;
+  size_t num_tiles_;
+  size_t texel_size_;
+  int min_level_;
+
+  LoadTileFunction load_tile_;
+  /* Serializes loading, image loaders are generally not thread-safe. */
+  thread_mutex mutex_;
+
+  /* Statistics, protected by the mutex. */
+  uint64_t bytes_loaded_;
+
+  friend class TextureCache;
+};
+
+class TextureCache {
+ public:
+  struct Statistics {
+    uint64_t tile_requests = 0;
+    uint64_t tile_loads = 0;
+    uint64_t tile_evictions = 0;
+    uint64_t bytes_loaded = 0;
+    size_t memory_used = 0;
+    size_t peak_memory = 0;
+
+    /* Fraction of tile requests that did not have to load the tile. */
+    double hit_rate() const;
+  };
+
+  explicit TextureCache(size_t memory_budget);
+  ~TextureCache();
+
+  size_t memory_budget() const
+  {
+    return memory_budget_;
+  }
+
+  /* Evict tiles that were not used recently, until the memory used is within the budget.
+   * Pointers to evicted tiles become invalid, so this must not be called while rendering. */
+  void collect_garbage();
+
+  /* Requests are counted by render threads locally, and added here after rendering. */
+  void add_tile_requests(uint64_t num_requests);
+
+  Statistics get_statistics();
+
+ protected:
+  struct ResidentTile {
+    TextureCacheImage *image;
+    size_t tile_index;
+  };
+
+  void tile_loaded(TextureCacheImage *image, size_t tile_index, size_t size);
+  void image_freed(TextureCacheImage *image);
+
+  size_t memory_budget_;
+  thread_mutex mutex_;
+
+  /* Loaded tiles in the order of the clock used for eviction. */
+  vector<ResidentTile> resident_tiles_;
+  size_t clock_hand_;
+
+  std::atomic<uint64_t> tile_requests_;
+  uint64_t tile_loads_;
+  uint64_t tile_evictions_;
+  uint64_t bytes_loaded_;
+  size_t memory_used_;
+  size_t peak_memory_;
+
+  friend class TextureCacheImage;
+};
+
+/* Texel access for one mip-map level of a cached image, with y pointing up like the other
+ * textures in the kernel. Meant to be used for a single texture lookup, tile requests are
+ * counted once for every tile the lookup reads from. */
+class TextureCacheTexels {
+ public:
+  TextureCacheTexels(TextureCacheImage &image, const int level, uint64_t &tile_requests)
+      : image_(image), level_(level), tile_requests_(tile_requests)
+  {
+    const int2 size = image.level_size(level);
+    width = size.x;
+    height = size.y;
+  }
+
+  template<typename T> ccl_always_inline const T &fetch(const int x, int y) const
+  {
+    y = height - 1 - y;
+    const int tile_x = x >> TEXTURE_CACHE_TILE_SIZE_SHIFT;
+    const int tile_y = y >> TEXTURE_CACHE_TILE_SIZE_SHIFT;
+    /* Interpolation reads neighboring texels, which are mostly in the same tile. Only look up
+     * and count a tile when the texel is in a different tile than the previous one. */
+    if (tile_x != last_tile_x_ || tile_y != last_tile_y_) {
+      last_tile_ = image_.tile(level_, tile_x, tile_y);
+      last_tile_x_ = tile_x;
+      last_tile_y_ = tile_y;
+      tile_requests_++;
+    }
+    const T *pixels = static_cast<const T *>(last_tile_);
+    return pixels[((y & TEXTURE_CACHE_TILE_SIZE_MASK) << TEXTURE_CACHE_TILE_SIZE_SHIFT) +
+                  (x & TEXTURE_CACHE_TILE_SIZE_MASK)];
+  }
+
+  int width;
+  int height;
+
+ private:
+  TextureCacheImage &image_;
+  int level_;
+  uint64_t &tile_requests_;
+
+  mutable const void *last_tile_ = nullptr;
+  mutable int last_tile_x_ = -1;
+  mutable int last_tile_y_ = -1;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
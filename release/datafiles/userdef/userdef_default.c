@@ -50,6 +50,8 @@ const UserDef U_default = {
     .timecode_style = USER_TIMECODE_MINIMAL,
     .versions = 1,
     .dbl_click_time = 350,
+    .file_compression_level = 3,
+    .file_compression_flag = 0,
     .mini_axis_type = USER_MINI_AXIS_TYPE_GIZMO,
     .uiflag = (USER_FILTERFILEEXTS | USER_DRAWVIEWINFO | USER_PLAINMENUS |
                USER_LOCK_CURSOR_ADJUST | USER_DEPTH_CURSOR | USER_AUTOPERSP |
@@ -139,6 +141,7 @@ const UserDef U_default = {
 
     .prefetchframes = 0,
     .pad_rot_angle = 15,
+    .compositor_cache_limit = 1024,
     .rvisize = 25,
     .rvibright = 8,
     .recent_files = 20,
@@ -236,6 +239,8 @@ const UserDef U_default = {
     .sequencer_disk_cache_size_limit = 100,
     .sequencer_disk_cache_flag = 0,
     .sequencer_proxy_setup = USER_SEQ_PROXY_SETUP_AUTOMATIC,
+    .sequencer_prefetch_threads = 1,
+    .sequencer_prefetch_memory_limit = 0,
 
     .collection_instance_empty_size = 1.0f,
 
@@ -1124,6 +1124,14 @@ class CompositorPerformanceButtonsPanel:
         row.prop(rd, "compositor_device", text="Device", expand=True)
         col.prop(rd, "compositor_precision", text="Precision")
 
+        if rd.compositor_device == 'CPU':
+            col = layout.column(heading="Tiles")
+            row = col.row(align=True)
+            row.prop(rd, "use_compositor_tiles", text="")
+            sub = row.row(align=True)
+            sub.active = rd.use_compositor_tiles
+            sub.prop(rd, "compositor_tile_size", text="Size")
+
 
 class RENDER_PT_eevee_performance_compositor(RenderButtonsPanel, CompositorPerformanceButtonsPanel, Panel):
     bl_options = {'DEFAULT_CLOSED'}
@@ -846,6 +846,14 @@ class NODE_PT_quality(bpy.types.Panel):
         col.prop(rd, "compositor_device", text="Device")
         col.prop(rd, "compositor_precision", text="Precision")
 
+        if rd.compositor_device == 'CPU':
+            col = layout.column(heading="Tiles")
+            row = col.row(align=True)
+            row.prop(rd, "use_compositor_tiles", text="")
+            sub = row.row(align=True)
+            sub.active = rd.use_compositor_tiles
+            sub.prop(rd, "compositor_tile_size", text="Size")
+
         col = layout.column()
         col.prop(tree, "use_viewer_border")
 
@@ -777,6 +777,11 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col.prop(system, "vbo_time_out", text="VBO Time Out")
         col.prop(system, "vbo_collection_rate", text="Garbage Collection Rate")
 
+        layout.separator()
+
+        col = layout.column()
+        col.prop(system, "compositor_cache_limit", text="Compositor Cache Limit")
+
         if sys.platform != "darwin":
             layout.separator()
             col = layout.column()
@@ -795,6 +800,12 @@ class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
 
         layout.separator()
 
+        col = layout.column()
+        col.prop(system, "sequencer_prefetch_threads", text="Prefetch Threads")
+        col.prop(system, "sequencer_prefetch_memory_limit", text="Prefetch Memory Limit")
+
+        layout.separator()
+
         layout.prop(system, "use_sequencer_disk_cache", text="Disk Cache")
         col = layout.column()
         col.active = system.use_sequencer_disk_cache
@@ -1808,6 +1819,10 @@ class USERPREF_PT_saveload_blend(SaveLoadPanel, CenterAlignMixIn, Panel):
         col.prop(paths, "use_file_compression")
         col.prop(paths, "use_load_ui")
 
+        col = layout.column(heading="Compression")
+        col.prop(paths, "file_compression_level", text="Level")
+        col.prop(paths, "use_file_compression_long_distance")
+
         col = layout.column(heading="Text Files")
         col.prop(paths, "use_tabs_as_spaces")
 
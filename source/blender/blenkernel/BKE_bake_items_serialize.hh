@@ -4,21 +4,41 @@
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "BLI_fileops.hh"
 #include "BLI_function_ref.hh"
+#include "BLI_implicit_sharing_ptr.hh"
 #include "BLI_serialize.hh"
 
 #include "BKE_bake_items.hh"
 
 namespace blender::bke::bake {
 
+/** Codec that is used to compress the data of a #BlobSlice. */
+enum class BlobCompression {
+  None,
+  /** Zstandard with a low compression level, which is fast to compress and decompress. */
+  Zstd,
+};
+
 /**
  * Reference to a slice of memory typically stored on disk.
  * A blob is a "binary large object".
  */
 struct BlobSlice {
   std::string name;
+  /** Range of the stored, potentially compressed, bytes. */
   IndexRange range;
+  BlobCompression compression = BlobCompression::None;
+  /** Size of the data after decompression. Only used when the slice is compressed. */
+  int64_t uncompressed_size = 0;
+
+  /** \return The number of bytes that the data has once it is read. */
+  int64_t data_size() const
+  {
+    return compression == BlobCompression::None ? range.size() : uncompressed_size;
+  }
 
   std::shared_ptr<io::serialize::DictionaryValue> serialize() const;
   static std::optional<BlobSlice> deserialize(const io::serialize::DictionaryValue &io_slice);
@@ -41,6 +61,16 @@ class BlobReader {
    */
   [[nodiscard]] virtual bool read_as_stream(const BlobSlice &slice,
                                             FunctionRef<bool(std::istream &)> fn) const;
+
+  /**
+   * Provides access to the data of the given slice without copying it, if the reader supports
+   * that. The returned sharing info keeps the data alive. The data may be modified by the owner
+   * of the sharing info once it is mutable, without changing the stored blob.
+   * \param alignment: Required alignment of the returned data.
+   * \return The data, or none if it has to be read with #read instead.
+   */
+  [[nodiscard]] virtual std::optional<ImplicitSharingInfoAndData> read_zero_copy(
+      const BlobSlice &slice, int64_t alignment) const;
 };
 
 /**
@@ -144,18 +174,31 @@ class BlobReadSharing : NonCopyable, NonMovable {
       FunctionRef<std::optional<ImplicitSharingInfoAndData>()> read_fn) const;
 };
 
+class MappedBlobFile;
+
 /**
- * A specific #BlobReader that reads from disk.
+ * A specific #BlobReader that reads from disk. Blob files are memory mapped, so that slices can
+ * be read from multiple threads at the same time and uncompressed data can be used without
+ * copying it, see #read_zero_copy.
  */
 class DiskBlobReader : public BlobReader {
  private:
   const std::string blobs_dir_;
-  mutable std::mutex mutex_;
-  mutable Map<std::string, std::unique_ptr<fstream>> open_input_streams_;
+  /** Only protects the map, reading from an already mapped file does not require a lock. */
+  mutable std::shared_mutex mutex_;
+  /** Contains null for files that could not be mapped. */
+  mutable Map<std::string, ImplicitSharingPtr<MappedBlobFile>> mapped_files_;
 
  public:
   DiskBlobReader(std::string blobs_dir);
+  ~DiskBlobReader();
+
   [[nodiscard]] bool read(const BlobSlice &slice, void *r_data) const override;
+  [[nodiscard]] std::optional<ImplicitSharingInfoAndData> read_zero_copy(
+      const BlobSlice &slice, int64_t alignment) const override;
+
+ private:
+  const MappedBlobFile *get_mapped_file(const BlobSlice &slice) const;
 };
 
 /**
@@ -168,6 +211,8 @@ class DiskBlobWriter : public BlobWriter {
   /** Name of the file that data is written to. */
   std::string base_name_;
   std::string blob_name_;
+  /** Codec that large slices are compressed with. */
+  BlobCompression compression_;
   /** File handle. The file is opened when the first data is written. */
   std::fstream blob_stream_;
   /** Current position in the file. */
@@ -176,7 +221,9 @@ class DiskBlobWriter : public BlobWriter {
   int independent_file_count_ = 0;
 
  public:
-  DiskBlobWriter(std::string blob_dir, std::string base_name);
+  DiskBlobWriter(std::string blob_dir,
+                 std::string base_name,
+                 BlobCompression compression = BlobCompression::None);
 
   BlobSlice write(const void *data, int64_t size) override;
 
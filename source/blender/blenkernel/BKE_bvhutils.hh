@@ -115,32 +115,46 @@ BVHTree *bvhtree_from_mesh_corner_tris_ex(BVHTreeFromMesh *data,
  *
  * \note This function only fills a cache, and therefore the mesh argument can
  * be considered logically const. Concurrent access is protected by a mutex.
+ *
+ * \param balance_flag: Passed to #BLI_bvhtree_balance_ex, trees with different flags are cached
+ * separately.
  */
 BVHTree *BKE_bvhtree_from_mesh_get(BVHTreeFromMesh *data,
                                    const Mesh *mesh,
                                    BVHCacheType bvh_cache_type,
-                                   int tree_type);
+                                   int tree_type,
+                                   int balance_flag = BVH_BALANCE_DEFAULT);
 
 /**
  * Build a bvh tree from the triangles in the mesh that correspond to the faces in the given mask.
+ *
+ * \param balance_flag: Passed to #BLI_bvhtree_balance_ex, also when the cached tree of the whole
+ * mesh is returned.
  */
 void BKE_bvhtree_from_mesh_tris_init(const Mesh &mesh,
                                      const blender::IndexMask &faces_mask,
-                                     BVHTreeFromMesh &r_data);
+                                     BVHTreeFromMesh &r_data,
+                                     int balance_flag = BVH_BALANCE_DEFAULT);
 
 /**
  * Build a bvh tree containing the given edges.
+ *
+ * \param balance_flag: See #BKE_bvhtree_from_mesh_tris_init.
  */
 void BKE_bvhtree_from_mesh_edges_init(const Mesh &mesh,
                                       const blender::IndexMask &edges_mask,
-                                      BVHTreeFromMesh &r_data);
+                                      BVHTreeFromMesh &r_data,
+                                      int balance_flag = BVH_BALANCE_DEFAULT);
 
 /**
  * Build a bvh tree containing the given vertices.
+ *
+ * \param balance_flag: See #BKE_bvhtree_from_mesh_tris_init.
  */
 void BKE_bvhtree_from_mesh_verts_init(const Mesh &mesh,
                                       const blender::IndexMask &verts_mask,
-                                      BVHTreeFromMesh &r_data);
+                                      BVHTreeFromMesh &r_data,
+                                      int balance_flag = BVH_BALANCE_DEFAULT);
 
 /**
  * Frees data allocated by a call to `bvhtree_from_mesh_*`.
@@ -167,9 +181,13 @@ struct BVHTreeFromPointCloud {
   const float (*coords)[3];
 };
 
+/**
+ * \param balance_flag: Passed to #BLI_bvhtree_balance_ex.
+ */
 void BKE_bvhtree_from_pointcloud_get(const PointCloud &pointcloud,
                                      const blender::IndexMask &points_mask,
-                                     BVHTreeFromPointCloud &r_data);
+                                     BVHTreeFromPointCloud &r_data,
+                                     int balance_flag = BVH_BALANCE_DEFAULT);
 
 void free_bvhtree_from_pointcloud(BVHTreeFromPointCloud *data);
 
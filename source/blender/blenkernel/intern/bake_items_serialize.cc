@@ -14,7 +14,9 @@
 
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
+#include "BLI_math_base.h"
 #include "BLI_math_matrix_types.hh"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
 
 #include "DNA_material_types.h"
@@ -23,9 +25,17 @@
 #include "RNA_access.hh"
 #include "RNA_enum_types.hh"
 
+#include <fcntl.h>
 #include <fmt/format.h>
 #include <sstream>
 #include <xxhash.h>
+#include <zstd.h>
+
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
 
 #ifdef WITH_OPENVDB
 #  include <openvdb/io/Stream.h>
@@ -39,12 +49,46 @@ namespace blender::bke::bake {
 using namespace io::serialize;
 using DictionaryValuePtr = std::shared_ptr<DictionaryValue>;
 
+/** Slices are aligned in blob files, so that their data can be used without copying it. */
+static constexpr int64_t blob_slice_alignment = 16;
+/** Smaller slices are not compressed, because the gain is not worth the overhead. */
+static constexpr int64_t blob_compression_min_size = 4096;
+/** Low levels are much faster and still give most of the size reduction for attribute data. */
+static constexpr int blob_zstd_compression_level = 1;
+
+static StringRefNull get_compression_io_name(const BlobCompression compression)
+{
+  switch (compression) {
+    case BlobCompression::None:
+      return "none";
+    case BlobCompression::Zstd:
+      return "zstd";
+  }
+  BLI_assert_unreachable();
+  return "none";
+}
+
+static std::optional<BlobCompression> get_compression_from_io_name(const StringRefNull io_name)
+{
+  if (io_name == "none") {
+    return BlobCompression::None;
+  }
+  if (io_name == "zstd") {
+    return BlobCompression::Zstd;
+  }
+  return std::nullopt;
+}
+
 std::shared_ptr<DictionaryValue> BlobSlice::serialize() const
 {
   auto io_slice = std::make_shared<DictionaryValue>();
   io_slice->append_str("name", this->name);
   io_slice->append_int("start", range.start());
   io_slice->append_int("size", range.size());
+  if (this->compression != BlobCompression::None) {
+    io_slice->append_str("compression", get_compression_io_name(this->compression));
+    io_slice->append_int("uncompressed_size", this->uncompressed_size);
+  }
   return io_slice;
 }
 
@@ -56,8 +100,24 @@ std::optional<BlobSlice> BlobSlice::deserialize(const DictionaryValue &io_slice)
   if (!name || !start || !size) {
     return std::nullopt;
   }
+  BlobSlice slice{*name, {*start, *size}};
 
-  return BlobSlice{*name, {*start, *size}};
+  if (const std::optional<StringRefNull> io_compression = io_slice.lookup_str("compression")) {
+    const std::optional<BlobCompression> compression = get_compression_from_io_name(
+        *io_compression);
+    if (!compression) {
+      return std::nullopt;
+    }
+    slice.compression = *compression;
+  }
+  if (slice.compression != BlobCompression::None) {
+    const std::optional<int64_t> uncompressed_size = io_slice.lookup_int("uncompressed_size");
+    if (!uncompressed_size) {
+      return std::nullopt;
+    }
+    slice.uncompressed_size = *uncompressed_size;
+  }
+  return slice;
 }
 
 BlobSlice BlobWriter::write_as_stream(const StringRef /*file_extension*/,
@@ -71,7 +131,7 @@ BlobSlice BlobWriter::write_as_stream(const StringRef /*file_extension*/,
 
 bool BlobReader::read_as_stream(const BlobSlice &slice, FunctionRef<bool(std::istream &)> fn) const
 {
-  const int64_t size = slice.range.size();
+  const int64_t size = slice.data_size();
   std::string buffer;
   buffer.resize(size);
   if (!this->read(slice, buffer.data())) {
@@ -84,31 +144,166 @@ bool BlobReader::read_as_stream(const BlobSlice &slice, FunctionRef<bool(std::is
   return true;
 }
 
+std::optional<ImplicitSharingInfoAndData> BlobReader::read_zero_copy(
+    const BlobSlice & /*slice*/, const int64_t /*alignment*/) const
+{
+  return std::nullopt;
+}
+
+/**
+ * A memory mapped blob file. It is shared between the #DiskBlobReader and all data that is used
+ * without copying it, so that the mapping stays valid as long as any of the data is used.
+ */
+class MappedBlobFile : public ImplicitSharingMixin {
+ public:
+  BLI_mmap_file *mmap_file;
+
+  MappedBlobFile(BLI_mmap_file *mmap_file) : mmap_file(mmap_file) {}
+
+  ~MappedBlobFile()
+  {
+    BLI_mmap_free(mmap_file);
+  }
+
+  Span<char> data() const
+  {
+    return {static_cast<const char *>(BLI_mmap_get_pointer(mmap_file)),
+            int64_t(BLI_mmap_get_length(mmap_file))};
+  }
+
+ private:
+  void delete_self() override
+  {
+    delete this;
+  }
+};
+
+/**
+ * Owns a single array that points into a #MappedBlobFile. Every array needs its own sharing info,
+ * because #BlobWriteSharing uses the sharing info to detect data that was written before.
+ */
+class MappedBlobSliceSharingInfo : public ImplicitSharingInfo {
+ private:
+  ImplicitSharingPtr<MappedBlobFile> file_;
+
+ public:
+  MappedBlobSliceSharingInfo(ImplicitSharingPtr<MappedBlobFile> file) : file_(std::move(file)) {}
+
+ private:
+  void delete_self_with_data() override
+  {
+    delete this;
+  }
+};
+
 DiskBlobReader::DiskBlobReader(std::string blobs_dir) : blobs_dir_(std::move(blobs_dir)) {}
 
-[[nodiscard]] bool DiskBlobReader::read(const BlobSlice &slice, void *r_data) const
+DiskBlobReader::~DiskBlobReader() = default;
+
+static ImplicitSharingPtr<MappedBlobFile> map_blob_file(const char *blob_path)
 {
-  if (slice.range.is_empty()) {
-    return true;
+  const int file = BLI_open(blob_path, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return {};
+  }
+  /* The mapping is copy-on-write, so that data that is used without copying it can still become
+   * mutable. */
+  BLI_mmap_file *mmap_file = BLI_mmap_open_copy_on_write(file);
+  /* The mapping stays valid after closing the file. */
+  close(file);
+  if (mmap_file == nullptr) {
+    return {};
   }
+  return ImplicitSharingPtr<MappedBlobFile>(new MappedBlobFile(mmap_file));
+}
 
-  char blob_path[FILE_MAX];
-  BLI_path_join(blob_path, sizeof(blob_path), blobs_dir_.c_str(), slice.name.c_str());
+const MappedBlobFile *DiskBlobReader::get_mapped_file(const BlobSlice &slice) const
+{
+  {
+    std::shared_lock lock{mutex_};
+    if (const ImplicitSharingPtr<MappedBlobFile> *file = mapped_files_.lookup_ptr(slice.name)) {
+      return file->get();
+    }
+  }
 
-  std::lock_guard lock{mutex_};
-  std::unique_ptr<fstream> &blob_file = open_input_streams_.lookup_or_add_cb_as(blob_path, [&]() {
-    return std::make_unique<fstream>(blob_path, std::ios::in | std::ios::binary);
-  });
-  blob_file->seekg(slice.range.start());
-  blob_file->read(static_cast<char *>(r_data), slice.range.size());
-  if (blob_file->gcount() != slice.range.size()) {
+  std::unique_lock lock{mutex_};
+  const ImplicitSharingPtr<MappedBlobFile> &file = mapped_files_.lookup_or_add_cb(
+      slice.name, [&]() {
+        char blob_path[FILE_MAX];
+        BLI_path_join(blob_path, sizeof(blob_path), blobs_dir_.c_str(), slice.name.c_str());
+        return map_blob_file(blob_path);
+      });
+  return file.get();
+}
+
+[[nodiscard]] bool DiskBlobReader::read(const BlobSlice &slice, void *r_data) const
+{
+  if (slice.data_size() == 0) {
+    return true;
+  }
+  const MappedBlobFile *file = this->get_mapped_file(slice);
+  if (file == nullptr) {
     return false;
   }
-  return true;
+  switch (slice.compression) {
+    case BlobCompression::None: {
+      return BLI_mmap_read(file->mmap_file, r_data, slice.range.start(), slice.range.size());
+    }
+    case BlobCompression::Zstd: {
+      const Span<char> file_data = file->data();
+      if (slice.range.one_after_last() > file_data.size()) {
+        return false;
+      }
+      const size_t decompressed_size = ZSTD_decompress(r_data,
+                                                       slice.uncompressed_size,
+                                                       file_data.slice(slice.range).data(),
+                                                       slice.range.size());
+      if (ZSTD_isError(decompressed_size) ||
+          int64_t(decompressed_size) != slice.uncompressed_size)
+      {
+        return false;
+      }
+      return !BLI_mmap_any_io_error(file->mmap_file);
+    }
+  }
+  return false;
 }
 
-DiskBlobWriter::DiskBlobWriter(std::string blob_dir, std::string base_name)
-    : blob_dir_(std::move(blob_dir)), base_name_(std::move(base_name))
+std::optional<ImplicitSharingInfoAndData> DiskBlobReader::read_zero_copy(
+    const BlobSlice &slice, const int64_t alignment) const
+{
+#ifdef WIN32
+  /* Files can't be deleted on Windows while they are mapped, which would make it impossible to
+   * remove or overwrite a bake while its data is still used. */
+  UNUSED_VARS(slice, alignment);
+  return std::nullopt;
+#else
+  if (slice.compression != BlobCompression::None || slice.range.is_empty()) {
+    return std::nullopt;
+  }
+  const MappedBlobFile *file = this->get_mapped_file(slice);
+  if (file == nullptr) {
+    return std::nullopt;
+  }
+  const Span<char> file_data = file->data();
+  if (slice.range.one_after_last() > file_data.size()) {
+    return std::nullopt;
+  }
+  const char *data = file_data.slice(slice.range).data();
+  if (uintptr_t(data) % uintptr_t(alignment) != 0) {
+    return std::nullopt;
+  }
+  file->add_user();
+  auto *sharing_info = new MappedBlobSliceSharingInfo(
+      ImplicitSharingPtr<MappedBlobFile>(const_cast<MappedBlobFile *>(file)));
+  return ImplicitSharingInfoAndData{sharing_info, data};
+#endif
+}
+
+DiskBlobWriter::DiskBlobWriter(std::string blob_dir,
+                               std::string base_name,
+                               const BlobCompression compression)
+    : blob_dir_(std::move(blob_dir)), base_name_(std::move(base_name)), compression_(compression)
 {
   blob_name_ = base_name_ + ".blob";
 }
@@ -122,6 +317,28 @@ BlobSlice DiskBlobWriter::write(const void *data, const int64_t size)
     blob_stream_.open(blob_path, std::ios::out | std::ios::binary);
   }
 
+  const int64_t padding = int64_t(ceil_to_multiple_ul(current_offset_, blob_slice_alignment)) -
+                          current_offset_;
+  if (padding > 0) {
+    const char zeros[blob_slice_alignment] = {0};
+    blob_stream_.write(zeros, padding);
+    current_offset_ += padding;
+  }
+
+  if (compression_ == BlobCompression::Zstd && size >= blob_compression_min_size) {
+    Array<char> compressed_data(ZSTD_compressBound(size), NoInitialization());
+    const size_t compressed_size = ZSTD_compress(
+        compressed_data.data(), compressed_data.size(), data, size, blob_zstd_compression_level);
+    /* Keep data uncompressed if compressing does not help, so that it can still be read without
+     * copying it. */
+    if (!ZSTD_isError(compressed_size) && int64_t(compressed_size) < size - size / 8) {
+      const int64_t old_offset = current_offset_;
+      blob_stream_.write(compressed_data.data(), compressed_size);
+      current_offset_ += compressed_size;
+      return {blob_name_, {old_offset, int64_t(compressed_size)}, BlobCompression::Zstd, size};
+    }
+  }
+
   const int64_t old_offset = current_offset_;
   blob_stream_.write(static_cast<const char *>(data), size);
   current_offset_ += size;
@@ -294,7 +511,7 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
   if (!slice) {
     return false;
   }
-  if (slice->range.size() != element_size * elements_num) {
+  if (slice->data_size() != element_size * elements_num) {
     return false;
   }
   if (!blob_reader.read(*slice, r_data)) {
@@ -342,7 +559,7 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_bytes(BlobWriter &blob_wr
   if (!slice) {
     return false;
   }
-  if (slice->range.size() != bytes_num) {
+  if (slice->data_size() != bytes_num) {
     return false;
   }
   return blob_reader.read(*slice, r_data);
@@ -407,6 +624,30 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
       sharing_info, [&]() { return write_blob_simple_gspan(blob_writer, blob_sharing, data); });
 }
 
+/**
+ * Use the stored data of an array directly if the blob reader supports that and the data does not
+ * have to be converted.
+ */
+static std::optional<ImplicitSharingInfoAndData> read_blob_simple_gspan_zero_copy(
+    const BlobReader &blob_reader,
+    const DictionaryValue &io_data,
+    const CPPType &cpp_type,
+    const int size)
+{
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice) {
+    return std::nullopt;
+  }
+  if (slice->data_size() != cpp_type.size() * size) {
+    return std::nullopt;
+  }
+  const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
+  if (stored_endian != get_endian_io_name(ENDIAN_ORDER)) {
+    return std::nullopt;
+  }
+  return blob_reader.read_zero_copy(*slice, cpp_type.alignment());
+}
+
 [[nodiscard]] static const void *read_blob_shared_simple_gspan(
     const DictionaryValue &io_data,
     const BlobReader &blob_reader,
@@ -418,6 +659,11 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
   const char *func = __func__;
   const std::optional<ImplicitSharingInfoAndData> sharing_info_and_data = blob_sharing.read_shared(
       io_data, [&]() -> std::optional<ImplicitSharingInfoAndData> {
+        if (std::optional<ImplicitSharingInfoAndData> data = read_blob_simple_gspan_zero_copy(
+                blob_reader, io_data, cpp_type, size))
+        {
+          return data;
+        }
         void *data_mem = MEM_mallocN_aligned(size * cpp_type.size(), cpp_type.alignment(), func);
         if (!read_blob_simple_gspan(blob_reader, io_data, {cpp_type, data_mem, size})) {
           MEM_freeN(data_mem);
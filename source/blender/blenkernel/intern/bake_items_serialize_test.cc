@@ -0,0 +1,253 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <fstream>
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_fileops.hh"
+#include "BLI_path_util.h"
+#include "BLI_system.h"
+#include "BLI_tempfile.h"
+
+#include "BKE_bake_items_serialize.hh"
+
+#include BLI_SYSTEM_PID_H
+
+namespace blender::bke::bake::tests {
+
+using namespace io::serialize;
+
+class BakeBlobTest : public testing::Test {
+ public:
+  /* Directory that contains the blob files of a test. Absolute path. */
+  std::string blobs_dir;
+
+  void SetUp() override
+  {
+    char temp_dir[FILE_MAX];
+    BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+    blobs_dir = std::string(temp_dir) + SEP_STR + "blender_bake_blob_test_" +
+                std::to_string(getpid());
+    BLI_dir_create_recursive(blobs_dir.c_str());
+  }
+
+  void TearDown() override
+  {
+    if (BLI_exists(blobs_dir.c_str())) {
+      BLI_delete(blobs_dir.c_str(), true, true);
+    }
+  }
+};
+
+/** Data that compresses well, like most attributes. */
+static Array<int> compressible_ints(const int size)
+{
+  Array<int> data(size);
+  for (const int i : data.index_range()) {
+    data[i] = i % 10;
+  }
+  return data;
+}
+
+/** Pseudo random bytes that don't get smaller when they are compressed. */
+static Array<uint8_t> random_bytes(const int size)
+{
+  Array<uint8_t> data(size);
+  uint32_t state = 12345;
+  for (const int i : data.index_range()) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    data[i] = uint8_t(state);
+  }
+  return data;
+}
+
+template<typename T>
+static void expect_read_equal(const BlobReader &reader, const BlobSlice &slice, Span<T> expected)
+{
+  ASSERT_EQ(slice.data_size(), expected.size_in_bytes());
+  Array<T> result(expected.size());
+  ASSERT_TRUE(reader.read(slice, result.data()));
+  EXPECT_EQ_ARRAY(expected.data(), result.data(), expected.size());
+}
+
+TEST_F(BakeBlobTest, round_trip_uncompressed)
+{
+  const Array<int> ints = compressible_ints(10000);
+  const Array<uint8_t> bytes = random_bytes(333);
+  const Array<float> floats = {1.0f, -2.5f, 3.25f};
+
+  Vector<BlobSlice> slices;
+  {
+    DiskBlobWriter writer{blobs_dir, "test"};
+    slices.append(writer.write(ints.data(), ints.as_span().size_in_bytes()));
+    slices.append(writer.write(bytes.data(), bytes.as_span().size_in_bytes()));
+    slices.append(writer.write(floats.data(), floats.as_span().size_in_bytes()));
+  }
+  for (const BlobSlice &slice : slices) {
+    EXPECT_EQ(slice.compression, BlobCompression::None);
+  }
+
+  DiskBlobReader reader{blobs_dir};
+  expect_read_equal(reader, slices[0], ints.as_span());
+  expect_read_equal(reader, slices[1], bytes.as_span());
+  expect_read_equal(reader, slices[2], floats.as_span());
+}
+
+TEST_F(BakeBlobTest, round_trip_compressed)
+{
+  const Array<int> large_ints = compressible_ints(100000);
+  const Array<int> small_ints = compressible_ints(100);
+  const Array<uint8_t> bytes = random_bytes(10000);
+
+  Vector<BlobSlice> slices;
+  {
+    DiskBlobWriter writer{blobs_dir, "test", BlobCompression::Zstd};
+    slices.append(writer.write(large_ints.data(), large_ints.as_span().size_in_bytes()));
+    slices.append(writer.write(small_ints.data(), small_ints.as_span().size_in_bytes()));
+    slices.append(writer.write(bytes.data(), bytes.as_span().size_in_bytes()));
+  }
+
+  EXPECT_EQ(slices[0].compression, BlobCompression::Zstd);
+  EXPECT_LT(slices[0].range.size(), large_ints.as_span().size_in_bytes());
+  /* Too small to be compressed. */
+  EXPECT_EQ(slices[1].compression, BlobCompression::None);
+  /* Compressing does not reduce the size enough. */
+  EXPECT_EQ(slices[2].compression, BlobCompression::None);
+
+  /* Slices are read from their serialized description, like when loading a bake. */
+  DiskBlobReader reader{blobs_dir};
+  const std::optional<BlobSlice> large_slice = BlobSlice::deserialize(*slices[0].serialize());
+  ASSERT_TRUE(large_slice.has_value());
+  EXPECT_EQ(large_slice->range, slices[0].range);
+  EXPECT_EQ(large_slice->compression, BlobCompression::Zstd);
+  EXPECT_EQ(large_slice->uncompressed_size, large_ints.as_span().size_in_bytes());
+  expect_read_equal(reader, *large_slice, large_ints.as_span());
+
+  const std::optional<BlobSlice> small_slice = BlobSlice::deserialize(*slices[1].serialize());
+  ASSERT_TRUE(small_slice.has_value());
+  EXPECT_EQ(small_slice->compression, BlobCompression::None);
+  expect_read_equal(reader, *small_slice, small_ints.as_span());
+
+  expect_read_equal(reader, slices[2], bytes.as_span());
+
+  /* Compressed data can't be used without decompressing it. */
+  EXPECT_FALSE(reader.read_zero_copy(slices[0], alignof(int)).has_value());
+}
+
+TEST_F(BakeBlobTest, read_old_slice)
+{
+  /* Bakes written before compression was supported store slices without padding and without
+   * information about the codec. */
+  const Array<int> ints = compressible_ints(10000);
+  const Array<uint8_t> bytes = random_bytes(7);
+  {
+    std::ofstream stream{blobs_dir + SEP_STR + "old.blob", std::ios::out | std::ios::binary};
+    stream.write(reinterpret_cast<const char *>(bytes.data()), bytes.as_span().size_in_bytes());
+    stream.write(reinterpret_cast<const char *>(ints.data()), ints.as_span().size_in_bytes());
+  }
+
+  DictionaryValue io_bytes;
+  io_bytes.append_str("name", "old.blob");
+  io_bytes.append_int("start", 0);
+  io_bytes.append_int("size", bytes.as_span().size_in_bytes());
+  DictionaryValue io_ints;
+  io_ints.append_str("name", "old.blob");
+  io_ints.append_int("start", bytes.as_span().size_in_bytes());
+  io_ints.append_int("size", ints.as_span().size_in_bytes());
+
+  const std::optional<BlobSlice> bytes_slice = BlobSlice::deserialize(io_bytes);
+  const std::optional<BlobSlice> ints_slice = BlobSlice::deserialize(io_ints);
+  ASSERT_TRUE(bytes_slice.has_value());
+  ASSERT_TRUE(ints_slice.has_value());
+  EXPECT_EQ(ints_slice->compression, BlobCompression::None);
+  EXPECT_EQ(ints_slice->data_size(), ints.as_span().size_in_bytes());
+
+  DiskBlobReader reader{blobs_dir};
+  expect_read_equal(reader, *bytes_slice, bytes.as_span());
+  /* The unaligned array is still read correctly, it's just copied. */
+  expect_read_equal(reader, *ints_slice, ints.as_span());
+}
+
+TEST_F(BakeBlobTest, invalid_slice)
+{
+  DictionaryValue io_unknown_codec;
+  io_unknown_codec.append_str("name", "test.blob");
+  io_unknown_codec.append_int("start", 0);
+  io_unknown_codec.append_int("size", 16);
+  io_unknown_codec.append_str("compression", "unknown");
+  io_unknown_codec.append_int("uncompressed_size", 32);
+  EXPECT_FALSE(BlobSlice::deserialize(io_unknown_codec).has_value());
+
+  DictionaryValue io_missing_size;
+  io_missing_size.append_str("name", "test.blob");
+  io_missing_size.append_int("start", 0);
+  io_missing_size.append_int("size", 16);
+  io_missing_size.append_str("compression", "zstd");
+  EXPECT_FALSE(BlobSlice::deserialize(io_missing_size).has_value());
+}
+
+TEST_F(BakeBlobTest, slice_alignment)
+{
+  for (const BlobCompression compression : {BlobCompression::None, BlobCompression::Zstd}) {
+    DiskBlobWriter writer{blobs_dir, "test", compression};
+    const Array<int> large_ints = compressible_ints(5001);
+    const Array<uint8_t> bytes = random_bytes(5);
+    for (const int i : IndexRange(3)) {
+      const BlobSlice bytes_slice = writer.write(bytes.data(), i + 1);
+      EXPECT_EQ(bytes_slice.range.start() % 16, 0);
+      const BlobSlice ints_slice = writer.write(large_ints.data(),
+                                                large_ints.as_span().size_in_bytes());
+      EXPECT_EQ(ints_slice.range.start() % 16, 0);
+    }
+  }
+}
+
+#ifndef WIN32
+TEST_F(BakeBlobTest, zero_copy_outlives_reader)
+{
+  Array<float> floats(1000);
+  for (const int i : floats.index_range()) {
+    floats[i] = float(i) * 0.5f;
+  }
+
+  BlobSlice slice;
+  {
+    DiskBlobWriter writer{blobs_dir, "test"};
+    /* Write something first, so that the array is not at the start of the file. */
+    const Array<uint8_t> bytes = random_bytes(3);
+    [[maybe_unused]] const BlobSlice bytes_slice = writer.write(bytes.data(), bytes.size());
+    slice = writer.write(floats.data(), floats.as_span().size_in_bytes());
+  }
+
+  std::optional<ImplicitSharingInfoAndData> shared_data;
+  {
+    DiskBlobReader reader{blobs_dir};
+    shared_data = reader.read_zero_copy(slice, alignof(float));
+  }
+  ASSERT_TRUE(shared_data.has_value());
+  ASSERT_NE(shared_data->sharing_info, nullptr);
+  EXPECT_EQ(uintptr_t(shared_data->data) % alignof(float), 0);
+
+  /* The data is still mapped after the reader has been destroyed. */
+  const float *data = static_cast<const float *>(shared_data->data);
+  EXPECT_EQ_ARRAY(floats.data(), data, floats.size());
+
+  /* The data is owned by this sharing info only, so it can be modified without changing the
+   * file. */
+  ASSERT_TRUE(shared_data->sharing_info->is_mutable());
+  const_cast<float *>(data)[0] = -1.0f;
+  {
+    DiskBlobReader reader{blobs_dir};
+    expect_read_equal(reader, slice, floats.as_span());
+  }
+
+  shared_data->sharing_info->remove_user_and_delete_if_last();
+}
+#endif
+
+}  // namespace blender::bke::bake::tests
@@ -36,9 +36,19 @@ struct BVHCacheItem {
 
 struct BVHCache {
   BVHCacheItem items[BVHTREE_MAX_ITEM];
+  /* Trees of the same types, balanced with #BVH_BALANCE_WIDE. */
+  BVHCacheItem wide_items[BVHTREE_MAX_ITEM];
   ThreadMutex mutex;
 };
 
+static BVHCacheItem &bvhcache_item(BVHCache *bvh_cache,
+                                   const BVHCacheType type,
+                                   const int balance_flag)
+{
+  return (balance_flag & BVH_BALANCE_WIDE) ? bvh_cache->wide_items[type] :
+                                             bvh_cache->items[type];
+}
+
 /**
  * Queries a bvhcache for the cache bvhtree of the request type
  *
@@ -49,6 +59,7 @@ struct BVHCache {
  */
 static bool bvhcache_find(BVHCache **bvh_cache_p,
                           BVHCacheType type,
+                          const int balance_flag,
                           BVHTree **r_tree,
                           bool *r_locked,
                           std::mutex *mesh_eval_mutex)
@@ -70,13 +81,14 @@ static bool bvhcache_find(BVHCache **bvh_cache_p,
   }
   BVHCache *bvh_cache = *bvh_cache_p;
 
-  if (bvh_cache->items[type].is_filled) {
-    *r_tree = bvh_cache->items[type].tree;
+  const BVHCacheItem &item = bvhcache_item(bvh_cache, type, balance_flag);
+  if (item.is_filled) {
+    *r_tree = item.tree;
     return true;
   }
   if (do_lock) {
     BLI_mutex_lock(&bvh_cache->mutex);
-    bool in_cache = bvhcache_find(bvh_cache_p, type, r_tree, nullptr, nullptr);
+    bool in_cache = bvhcache_find(bvh_cache_p, type, balance_flag, r_tree, nullptr, nullptr);
     if (in_cache) {
       BLI_mutex_unlock(&bvh_cache->mutex);
       return in_cache;
@@ -100,7 +112,7 @@ bool bvhcache_has_tree(const BVHCache *bvh_cache, const BVHTree *tree)
   }
 
   for (int i = 0; i < BVHTREE_MAX_ITEM; i++) {
-    if (bvh_cache->items[i].tree == tree) {
+    if (bvh_cache->items[i].tree == tree || bvh_cache->wide_items[i].tree == tree) {
       return true;
     }
   }
@@ -121,20 +133,24 @@ BVHCache *bvhcache_init()
  * A call to this assumes that there was no previous cached tree of the given type
  * \warning The #BVHTree can be nullptr.
  */
-static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType type)
+static void bvhcache_insert(BVHCache *bvh_cache,
+                            BVHTree *tree,
+                            BVHCacheType type,
+                            const int balance_flag)
 {
-  BVHCacheItem *item = &bvh_cache->items[type];
-  BLI_assert(!item->is_filled);
-  item->tree = tree;
-  item->is_filled = true;
+  BVHCacheItem &item = bvhcache_item(bvh_cache, type, balance_flag);
+  BLI_assert(!item.is_filled);
+  item.tree = tree;
+  item.is_filled = true;
 }
 
 void bvhcache_free(BVHCache *bvh_cache)
 {
   for (int index = 0; index < BVHTREE_MAX_ITEM; index++) {
-    BVHCacheItem *item = &bvh_cache->items[index];
-    BLI_bvhtree_free(item->tree);
-    item->tree = nullptr;
+    BLI_bvhtree_free(bvh_cache->items[index].tree);
+    BLI_bvhtree_free(bvh_cache->wide_items[index].tree);
+    bvh_cache->items[index].tree = nullptr;
+    bvh_cache->wide_items[index].tree = nullptr;
   }
   BLI_mutex_end(&bvh_cache->mutex);
   MEM_freeN(bvh_cache);
@@ -150,14 +166,21 @@ static void bvhtree_balance_isolated(void *userdata)
   BLI_bvhtree_balance((BVHTree *)userdata);
 }
 
-static void bvhtree_balance(BVHTree *tree, const bool isolate)
+static void bvhtree_balance_wide_isolated(void *userdata)
+{
+  BLI_bvhtree_balance_ex((BVHTree *)userdata, BVH_BALANCE_WIDE);
+}
+
+static void bvhtree_balance(BVHTree *tree, const bool isolate, const int balance_flag)
 {
   if (tree) {
     if (isolate) {
-      BLI_task_isolate(bvhtree_balance_isolated, tree);
+      BLI_task_isolate((balance_flag & BVH_BALANCE_WIDE) ? bvhtree_balance_wide_isolated :
+                                                           bvhtree_balance_isolated,
+                       tree);
     }
     else {
-      BLI_bvhtree_balance(tree);
+      BLI_bvhtree_balance_ex(tree, balance_flag);
     }
   }
 }
@@ -593,7 +616,7 @@ BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
   BVHTree *tree = bvhtree_from_mesh_verts_create_tree(
       epsilon, tree_type, axis, vert_positions, verts_mask, verts_num_active);
 
-  bvhtree_balance(tree, false);
+  bvhtree_balance(tree, false, BVH_BALANCE_DEFAULT);
 
   if (data) {
     /* Setup BVHTreeFromMesh */
@@ -648,7 +671,7 @@ BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
   BVHTree *tree = bvhtree_from_mesh_edges_create_tree(
       vert_positions, edges, edges_mask, edges_num_active, epsilon, tree_type, axis);
 
-  bvhtree_balance(tree, false);
+  bvhtree_balance(tree, false, BVH_BALANCE_DEFAULT);
 
   if (data) {
     /* Setup BVHTreeFromMesh */
@@ -764,7 +787,7 @@ BVHTree *bvhtree_from_mesh_corner_tris_ex(BVHTreeFromMesh *data,
                                                             corner_tris_mask,
                                                             corner_tris_num_active);
 
-  bvhtree_balance(tree, false);
+  bvhtree_balance(tree, false, BVH_BALANCE_DEFAULT);
 
   if (data) {
     /* Setup BVHTreeFromMesh */
@@ -899,7 +922,8 @@ static BitVector<> corner_tris_no_hidden_map_get(const blender::OffsetIndices<in
 BVHTree *BKE_bvhtree_from_mesh_get(BVHTreeFromMesh *data,
                                    const Mesh *mesh,
                                    const BVHCacheType bvh_cache_type,
-                                   const int tree_type)
+                                   const int tree_type,
+                                   const int balance_flag)
 {
   using namespace blender;
   using namespace blender::bke;
@@ -925,8 +949,12 @@ BVHTree *BKE_bvhtree_from_mesh_get(BVHTreeFromMesh *data,
                                data);
 
   bool lock_started = false;
-  data->cached = bvhcache_find(
-      bvh_cache_p, bvh_cache_type, &data->tree, &lock_started, &mesh->runtime->eval_mutex);
+  data->cached = bvhcache_find(bvh_cache_p,
+                               bvh_cache_type,
+                               balance_flag,
+                               &data->tree,
+                               &lock_started,
+                               &mesh->runtime->eval_mutex);
 
   if (data->cached) {
     BLI_assert(lock_started == false);
@@ -1008,13 +1036,13 @@ BVHTree *BKE_bvhtree_from_mesh_get(BVHTreeFromMesh *data,
       break;
   }
 
-  bvhtree_balance(data->tree, lock_started);
+  bvhtree_balance(data->tree, lock_started, balance_flag);
 
   /* Save on cache for later use */
   // printf("BVHTree built and saved on cache\n");
   BLI_assert(data->cached == false);
   data->cached = true;
-  bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type);
+  bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type, balance_flag);
   bvhcache_unlock(*bvh_cache_p, lock_started);
 
 #ifndef NDEBUG
@@ -1032,14 +1060,15 @@ BVHTree *BKE_bvhtree_from_mesh_get(BVHTreeFromMesh *data,
 
 void BKE_bvhtree_from_mesh_tris_init(const Mesh &mesh,
                                      const blender::IndexMask &faces_mask,
-                                     BVHTreeFromMesh &r_data)
+                                     BVHTreeFromMesh &r_data,
+                                     const int balance_flag)
 {
   using namespace blender;
   using namespace blender::bke;
 
   if (faces_mask.size() == mesh.faces_num) {
     /* Can use cache if all faces are in the bvh tree. */
-    BKE_bvhtree_from_mesh_get(&r_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 2);
+    BKE_bvhtree_from_mesh_get(&r_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 2, balance_flag);
     return;
   }
 
@@ -1080,19 +1109,20 @@ void BKE_bvhtree_from_mesh_tris_init(const Mesh &mesh,
     }
   });
 
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 }
 
 void BKE_bvhtree_from_mesh_edges_init(const Mesh &mesh,
                                       const blender::IndexMask &edges_mask,
-                                      BVHTreeFromMesh &r_data)
+                                      BVHTreeFromMesh &r_data,
+                                      const int balance_flag)
 {
   using namespace blender;
   using namespace blender::bke;
 
   if (edges_mask.size() == mesh.edges_num) {
     /* Can use cache if all edges are in the bvh tree. */
-    BKE_bvhtree_from_mesh_get(&r_data, &mesh, BVHTREE_FROM_EDGES, 2);
+    BKE_bvhtree_from_mesh_get(&r_data, &mesh, BVHTREE_FROM_EDGES, 2, balance_flag);
     return;
   }
 
@@ -1116,19 +1146,20 @@ void BKE_bvhtree_from_mesh_edges_init(const Mesh &mesh,
     BLI_bvhtree_insert(tree, edge_i, co[0], 2);
   });
 
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 }
 
 void BKE_bvhtree_from_mesh_verts_init(const Mesh &mesh,
                                       const blender::IndexMask &verts_mask,
-                                      BVHTreeFromMesh &r_data)
+                                      BVHTreeFromMesh &r_data,
+                                      const int balance_flag)
 {
   using namespace blender;
   using namespace blender::bke;
 
   if (verts_mask.size() == mesh.verts_num) {
     /* Can use cache if all vertices are in the bvh tree. */
-    BKE_bvhtree_from_mesh_get(&r_data, &mesh, BVHTREE_FROM_VERTS, 2);
+    BKE_bvhtree_from_mesh_get(&r_data, &mesh, BVHTREE_FROM_VERTS, 2, balance_flag);
     return;
   }
 
@@ -1148,7 +1179,7 @@ void BKE_bvhtree_from_mesh_verts_init(const Mesh &mesh,
     BLI_bvhtree_insert(tree, vert_i, position, 1);
   });
 
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 }
 
 /** \} */
@@ -1174,7 +1205,8 @@ void free_bvhtree_from_mesh(BVHTreeFromMesh *data)
 
 void BKE_bvhtree_from_pointcloud_get(const PointCloud &pointcloud,
                                      const blender::IndexMask &points_mask,
-                                     BVHTreeFromPointCloud &r_data)
+                                     BVHTreeFromPointCloud &r_data,
+                                     const int balance_flag)
 {
   int active_num = -1;
   BVHTree *tree = bvhtree_new_common(0.0f, 2, 6, points_mask.size(), active_num);
@@ -1186,7 +1218,7 @@ void BKE_bvhtree_from_pointcloud_get(const PointCloud &pointcloud,
   const Span<float3> positions = pointcloud.positions();
   points_mask.foreach_index([&](const int i) { BLI_bvhtree_insert(tree, i, positions[i], 1); });
 
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   r_data.coords = (const float(*)[3])positions.data();
   r_data.tree = tree;
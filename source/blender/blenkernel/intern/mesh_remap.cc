@@ -124,7 +124,7 @@ float BKE_mesh_remap_calc_difference_from_mesh(const SpaceTransform *space_trans
   float result = 0.0f;
   int i;
 
-  BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
+  BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2, BVH_BALANCE_WIDE);
   nearest.index = -1;
 
   for (i = 0; i < numverts_dst; i++) {
@@ -478,7 +478,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
     float tmp_co[3], tmp_no[3];
 
     if (mode == MREMAP_MODE_VERT_NEAREST) {
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2, BVH_BALANCE_WIDE);
       nearest.index = -1;
 
       for (i = 0; i < numverts_dst; i++) {
@@ -503,7 +503,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       const blender::Span<blender::int2> edges_src = me_src->edges();
       const blender::Span<blender::float3> positions_src = me_src->vert_positions();
 
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2, BVH_BALANCE_WIDE);
       nearest.index = -1;
 
       for (i = 0; i < numverts_dst; i++) {
@@ -565,7 +565,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       float *weights = static_cast<float *>(
           MEM_mallocN(sizeof(*weights) * tmp_buff_size, __func__));
 
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2, BVH_BALANCE_WIDE);
 
       if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
         for (i = 0; i < numverts_dst; i++) {
@@ -725,7 +725,7 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
       const GroupedSpan<int> vert_to_edge_src_map = bke::mesh::build_vert_to_edge_map(
           edges_src, num_verts_src, vert_to_edge_src_offsets, vert_to_edge_src_indices);
 
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2, BVH_BALANCE_WIDE);
       nearest.index = -1;
 
       for (i = 0; i < numedges_dst; i++) {
@@ -828,7 +828,7 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
       MEM_freeN(v_dst_to_src_map);
     }
     else if (mode == MREMAP_MODE_EDGE_NEAREST) {
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2, BVH_BALANCE_WIDE);
       nearest.index = -1;
 
       for (i = 0; i < numedges_dst; i++) {
@@ -859,7 +859,7 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
       const blender::Span<blender::float3> positions_src = me_src->vert_positions();
       const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2, BVH_BALANCE_WIDE);
 
       for (i = 0; i < numedges_dst; i++) {
         interp_v3_v3v3(tmp_co,
@@ -916,7 +916,7 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
       float *weights = static_cast<float *>(
           MEM_mallocN(sizeof(*weights) * size_t(numedges_src), __func__));
 
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2, BVH_BALANCE_WIDE);
 
       const blender::Span<blender::float3> vert_normals_dst = me_dst->vert_normals();
 
@@ -1436,7 +1436,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
       }
       else {
         BLI_assert(num_trees == 1);
-        BKE_bvhtree_from_mesh_get(&treedata[0], me_src, BVHTREE_FROM_VERTS, 2);
+        BKE_bvhtree_from_mesh_get(&treedata[0], me_src, BVHTREE_FROM_VERTS, 2, BVH_BALANCE_WIDE);
       }
     }
     else { /* We use faces. */
@@ -1468,7 +1468,8 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
       }
       else {
         BLI_assert(num_trees == 1);
-        BKE_bvhtree_from_mesh_get(&treedata[0], me_src, BVHTREE_FROM_CORNER_TRIS, 2);
+        BKE_bvhtree_from_mesh_get(
+            &treedata[0], me_src, BVHTREE_FROM_CORNER_TRIS, 2, BVH_BALANCE_WIDE);
       }
     }
 
@@ -2069,7 +2070,7 @@ void BKE_mesh_remap_calc_faces_from_mesh(const int mode,
     float hit_dist;
     const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
-    BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
+    BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2, BVH_BALANCE_WIDE);
 
     if (mode == MREMAP_MODE_POLY_NEAREST) {
       nearest.index = -1;
@@ -18,11 +18,15 @@
 #include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_kdopbvh.hh"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
 #include "BLI_math_solvers.h"
 #include "BLI_math_vector.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_attribute.hh"
@@ -120,7 +124,8 @@ bool BKE_shrinkwrap_init_tree(
   data->sharp_faces = *attributes.lookup<bool>("sharp_face", AttrDomain::Face);
 
   if (shrinkType == MOD_SHRINKWRAP_NEAREST_VERTEX) {
-    data->bvh = BKE_bvhtree_from_mesh_get(&data->treeData, mesh, BVHTREE_FROM_VERTS, 2);
+    data->bvh = BKE_bvhtree_from_mesh_get(
+        &data->treeData, mesh, BVHTREE_FROM_VERTS, 2, BVH_BALANCE_WIDE);
 
     return data->bvh != nullptr;
   }
@@ -129,7 +134,8 @@ bool BKE_shrinkwrap_init_tree(
     return false;
   }
 
-  data->bvh = BKE_bvhtree_from_mesh_get(&data->treeData, mesh, BVHTREE_FROM_CORNER_TRIS, 4);
+  data->bvh = BKE_bvhtree_from_mesh_get(
+      &data->treeData, mesh, BVHTREE_FROM_CORNER_TRIS, 4, BVH_BALANCE_WIDE);
 
   if (data->bvh == nullptr) {
     return false;
@@ -303,88 +309,69 @@ const ShrinkwrapBoundaryData &boundary_cache_ensure(const Mesh &mesh)
  * Shrink-wrap to the nearest vertex
  *
  * it builds a BVH-tree of vertices we can attach to and then
- * for each vertex performs a nearest vertex search on the tree.
+ * performs a batched nearest vertex search on the tree for all vertices.
  */
-static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
-                                                 const int i,
-                                                 const TaskParallelTLS *__restrict tls)
+static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 {
-  ShrinkwrapCalcCBData *data = static_cast<ShrinkwrapCalcCBData *>(userdata);
-
-  ShrinkwrapCalcData *calc = data->calc;
-  BVHTreeFromMesh *treeData = &data->tree->treeData;
-  BVHTreeNearest *nearest = static_cast<BVHTreeNearest *>(tls->userdata_chunk);
-
-  float *co = calc->vertexCos[i];
-  float tmp_co[3];
-  float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
-
-  if (calc->invert_vgroup) {
-    weight = 1.0f - weight;
-  }
-
-  if (weight == 0.0f) {
-    return;
-  }
-
-  /* Convert the vertex to tree coordinates */
-  if (calc->vert_positions) {
-    copy_v3_v3(tmp_co, calc->vert_positions[i]);
-  }
-  else {
-    copy_v3_v3(tmp_co, co);
-  }
-  BLI_space_transform_apply(&calc->local2target, tmp_co);
-
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
-  }
-  else {
-    nearest->dist_sq = FLT_MAX;
-  }
-
-  BLI_bvhtree_find_nearest(treeData->tree, tmp_co, nearest, treeData->nearest_callback, treeData);
+  using namespace blender;
+  BVHTreeFromMesh *treeData = &calc->tree->treeData;
+
+  /* Convert the vertices to tree coordinates. */
+  Array<float> weights(calc->numVerts);
+  Array<float3> tree_positions(calc->numVerts);
+  threading::parallel_for(IndexRange(calc->numVerts), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      float weight = BKE_defvert_array_find_weight_safe(calc->dvert, int(i), calc->vgroup);
+      if (calc->invert_vgroup) {
+        weight = 1.0f - weight;
+      }
+      weights[i] = weight;
 
-  /* Found the nearest vertex */
-  if (nearest->index != -1) {
+      if (calc->vert_positions) {
+        copy_v3_v3(tree_positions[i], calc->vert_positions[i]);
+      }
+      else {
+        copy_v3_v3(tree_positions[i], calc->vertexCos[i]);
+      }
+      BLI_space_transform_apply(&calc->local2target, tree_positions[i]);
+    }
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(calc->numVerts), GrainSize(4096), memory, [&](const int64_t i) {
+        return weights[i] != 0.0f;
+      });
+
+  Array<BVHTreeNearest> nearest(calc->numVerts);
+  mask.foreach_index_optimized<int>(GrainSize(4096), [&](const int i) {
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  });
+  kdopbvh::find_nearest_batch(
+      *treeData->tree, mask, tree_positions, nearest, treeData->nearest_callback, treeData);
+
+  mask.foreach_index(GrainSize(4096), [&](const int i) {
+    /* Found the nearest vertex */
+    if (nearest[i].index == -1) {
+      return;
+    }
+    float weight = weights[i];
     /* Adjusting the vertex weight,
      * so that after interpolating it keeps a certain distance from the nearest position */
-    if (nearest->dist_sq > FLT_EPSILON) {
-      const float dist = sqrtf(nearest->dist_sq);
+    if (nearest[i].dist_sq > FLT_EPSILON) {
+      const float dist = sqrtf(nearest[i].dist_sq);
       weight *= (dist - calc->keepDist) / dist;
     }
 
     /* Convert the coordinates back to mesh coordinates */
-    copy_v3_v3(tmp_co, nearest->co);
+    float tmp_co[3];
+    copy_v3_v3(tmp_co, nearest[i].co);
     BLI_space_transform_invert(&calc->local2target, tmp_co);
 
+    float *co = calc->vertexCos[i];
     interp_v3_v3v3(co, co, tmp_co, weight); /* linear interpolation */
-  }
-}
-
-static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
-{
-  BVHTreeNearest nearest = NULL_BVHTreeNearest;
-
-  /* Setup nearest */
-  nearest.index = -1;
-  nearest.dist_sq = FLT_MAX;
-
-  ShrinkwrapCalcCBData data{};
-  data.calc = calc;
-  data.tree = calc->tree;
-  TaskParallelSettings settings;
-  BLI_parallel_range_settings_defaults(&settings);
-  settings.use_threading = (calc->numVerts > 10000);
-  settings.userdata_chunk = &nearest;
-  settings.userdata_chunk_size = sizeof(nearest);
-  BLI_task_parallel_range(
-      0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
+  });
 }
 
 bool BKE_shrinkwrap_project_normal(char options,
@@ -62,6 +62,13 @@ FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT AT
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
 FileReader *BLI_filereader_new_gzip(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
+/**
+ * Decompress the frames following the reading position of a seekable `Zstd` reader on worker
+ * threads, for files that are read from start to end.
+ * \return False if the reader does not support this, in which case nothing changes.
+ */
+bool BLI_filereader_zstd_read_ahead_enable(FileReader *reader) ATTR_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
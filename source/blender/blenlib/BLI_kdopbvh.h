@@ -89,6 +89,15 @@ enum {
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
 };
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
+enum {
+  /* Also build a wide tree with the surface area heuristic, used to accelerate ray-cast,
+   * nearest and range queries. Only supported for trees with axis 6, 8, 14 or 26.
+   * The wide tree takes more time and memory to build, so it is only worth it for trees that
+   * are queried for many elements, like in geometry nodes that query once per evaluated
+   * element. */
+  BVH_BALANCE_WIDE = (1 << 0),
+};
+#define BVH_BALANCE_DEFAULT 0
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
 
 /**
@@ -138,6 +147,10 @@ void BLI_bvhtree_free(BVHTree *tree);
  */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+/**
+ * \param flag: See #BVH_BALANCE_WIDE.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, int flag);
 
 /**
  * Update: first update points/nodes, then call update_tree to refit the bounding volumes.
@@ -150,6 +163,7 @@ bool BLI_bvhtree_update_node(
  *
  * Note that this does not rebalance the tree, so if the shape of the mesh changes
  * too much, operations on the tree may become suboptimal.
+ * A wide tree built with #BVH_BALANCE_WIDE is freed, queries use the k-DOP tree afterwards.
  */
 void BLI_bvhtree_update_tree(BVHTree *tree);
 
@@ -0,0 +1,58 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Batched queries on a #BVHTree.
+ *
+ * Issuing one #BLI_bvhtree_ray_cast or #BLI_bvhtree_find_nearest call per element restarts the
+ * traversal at the root every time, and neighboring queries in memory are often far apart in
+ * space. The batched functions sort the queries along a Morton curve first, so that queries
+ * that visit the same nodes are processed together. Trees balanced with #BVH_BALANCE_WIDE are
+ * then traversed with packets of queries, other trees are queried one by one in sorted order.
+ *
+ * The functions are multi-threaded, so the callbacks have to be thread-safe.
+ */
+
+#include "BLI_index_mask_fwd.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
+
+namespace blender::kdopbvh {
+
+/**
+ * Cast a ray for every index in \a mask, see #BLI_bvhtree_ray_cast_ex.
+ *
+ * \param directions: Normalized ray directions.
+ * \param r_hits: Like for a single ray-cast, the index and maximum distance have to be
+ * initialized by the caller. They are updated by the callback when there is a hit.
+ */
+void ray_cast_batch(const BVHTree &tree,
+                    const IndexMask &mask,
+                    Span<float3> origins,
+                    Span<float3> directions,
+                    float radius,
+                    MutableSpan<BVHTreeRayHit> r_hits,
+                    BVHTree_RayCastCallback callback,
+                    void *userdata,
+                    int flag = BVH_RAYCAST_DEFAULT);
+
+/**
+ * Find the nearest primitive for every index in \a mask, see #BLI_bvhtree_find_nearest.
+ *
+ * \param r_nearest: Like for a single query, the maximum squared distance has to be initialized
+ * by the caller. It is updated by the callback when a closer primitive is found.
+ */
+void find_nearest_batch(const BVHTree &tree,
+                        const IndexMask &mask,
+                        Span<float3> positions,
+                        MutableSpan<BVHTreeNearest> r_nearest,
+                        BVHTree_NearestPointCallback callback,
+                        void *userdata);
+
+}  // namespace blender::kdopbvh
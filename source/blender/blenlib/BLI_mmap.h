@@ -25,6 +25,9 @@ typedef struct BLI_mmap_file BLI_mmap_file;
  * May return NULL if the operation fails.
  * Note that this seeks to the end of the file to determine its length. */
 BLI_mmap_file *BLI_mmap_open(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+/* Same as #BLI_mmap_open, but the mapped memory may also be written to. The mapping is private,
+ * so pages are copied on their first write and changes are never written back to the file. */
+BLI_mmap_file *BLI_mmap_open_copy_on_write(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
 
 /* Reads length bytes from file at the given offset into dest.
  * Returns whether the operation was successful (may fail when reading beyond the file
@@ -35,6 +38,11 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
 void *BLI_mmap_get_pointer(BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 size_t BLI_mmap_get_length(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 
+/* Returns whether an IO error occurred while accessing the mapped memory.
+ * Code that reads directly through #BLI_mmap_get_pointer has to check this once it is done,
+ * since on POSIX systems the failed region is replaced with zeroes. */
+bool BLI_mmap_any_io_error(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+
 void BLI_mmap_free(BLI_mmap_file *file) ATTR_NONNULL(1);
 
 #ifdef __cplusplus
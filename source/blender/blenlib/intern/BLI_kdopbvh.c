@@ -28,6 +28,7 @@
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
+#include "BLI_kdopbvh_wide.h"
 #include "BLI_math_geom.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
@@ -85,11 +86,12 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* KDOP type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quad-tree). */
+  BVHWideTree *wide_tree;       /* optional, see #BVH_BALANCE_WIDE */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 56) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 36),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -935,6 +937,9 @@ fail:
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
+    if (tree->wide_tree) {
+      bvhtree_wide_free(tree->wide_tree);
+    }
     MEM_SAFE_FREE(tree->nodes);
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
@@ -943,6 +948,41 @@ void BLI_bvhtree_free(BVHTree *tree)
   }
 }
 
+static void bvhtree_wide_ensure(BVHTree *tree)
+{
+  /* The wide tree only uses the axis aligned bounds, the first 3 axes of the k-DOP. */
+  if (tree->start_axis != 0 || tree->leaf_num == 0) {
+    return;
+  }
+
+  float(*leaf_bounds)[6] = MEM_malloc_arrayN(
+      (size_t)tree->leaf_num, sizeof(*leaf_bounds), "BVHWideTree leaf bounds");
+  int *leaf_indices = MEM_malloc_arrayN(
+      (size_t)tree->leaf_num, sizeof(*leaf_indices), "BVHWideTree leaf indices");
+  for (int i = 0; i < tree->leaf_num; i++) {
+    memcpy(leaf_bounds[i], tree->nodes[i]->bv, sizeof(*leaf_bounds));
+    leaf_indices[i] = tree->nodes[i]->index;
+  }
+  tree->wide_tree = bvhtree_wide_build(
+      (const float(*)[6])leaf_bounds, leaf_indices, tree->leaf_num);
+  MEM_freeN(leaf_bounds);
+  MEM_freeN(leaf_indices);
+}
+
+const BVHWideTree *bvhtree_wide_get(const BVHTree *tree)
+{
+  return tree->wide_tree;
+}
+
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
+{
+  BLI_bvhtree_balance(tree);
+
+  if (flag & BVH_BALANCE_WIDE) {
+    bvhtree_wide_ensure(tree);
+  }
+}
+
 void BLI_bvhtree_balance(BVHTree *tree)
 {
   BVHNode **leafs_array = tree->nodes;
@@ -1036,6 +1076,12 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
   BVHNode **root = tree->nodes + tree->leaf_num;
   BVHNode **index = tree->nodes + tree->leaf_num + tree->branch_num - 1;
 
+  /* The wide tree is not refitted, it would go out of date. */
+  if (tree->wide_tree) {
+    bvhtree_wide_free(tree->wide_tree);
+    tree->wide_tree = NULL;
+  }
+
   for (; index >= root; index--) {
     node_join(tree, *index);
   }
@@ -1686,7 +1732,11 @@ int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
   }
 
   /* dfs search */
-  if (root) {
+  if (tree->wide_tree && !(flag & BVH_NEAREST_OPTIMAL_ORDER)) {
+    /* The wide tree is traversed in near to far order already. */
+    bvhtree_wide_find_nearest(tree->wide_tree, co, &data.nearest, callback, userdata);
+  }
+  else if (root) {
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
@@ -2020,7 +2070,10 @@ int BLI_bvhtree_ray_cast_ex(const BVHTree *tree,
     data.hit.dist = BVH_RAYCAST_DIST_MAX;
   }
 
-  if (root) {
+  if (tree->wide_tree) {
+    bvhtree_wide_ray_cast(tree->wide_tree, &data.ray, &data.hit, callback, userdata, false);
+  }
+  else if (root) {
     dfs_raycast(&data, root);
     //      iterative_raycast(&data, root);
   }
@@ -2100,7 +2153,10 @@ void BLI_bvhtree_ray_cast_all_ex(const BVHTree *tree,
   data.hit.index = -1;
   data.hit.dist = hit_dist;
 
-  if (root) {
+  if (tree->wide_tree) {
+    bvhtree_wide_ray_cast(tree->wide_tree, &data.ray, &data.hit, callback, userdata, true);
+  }
+  else if (root) {
     dfs_raycast_all(&data, root);
   }
 }
@@ -2187,7 +2243,10 @@ int BLI_bvhtree_range_query(const BVHTree *tree,
   data.callback = callback;
   data.userdata = userdata;
 
-  if (root != NULL) {
+  if (tree->wide_tree) {
+    data.hits = bvhtree_wide_range_query(tree->wide_tree, co, data.radius_sq, callback, userdata);
+  }
+  else if (root != NULL) {
     float nearest[3];
     float dist_sq = calc_nearest_point_squared(data.center, root, nearest);
     if (dist_sq < data.radius_sq) {
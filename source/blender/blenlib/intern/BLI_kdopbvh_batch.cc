@@ -0,0 +1,208 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+#include <cfloat>
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_kdopbvh.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
+
+#include "BLI_kdopbvh_wide.h"
+
+namespace blender::kdopbvh {
+
+using kdopbvh_wide::PACKET_SIZE;
+
+/** Smaller batches are not sorted, sorting would cost more than it gains. */
+static constexpr int64_t SORT_QUERIES_MIN = 256;
+
+/** Spread the lower 10 bits of \a value so that there are two zero bits between all bits. */
+static uint32_t morton_expand_bits(uint32_t value)
+{
+  value = (value * 0x00010001u) & 0xFF0000FFu;
+  value = (value * 0x00000101u) & 0x0F00F00Fu;
+  value = (value * 0x00000011u) & 0xC30C30C3u;
+  value = (value * 0x00000005u) & 0x49249249u;
+  return value;
+}
+
+static uint32_t morton_quantize(const float value)
+{
+  const float scaled = value * 1023.0f;
+  /* Also handles NaN. */
+  if (!(scaled > 0.0f)) {
+    return 0;
+  }
+  return std::min(uint32_t(scaled), 1023u);
+}
+
+/**
+ * Sort the indices in \a mask along a Morton curve through \a positions, so that consecutive
+ * queries are close to each other. \a get_key_prefix adds more significant bits to the key,
+ * which groups queries with the same prefix together.
+ */
+template<typename PrefixFn>
+static Array<int> sort_queries(const IndexMask &mask,
+                               const Span<float3> positions,
+                               const PrefixFn &get_key_prefix)
+{
+  Array<int> indices(mask.size());
+  mask.to_indices<int>(indices);
+  if (mask.size() < SORT_QUERIES_MIN) {
+    return indices;
+  }
+
+  using MinMax = std::pair<float3, float3>;
+  const MinMax bounds = threading::parallel_reduce(
+      indices.index_range(),
+      4096,
+      MinMax(float3(FLT_MAX), float3(-FLT_MAX)),
+      [&](const IndexRange range, MinMax result) {
+        for (const int i : indices.as_span().slice(range)) {
+          result.first = math::min(result.first, positions[i]);
+          result.second = math::max(result.second, positions[i]);
+        }
+        return result;
+      },
+      [](const MinMax &a, const MinMax &b) {
+        return MinMax(math::min(a.first, b.first), math::max(a.second, b.second));
+      });
+  const float3 extent = bounds.second - bounds.first;
+  const float3 scale(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                     extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                     extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+  Array<std::pair<uint64_t, int>> keys(indices.size());
+  threading::parallel_for(indices.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const int index = indices[i];
+      const float3 normalized = (positions[index] - bounds.first) * scale;
+      const uint64_t code = morton_expand_bits(morton_quantize(normalized.x)) |
+                            (morton_expand_bits(morton_quantize(normalized.y)) << 1) |
+                            (morton_expand_bits(morton_quantize(normalized.z)) << 2);
+      keys[i] = {(uint64_t(get_key_prefix(index)) << 30) | code, index};
+    }
+  });
+  parallel_sort(keys.begin(), keys.end(), [](const auto &a, const auto &b) {
+    return a.first < b.first;
+  });
+
+  threading::parallel_for(indices.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      indices[i] = keys[i].second;
+    }
+  });
+  return indices;
+}
+
+void ray_cast_batch(const BVHTree &tree,
+                    const IndexMask &mask,
+                    const Span<float3> origins,
+                    const Span<float3> directions,
+                    const float radius,
+                    MutableSpan<BVHTreeRayHit> r_hits,
+                    BVHTree_RayCastCallback callback,
+                    void *userdata,
+                    const int flag)
+{
+  /* Rays going in different directions visit the tree in a different order, so rays are
+   * grouped by the octant of their direction first. */
+  const Array<int> order = sort_queries(mask, origins, [&](const int i) {
+    const float3 &direction = directions[i];
+    return int(direction.x < 0.0f) | (int(direction.y < 0.0f) << 1) |
+           (int(direction.z < 0.0f) << 2);
+  });
+
+  const BVHWideTree *wide_tree = bvhtree_wide_get(&tree);
+  threading::parallel_for(order.index_range(), 512, [&](const IndexRange range) {
+    for (int64_t start = range.first(); start < range.one_after_last(); start += PACKET_SIZE) {
+      const Span<int> packet = order.as_span().slice(
+          start, std::min<int64_t>(PACKET_SIZE, range.one_after_last() - start));
+      if (wide_tree == nullptr) {
+        for (const int i : packet) {
+          BLI_bvhtree_ray_cast_ex(
+              &tree, origins[i], directions[i], radius, &r_hits[i], callback, userdata, flag);
+        }
+        continue;
+      }
+
+      BVHTreeRay rays[PACKET_SIZE];
+      IsectRayPrecalc isect_precalc[PACKET_SIZE];
+      BVHTreeRayHit hits[PACKET_SIZE];
+      for (const int j : packet.index_range()) {
+        const int i = packet[j];
+        BLI_ASSERT_UNIT_V3(directions[i]);
+        copy_v3_v3(rays[j].origin, origins[i]);
+        copy_v3_v3(rays[j].direction, directions[i]);
+        rays[j].radius = radius;
+        if (flag & BVH_RAYCAST_WATERTIGHT) {
+          isect_ray_tri_watertight_v3_precalc(&isect_precalc[j], rays[j].direction);
+          rays[j].isect_precalc = &isect_precalc[j];
+        }
+        else {
+          rays[j].isect_precalc = nullptr;
+        }
+        hits[j] = r_hits[i];
+      }
+      kdopbvh_wide::ray_cast_packet(*wide_tree,
+                                    Span(rays, packet.size()),
+                                    MutableSpan(hits, packet.size()),
+                                    callback,
+                                    userdata);
+      for (const int j : packet.index_range()) {
+        r_hits[packet[j]] = hits[j];
+      }
+    }
+  });
+}
+
+void find_nearest_batch(const BVHTree &tree,
+                        const IndexMask &mask,
+                        const Span<float3> positions,
+                        MutableSpan<BVHTreeNearest> r_nearest,
+                        BVHTree_NearestPointCallback callback,
+                        void *userdata)
+{
+  const Array<int> order = sort_queries(mask, positions, [](const int /*i*/) { return 0; });
+
+  const BVHWideTree *wide_tree = bvhtree_wide_get(&tree);
+  threading::parallel_for(order.index_range(), 512, [&](const IndexRange range) {
+    for (int64_t start = range.first(); start < range.one_after_last(); start += PACKET_SIZE) {
+      const Span<int> packet = order.as_span().slice(
+          start, std::min<int64_t>(PACKET_SIZE, range.one_after_last() - start));
+      if (wide_tree == nullptr) {
+        for (const int i : packet) {
+          BLI_bvhtree_find_nearest(&tree, positions[i], &r_nearest[i], callback, userdata);
+        }
+        continue;
+      }
+
+      float3 packet_positions[PACKET_SIZE];
+      BVHTreeNearest nearest[PACKET_SIZE];
+      for (const int j : packet.index_range()) {
+        packet_positions[j] = positions[packet[j]];
+        nearest[j] = r_nearest[packet[j]];
+      }
+      kdopbvh_wide::find_nearest_packet(*wide_tree,
+                                        Span(packet_positions, packet.size()),
+                                        MutableSpan(nearest, packet.size()),
+                                        callback,
+                                        userdata);
+      for (const int j : packet.index_range()) {
+        r_nearest[packet[j]] = nearest[j];
+      }
+    }
+  });
+}
+
+}  // namespace blender::kdopbvh
@@ -0,0 +1,909 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Wide bounding volume hierarchy used to accelerate ray-cast, nearest and range queries on
+ * #BVHTree.
+ *
+ * The tree is built in two steps:
+ * - A binary tree is built top-down with a binned surface area heuristic (SAH). Sub-trees are
+ *   built in parallel, and every leaf of the binary tree contains a single primitive.
+ * - The binary tree is collapsed into nodes with up to four children by repeatedly opening the
+ *   child with the largest surface area.
+ *
+ * Wide nodes store the bounds of their children in a structure of arrays layout, so that a
+ * query can test all children of a node at once with SIMD instructions. Children are then
+ * visited in near to far order, which makes the pruning by the current hit distance much more
+ * effective than the fixed child order of the k-DOP tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
+#include "BLI_math_vector.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_simd.hh"
+#include "BLI_stack.hh"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "BLI_kdopbvh_wide.h"
+
+#include "BLI_strict_flags.h" /* Keep last. */
+
+namespace blender::kdopbvh_wide {
+
+/** Maximum number of children of a wide node. */
+static constexpr int WIDTH = 4;
+/** Number of bins per axis used to evaluate the surface area heuristic. */
+static constexpr int BIN_NUM = 16;
+/** Deeper nodes are split at the object median to bound the depth of degenerate trees. */
+static constexpr int SAH_DEPTH_MAX = 64;
+/** Sub-trees with fewer primitives are built on the current thread. */
+static constexpr int64_t PARALLEL_PRIMS_MIN = 4096;
+
+/** Axis aligned box in the same layout as the first axes of a k-DOP. */
+struct AABB {
+  float bv[6];
+
+  static AABB empty()
+  {
+    return {{FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX}};
+  }
+
+  void join(const AABB &other)
+  {
+    for (int axis = 0; axis < 3; axis++) {
+      bv[axis * 2] = std::min(bv[axis * 2], other.bv[axis * 2]);
+      bv[axis * 2 + 1] = std::max(bv[axis * 2 + 1], other.bv[axis * 2 + 1]);
+    }
+  }
+
+  void join(const float co[3])
+  {
+    for (int axis = 0; axis < 3; axis++) {
+      bv[axis * 2] = std::min(bv[axis * 2], co[axis]);
+      bv[axis * 2 + 1] = std::max(bv[axis * 2 + 1], co[axis]);
+    }
+  }
+
+  float extent(const int axis) const
+  {
+    return bv[axis * 2 + 1] - bv[axis * 2];
+  }
+
+  /** Half of the surface area, which is all the surface area heuristic needs. */
+  float half_area() const
+  {
+    const float x = std::max(this->extent(0), 0.0f);
+    const float y = std::max(this->extent(1), 0.0f);
+    const float z = std::max(this->extent(2), 0.0f);
+    return x * y + y * z + z * x;
+  }
+};
+
+struct PrimRef {
+  AABB bounds;
+  /** Index of the leaf in the k-DOP tree. */
+  int leaf;
+
+  float3 centroid() const
+  {
+    return float3(bounds.bv[0] + bounds.bv[1],
+                  bounds.bv[2] + bounds.bv[3],
+                  bounds.bv[4] + bounds.bv[5]) *
+           0.5f;
+  }
+};
+
+struct BinaryNode {
+  AABB bounds;
+  /** Both children are -1 for leaves. */
+  int children[2];
+  /** Position of the primitive in the sorted primitive array, only used for leaves. */
+  int prim;
+
+  bool is_leaf() const
+  {
+    return children[0] == -1;
+  }
+};
+
+/** The bounds and centroid bounds of a range of primitives. */
+struct RangeBounds {
+  AABB bounds = AABB::empty();
+  AABB centroid_bounds = AABB::empty();
+};
+
+struct Bins {
+  int count[3][BIN_NUM];
+  AABB bounds[3][BIN_NUM];
+
+  Bins()
+  {
+    for (int axis = 0; axis < 3; axis++) {
+      for (int bin = 0; bin < BIN_NUM; bin++) {
+        count[axis][bin] = 0;
+        bounds[axis][bin] = AABB::empty();
+      }
+    }
+  }
+
+  void join(const Bins &other)
+  {
+    for (int axis = 0; axis < 3; axis++) {
+      for (int bin = 0; bin < BIN_NUM; bin++) {
+        count[axis][bin] += other.count[axis][bin];
+        bounds[axis][bin].join(other.bounds[axis][bin]);
+      }
+    }
+  }
+};
+
+struct alignas(16) WideNode {
+  /** Bounds of all children, the first index is the k-DOP bound index (min-x, max-x, ...). */
+  float bounds[6][WIDTH];
+  /**
+   * Index of a child wide node when positive, otherwise the primitive at `-(child + 1)` in the
+   * sorted primitive arrays.
+   */
+  int children[WIDTH];
+  int children_num;
+};
+
+}  // namespace blender::kdopbvh_wide
+
+struct BVHWideTree {
+  blender::Vector<blender::kdopbvh_wide::WideNode> nodes;
+  /** Bounds of every primitive, sorted in the order of the tree. */
+  blender::Array<blender::kdopbvh_wide::AABB> prim_bounds;
+  /** Index passed to callbacks for every primitive, sorted in the order of the tree. */
+  blender::Array<int> prim_indices;
+};
+
+namespace blender::kdopbvh_wide {
+
+/* -------------------------------------------------------------------- */
+/** \name Build
+ * \{ */
+
+class BinaryTreeBuilder {
+ private:
+  /** Primitives that are sorted while building the tree. */
+  MutableSpan<PrimRef> refs_;
+  Array<BinaryNode> nodes_;
+  std::atomic<int> nodes_num_ = 0;
+
+ public:
+  BinaryTreeBuilder(MutableSpan<PrimRef> refs) : refs_(refs)
+  {
+    /* A binary tree with one primitive per leaf has `2 * n - 1` nodes. */
+    nodes_.reinitialize(std::max<int64_t>(refs.size() * 2 - 1, 1));
+  }
+
+  Span<BinaryNode> nodes() const
+  {
+    return nodes_.as_span().take_front(nodes_num_.load());
+  }
+
+  int build(const IndexRange range, const int depth)
+  {
+    const int node_index = nodes_num_.fetch_add(1, std::memory_order_relaxed);
+    BinaryNode &node = nodes_[node_index];
+    node.children[0] = -1;
+    node.children[1] = -1;
+
+    if (range.size() == 1) {
+      node.bounds = refs_[range.first()].bounds;
+      node.prim = int(range.first());
+      return node_index;
+    }
+
+    const RangeBounds range_bounds = this->compute_bounds(range);
+    node.bounds = range_bounds.bounds;
+
+    const int64_t mid = this->split(range, range_bounds.centroid_bounds, depth);
+    const IndexRange left_range = range.take_front(mid - range.first());
+    const IndexRange right_range = range.drop_front(mid - range.first());
+
+    int left, right;
+    threading::parallel_invoke(
+        range.size() >= PARALLEL_PRIMS_MIN,
+        [&]() { left = this->build(left_range, depth + 1); },
+        [&]() { right = this->build(right_range, depth + 1); });
+    node.children[0] = left;
+    node.children[1] = right;
+    return node_index;
+  }
+
+ private:
+  RangeBounds compute_bounds(const IndexRange range) const
+  {
+    return threading::parallel_reduce(
+        range,
+        PARALLEL_PRIMS_MIN,
+        RangeBounds(),
+        [&](const IndexRange sub_range, RangeBounds result) {
+          for (const PrimRef &ref : refs_.slice(sub_range)) {
+            result.bounds.join(ref.bounds);
+            result.centroid_bounds.join(ref.centroid());
+          }
+          return result;
+        },
+        [](RangeBounds a, const RangeBounds &b) {
+          a.bounds.join(b.bounds);
+          a.centroid_bounds.join(b.centroid_bounds);
+          return a;
+        });
+  }
+
+  /**
+   * Reorder the primitives in the range so that they are split into two non-empty parts.
+   * \return The index of the first primitive of the second part.
+   */
+  int64_t split(const IndexRange range, const AABB &centroid_bounds, const int depth)
+  {
+    int largest_axis = 0;
+    for (int axis = 1; axis < 3; axis++) {
+      if (centroid_bounds.extent(axis) > centroid_bounds.extent(largest_axis)) {
+        largest_axis = axis;
+      }
+    }
+
+    if (!(centroid_bounds.extent(largest_axis) > 0.0f)) {
+      /* All centroids are at the same position, any split is as good as another. */
+      return range.first() + range.size() / 2;
+    }
+
+    if (depth < SAH_DEPTH_MAX) {
+      const int64_t mid = this->split_sah(range, centroid_bounds);
+      if (mid != -1) {
+        return mid;
+      }
+    }
+
+    /* Object median split, which guarantees a balanced tree. */
+    const int64_t mid = range.first() + range.size() / 2;
+    std::nth_element(refs_.begin() + range.first(),
+                     refs_.begin() + mid,
+                     refs_.begin() + range.one_after_last(),
+                     [&](const PrimRef &a, const PrimRef &b) {
+                       return a.centroid()[largest_axis] < b.centroid()[largest_axis];
+                     });
+    return mid;
+  }
+
+  int64_t split_sah(const IndexRange range, const AABB &centroid_bounds)
+  {
+    float scale[3];
+    for (int axis = 0; axis < 3; axis++) {
+      const float extent = centroid_bounds.extent(axis);
+      scale[axis] = extent > 0.0f ? float(BIN_NUM) * (1.0f - 1e-6f) / extent : 0.0f;
+    }
+    auto bin_index = [&](const float3 &centroid, const int axis) {
+      const int bin = int((centroid[axis] - centroid_bounds.bv[axis * 2]) * scale[axis]);
+      return std::clamp(bin, 0, BIN_NUM - 1);
+    };
+
+    const Bins bins = threading::parallel_reduce(
+        range,
+        PARALLEL_PRIMS_MIN,
+        Bins(),
+        [&](const IndexRange sub_range, Bins result) {
+          for (const PrimRef &ref : refs_.slice(sub_range)) {
+            const float3 centroid = ref.centroid();
+            for (int axis = 0; axis < 3; axis++) {
+              const int bin = bin_index(centroid, axis);
+              result.count[axis][bin]++;
+              result.bounds[axis][bin].join(ref.bounds);
+            }
+          }
+          return result;
+        },
+        [](Bins a, const Bins &b) {
+          a.join(b);
+          return a;
+        });
+
+    float best_cost = FLT_MAX;
+    int best_axis = -1;
+    int best_bin = -1;
+    for (int axis = 0; axis < 3; axis++) {
+      if (scale[axis] == 0.0f) {
+        continue;
+      }
+      /* Cost of the primitives right of every split, the split is between `bin - 1` and `bin`. */
+      float right_cost[BIN_NUM];
+      AABB right_bounds = AABB::empty();
+      int right_count = 0;
+      for (int bin = BIN_NUM - 1; bin > 0; bin--) {
+        right_bounds.join(bins.bounds[axis][bin]);
+        right_count += bins.count[axis][bin];
+        right_cost[bin] = right_count == 0 ? -1.0f : float(right_count) * right_bounds.half_area();
+      }
+      AABB left_bounds = AABB::empty();
+      int left_count = 0;
+      for (int bin = 1; bin < BIN_NUM; bin++) {
+        left_bounds.join(bins.bounds[axis][bin - 1]);
+        left_count += bins.count[axis][bin - 1];
+        if (left_count == 0 || right_cost[bin] < 0.0f) {
+          continue;
+        }
+        const float cost = float(left_count) * left_bounds.half_area() + right_cost[bin];
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_axis = axis;
+          best_bin = bin;
+        }
+      }
+    }
+
+    if (best_axis == -1) {
+      return -1;
+    }
+
+    PrimRef *first = refs_.begin() + range.first();
+    PrimRef *last = refs_.begin() + range.one_after_last();
+    const PrimRef *mid = std::partition(first, last, [&](const PrimRef &ref) {
+      return bin_index(ref.centroid(), best_axis) < best_bin;
+    });
+    return range.first() + (mid - first);
+  }
+};
+
+/**
+ * Collapse the binary tree into wide nodes. The nodes are stored in depth first order, so that
+ * nodes close in the tree are close in memory as well.
+ */
+static void collapse_binary_tree(const Span<BinaryNode> binary_nodes,
+                                 const int binary_root,
+                                 Vector<WideNode> &r_nodes)
+{
+  struct PendingNode {
+    int binary_node;
+    int parent;
+    int slot;
+  };
+  Stack<PendingNode> pending;
+  pending.push({binary_root, -1, 0});
+
+  while (!pending.is_empty()) {
+    const PendingNode item = pending.pop();
+
+    int slots[WIDTH];
+    int slots_num = 0;
+    const BinaryNode &binary_node = binary_nodes[item.binary_node];
+    if (binary_node.is_leaf()) {
+      /* Only happens for the root of trees with a single primitive. */
+      slots[slots_num++] = item.binary_node;
+    }
+    else {
+      slots[slots_num++] = binary_node.children[0];
+      slots[slots_num++] = binary_node.children[1];
+    }
+
+    /* Pull in grandchildren until the node is full, opening the largest children first. */
+    while (slots_num < WIDTH) {
+      int largest_slot = -1;
+      float largest_area = -1.0f;
+      for (int i = 0; i < slots_num; i++) {
+        const BinaryNode &child = binary_nodes[slots[i]];
+        if (!child.is_leaf() && child.bounds.half_area() > largest_area) {
+          largest_area = child.bounds.half_area();
+          largest_slot = i;
+        }
+      }
+      if (largest_slot == -1) {
+        break;
+      }
+      const BinaryNode &child = binary_nodes[slots[largest_slot]];
+      slots[largest_slot] = child.children[0];
+      slots[slots_num++] = child.children[1];
+    }
+
+    const int node_index = int(r_nodes.append_and_get_index({}));
+    if (item.parent != -1) {
+      r_nodes[item.parent].children[item.slot] = node_index;
+    }
+    WideNode &node = r_nodes[node_index];
+    node.children_num = slots_num;
+    for (int i = 0; i < WIDTH; i++) {
+      if (i < slots_num) {
+        const BinaryNode &child = binary_nodes[slots[i]];
+        for (int bound = 0; bound < 6; bound++) {
+          node.bounds[bound][i] = child.bounds.bv[bound];
+        }
+        if (child.is_leaf()) {
+          node.children[i] = -(child.prim + 1);
+        }
+        else {
+          node.children[i] = -1;
+          pending.push({slots[i], node_index, i});
+        }
+      }
+      else {
+        /* Unused lanes are masked out by the queries, they only need finite values. */
+        for (int bound = 0; bound < 6; bound++) {
+          node.bounds[bound][i] = 0.0f;
+        }
+        node.children[i] = -1;
+      }
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Child Tests
+ *
+ * Every test computes a distance for all children of a node and returns a bit mask of the
+ * children that have to be visited.
+ * \{ */
+
+struct RayPrecalc {
+  float origin[3];
+  float idot_axis[3];
+  float radius;
+};
+
+static int ray_test_children(const WideNode &node,
+                             const RayPrecalc &ray,
+                             const float dist_max,
+                             float r_dist[WIDTH])
+{
+  const int valid_mask = (1 << node.children_num) - 1;
+#if BLI_HAVE_SSE2
+  const __m128 radius = _mm_set1_ps(ray.radius);
+  const __m128 zero = _mm_setzero_ps();
+  __m128 tmin = _mm_set1_ps(-FLT_MAX);
+  __m128 tmax = _mm_set1_ps(FLT_MAX);
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 origin = _mm_set1_ps(ray.origin[axis]);
+    const __m128 idot = _mm_set1_ps(ray.idot_axis[axis]);
+    const __m128 low = _mm_sub_ps(_mm_load_ps(node.bounds[axis * 2]), radius);
+    const __m128 high = _mm_add_ps(_mm_load_ps(node.bounds[axis * 2 + 1]), radius);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(low, origin), idot);
+    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(high, origin), idot);
+    tmin = _mm_max_ps(tmin, _mm_min_ps(t1, t2));
+    tmax = _mm_min_ps(tmax, _mm_max_ps(t1, t2));
+  }
+  /* Rays with a radius start at their origin, like #ray_nearest_hit in the k-DOP tree. */
+  const __m128 tnear = ray.radius != 0.0f ? _mm_max_ps(tmin, zero) : tmin;
+  const __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(tmin, tmax), _mm_cmpge_ps(tmax, zero)),
+                                _mm_cmplt_ps(tnear, _mm_set1_ps(dist_max)));
+  _mm_storeu_ps(r_dist, tnear);
+  return _mm_movemask_ps(hit) & valid_mask;
+#else
+  int mask = 0;
+  for (int i = 0; i < node.children_num; i++) {
+    float tmin = -FLT_MAX;
+    float tmax = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+      const float low = node.bounds[axis * 2][i] - ray.radius;
+      const float high = node.bounds[axis * 2 + 1][i] + ray.radius;
+      const float t1 = (low - ray.origin[axis]) * ray.idot_axis[axis];
+      const float t2 = (high - ray.origin[axis]) * ray.idot_axis[axis];
+      tmin = std::max(tmin, std::min(t1, t2));
+      tmax = std::min(tmax, std::max(t1, t2));
+    }
+    const float tnear = ray.radius != 0.0f ? std::max(tmin, 0.0f) : tmin;
+    r_dist[i] = tnear;
+    if (tmin <= tmax && tmax >= 0.0f && tnear < dist_max) {
+      mask |= 1 << i;
+    }
+  }
+  return mask & valid_mask;
+#endif
+}
+
+static int point_test_children(const WideNode &node,
+                               const float co[3],
+                               const float dist_sq_max,
+                               float r_dist_sq[WIDTH])
+{
+  const int valid_mask = (1 << node.children_num) - 1;
+#if BLI_HAVE_SSE2
+  const __m128 zero = _mm_setzero_ps();
+  __m128 dist_sq = zero;
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 co_axis = _mm_set1_ps(co[axis]);
+    const __m128 below = _mm_sub_ps(_mm_load_ps(node.bounds[axis * 2]), co_axis);
+    const __m128 above = _mm_sub_ps(co_axis, _mm_load_ps(node.bounds[axis * 2 + 1]));
+    const __m128 delta = _mm_max_ps(_mm_max_ps(below, above), zero);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(delta, delta));
+  }
+  _mm_storeu_ps(r_dist_sq, dist_sq);
+  return _mm_movemask_ps(_mm_cmplt_ps(dist_sq, _mm_set1_ps(dist_sq_max))) & valid_mask;
+#else
+  int mask = 0;
+  for (int i = 0; i < node.children_num; i++) {
+    float dist_sq = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float below = node.bounds[axis * 2][i] - co[axis];
+      const float above = co[axis] - node.bounds[axis * 2 + 1][i];
+      const float delta = std::max(std::max(below, above), 0.0f);
+      dist_sq += delta * delta;
+    }
+    r_dist_sq[i] = dist_sq;
+    if (dist_sq < dist_sq_max) {
+      mask |= 1 << i;
+    }
+  }
+  return mask & valid_mask;
+#endif
+}
+
+/** Fill \a r_order with the children in \a mask, sorted by increasing distance. */
+static int sort_children(const int mask, const float dist[WIDTH], int r_order[WIDTH])
+{
+  int order_num = 0;
+  for (int i = 0; i < WIDTH; i++) {
+    if ((mask & (1 << i)) == 0) {
+      continue;
+    }
+    int j = order_num++;
+    for (; j > 0 && dist[r_order[j - 1]] > dist[i]; j--) {
+      r_order[j] = r_order[j - 1];
+    }
+    r_order[j] = i;
+  }
+  return order_num;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Queries
+ * \{ */
+
+struct StackItem {
+  int node;
+  float dist;
+};
+
+/**
+ * Generic near to far traversal. \a test_children computes the distance of all children of a
+ * node and \a dist_max returns the current pruning distance, which may shrink while traversing.
+ * \a leaf_fn is called for every primitive that is closer than that distance.
+ */
+template<typename TestFn, typename DistMaxFn, typename LeafFn>
+static void traverse_sorted(const BVHWideTree &tree,
+                            const TestFn &test_children,
+                            const DistMaxFn &dist_max,
+                            const LeafFn &leaf_fn)
+{
+  Stack<StackItem, 64> stack;
+  stack.push({0, -FLT_MAX});
+  while (!stack.is_empty()) {
+    const StackItem item = stack.pop();
+    if (item.dist >= dist_max()) {
+      continue;
+    }
+    const WideNode &node = tree.nodes[item.node];
+    float dist[WIDTH];
+    const int mask = test_children(node, dist_max(), dist);
+    int order[WIDTH];
+    const int order_num = sort_children(mask, dist, order);
+
+    int inner[WIDTH];
+    int inner_num = 0;
+    for (int i = 0; i < order_num; i++) {
+      const int child = node.children[order[i]];
+      if (child < 0) {
+        /* The distance may have become smaller since the child was tested. */
+        if (dist[order[i]] < dist_max()) {
+          leaf_fn(-(child + 1), dist[order[i]]);
+        }
+      }
+      else {
+        inner[inner_num++] = order[i];
+      }
+    }
+    /* Push the farthest child first so that the nearest one is visited next. */
+    for (int i = inner_num - 1; i >= 0; i--) {
+      stack.push({node.children[inner[i]], dist[inner[i]]});
+    }
+  }
+}
+
+static RayPrecalc ray_precalc(const BVHTreeRay &ray)
+{
+  RayPrecalc precalc;
+  copy_v3_v3(precalc.origin, ray.origin);
+  precalc.radius = ray.radius;
+  for (int axis = 0; axis < 3; axis++) {
+    /* Match #bvhtree_ray_cast_data_precalc, axis aligned rays use a very large inverse. */
+    precalc.idot_axis[axis] = fabsf(ray.direction[axis]) < FLT_EPSILON ?
+                                  FLT_MAX :
+                                  1.0f / ray.direction[axis];
+  }
+  return precalc;
+}
+
+static void ray_hit_prim(const BVHWideTree &tree,
+                         const int prim,
+                         const float dist,
+                         const BVHTreeRay &ray,
+                         BVHTreeRayHit &hit,
+                         BVHTree_RayCastCallback callback,
+                         void *userdata,
+                         const bool cast_all)
+{
+  const int index = tree.prim_indices[prim];
+  if (cast_all) {
+    /* Using 'all' only makes sense with a callback. */
+    const float hit_dist = hit.dist;
+    callback(userdata, index, &ray, &hit);
+    hit.index = -1;
+    hit.dist = hit_dist;
+  }
+  else if (callback) {
+    callback(userdata, index, &ray, &hit);
+  }
+  else {
+    hit.index = index;
+    hit.dist = dist;
+    madd_v3_v3v3fl(hit.co, ray.origin, ray.direction, dist);
+  }
+}
+
+static void nearest_prim(const BVHWideTree &tree,
+                         const int prim,
+                         const float dist_sq,
+                         const float co[3],
+                         BVHTreeNearest &nearest,
+                         BVHTree_NearestPointCallback callback,
+                         void *userdata)
+{
+  const int index = tree.prim_indices[prim];
+  if (callback) {
+    callback(userdata, index, co, &nearest);
+  }
+  else {
+    const AABB &bounds = tree.prim_bounds[prim];
+    for (int axis = 0; axis < 3; axis++) {
+      nearest.co[axis] = std::clamp(co[axis], bounds.bv[axis * 2], bounds.bv[axis * 2 + 1]);
+    }
+    nearest.index = index;
+    nearest.dist_sq = dist_sq;
+  }
+}
+
+/**
+ * Traverse the tree for a packet of queries at once. Every node is fetched once for all queries
+ * that still have to visit it, and children are visited in near to far order of the closest
+ * query. The callbacks are the same as in #traverse_sorted, with an additional query index.
+ */
+template<typename TestFn, typename DistMaxFn, typename LeafFn>
+static void traverse_packet(const BVHWideTree &tree,
+                            const int queries_num,
+                            const TestFn &test_children,
+                            const DistMaxFn &dist_max,
+                            const LeafFn &leaf_fn)
+{
+  static_assert(PACKET_SIZE <= 32, "Query masks are stored in 32 bit integers");
+  BLI_assert(queries_num > 0 && queries_num <= PACKET_SIZE);
+
+  struct PacketStackItem {
+    int node;
+    uint32_t queries_mask;
+  };
+  Stack<PacketStackItem, 64> stack;
+  stack.push({0, uint32_t((uint64_t(1) << queries_num) - 1)});
+  while (!stack.is_empty()) {
+    const PacketStackItem item = stack.pop();
+    const WideNode &node = tree.nodes[item.node];
+
+    float dist[PACKET_SIZE][WIDTH];
+    uint32_t child_queries[WIDTH] = {0, 0, 0, 0};
+    float child_dist[WIDTH] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+    for (int query = 0; query < queries_num; query++) {
+      if ((item.queries_mask & (uint32_t(1) << query)) == 0) {
+        continue;
+      }
+      const int mask = test_children(query, node, dist_max(query), dist[query]);
+      for (int i = 0; i < WIDTH; i++) {
+        if (mask & (1 << i)) {
+          child_queries[i] |= uint32_t(1) << query;
+          child_dist[i] = std::min(child_dist[i], dist[query][i]);
+        }
+      }
+    }
+
+    int children_mask = 0;
+    for (int i = 0; i < WIDTH; i++) {
+      if (child_queries[i] != 0) {
+        children_mask |= 1 << i;
+      }
+    }
+    int order[WIDTH];
+    const int order_num = sort_children(children_mask, child_dist, order);
+
+    int inner[WIDTH];
+    int inner_num = 0;
+    for (int i = 0; i < order_num; i++) {
+      const int lane = order[i];
+      const int child = node.children[lane];
+      if (child < 0) {
+        for (int query = 0; query < queries_num; query++) {
+          /* The distance may have become smaller since the child was tested. */
+          if ((child_queries[lane] & (uint32_t(1) << query)) &&
+              dist[query][lane] < dist_max(query))
+          {
+            leaf_fn(query, -(child + 1), dist[query][lane]);
+          }
+        }
+      }
+      else {
+        inner[inner_num++] = lane;
+      }
+    }
+    /* Push the farthest child first so that the nearest one is visited next. */
+    for (int i = inner_num - 1; i >= 0; i--) {
+      stack.push({node.children[inner[i]], child_queries[inner[i]]});
+    }
+  }
+}
+
+void ray_cast_packet(const BVHWideTree &tree,
+                     const Span<BVHTreeRay> rays,
+                     MutableSpan<BVHTreeRayHit> hits,
+                     BVHTree_RayCastCallback callback,
+                     void *userdata)
+{
+  BLI_assert(rays.size() == hits.size());
+  RayPrecalc precalc[PACKET_SIZE];
+  for (const int64_t i : rays.index_range()) {
+    precalc[i] = ray_precalc(rays[i]);
+  }
+  traverse_packet(
+      tree,
+      int(rays.size()),
+      [&](const int ray, const WideNode &node, const float dist_max, float r_dist[WIDTH]) {
+        return ray_test_children(node, precalc[ray], dist_max, r_dist);
+      },
+      [&](const int ray) { return hits[ray].dist; },
+      [&](const int ray, const int prim, const float dist) {
+        ray_hit_prim(tree, prim, dist, rays[ray], hits[ray], callback, userdata, false);
+      });
+}
+
+void find_nearest_packet(const BVHWideTree &tree,
+                         const Span<float3> positions,
+                         MutableSpan<BVHTreeNearest> nearest,
+                         BVHTree_NearestPointCallback callback,
+                         void *userdata)
+{
+  BLI_assert(positions.size() == nearest.size());
+  traverse_packet(
+      tree,
+      int(positions.size()),
+      [&](const int query, const WideNode &node, const float dist_max, float r_dist[WIDTH]) {
+        return point_test_children(node, positions[query], dist_max, r_dist);
+      },
+      [&](const int query) { return nearest[query].dist_sq; },
+      [&](const int query, const int prim, const float dist_sq) {
+        nearest_prim(tree, prim, dist_sq, positions[query], nearest[query], callback, userdata);
+      });
+}
+
+}  // namespace blender::kdopbvh_wide
+
+using namespace blender;
+using namespace blender::kdopbvh_wide;
+
+BVHWideTree *bvhtree_wide_build(const float (*leaf_bounds)[6],
+                                const int *leaf_indices,
+                                const int leaf_num)
+{
+  BLI_assert(leaf_num > 0);
+  Array<PrimRef> refs(leaf_num);
+  threading::parallel_for(refs.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      memcpy(refs[i].bounds.bv, leaf_bounds[i], sizeof(refs[i].bounds.bv));
+      refs[i].leaf = int(i);
+    }
+  });
+
+  BinaryTreeBuilder builder(refs);
+  const int binary_root = builder.build(IndexRange(leaf_num), 0);
+
+  BVHWideTree *tree = MEM_new<BVHWideTree>(__func__);
+  /* A tree with four children per node has at most `(n - 1) / 3` inner nodes. */
+  tree->nodes.reserve(std::max(1, (leaf_num - 1) / 3 + 1));
+  collapse_binary_tree(builder.nodes(), binary_root, tree->nodes);
+
+  tree->prim_bounds.reinitialize(leaf_num);
+  tree->prim_indices.reinitialize(leaf_num);
+  threading::parallel_for(refs.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      tree->prim_bounds[i] = refs[i].bounds;
+      tree->prim_indices[i] = leaf_indices[refs[i].leaf];
+    }
+  });
+  return tree;
+}
+
+void bvhtree_wide_free(BVHWideTree *wide_tree)
+{
+  MEM_delete(wide_tree);
+}
+
+void bvhtree_wide_ray_cast(const BVHWideTree *wide_tree,
+                           const BVHTreeRay *ray,
+                           BVHTreeRayHit *hit,
+                           BVHTree_RayCastCallback callback,
+                           void *userdata,
+                           const bool cast_all)
+{
+  const RayPrecalc precalc = ray_precalc(*ray);
+  traverse_sorted(
+      *wide_tree,
+      [&](const WideNode &node, const float dist_max, float r_dist[WIDTH]) {
+        return ray_test_children(node, precalc, dist_max, r_dist);
+      },
+      [&]() { return hit->dist; },
+      [&](const int prim, const float dist) {
+        ray_hit_prim(*wide_tree, prim, dist, *ray, *hit, callback, userdata, cast_all);
+      });
+}
+
+void bvhtree_wide_find_nearest(const BVHWideTree *wide_tree,
+                               const float co[3],
+                               BVHTreeNearest *nearest,
+                               BVHTree_NearestPointCallback callback,
+                               void *userdata)
+{
+  traverse_sorted(
+      *wide_tree,
+      [&](const WideNode &node, const float dist_max, float r_dist[WIDTH]) {
+        return point_test_children(node, co, dist_max, r_dist);
+      },
+      [&]() { return nearest->dist_sq; },
+      [&](const int prim, const float dist_sq) {
+        nearest_prim(*wide_tree, prim, dist_sq, co, *nearest, callback, userdata);
+      });
+}
+
+int bvhtree_wide_range_query(const BVHWideTree *wide_tree,
+                             const float co[3],
+                             const float radius_sq,
+                             BVHTree_RangeQuery callback,
+                             void *userdata)
+{
+  int hits = 0;
+  Stack<int, 64> stack;
+  stack.push(0);
+  while (!stack.is_empty()) {
+    const WideNode &node = wide_tree->nodes[stack.pop()];
+    float dist_sq[WIDTH];
+    const int mask = point_test_children(node, co, radius_sq, dist_sq);
+    for (int i = 0; i < node.children_num; i++) {
+      if ((mask & (1 << i)) == 0) {
+        continue;
+      }
+      const int child = node.children[i];
+      if (child < 0) {
+        hits++;
+        callback(userdata, wide_tree->prim_indices[-(child + 1)], co, dist_sq[i]);
+      }
+      else {
+        stack.push(child);
+      }
+    }
+  }
+  return hits;
+}
+
+/** \} */
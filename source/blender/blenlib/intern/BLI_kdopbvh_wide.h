@@ -0,0 +1,85 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Private API of the wide bounding volume hierarchy that #BVHTree can build in addition to its
+ * k-DOP nodes, see #BVH_BALANCE_WIDE.
+ */
+
+#include "BLI_kdopbvh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BVHWideTree BVHWideTree;
+
+/** \return The wide tree of \a tree, or null when it has not been built. */
+const BVHWideTree *bvhtree_wide_get(const BVHTree *tree);
+
+/**
+ * Build the wide tree from the axis aligned bounds of all leaves.
+ *
+ * \param leaf_bounds: Bounds in the k-DOP layout: minimum and maximum on the X, Y and Z axis.
+ * \param leaf_indices: Index that is passed to callbacks for every leaf.
+ */
+BVHWideTree *bvhtree_wide_build(const float (*leaf_bounds)[6],
+                                const int *leaf_indices,
+                                int leaf_num);
+void bvhtree_wide_free(BVHWideTree *wide_tree);
+
+/**
+ * Same behavior as the k-DOP ray-cast. When \a cast_all is true, the hit distance is restored
+ * after every callback, like #BLI_bvhtree_ray_cast_all.
+ */
+void bvhtree_wide_ray_cast(const BVHWideTree *wide_tree,
+                           const BVHTreeRay *ray,
+                           BVHTreeRayHit *hit,
+                           BVHTree_RayCastCallback callback,
+                           void *userdata,
+                           bool cast_all);
+void bvhtree_wide_find_nearest(const BVHWideTree *wide_tree,
+                               const float co[3],
+                               BVHTreeNearest *nearest,
+                               BVHTree_NearestPointCallback callback,
+                               void *userdata);
+int bvhtree_wide_range_query(const BVHWideTree *wide_tree,
+                             const float co[3],
+                             float radius_sq,
+                             BVHTree_RangeQuery callback,
+                             void *userdata);
+
+#ifdef __cplusplus
+}
+
+#  include "BLI_math_vector_types.hh"
+#  include "BLI_span.hh"
+
+namespace blender::kdopbvh_wide {
+
+/** Maximum number of queries that are traversed together. */
+constexpr int PACKET_SIZE = 8;
+
+/**
+ * Cast up to #PACKET_SIZE rays with a single traversal. Rays in a packet should be coherent,
+ * otherwise this is slower than casting them one by one.
+ */
+void ray_cast_packet(const BVHWideTree &tree,
+                     Span<BVHTreeRay> rays,
+                     MutableSpan<BVHTreeRayHit> hits,
+                     BVHTree_RayCastCallback callback,
+                     void *userdata);
+/** Find the nearest primitive for up to #PACKET_SIZE positions with a single traversal. */
+void find_nearest_packet(const BVHWideTree &tree,
+                         Span<float3> positions,
+                         MutableSpan<BVHTreeNearest> nearest,
+                         BVHTree_NearestPointCallback callback,
+                         void *userdata);
+
+}  // namespace blender::kdopbvh_wide
+#endif
@@ -11,9 +11,51 @@
 
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+/**
+ * Number of decompressed frames that are kept around. Reading data blocks on demand seeks back
+ * and forth between the block and the current position in the file, so caching a single frame
+ * would decompress the same frames over and over again.
+ */
+#define ZSTD_SEEK_CACHE_FRAMES 4
+/** Upper limit for the number of frames that are decompressed ahead of the reading position. */
+#define ZSTD_READ_AHEAD_MAX_FRAMES 32
+
+typedef enum eZstdFrameState {
+  /** The content is decompressed (or the entry is unused when the frame is -1). */
+  ZSTD_FRAME_READY = 0,
+  /** The compressed data is loaded and waits to be decompressed by a task. */
+  ZSTD_FRAME_QUEUED,
+  /** The frame is being decompressed, either by a task or by the reading thread. */
+  ZSTD_FRAME_DECOMPRESSING,
+  ZSTD_FRAME_FAILED,
+} eZstdFrameState;
+
+typedef struct ZstdCachedFrame {
+  /** Index of the cached frame, -1 when unused. */
+  int frame;
+  /** #eZstdFrameState, changed atomically when frames are read ahead. */
+  int32_t state;
+  /** Counter value of the last read, the least recently used frame is replaced first. */
+  uint64_t last_use;
+  char *content;
+  /** Allocated size of #content, which can be larger than the frame. */
+  size_t content_size;
+
+  /** Compressed data and decompression context for frames that are read ahead. */
+  char *compressed;
+  size_t compressed_size;
+  size_t compressed_alloc_size;
+  ZSTD_DCtx *ctx;
+  size_t uncompressed_size;
+} ZstdCachedFrame;
+
 typedef struct {
   FileReader reader;
 
@@ -28,8 +70,21 @@ typedef struct {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
-    char *cached_content;
-    int cached_frame;
+    ZstdCachedFrame *cache;
+    int cache_num;
+    uint64_t use_counter;
+
+    /** Reused buffer for the compressed data of a frame. */
+    char *compressed_buf;
+    size_t compressed_buf_size;
+
+    /** Frame that was read last, read-ahead is started when reading moves forward. */
+    int last_frame;
+    /** Number of frames decompressed ahead of the reading position, zero when disabled. */
+    int read_ahead_num;
+    TaskPool *task_pool;
+    ThreadMutex mutex;
+    ThreadCondition condition;
   } seek;
 } ZstdReader;
 
@@ -125,7 +180,12 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
     return false;
   }
 
-  zstd->seek.cached_frame = -1;
+  zstd->seek.cache_num = ZSTD_SEEK_CACHE_FRAMES;
+  zstd->seek.cache = MEM_calloc_arrayN(zstd->seek.cache_num, sizeof(ZstdCachedFrame), __func__);
+  for (int i = 0; i < zstd->seek.cache_num; i++) {
+    zstd->seek.cache[i].frame = -1;
+  }
+  zstd->seek.last_frame = -1;
 
   return true;
 }
@@ -153,42 +213,209 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
-static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+static size_t zstd_frame_uncompressed_size(const ZstdReader *zstd, int frame)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  return zstd->seek.uncompressed_ofs[frame + 1] - zstd->seek.uncompressed_ofs[frame];
+}
+
+/* Read the compressed data of the given frame into `*buf`, growing it when needed. */
+static bool zstd_read_compressed_frame(ZstdReader *zstd,
+                                       int frame,
+                                       char **buf,
+                                       size_t *buf_size,
+                                       size_t *r_compressed_size)
+{
+  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+  if (*buf_size < compressed_size) {
+    MEM_SAFE_FREE(*buf);
+    *buf = MEM_mallocN(compressed_size, __func__);
+    *buf_size = compressed_size;
   }
+  *r_compressed_size = compressed_size;
+  return zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) >= 0 &&
+         zstd->base->read(zstd->base, *buf, compressed_size) == compressed_size;
+}
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
-  MEM_SAFE_FREE(zstd->seek.cached_content);
+static bool zstd_decompress_data(
+    ZSTD_DCtx *ctx, char *dst, size_t dst_size, const char *src, size_t src_size)
+{
+  size_t res = ZSTD_decompressDCtx(ctx, dst, dst_size, src, src_size);
+  return !ZSTD_isError(res) && res == dst_size;
+}
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
-                             zstd->seek.uncompressed_ofs[frame];
+/* Decompress the given frame into `dst`, which must fit the whole frame. */
+static bool zstd_decompress_frame(ZstdReader *zstd, int frame, char *dst)
+{
+  size_t compressed_size;
+  if (!zstd_read_compressed_frame(zstd,
+                                  frame,
+                                  &zstd->seek.compressed_buf,
+                                  &zstd->seek.compressed_buf_size,
+                                  &compressed_size))
+  {
+    return false;
+  }
+  return zstd_decompress_data(zstd->ctx,
+                              dst,
+                              zstd_frame_uncompressed_size(zstd, frame),
+                              zstd->seek.compressed_buf,
+                              compressed_size);
+}
+
+static ZstdCachedFrame *zstd_find_cache(ZstdReader *zstd, int frame)
+{
+  for (int i = 0; i < zstd->seek.cache_num; i++) {
+    if (zstd->seek.cache[i].frame == frame) {
+      return &zstd->seek.cache[i];
+    }
+  }
+  return NULL;
+}
+
+static bool zstd_read_ahead_wait(ZstdReader *zstd, ZstdCachedFrame *cached);
 
-  char *uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
-  char *compressed_data = MEM_mallocN(compressed_size, __func__);
-  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
-      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size)
+/* Find the least recently used entry, preferring entries that are not being read ahead. */
+static ZstdCachedFrame *zstd_cache_entry_for_reuse(ZstdReader *zstd)
+{
+  ZstdCachedFrame *result = NULL;
+  ZstdCachedFrame *result_busy = NULL;
+  for (int i = 0; i < zstd->seek.cache_num; i++) {
+    ZstdCachedFrame *cached = &zstd->seek.cache[i];
+    ZstdCachedFrame **r_entry = (atomic_load_int32(&cached->state) == ZSTD_FRAME_READY) ?
+                                    &result :
+                                    &result_busy;
+    if (*r_entry == NULL || cached->last_use < (*r_entry)->last_use) {
+      *r_entry = cached;
+    }
+  }
+  if (result == NULL) {
+    /* All entries are read ahead, which happens when reading skips ahead further than the frames
+     * that are read ahead. Those frames were not needed after all. */
+    zstd_read_ahead_wait(zstd, result_busy);
+    result = result_busy;
+  }
+  return result;
+}
+
+static void zstd_cache_ensure_content_size(ZstdCachedFrame *cached, size_t size)
+{
+  if (cached->content_size < size) {
+    MEM_SAFE_FREE(cached->content);
+    cached->content = MEM_mallocN(size, __func__);
+    cached->content_size = size;
+  }
+}
+
+/* Decompress a frame that was read ahead, on a worker thread or the reading thread. */
+static void zstd_read_ahead_decompress(ZstdReader *zstd, ZstdCachedFrame *cached, ZSTD_DCtx *ctx)
+{
+  bool success = zstd_decompress_data(ctx,
+                                      cached->content,
+                                      cached->uncompressed_size,
+                                      cached->compressed,
+                                      cached->compressed_size);
+
+  BLI_mutex_lock(&zstd->seek.mutex);
+  atomic_cas_int32(&cached->state,
+                   ZSTD_FRAME_DECOMPRESSING,
+                   success ? ZSTD_FRAME_READY : ZSTD_FRAME_FAILED);
+  BLI_condition_notify_all(&zstd->seek.condition);
+  BLI_mutex_unlock(&zstd->seek.mutex);
+}
+
+static void zstd_read_ahead_task(TaskPool *__restrict pool, void *taskdata)
+{
+  ZstdReader *zstd = BLI_task_pool_user_data(pool);
+  ZstdCachedFrame *cached = taskdata;
+  /* The reading thread may have taken over the frame already. */
+  if (atomic_cas_int32(&cached->state, ZSTD_FRAME_QUEUED, ZSTD_FRAME_DECOMPRESSING) ==
+      ZSTD_FRAME_QUEUED)
+  {
+    zstd_read_ahead_decompress(zstd, cached, cached->ctx);
+  }
+}
+
+/* Wait until a frame that was read ahead is decompressed, or decompress it right away when no
+ * task has started working on it yet. */
+static bool zstd_read_ahead_wait(ZstdReader *zstd, ZstdCachedFrame *cached)
+{
+  if (atomic_cas_int32(&cached->state, ZSTD_FRAME_QUEUED, ZSTD_FRAME_DECOMPRESSING) ==
+      ZSTD_FRAME_QUEUED)
   {
-    MEM_freeN(compressed_data);
-    MEM_freeN(uncompressed_data);
-    return NULL;
+    zstd_read_ahead_decompress(zstd, cached, zstd->ctx);
+  }
+  else {
+    BLI_mutex_lock(&zstd->seek.mutex);
+    while (atomic_load_int32(&cached->state) == ZSTD_FRAME_DECOMPRESSING) {
+      BLI_condition_wait(&zstd->seek.condition, &zstd->seek.mutex);
+    }
+    BLI_mutex_unlock(&zstd->seek.mutex);
+  }
+
+  if (atomic_load_int32(&cached->state) == ZSTD_FRAME_FAILED) {
+    cached->state = ZSTD_FRAME_READY;
+    cached->frame = -1;
+    cached->last_use = 0;
+    return false;
   }
+  return true;
+}
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
-  MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
-    MEM_freeN(uncompressed_data);
-    return NULL;
+/* Start decompressing the frames after the given one on worker threads. */
+static void zstd_read_ahead(ZstdReader *zstd, int frame)
+{
+  const int last_frame = min_ii(frame + zstd->seek.read_ahead_num, zstd->seek.frames_num - 1);
+  for (int next_frame = frame + 1; next_frame <= last_frame; next_frame++) {
+    if (zstd_find_cache(zstd, next_frame) != NULL) {
+      continue;
+    }
+
+    ZstdCachedFrame *cached = zstd_cache_entry_for_reuse(zstd);
+    cached->frame = -1;
+    /* Count as used, so that frames read ahead are not replaced before they are read. */
+    cached->last_use = ++zstd->seek.use_counter;
+    if (!zstd_read_compressed_frame(zstd,
+                                    next_frame,
+                                    &cached->compressed,
+                                    &cached->compressed_alloc_size,
+                                    &cached->compressed_size))
+    {
+      /* Leave the error to be handled when the frame is actually read. */
+      cached->last_use = 0;
+      break;
+    }
+    cached->uncompressed_size = zstd_frame_uncompressed_size(zstd, next_frame);
+    zstd_cache_ensure_content_size(cached, cached->uncompressed_size);
+    cached->frame = next_frame;
+    cached->state = ZSTD_FRAME_QUEUED;
+    BLI_task_pool_push(zstd->seek.task_pool, zstd_read_ahead_task, cached, false, NULL);
   }
+}
 
-  zstd->seek.cached_frame = frame;
-  zstd->seek.cached_content = uncompressed_data;
-  return uncompressed_data;
+/* Ensure that the given frame is loaded into the cache. */
+static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+{
+  ZstdCachedFrame *cached = zstd_find_cache(zstd, frame);
+  if (cached != NULL) {
+    if (atomic_load_int32(&cached->state) != ZSTD_FRAME_READY &&
+        !zstd_read_ahead_wait(zstd, cached))
+    {
+      return NULL;
+    }
+  }
+  else {
+    cached = zstd_cache_entry_for_reuse(zstd);
+    zstd_cache_ensure_content_size(cached, zstd_frame_uncompressed_size(zstd, frame));
+    if (!zstd_decompress_frame(zstd, frame, cached->content)) {
+      cached->frame = -1;
+      cached->last_use = 0;
+      return NULL;
+    }
+    cached->frame = frame;
+  }
+
+  cached->last_use = ++zstd->seek.use_counter;
+  return cached->content;
 }
 
 static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
@@ -203,19 +430,35 @@ static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
       break;
     }
 
-    const char *framedata = zstd_ensure_cache(zstd, frame);
-    if (framedata == NULL) {
-      /* Error while reading the frame, so return as much as we can. */
-      break;
-    }
-
     size_t frame_end_offset = min_zz(zstd->seek.uncompressed_ofs[frame + 1], end_offset);
     size_t frame_read_len = frame_end_offset - zstd->reader.offset;
-
     size_t offset_in_frame = zstd->reader.offset - zstd->seek.uncompressed_ofs[frame];
-    memcpy((char *)buffer + read_len, framedata + offset_in_frame, frame_read_len);
+
+    if (frame_read_len == zstd_frame_uncompressed_size(zstd, frame) &&
+        zstd_find_cache(zstd, frame) == NULL)
+    {
+      /* The whole frame is read, decompress it directly into the output buffer.
+       * This is common when reading large data blocks, which are unlikely to be read again. */
+      if (!zstd_decompress_frame(zstd, frame, (char *)buffer + read_len)) {
+        break;
+      }
+    }
+    else {
+      const char *framedata = zstd_ensure_cache(zstd, frame);
+      if (framedata == NULL) {
+        /* Error while reading the frame, so return as much as we can. */
+        break;
+      }
+      memcpy((char *)buffer + read_len, framedata + offset_in_frame, frame_read_len);
+    }
+
     read_len += frame_read_len;
     zstd->reader.offset = frame_end_offset;
+
+    if (zstd->seek.read_ahead_num > 0 && frame > zstd->seek.last_frame) {
+      zstd_read_ahead(zstd, frame);
+    }
+    zstd->seek.last_frame = frame;
   }
 
   return read_len;
@@ -281,10 +524,23 @@ static void zstd_close(FileReader *reader)
   if (zstd->reader.seek) {
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
-    /* When an error has occurred this may be NULL, see: #99744. */
-    if (zstd->seek.cached_content) {
-      MEM_freeN(zstd->seek.cached_content);
+    if (zstd->seek.task_pool) {
+      BLI_task_pool_work_and_wait(zstd->seek.task_pool);
+      BLI_task_pool_free(zstd->seek.task_pool);
+      BLI_mutex_end(&zstd->seek.mutex);
+      BLI_condition_end(&zstd->seek.condition);
+    }
+    /* When an error has occurred these may be NULL, see: #99744. */
+    for (int i = 0; i < zstd->seek.cache_num; i++) {
+      ZstdCachedFrame *cached = &zstd->seek.cache[i];
+      MEM_SAFE_FREE(cached->content);
+      MEM_SAFE_FREE(cached->compressed);
+      if (cached->ctx) {
+        ZSTD_freeDCtx(cached->ctx);
+      }
     }
+    MEM_freeN(zstd->seek.cache);
+    MEM_SAFE_FREE(zstd->seek.compressed_buf);
   }
   else {
     MEM_freeN((void *)zstd->in_buf.src);
@@ -323,3 +579,37 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
 
   return (FileReader *)zstd;
 }
+
+bool BLI_filereader_zstd_read_ahead_enable(FileReader *reader)
+{
+  if (reader->close != zstd_close || reader->seek == NULL) {
+    /* Not a seekable `Zstd` reader. */
+    return false;
+  }
+  ZstdReader *zstd = (ZstdReader *)reader;
+  if (zstd->seek.read_ahead_num > 0) {
+    return true;
+  }
+
+  const int threads_num = BLI_task_scheduler_num_threads();
+  if (threads_num < 2) {
+    return false;
+  }
+  zstd->seek.read_ahead_num = min_ii(threads_num, ZSTD_READ_AHEAD_MAX_FRAMES);
+
+  /* Frames that are read ahead need cache entries in addition to the regular ones. */
+  const int cache_num = ZSTD_SEEK_CACHE_FRAMES + zstd->seek.read_ahead_num + 1;
+  zstd->seek.cache = MEM_recallocN(zstd->seek.cache, sizeof(ZstdCachedFrame) * cache_num);
+  for (int i = zstd->seek.cache_num; i < cache_num; i++) {
+    zstd->seek.cache[i].frame = -1;
+  }
+  zstd->seek.cache_num = cache_num;
+  for (int i = 0; i < cache_num; i++) {
+    zstd->seek.cache[i].ctx = ZSTD_createDCtx();
+  }
+
+  BLI_mutex_init(&zstd->seek.mutex);
+  BLI_condition_init(&zstd->seek.condition);
+  zstd->seek.task_pool = BLI_task_pool_create_background(zstd, TASK_PRIORITY_HIGH);
+  return true;
+}
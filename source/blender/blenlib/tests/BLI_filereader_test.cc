@@ -0,0 +1,148 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <zstd.h>
+
+#include "BLI_filereader.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+static void append_u32_le(Vector<uint8_t> &data, const uint32_t value)
+{
+  for (int i = 0; i < 4; i++) {
+    data.append(uint8_t(value >> (8 * i)));
+  }
+}
+
+/** Compress `content` into independent frames of the given sizes, followed by a seek table. */
+static Vector<uint8_t> compress_seekable(const Span<uint8_t> content, const Span<int> frame_sizes)
+{
+  Vector<uint8_t> data;
+  Vector<std::pair<uint32_t, uint32_t>> frames;
+  int64_t offset = 0;
+  for (const int frame_size : frame_sizes) {
+    const Span<uint8_t> frame = content.slice(offset, frame_size);
+    const int64_t start = data.size();
+    data.resize(start + ZSTD_compressBound(frame.size()));
+    const size_t compressed_size = ZSTD_compress(
+        data.data() + start, data.size() - start, frame.data(), frame.size(), 3);
+    BLI_assert(!ZSTD_isError(compressed_size));
+    data.resize(start + compressed_size);
+    frames.append({uint32_t(compressed_size), uint32_t(frame.size())});
+    offset += frame_size;
+  }
+  BLI_assert(offset == content.size());
+
+  append_u32_le(data, 0x184D2A5E);
+  append_u32_le(data, uint32_t(frames.size() * 8 + 9));
+  for (const std::pair<uint32_t, uint32_t> &frame : frames) {
+    append_u32_le(data, frame.first);
+    append_u32_le(data, frame.second);
+  }
+  append_u32_le(data, uint32_t(frames.size()));
+  data.append(0);
+  append_u32_le(data, 0x8F92EAB1);
+  return data;
+}
+
+class ZstdFileReaderTest : public testing::Test {
+ public:
+  Vector<uint8_t> content;
+  Vector<uint8_t> compressed;
+  FileReader *reader = nullptr;
+
+  void SetUp() override
+  {
+    Vector<int> frame_sizes = {1000, 70000, 1, 5000, 100000, 30000, 4000, 2000};
+    frame_sizes.append_n_times(3000, 40);
+    RandomNumberGenerator rng(42);
+    for (const int frame_size : frame_sizes) {
+      for (int i = 0; i < frame_size; i++) {
+        content.append(uint8_t(i / 16 + rng.get_int32(4)));
+      }
+    }
+    compressed = compress_seekable(content, frame_sizes);
+    reader = BLI_filereader_new_zstd(
+        BLI_filereader_new_memory(compressed.data(), compressed.size()));
+    ASSERT_NE(reader, nullptr);
+    ASSERT_NE(reader->seek, nullptr);
+  }
+
+  void TearDown() override
+  {
+    reader->close(reader);
+  }
+
+  void expect_read(const int64_t offset, const int64_t size)
+  {
+    ASSERT_EQ(reader->seek(reader, offset, SEEK_SET), offset);
+    Vector<uint8_t> buffer(size);
+    const int64_t expected_size = std::min(size, content.size() - offset);
+    EXPECT_EQ(reader->read(reader, buffer.data(), size), expected_size);
+    EXPECT_EQ(buffer.as_span().take_front(expected_size),
+              content.as_span().slice(offset, expected_size));
+    EXPECT_EQ(reader->offset, offset + expected_size);
+  }
+};
+
+TEST_F(ZstdFileReaderTest, SequentialRead)
+{
+  for (const int chunk_size : {1, 7, 1000, 4096, 100000, 1000000}) {
+    for (int64_t offset = 0; offset < content.size(); offset += chunk_size) {
+      expect_read(offset, chunk_size);
+    }
+  }
+}
+
+TEST_F(ZstdFileReaderTest, RandomRead)
+{
+  RandomNumberGenerator rng(0);
+  for (int i = 0; i < 1000; i++) {
+    const int64_t offset = rng.get_int32(int(content.size()));
+    expect_read(offset, rng.get_int32(i % 10 == 0 ? 200000 : 2000));
+  }
+}
+
+TEST_F(ZstdFileReaderTest, WholeFrames)
+{
+  /* Whole frames, which are decompressed directly into the output buffer. */
+  expect_read(1000, 70000);
+  expect_read(71000, 1);
+  expect_read(0, 71001);
+  /* Partially cached, partially whole frames. */
+  expect_read(71500, 4500);
+  expect_read(71500, 140000);
+}
+
+TEST_F(ZstdFileReaderTest, ReadAhead)
+{
+  BLI_filereader_zstd_read_ahead_enable(reader);
+  for (const int chunk_size : {1000, 7, 100000}) {
+    for (int64_t offset = 0; offset < content.size(); offset += chunk_size) {
+      expect_read(offset, chunk_size);
+    }
+  }
+  /* Skipping ahead leaves frames that were read ahead unused. */
+  expect_read(0, 10);
+  expect_read(200000, 10);
+  expect_read(100, 10);
+  RandomNumberGenerator rng(0);
+  for (int i = 0; i < 1000; i++) {
+    expect_read(rng.get_int32(int(content.size())), rng.get_int32(2000));
+  }
+}
+
+TEST_F(ZstdFileReaderTest, SeekPastEnd)
+{
+  EXPECT_EQ(reader->seek(reader, 0, SEEK_END), content.size());
+  uint8_t value;
+  EXPECT_EQ(reader->read(reader, &value, 1), 0);
+  EXPECT_EQ(reader->seek(reader, 1, SEEK_END), -1);
+}
+
+}  // namespace blender::tests
@@ -4,14 +4,22 @@
 
 #include "testing/testing.h"
 
+#include <algorithm>
+
 /* TODO: ray intersection, overlap ... etc. */
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_compiler_attrs.h"
+#include "BLI_index_mask.hh"
 #include "BLI_kdopbvh.h"
+#include "BLI_kdopbvh.hh"
+#include "BLI_math_geom.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
 
 /* -------------------------------------------------------------------- */
 /* Helper Functions */
@@ -68,8 +76,12 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int balance_flag = 0)
 {
   RNG *rng = BLI_rng_new(random_seed);
   BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
@@ -81,7 +93,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : nullptr;
@@ -134,3 +146,321 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, WideFindNearest_1)
+{
+  find_nearest_points_test(1, 1.0, 1000, 1234, false, BVH_BALANCE_WIDE);
+}
+TEST(kdopbvh, WideFindNearest_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BALANCE_WIDE);
+}
+TEST(kdopbvh, WideFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BALANCE_WIDE);
+}
+TEST(kdopbvh, WideOptimalFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVH_BALANCE_WIDE);
+}
+
+static void raycast_tris_callback(void *userdata,
+                                  int index,
+                                  const BVHTreeRay *ray,
+                                  BVHTreeRayHit *hit)
+{
+  const float(*tris)[3][3] = static_cast<const float(*)[3][3]>(userdata);
+  float dist;
+  if (isect_ray_tri_v3(ray->origin,
+                       ray->direction,
+                       tris[index][0],
+                       tris[index][1],
+                       tris[index][2],
+                       &dist,
+                       nullptr) &&
+      dist < hit->dist)
+  {
+    hit->index = index;
+    hit->dist = dist;
+    madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist);
+  }
+}
+
+struct RayCastAllData {
+  const float (*tris)[3][3];
+  blender::Vector<int> hits;
+};
+
+static void raycast_all_callback(void *userdata,
+                                 int index,
+                                 const BVHTreeRay *ray,
+                                 BVHTreeRayHit *hit)
+{
+  RayCastAllData *data = static_cast<RayCastAllData *>(userdata);
+  BVHTreeRayHit tri_hit = *hit;
+  tri_hit.index = -1;
+  raycast_tris_callback(const_cast<float(*)[3][3]>(data->tris), index, ray, &tri_hit);
+  if (tri_hit.index != -1) {
+    data->hits.append(index);
+  }
+}
+
+static void range_query_callback(void *userdata,
+                                 int index,
+                                 const float /*co*/[3],
+                                 float /*dist_sq*/)
+{
+  static_cast<blender::Vector<int> *>(userdata)->append(index);
+}
+
+static BVHTree *tris_tree_new(const float (*tris)[3][3], int tris_len, int balance_flag)
+{
+  BVHTree *tree = BLI_bvhtree_new(tris_len, 0.0f, 4, 6);
+  for (int i = 0; i < tris_len; i++) {
+    BLI_bvhtree_insert(tree, i, tris[i][0], 3);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  return tree;
+}
+
+/**
+ * Check that queries on the wide tree give the same results as the k-DOP tree.
+ */
+static void wide_tree_compare_test(int tris_len, int random_seed)
+{
+  RNG *rng = BLI_rng_new(random_seed);
+  blender::Array<float[3][3]> tris(tris_len);
+  for (int i = 0; i < tris_len; i++) {
+    float center[3];
+    rng_v3_round(center, 3, rng, 1000, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      rng_v3_round(tris[i][j], 3, rng, 1000, 0.05f);
+      add_v3_v3(tris[i][j], center);
+    }
+  }
+  BVHTree *tree = tris_tree_new(tris.data(), tris_len, 0);
+  BVHTree *tree_wide = tris_tree_new(tris.data(), tris_len, BVH_BALANCE_WIDE);
+
+  int hits_num = 0;
+  for (int i = 0; i < 200; i++) {
+    float co[3], dir[3];
+    rng_v3_round(co, 3, rng, 1000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, dir);
+    /* Also test axis aligned rays. */
+    if (i % 10 == 0) {
+      zero_v3(dir);
+      dir[i % 3] = (i % 20 == 0) ? 1.0f : -1.0f;
+    }
+    const float radius = (i % 4 == 0) ? 0.01f : 0.0f;
+
+    BVHTreeRayHit hit = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+    BVHTreeRayHit hit_wide = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+    BLI_bvhtree_ray_cast(tree, co, dir, radius, &hit, raycast_tris_callback, tris.data());
+    BLI_bvhtree_ray_cast(
+        tree_wide, co, dir, radius, &hit_wide, raycast_tris_callback, tris.data());
+    EXPECT_EQ(hit.index, hit_wide.index);
+    EXPECT_FLOAT_EQ(hit.dist, hit_wide.dist);
+    hits_num += hit.index != -1;
+
+    RayCastAllData all_data = {tris.data()};
+    RayCastAllData all_data_wide = {tris.data()};
+    BLI_bvhtree_ray_cast_all(
+        tree, co, dir, radius, BVH_RAYCAST_DIST_MAX, raycast_all_callback, &all_data);
+    BLI_bvhtree_ray_cast_all(
+        tree_wide, co, dir, radius, BVH_RAYCAST_DIST_MAX, raycast_all_callback, &all_data_wide);
+    std::sort(all_data.hits.begin(), all_data.hits.end());
+    std::sort(all_data_wide.hits.begin(), all_data_wide.hits.end());
+    EXPECT_EQ(all_data.hits.as_span(), all_data_wide.hits.as_span());
+
+    BVHTreeNearest nearest = {-1, {0.0f}, {0.0f}, FLT_MAX};
+    BVHTreeNearest nearest_wide = {-1, {0.0f}, {0.0f}, FLT_MAX};
+    BLI_bvhtree_find_nearest(tree, co, &nearest, nullptr, nullptr);
+    BLI_bvhtree_find_nearest(tree_wide, co, &nearest_wide, nullptr, nullptr);
+    EXPECT_FLOAT_EQ(nearest.dist_sq, nearest_wide.dist_sq);
+
+    blender::Vector<int> range, range_wide;
+    const int range_len = BLI_bvhtree_range_query(tree, co, 0.2f, range_query_callback, &range);
+    const int range_len_wide = BLI_bvhtree_range_query(
+        tree_wide, co, 0.2f, range_query_callback, &range_wide);
+    EXPECT_EQ(range_len, range_len_wide);
+    std::sort(range.begin(), range.end());
+    std::sort(range_wide.begin(), range_wide.end());
+    EXPECT_EQ(range.as_span(), range_wide.as_span());
+  }
+  /* Ensure the test isn't trivially passing. */
+  if (tris_len > 1) {
+    EXPECT_GT(hits_num, 0);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_wide);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, WideCompare_1)
+{
+  wide_tree_compare_test(1, 12);
+}
+TEST(kdopbvh, WideCompare_1000)
+{
+  wide_tree_compare_test(1000, 123);
+}
+
+/**
+ * Check that batched queries give the same results as single queries.
+ */
+static void batch_compare_test(int tris_len, int queries_len, int balance_flag, int random_seed)
+{
+  using namespace blender;
+  RNG *rng = BLI_rng_new(random_seed);
+  Array<float[3][3]> tris(tris_len);
+  for (int i = 0; i < tris_len; i++) {
+    float center[3];
+    rng_v3_round(center, 3, rng, 1000, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      rng_v3_round(tris[i][j], 3, rng, 1000, 0.05f);
+      add_v3_v3(tris[i][j], center);
+    }
+  }
+  BVHTree *tree = tris_tree_new(tris.data(), tris_len, balance_flag);
+
+  Array<float3> origins(queries_len);
+  Array<float3> directions(queries_len);
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 1000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, directions[i]);
+  }
+  /* Skip some queries to test masks. */
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(queries_len), GrainSize(1024), memory, [](const int i) { return i % 7 != 3; });
+
+  Array<BVHTreeRayHit> hits(queries_len, {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX});
+  kdopbvh::ray_cast_batch(
+      *tree, mask, origins, directions, 0.0f, hits, raycast_tris_callback, tris.data());
+  Array<BVHTreeNearest> nearest(queries_len, {-1, {0.0f}, {0.0f}, FLT_MAX});
+  kdopbvh::find_nearest_batch(*tree, mask, origins, nearest, nullptr, nullptr);
+
+  int hits_num = 0;
+  for (int i = 0; i < queries_len; i++) {
+    if (!mask.contains(i)) {
+      EXPECT_EQ(hits[i].index, -1);
+      EXPECT_EQ(nearest[i].index, -1);
+      continue;
+    }
+    BVHTreeRayHit hit = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+    BLI_bvhtree_ray_cast(
+        tree, origins[i], directions[i], 0.0f, &hit, raycast_tris_callback, tris.data());
+    EXPECT_EQ(hit.index, hits[i].index);
+    EXPECT_FLOAT_EQ(hit.dist, hits[i].dist);
+    hits_num += hit.index != -1;
+
+    BVHTreeNearest single_nearest = {-1, {0.0f}, {0.0f}, FLT_MAX};
+    BLI_bvhtree_find_nearest(tree, origins[i], &single_nearest, nullptr, nullptr);
+    EXPECT_FLOAT_EQ(single_nearest.dist_sq, nearest[i].dist_sq);
+  }
+  EXPECT_GT(hits_num, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, BatchCompare)
+{
+  batch_compare_test(1000, 5000, 0, 1234);
+}
+TEST(kdopbvh, BatchCompareWide)
+{
+  batch_compare_test(1000, 5000, BVH_BALANCE_WIDE, 1234);
+}
+
+#if 0 /* Benchmark, disabled by default. */
+TEST(kdopbvh, benchmark_wide_ray_cast)
+{
+  /* A dense grid of triangles on a wavy surface, similar to a subdivided mesh. */
+  const int grid_size = 1500;
+  const int tris_len = grid_size * grid_size * 2;
+  blender::Array<float[3][3]> tris(tris_len);
+  auto grid_co = [&](int x, int y, float r_co[3]) {
+    r_co[0] = float(x) / grid_size;
+    r_co[1] = float(y) / grid_size;
+    r_co[2] = 0.1f * sinf(r_co[0] * 20.0f) * cosf(r_co[1] * 13.0f);
+  };
+  for (int y = 0; y < grid_size; y++) {
+    for (int x = 0; x < grid_size; x++) {
+      float(*tri)[3][3] = &tris[(y * grid_size + x) * 2];
+      grid_co(x, y, tri[0][0]);
+      grid_co(x + 1, y, tri[0][1]);
+      grid_co(x + 1, y + 1, tri[0][2]);
+      grid_co(x, y, tri[1][0]);
+      grid_co(x + 1, y + 1, tri[1][1]);
+      grid_co(x, y + 1, tri[1][2]);
+    }
+  }
+
+  RNG *rng = BLI_rng_new(0);
+  const int rays_len = 1000000;
+  blender::Array<float[3]> origins(rays_len), dirs(rays_len);
+  for (int i = 0; i < rays_len; i++) {
+    origins[i][0] = BLI_rng_get_float(rng);
+    origins[i][1] = BLI_rng_get_float(rng);
+    origins[i][2] = 1.0f;
+    BLI_rng_get_float_unit_v3(rng, dirs[i]);
+    dirs[i][2] = -fabsf(dirs[i][2]) - 0.5f;
+    normalize_v3(dirs[i]);
+  }
+  BLI_rng_free(rng);
+
+  for (const int balance_flag : {0, int(BVH_BALANCE_WIDE)}) {
+    BVHTree *tree;
+    {
+      SCOPED_TIMER(balance_flag ? "wide build" : "k-DOP build");
+      tree = tris_tree_new(tris.data(), tris_len, balance_flag);
+    }
+    int hits = 0;
+    {
+      SCOPED_TIMER(balance_flag ? "wide ray cast" : "k-DOP ray cast");
+      for (int i = 0; i < rays_len; i++) {
+        BVHTreeRayHit hit = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+        hits += BLI_bvhtree_ray_cast(
+                    tree, origins[i], dirs[i], 0.0f, &hit, raycast_tris_callback, tris.data()) !=
+                -1;
+      }
+    }
+    {
+      SCOPED_TIMER(balance_flag ? "wide batch ray cast" : "k-DOP batch ray cast");
+      blender::Array<BVHTreeRayHit> batch_hits(rays_len,
+                                               {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX});
+      blender::kdopbvh::ray_cast_batch(*tree,
+                                       blender::IndexRange(rays_len),
+                                       origins.as_span().cast<blender::float3>(),
+                                       dirs.as_span().cast<blender::float3>(),
+                                       0.0f,
+                                       batch_hits,
+                                       raycast_tris_callback,
+                                       tris.data());
+    }
+    {
+      SCOPED_TIMER(balance_flag ? "wide find nearest" : "k-DOP find nearest");
+      for (int i = 0; i < rays_len; i++) {
+        /* Query points close to the surface. */
+        const float co[3] = {origins[i][0], origins[i][1], 0.0f};
+        BVHTreeNearest nearest = {-1, {0.0f}, {0.0f}, FLT_MAX};
+        BLI_bvhtree_find_nearest(tree, co, &nearest, nullptr, nullptr);
+      }
+    }
+    {
+      SCOPED_TIMER(balance_flag ? "wide batch find nearest" : "k-DOP batch find nearest");
+      blender::Array<blender::float3> positions(rays_len);
+      for (int i = 0; i < rays_len; i++) {
+        positions[i] = {origins[i][0], origins[i][1], 0.0f};
+      }
+      blender::Array<BVHTreeNearest> nearest(rays_len, {-1, {0.0f}, {0.0f}, FLT_MAX});
+      blender::kdopbvh::find_nearest_batch(
+          *tree, blender::IndexRange(rays_len), positions, nearest, nullptr, nullptr);
+    }
+    printf("hits: %d\n", hits);
+    BLI_bvhtree_free(tree);
+  }
+}
+#endif
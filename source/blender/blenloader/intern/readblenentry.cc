@@ -66,7 +66,7 @@ BlendHandle *BLO_blendhandle_from_file(const char *filepath, BlendFileReadReport
 {
   BlendHandle *bh;
 
-  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports);
+  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports, false);
 
   return bh;
 }
@@ -347,7 +347,7 @@ BlendFileData *BLO_read_from_file(const char *filepath,
   BlendFileData *bfd = nullptr;
   FileData *fd;
 
-  fd = blo_filedata_from_file(filepath, reports);
+  fd = blo_filedata_from_file(filepath, reports, true);
   if (fd) {
     fd->skip_flags = skip_flags;
     bfd = blo_read_file_internal(fd, filepath);
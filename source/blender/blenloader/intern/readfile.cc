@@ -163,8 +163,10 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when using GZIP compression,
  * while ZLIB supports seek it's unusably slow, see: #61880.
+ * Zstd compressed files written by Blender contain a seek table, only the frames that contain
+ * requested data are decompressed.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
@@ -1250,10 +1252,15 @@ static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileRead
   return blo_filedata_from_file_descriptor(filepath, reports, file);
 }
 
-FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports)
+FileData *blo_filedata_from_file(const char *filepath,
+                                 BlendFileReadReport *reports,
+                                 const bool use_read_ahead)
 {
   FileData *fd = blo_filedata_from_file_open(filepath, reports);
   if (fd != nullptr) {
+    if (use_read_ahead) {
+      BLI_filereader_zstd_read_ahead_enable(fd->file);
+    }
     /* needed for library_append and read_libraries */
     STRNCPY(fd->relabase, filepath);
 
@@ -4554,7 +4561,7 @@ static FileData *read_library_file_data(FileData *basefd,
                      mainptr->curlib->runtime.filepath_abs,
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_file(mainptr->curlib->runtime.filepath_abs, basefd->reports);
+    fd = blo_filedata_from_file(mainptr->curlib->runtime.filepath_abs, basefd->reports, false);
   }
 
   if (fd) {
@@ -152,8 +152,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath) ATTR_N
  * On each new library added, it now checks for the current #FileData and expands relativeness
  *
  * cannot be called with relative paths anymore!
+ *
+ * \param use_read_ahead: Decompress data ahead of the reading position on worker threads,
+ * for when the whole file is going to be read.
  */
-FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports);
+FileData *blo_filedata_from_file(const char *filepath,
+                                 BlendFileReadReport *reports,
+                                 bool use_read_ahead);
 FileData *blo_filedata_from_memory(const void *mem, int memsize, BlendFileReadReport *reports);
 FileData *blo_filedata_from_memfile(MemFile *memfile,
                                     const BlendFileReadParams *params,
@@ -1023,6 +1023,18 @@ void blo_do_versions_userdef(UserDef *userdef)
     userdef->statusbar_flag |= STATUSBAR_SHOW_EXTENSIONS_UPDATES;
   }
 
+  if (!USER_VERSION_ATLEAST(403, 7)) {
+    userdef->file_compression_level = 3;
+  }
+
+  if (!USER_VERSION_ATLEAST(403, 8)) {
+    userdef->sequencer_prefetch_threads = 1;
+  }
+
+  if (!USER_VERSION_ATLEAST(403, 9)) {
+    userdef->compositor_cache_limit = 1024;
+  }
+
   /**
    * Always bump subversion in BKE_blender_version.h when adding versioning
    * code here, and wrap it inside a USER_VERSION_ATLEAST check.
@@ -58,13 +58,18 @@
  *   - #BLENDER_USERPREF_FILE (on UNIX `~/.config/blender/X.X/config/userpref.blend`).
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <mutex>
+#include <optional>
 
 #ifdef WIN32
 #  include "BLI_winstuff.h"
@@ -94,9 +99,11 @@
 #include "BLI_implicit_sharing.hh"
 #include "BLI_link_utils.h"
 #include "BLI_linklist.h"
+#include "BLI_map.hh"
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
-#include "BLI_threads.h"
+#include "BLI_task.h"
+#include "BLI_vector.hh"
 
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -141,7 +148,10 @@
 #define ZSTD_BUFFER_SIZE (1 << 21) /* 2mb */
 #define ZSTD_CHUNK_SIZE (1 << 20)  /* 1mb */
 
-#define ZSTD_COMPRESSION_LEVEL 3
+/** Minimum frame size when long distance matching is used. */
+#define ZSTD_LONG_FRAME_SIZE (1 << 23) /* 8mb */
+/** Limit for the data of frames that are being compressed or wait to be written. */
+#define ZSTD_MAX_IN_FLIGHT_SIZE (1 << 28) /* 256mb */
 
 static CLG_LogRef LOG = {"blo.writefile"};
 
@@ -153,8 +163,6 @@ static CLG_LogRef LOG = {"blo.writefile"};
  * \{ */
 
 struct ZstdFrame {
-  ZstdFrame *next, *prev;
-
   uint32_t compressed_size;
   uint32_t uncompressed_size;
 };
@@ -204,83 +212,179 @@ bool RawWriteWrap::write(const void *buf, size_t buf_len)
 class ZstdWriteWrap : public WriteWrap {
   WriteWrap &base_wrap;
 
-  ListBase threadpool = {};
-  ListBase tasks = {};
-  ThreadMutex mutex = {};
-  ThreadCondition condition = {};
-  int next_frame = 0;
-  int num_frames = 0;
+  int compression_level;
+  bool use_long_distance_matching;
+  /** Writes are collected until a frame has at least this many bytes. */
+  size_t min_frame_size;
+  /** Upper bound for frames that were submitted but not yet written, limits memory usage. */
+  int max_frames_in_flight;
+
+  TaskPool *task_pool = nullptr;
+  std::mutex mutex;
+  std::condition_variable frame_written_cond;
+
+  /** Data of the frame that is currently being collected. */
+  blender::Vector<uint8_t> pending_data;
+  int submitted_frames_num = 0;
 
-  ListBase frames = {};
+  /** Compressed frames that are waiting for the frames before them to be written. */
+  struct CompressedFrame {
+    blender::Vector<uint8_t> data;
+    uint32_t uncompressed_size;
+    bool is_valid;
+  };
+  blender::Map<int, CompressedFrame> compressed_frames;
+  int next_frame_to_write = 0;
+  /** True while a thread writes compressed frames to the file, only one thread may do so. */
+  bool is_writing_frames = false;
 
-  bool write_error = false;
+  /** Compression contexts are reused, allocating them for every frame is expensive. */
+  blender::Vector<ZSTD_CCtx *> free_contexts;
+
+  /** Frames written so far, for the seek table. */
+  blender::Vector<ZstdFrame> frames;
+
+  std::atomic<bool> write_error = false;
 
  public:
-  ZstdWriteWrap(WriteWrap &base_wrap) : base_wrap(base_wrap) {}
+  ZstdWriteWrap(WriteWrap &base_wrap, int compression_level, bool use_long_distance_matching);
 
   bool open(const char *filepath) override;
   bool close() override;
   bool write(const void *buf, size_t buf_len) override;
 
  private:
-  struct ZstdWriteBlockTask;
-  void write_task(ZstdWriteBlockTask *task);
+  struct ZstdCompressTask;
+  void submit_pending_frame();
+  void compress_frame(ZstdCompressTask &task);
+  void write_compressed_frames();
+  ZSTD_CCtx *context_acquire();
+  void context_release(ZSTD_CCtx *ctx);
   void write_u32_le(uint32_t val);
   void write_seekable_frames();
 };
 
-struct ZstdWriteWrap::ZstdWriteBlockTask {
-  ZstdWriteBlockTask *next, *prev;
-  void *data;
-  size_t size;
-  int frame_number;
+struct ZstdWriteWrap::ZstdCompressTask {
   ZstdWriteWrap *ww;
+  int frame_number;
+  blender::Vector<uint8_t> data;
 
-  static void *write_task(void *userdata)
+  static void run(TaskPool *__restrict /*pool*/, void *taskdata)
   {
-    auto *task = static_cast<ZstdWriteBlockTask *>(userdata);
-    task->ww->write_task(task);
-    return nullptr;
+    auto *task = static_cast<ZstdCompressTask *>(taskdata);
+    task->ww->compress_frame(*task);
+  }
+
+  static void free(TaskPool *__restrict /*pool*/, void *taskdata)
+  {
+    MEM_delete(static_cast<ZstdCompressTask *>(taskdata));
   }
 };
 
-void ZstdWriteWrap::write_task(ZstdWriteBlockTask *task)
+ZstdWriteWrap::ZstdWriteWrap(WriteWrap &base_wrap,
+                             const int compression_level,
+                             const bool use_long_distance_matching)
+    : base_wrap(base_wrap),
+      compression_level(compression_level),
+      use_long_distance_matching(use_long_distance_matching)
 {
-  size_t out_buf_len = ZSTD_compressBound(task->size);
-  void *out_buf = MEM_mallocN(out_buf_len, "Zstd out buffer");
-  size_t out_size = ZSTD_compress(
-      out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  /* Long distance matching only finds matches within a frame, so it needs bigger frames to be
+   * useful. Smaller frames are better for seeking when reading the file. */
+  min_frame_size = use_long_distance_matching ? ZSTD_LONG_FRAME_SIZE : ZSTD_CHUNK_SIZE;
+}
 
-  MEM_freeN(task->data);
+ZSTD_CCtx *ZstdWriteWrap::context_acquire()
+{
+  {
+    std::lock_guard lock{mutex};
+    if (!free_contexts.is_empty()) {
+      return free_contexts.pop_last();
+    }
+  }
+  ZSTD_CCtx *ctx = ZSTD_createCCtx();
+  ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, compression_level);
+  if (use_long_distance_matching) {
+    ZSTD_CCtx_setParameter(ctx, ZSTD_c_enableLongDistanceMatching, 1);
+  }
+  return ctx;
+}
 
-  BLI_mutex_lock(&mutex);
+void ZstdWriteWrap::context_release(ZSTD_CCtx *ctx)
+{
+  std::lock_guard lock{mutex};
+  free_contexts.append(ctx);
+}
+
+void ZstdWriteWrap::compress_frame(ZstdCompressTask &task)
+{
+  CompressedFrame frame;
+  frame.uncompressed_size = uint32_t(task.data.size());
+  frame.data.resize(ZSTD_compressBound(task.data.size()));
 
-  while (next_frame != task->frame_number) {
-    BLI_condition_wait(&condition, &mutex);
+  ZSTD_CCtx *ctx = context_acquire();
+  const size_t out_size = ZSTD_compress2(
+      ctx, frame.data.data(), frame.data.size(), task.data.data(), task.data.size());
+  context_release(ctx);
+
+  /* Free the input early, the compressed data may have to wait for earlier frames. */
+  task.data.clear_and_shrink();
+
+  frame.is_valid = !ZSTD_isError(out_size);
+  frame.data.resize(frame.is_valid ? out_size : 0);
+
+  {
+    std::lock_guard lock{mutex};
+    compressed_frames.add_new(task.frame_number, std::move(frame));
   }
+  write_compressed_frames();
+}
 
-  if (ZSTD_isError(out_size)) {
-    write_error = true;
+void ZstdWriteWrap::write_compressed_frames()
+{
+  std::unique_lock lock{mutex};
+  if (is_writing_frames) {
+    /* The thread that is writing will also write the frames added by this thread. */
+    return;
   }
-  else {
-    if (base_wrap.write(out_buf, out_size)) {
-      ZstdFrame *frameinfo = static_cast<ZstdFrame *>(
-          MEM_mallocN(sizeof(ZstdFrame), "zstd frameinfo"));
-      frameinfo->uncompressed_size = task->size;
-      frameinfo->compressed_size = out_size;
-      BLI_addtail(&frames, frameinfo);
+  is_writing_frames = true;
+  while (std::optional<CompressedFrame> frame = compressed_frames.pop_try(next_frame_to_write))
+  {
+    /* Compression of other frames can continue while this one is written. */
+    lock.unlock();
+    const bool success = frame->is_valid && !write_error &&
+                         base_wrap.write(frame->data.data(), frame->data.size());
+    lock.lock();
+
+    if (success) {
+      frames.append({uint32_t(frame->data.size()), frame->uncompressed_size});
     }
     else {
       write_error = true;
     }
+    next_frame_to_write++;
+    frame_written_cond.notify_all();
   }
+  is_writing_frames = false;
+}
 
-  next_frame++;
+void ZstdWriteWrap::submit_pending_frame()
+{
+  {
+    /* Wait until there is room in the queue, to bound the memory used by frames that are
+     * being compressed or wait to be written. */
+    std::unique_lock lock{mutex};
+    frame_written_cond.wait(lock, [&]() {
+      return submitted_frames_num - next_frame_to_write < max_frames_in_flight;
+    });
+  }
 
-  BLI_mutex_unlock(&mutex);
-  BLI_condition_notify_all(&condition);
+  ZstdCompressTask *task = MEM_new<ZstdCompressTask>(__func__);
+  task->ww = this;
+  task->frame_number = submitted_frames_num++;
+  task->data = std::move(pending_data);
+  pending_data.reserve(min_frame_size);
 
-  MEM_freeN(out_buf);
+  BLI_task_pool_push(task_pool, ZstdCompressTask::run, task, true, ZstdCompressTask::free);
 }
 
 bool ZstdWriteWrap::open(const char *filepath)
@@ -289,11 +393,13 @@ bool ZstdWriteWrap::open(const char *filepath)
     return false;
   }
 
-  /* Leave one thread open for the main writing logic, unless we only have one HW thread. */
-  int num_threads = max_ii(1, BLI_system_thread_count() - 1);
-  BLI_threadpool_init(&threadpool, ZstdWriteBlockTask::write_task, num_threads);
-  BLI_mutex_init(&mutex);
-  BLI_condition_init(&condition);
+  /* Use a background pool, so that frames are compressed even when running with a single
+   * thread, while this thread waits for room in the queue. */
+  task_pool = BLI_task_pool_create_background(this, TASK_PRIORITY_HIGH);
+  max_frames_in_flight = std::clamp(2 * BLI_task_scheduler_num_threads(),
+                                    2,
+                                    std::max(2, int(ZSTD_MAX_IN_FLIGHT_SIZE / min_frame_size)));
+  pending_data.reserve(min_frame_size);
 
   return true;
 }
@@ -319,17 +425,17 @@ void ZstdWriteWrap::write_seekable_frames()
   /* Write seek table header (magic number and frame size). */
   write_u32_le(0x184D2A5E);
 
-  /* The actual frame number might not match num_frames if there was a write error. */
-  const uint32_t num_frames = BLI_listbase_count(&frames);
+  /* The actual frame number might not match the submitted frames if there was a write error. */
+  const uint32_t num_frames = uint32_t(frames.size());
   /* Each frame consists of two u32, so 8 bytes each.
    * After the frames, a footer containing two u32 and one byte (9 bytes total) is written. */
   const uint32_t frame_size = num_frames * 8 + 9;
   write_u32_le(frame_size);
 
   /* Write seek table entries. */
-  LISTBASE_FOREACH (ZstdFrame *, frame, &frames) {
-    write_u32_le(frame->compressed_size);
-    write_u32_le(frame->uncompressed_size);
+  for (const ZstdFrame &frame : frames) {
+    write_u32_le(frame.compressed_size);
+    write_u32_le(frame.uncompressed_size);
   }
 
   /* Write seek table footer (number of frames, option flags and second magic number). */
@@ -341,14 +447,19 @@ void ZstdWriteWrap::write_seekable_frames()
 
 bool ZstdWriteWrap::close()
 {
-  BLI_threadpool_end(&threadpool);
-  BLI_freelistN(&tasks);
+  if (!pending_data.is_empty()) {
+    submit_pending_frame();
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+  task_pool = nullptr;
 
-  BLI_mutex_end(&mutex);
-  BLI_condition_end(&condition);
+  for (ZSTD_CCtx *ctx : free_contexts) {
+    ZSTD_freeCCtx(ctx);
+  }
+  free_contexts.clear();
 
   write_seekable_frames();
-  BLI_freelistN(&frames);
 
   return base_wrap.close() && !write_error;
 }
@@ -359,33 +470,10 @@ bool ZstdWriteWrap::write(const void *buf, size_t buf_len)
     return false;
   }
 
-  ZstdWriteBlockTask *task = static_cast<ZstdWriteBlockTask *>(
-      MEM_mallocN(sizeof(ZstdWriteBlockTask), __func__));
-  task->data = MEM_mallocN(buf_len, __func__);
-  memcpy(task->data, buf, buf_len);
-  task->size = buf_len;
-  task->frame_number = num_frames++;
-  task->ww = this;
-
-  BLI_mutex_lock(&mutex);
-  BLI_addtail(&tasks, task);
-
-  /* If there's a free worker thread, just push the block into that thread.
-   * Otherwise, we wait for the earliest thread to finish.
-   * We look up the earliest thread while holding the mutex, but release it
-   * before joining the thread to prevent a deadlock. */
-  ZstdWriteBlockTask *first_task = static_cast<ZstdWriteBlockTask *>(tasks.first);
-  BLI_mutex_unlock(&mutex);
-  if (!BLI_available_threads(&threadpool)) {
-    BLI_threadpool_remove(&threadpool, first_task);
-
-    /* If the task list was empty before we pushed our task, there should
-     * always be a free thread. */
-    BLI_assert(first_task != task);
-    BLI_remlink(&tasks, first_task);
-    MEM_freeN(first_task);
+  pending_data.extend(blender::Span(static_cast<const uint8_t *>(buf), int64_t(buf_len)));
+  if (pending_data.size() >= min_frame_size) {
+    submit_pending_frame();
   }
-  BLI_threadpool_insert(&threadpool, task);
 
   return true;
 }
@@ -1671,7 +1759,9 @@ bool BLO_write_file(Main *mainvar,
   RawWriteWrap raw_wrap;
 
   if (write_flags & G_FILE_COMPRESS) {
-    ZstdWriteWrap zstd_wrap(raw_wrap);
+    ZstdWriteWrap zstd_wrap(raw_wrap,
+                            U.file_compression_level,
+                            (U.file_compression_flag & USER_FILE_COMPRESSION_LONG_DISTANCE) != 0);
     return BLO_write_file_impl(mainvar, filepath, write_flags, params, reports, zstd_wrap);
   }
 
@@ -0,0 +1,133 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include "BKE_appdir.hh"
+#include "BKE_global.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+#include "BLO_readfile.hh"
+#include "BLO_writefile.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_userdef_types.h"
+
+using namespace blender;
+
+class BlendfileWritingTest : public BlendfileLoadingBaseTest {
+ protected:
+  /* Compression preferences are global, restore them for the tests that run afterwards. */
+  char orig_file_compression_level_ = 0;
+  char orig_file_compression_flag_ = 0;
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    orig_file_compression_level_ = U.file_compression_level;
+    orig_file_compression_flag_ = U.file_compression_flag;
+  }
+
+  void TearDown() override
+  {
+    U.file_compression_level = orig_file_compression_level_;
+    U.file_compression_flag = orig_file_compression_flag_;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /** Add a mesh with noisy grid positions, which compress about as well as real geometry. */
+  Mesh *add_mesh(const char *name, const int verts_num)
+  {
+    Mesh *mesh_src = BKE_mesh_new_nomain(verts_num, 0, 0, 0);
+    RandomNumberGenerator rng(0);
+    MutableSpan<float3> positions = mesh_src->vert_positions_for_write();
+    for (const int i : positions.index_range()) {
+      positions[i] = float3(i % 1000, i / 1000, 0.0f) + rng.get_unit_float3() * 0.01f;
+    }
+    Mesh *mesh = BKE_mesh_add(bfile->main, name);
+    BKE_mesh_nomain_to_mesh(mesh_src, mesh, nullptr);
+    return mesh;
+  }
+
+  std::string write_compressed(const char *filename,
+                               const int compression_level,
+                               const bool use_long_distance_matching)
+  {
+    U.file_compression_level = compression_level;
+    SET_FLAG_FROM_TEST(U.file_compression_flag,
+                       use_long_distance_matching,
+                       USER_FILE_COMPRESSION_LONG_DISTANCE);
+
+    BKE_tempdir_init(nullptr);
+    char filepath[FILE_MAX];
+    BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_base(), filename);
+    BlendFileWriteParams params{};
+    EXPECT_TRUE(BLO_write_file(bfile->main, filepath, G_FILE_COMPRESS, &params, nullptr));
+    return filepath;
+  }
+};
+
+TEST_F(BlendfileWritingTest, CompressedRoundTrip)
+{
+  if (!blendfile_load("modifier_stack" SEP_STR "array_test.blend")) {
+    return;
+  }
+  const Mesh *mesh = add_mesh("WriteTestMesh", 500'000);
+
+  for (const int compression_level : {1, 3, 9}) {
+    for (const bool use_long_distance_matching : {false, true}) {
+      const std::string filepath = write_compressed(
+          "write_test.blend", compression_level, use_long_distance_matching);
+
+      BlendFileReadReport bf_reports = {};
+      BlendFileData *bfile_read = BLO_read_from_file(
+          filepath.c_str(), BLO_READ_SKIP_NONE, &bf_reports);
+      ASSERT_NE(bfile_read, nullptr);
+      const Mesh *mesh_read = reinterpret_cast<const Mesh *>(
+          BKE_libblock_find_name(bfile_read->main, ID_ME, "WriteTestMesh"));
+      ASSERT_NE(mesh_read, nullptr);
+      EXPECT_EQ(mesh->vert_positions(), mesh_read->vert_positions());
+
+      BLO_blendfiledata_free(bfile_read);
+      BLI_delete(filepath.c_str(), false, false);
+    }
+  }
+}
+
+/* Disable benchmark by default. */
+#if 0
+TEST_F(BlendfileWritingTest, CompressedWriteBenchmark)
+{
+  if (!blendfile_load("modifier_stack" SEP_STR "array_test.blend")) {
+    return;
+  }
+  for (const int i : IndexRange(8)) {
+    add_mesh(("BenchmarkMesh" + std::to_string(i)).c_str(), 10'000'000);
+  }
+
+  for (const int compression_level : {1, 3, 9}) {
+    for (const bool use_long_distance_matching : {false, true}) {
+      const timeit::TimePoint start = timeit::Clock::now();
+      const std::string filepath = write_compressed(
+          "write_benchmark.blend", compression_level, use_long_distance_matching);
+      const timeit::Nanoseconds duration = timeit::Clock::now() - start;
+
+      const double seconds = double(duration.count()) / 1e9;
+      const double megabytes = double(BLI_file_size(filepath.c_str())) / (1024.0 * 1024.0);
+      printf("Level %d, long distance matching %s: %.3f s, %.1f MB\n",
+             compression_level,
+             use_long_distance_matching ? "on" : "off",
+             seconds,
+             megabytes);
+      BLI_delete(filepath.c_str(), false, false);
+    }
+  }
+}
+#endif
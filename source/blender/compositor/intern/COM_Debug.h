@@ -21,6 +21,9 @@ static constexpr bool COM_GRAPHVIZ_SHOW_NODE_NAME = false;
 /* Saves operations results to image files. */
 static constexpr bool COM_EXPORT_OPERATION_BUFFERS = false;
 
+/* Prints memory statistics of the #MemoryBufferPool after each execution. */
+static constexpr bool COM_PRINT_BUFFER_POOL_STATS = false;
+
 class Node;
 class NodeOperation;
 class ExecutionSystem;
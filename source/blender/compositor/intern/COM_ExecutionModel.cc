@@ -4,6 +4,7 @@
 
 #include "COM_ExecutionModel.h"
 #include "COM_CompositorContext.h"
+#include "COM_NodeOperation.h"
 
 namespace blender::compositor {
 
@@ -26,4 +27,30 @@ ExecutionModel::ExecutionModel(CompositorContext &context, Span<NodeOperation *>
   border_.render_border = &rd->border;
 }
 
+void ExecutionModel::get_output_render_area(NodeOperation *output_op, rcti &r_area)
+{
+  BLI_assert(output_op->is_output_operation(context_.is_rendering()));
+
+  /* By default return operation bounds (no border). */
+  rcti canvas = output_op->get_canvas();
+  r_area = canvas;
+
+  const bool has_viewer_border = border_.use_viewer_border &&
+                                 (output_op->get_flags().is_viewer_operation ||
+                                  output_op->get_flags().is_preview_operation);
+  const bool has_render_border = border_.use_render_border;
+  if (has_viewer_border || has_render_border) {
+    /* Get border with normalized coordinates. */
+    const rctf *norm_border = has_viewer_border ? border_.viewer_border : border_.render_border;
+
+    /* Return denormalized border within canvas. */
+    const int w = output_op->get_width();
+    const int h = output_op->get_height();
+    r_area.xmin = canvas.xmin + norm_border->xmin * w;
+    r_area.xmax = canvas.xmin + norm_border->xmax * w;
+    r_area.ymin = canvas.ymin + norm_border->ymin * h;
+    r_area.ymax = canvas.ymin + norm_border->ymax * h;
+  }
+}
+
 }  // namespace blender::compositor
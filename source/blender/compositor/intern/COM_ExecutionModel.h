@@ -51,6 +51,13 @@ class ExecutionModel {
 
   virtual void execute(ExecutionSystem &exec_system) = 0;
 
+ protected:
+  /**
+   * Calculates given output operation area to be rendered taking into account viewer and render
+   * borders.
+   */
+  void get_output_render_area(NodeOperation *output_op, rcti &r_area);
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:BaseExecutionModel")
 #endif
@@ -8,6 +8,7 @@
 #include "COM_FullFrameExecutionModel.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
+#include "COM_TiledExecutionModel.h"
 #include "COM_WorkPackage.h"
 #include "COM_WorkScheduler.h"
 
@@ -46,7 +47,14 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     builder.convert_to_operations(this);
   }
 
-  execution_model_ = new FullFrameExecutionModel(context_, active_buffers_, operations_);
+  if ((rd->compositor_flag & SCE_COMPOSITOR_USE_TILES) &&
+      TiledExecutionModel::is_supported(context_, operations_))
+  {
+    execution_model_ = new TiledExecutionModel(context_, operations_, rd->compositor_tile_size);
+  }
+  else {
+    execution_model_ = new FullFrameExecutionModel(context_, active_buffers_, operations_);
+  }
 }
 
 ExecutionSystem::~ExecutionSystem()
@@ -118,7 +126,8 @@ void ExecutionSystem::execute_work(const rcti &work_rect,
       BLI_mutex_lock(&work_mutex_);
       num_sub_works_finished++;
       if (num_sub_works_finished == num_sub_works) {
-        BLI_condition_notify_one(&work_finished_cond_);
+        /* Several operations may be waiting for their own works, see #FullFrameExecutionModel. */
+        BLI_condition_notify_all(&work_finished_cond_);
       }
       BLI_mutex_unlock(&work_mutex_);
     };
@@ -133,7 +142,7 @@ void ExecutionSystem::execute_work(const rcti &work_rect,
    * TODO: This a workaround for WorkScheduler::finish() not waiting all works on queue threading
    * model. Sync code should be removed once it's fixed. */
   BLI_mutex_lock(&work_mutex_);
-  if (num_sub_works_finished < num_sub_works) {
+  while (num_sub_works_finished < num_sub_works) {
     BLI_condition_wait(&work_finished_cond_, &work_mutex_);
   }
   BLI_mutex_unlock(&work_mutex_);
@@ -4,11 +4,18 @@
 
 #include "COM_FullFrameExecutionModel.h"
 
+#include "BLI_set.hh"
 #include "BLI_string.h"
+#include "BLI_system.h"
 
 #include "BLT_translation.hh"
 
+#include "DNA_userdef_types.h"
+
+#include "BKE_global.hh"
+
 #include "COM_Debug.h"
+#include "COM_OperationCache.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -22,16 +29,39 @@
 
 namespace blender::compositor {
 
+/**
+ * Operations rendering faster than this are not cached, rendering them again is cheap compared to
+ * the memory they would take from more expensive operations.
+ */
+static constexpr timeit::Nanoseconds CACHE_MIN_RENDER_TIME = std::chrono::milliseconds(10);
+
 FullFrameExecutionModel::FullFrameExecutionModel(CompositorContext &context,
                                                  SharedOperationBuffers &shared_buffers,
                                                  Span<NodeOperation *> operations)
     : ExecutionModel(context, operations),
       active_buffers_(shared_buffers),
-      num_operations_finished_(0)
+      num_operations_finished_(0),
+      num_scheduled_operations_left_(0),
+      num_running_operations_(0),
+      live_buffers_bytes_(0),
+      cache_limit_bytes_(0)
 {
   priorities_.append(eCompositorPriority::High);
   priorities_.append(eCompositorPriority::Medium);
   priorities_.append(eCompositorPriority::Low);
+
+  BLI_mutex_init(&mutex_);
+  BLI_condition_init(&operation_finished_cond_);
+
+  /* Running branches concurrently may keep more buffers alive than rendering them one after the
+   * other, stay well within the system memory. */
+  live_buffers_bytes_limit_ = int64_t(BLI_system_memory_max_in_megabytes()) * 1024 * 1024 / 2;
+}
+
+FullFrameExecutionModel::~FullFrameExecutionModel()
+{
+  BLI_condition_end(&operation_finished_cond_);
+  BLI_mutex_end(&mutex_);
 }
 
 void FullFrameExecutionModel::execute(ExecutionSystem &exec_system)
@@ -43,9 +73,43 @@ void FullFrameExecutionModel::execute(ExecutionSystem &exec_system)
   DebugInfo::graphviz(&exec_system, "compositor_prior_rendering");
 
   determine_areas_to_render_and_reads();
+  lookup_cached_buffers();
   render_operations();
 }
 
+void FullFrameExecutionModel::lookup_cached_buffers()
+{
+  OperationCache &cache = OperationCache::get();
+  if (context_.is_rendering() || G.is_rendering || U.compositor_cache_limit <= 0) {
+    /* Rendering changes the render results read by cached operations, don't keep them. Render
+     * layers are written in place while a render is running, so nothing is cached meanwhile. */
+    cache.clear();
+    return;
+  }
+  cache_limit_bytes_ = int64_t(U.compositor_cache_limit) * 1024 * 1024;
+
+  cache_keys_ = OperationCache::generate_keys(operations_);
+  for (NodeOperation *op : operations_) {
+    const std::optional<uint64_t> key = cache_keys_.lookup_default(op, std::nullopt);
+    if (!key || op->get_flags().is_constant_operation || op->get_number_of_output_sockets() == 0) {
+      continue;
+    }
+    const Vector<rcti> areas = active_buffers_.get_areas_to_render(
+        op, -op->get_canvas().xmin, -op->get_canvas().ymin);
+    if (areas.is_empty()) {
+      continue;
+    }
+    if (std::shared_ptr<MemoryBuffer> buffer = cache.lookup(*key, areas)) {
+      cached_buffers_.add_new(op, std::move(buffer));
+    }
+  }
+
+  if (!cached_buffers_.is_empty()) {
+    active_buffers_.clear();
+    determine_areas_to_render_and_reads();
+  }
+}
+
 void FullFrameExecutionModel::determine_areas_to_render_and_reads()
 {
   const bool is_rendering = context_.is_rendering();
@@ -97,6 +161,18 @@ MemoryBuffer *FullFrameExecutionModel::create_operation_buffer(NodeOperation *op
   return new MemoryBuffer(data_type, rect, is_a_single_elem);
 }
 
+int64_t FullFrameExecutionModel::get_buffer_bytes(NodeOperation *op)
+{
+  if (op->get_number_of_output_sockets() == 0) {
+    return 0;
+  }
+  const int64_t num_elems = op->get_flags().is_constant_operation ?
+                                1 :
+                                int64_t(op->get_width()) * op->get_height();
+  const DataType data_type = op->get_output_socket(0)->get_data_type();
+  return num_elems * COM_data_type_num_channels(data_type) * sizeof(float);
+}
+
 void FullFrameExecutionModel::render_operation(NodeOperation *op)
 {
   /* Output has no offset for easier image algorithms implementation on operations. */
@@ -105,33 +181,60 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
 
   const timeit::TimePoint before_time = timeit::Clock::now();
 
+  if (const std::shared_ptr<MemoryBuffer> *cached_buffer = cached_buffers_.lookup_ptr(op)) {
+    BLI_mutex_lock(&mutex_);
+    active_buffers_.set_rendered_buffer(op, *cached_buffer);
+    operation_finished(op);
+    BLI_mutex_unlock(&mutex_);
+    return;
+  }
+
   const bool has_outputs = op->get_number_of_output_sockets() > 0;
   MemoryBuffer *op_buf = has_outputs ? create_operation_buffer(op, output_x, output_y) : nullptr;
+  Vector<rcti> areas;
   if (op->get_width() > 0 && op->get_height() > 0) {
-    Vector<MemoryBuffer *> input_bufs = get_input_buffers(op, output_x, output_y);
     const int op_offset_x = output_x - op->get_canvas().xmin;
     const int op_offset_y = output_y - op->get_canvas().ymin;
-    Vector<rcti> areas = active_buffers_.get_areas_to_render(op, op_offset_x, op_offset_y);
+    BLI_mutex_lock(&mutex_);
+    Vector<MemoryBuffer *> input_bufs = get_input_buffers(op, output_x, output_y);
+    areas = active_buffers_.get_areas_to_render(op, op_offset_x, op_offset_y);
+    BLI_mutex_unlock(&mutex_);
+
     op->render(op_buf, areas, input_bufs);
-    DebugInfo::operation_rendered(op, op_buf);
 
     for (MemoryBuffer *buf : input_bufs) {
       delete buf;
     }
   }
-  /* Even if operation has no resolution set the empty buffer. It will be clipped with a
-   * TranslateOperation from convert resolutions if linked to an operation with resolution. */
-  active_buffers_.set_rendered_buffer(op, std::unique_ptr<MemoryBuffer>(op_buf));
-
-  operation_finished(op);
 
   /* The operation may not come from any node. For example, it may have been added to convert data
    * type. Do not accumulate time from its execution. */
   const timeit::TimePoint after_time = timeit::Clock::now();
   const bNodeInstanceKey node_instance_key = op->get_node_instance_key();
+  std::shared_ptr<MemoryBuffer> buffer(op_buf);
+
+  BLI_mutex_lock(&mutex_);
+  if (op->get_width() > 0 && op->get_height() > 0) {
+    DebugInfo::operation_rendered(op, op_buf);
+  }
+  /* Even if operation has no resolution set the empty buffer. It will be clipped with a
+   * TranslateOperation from convert resolutions if linked to an operation with resolution. */
+  active_buffers_.set_rendered_buffer(op, buffer);
+
+  operation_finished(op);
+
   if (context_.get_profiler() && node_instance_key != bke::NODE_INSTANCE_KEY_NONE) {
     context_.get_profiler()->set_node_evaluation_time(node_instance_key, after_time - before_time);
   }
+  BLI_mutex_unlock(&mutex_);
+
+  if (buffer && !areas.is_empty() && cache_limit_bytes_ > 0 &&
+      after_time - before_time >= CACHE_MIN_RENDER_TIME)
+  {
+    if (const std::optional<uint64_t> key = cache_keys_.lookup_default(op, std::nullopt)) {
+      OperationCache::get().add(*key, std::move(buffer), areas, cache_limit_bytes_);
+    }
+  }
 }
 
 void FullFrameExecutionModel::render_operations()
@@ -140,27 +243,30 @@ void FullFrameExecutionModel::render_operations()
 
   WorkScheduler::start();
   for (eCompositorPriority priority : priorities_) {
+    Vector<NodeOperation *> output_ops;
     for (NodeOperation *op : operations_) {
       const bool has_size = op->get_width() > 0 && op->get_height() > 0;
       const bool is_priority_output = op->is_output_operation(is_rendering) &&
                                       op->get_render_priority() == priority;
       if (is_priority_output && has_size) {
-        render_output_dependencies(op);
-        render_operation(op);
+        output_ops.append(op);
       }
       else if (is_priority_output && !has_size && op->is_active_viewer_output()) {
         static_cast<ViewerOperation *>(op)->clear_display_buffer();
       }
     }
+    render_outputs(output_ops);
   }
   WorkScheduler::stop();
 }
 
 /**
  * Returns all dependencies from inputs to outputs. A dependency may be repeated when
- * several operations depend on it.
+ * several operations depend on it. Dependencies of cached operations are skipped.
  */
-static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operation)
+static Vector<NodeOperation *> get_operation_dependencies(
+    NodeOperation *operation,
+    const Map<NodeOperation *, std::shared_ptr<MemoryBuffer>> &cached_buffers)
 {
   /* Get dependencies from outputs to inputs. */
   Vector<NodeOperation *> dependencies;
@@ -170,6 +276,9 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
     Vector<NodeOperation *> outputs(next_outputs);
     next_outputs.clear();
     for (NodeOperation *output : outputs) {
+      if (cached_buffers.contains(output)) {
+        continue;
+      }
       for (int i = 0; i < output->get_number_of_input_sockets(); i++) {
         next_outputs.append(output->get_input_operation(i));
       }
@@ -183,15 +292,114 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
   return dependencies;
 }
 
-void FullFrameExecutionModel::render_output_dependencies(NodeOperation *output_op)
+void *FullFrameExecutionModel::render_thread(void *data)
 {
-  BLI_assert(output_op->is_output_operation(context_.is_rendering()));
-  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op);
-  for (NodeOperation *op : dependencies) {
-    if (!active_buffers_.is_operation_rendered(op)) {
-      render_operation(op);
+  static_cast<FullFrameExecutionModel *>(data)->render_scheduled_operations();
+  return nullptr;
+}
+
+void FullFrameExecutionModel::render_outputs(Span<NodeOperation *> output_ops)
+{
+  /* Schedule operations not rendered yet in the order they would render serially. */
+  Vector<NodeOperation *> scheduled_ops;
+  Set<NodeOperation *> scheduled_ops_set;
+  for (NodeOperation *output_op : output_ops) {
+    BLI_assert(output_op->is_output_operation(context_.is_rendering()));
+    Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op,
+                                                                         cached_buffers_);
+    dependencies.append(output_op);
+    for (NodeOperation *op : dependencies) {
+      if (!active_buffers_.is_operation_rendered(op) && scheduled_ops_set.add(op)) {
+        scheduled_ops.append(op);
+      }
+    }
+  }
+  if (scheduled_ops.is_empty()) {
+    return;
+  }
+
+  pending_inputs_.clear();
+  scheduled_readers_.clear();
+  ready_operations_.clear();
+  for (NodeOperation *op : scheduled_ops) {
+    Set<NodeOperation *> pending_inputs;
+    const int num_inputs = cached_buffers_.contains(op) ? 0 : op->get_number_of_input_sockets();
+    for (int i = 0; i < num_inputs; i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      if (scheduled_ops_set.contains(input_op) && pending_inputs.add(input_op)) {
+        scheduled_readers_.add(input_op, op);
+      }
+    }
+    pending_inputs_.add_new(op, pending_inputs.size());
+    if (pending_inputs.is_empty()) {
+      ready_operations_.append(op);
+    }
+  }
+  num_scheduled_operations_left_ = scheduled_ops.size();
+  num_running_operations_ = 0;
+
+  /* The calling thread renders too. More threads than the ones doing the work of the operations
+   * would only add memory pressure. */
+  const int num_threads = std::min<int>(WorkScheduler::get_num_cpu_threads(),
+                                        scheduled_ops.size());
+  ListBase threads;
+  if (num_threads > 1) {
+    BLI_threadpool_init(&threads, render_thread, num_threads - 1);
+    for (int i = 0; i < num_threads - 1; i++) {
+      BLI_threadpool_insert(&threads, this);
     }
   }
+  render_scheduled_operations();
+  if (num_threads > 1) {
+    BLI_threadpool_end(&threads);
+  }
+  BLI_assert(num_scheduled_operations_left_ == 0);
+}
+
+NodeOperation *FullFrameExecutionModel::pop_startable_operation()
+{
+  for (const int i : ready_operations_.index_range()) {
+    NodeOperation *op = ready_operations_[i];
+    if (num_running_operations_ == 0 ||
+        live_buffers_bytes_ + get_buffer_bytes(op) <= live_buffers_bytes_limit_)
+    {
+      ready_operations_.remove(i);
+      return op;
+    }
+  }
+  return nullptr;
+}
+
+void FullFrameExecutionModel::render_scheduled_operations()
+{
+  BLI_mutex_lock(&mutex_);
+  while (num_scheduled_operations_left_ > 0) {
+    NodeOperation *op = pop_startable_operation();
+    if (op == nullptr) {
+      /* Wait for inputs to be rendered or for buffers to be disposed. */
+      BLI_condition_wait(&operation_finished_cond_, &mutex_);
+      continue;
+    }
+
+    num_running_operations_++;
+    live_buffers_bytes_ += get_buffer_bytes(op);
+    BLI_mutex_unlock(&mutex_);
+
+    render_operation(op);
+
+    BLI_mutex_lock(&mutex_);
+    num_running_operations_--;
+    num_scheduled_operations_left_--;
+    for (NodeOperation *reader : scheduled_readers_.lookup(op)) {
+      int &pending_inputs = pending_inputs_.lookup(reader);
+      pending_inputs--;
+      if (pending_inputs == 0) {
+        ready_operations_.append(reader);
+      }
+    }
+    BLI_condition_notify_all(&operation_finished_cond_);
+  }
+  BLI_mutex_unlock(&mutex_);
 }
 
 void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op,
@@ -212,6 +420,9 @@ void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op
     }
 
     active_buffers_.register_area(operation, render_area);
+    if (cached_buffers_.contains(operation)) {
+      continue;
+    }
 
     const int num_inputs = operation->get_number_of_input_sockets();
     for (int i = 0; i < num_inputs; i++) {
@@ -235,6 +446,9 @@ void FullFrameExecutionModel::determine_reads(NodeOperation *output_op)
   stack.append(output_op);
   while (stack.size() > 0) {
     NodeOperation *operation = stack.pop_last();
+    if (cached_buffers_.contains(operation)) {
+      continue;
+    }
     const int num_inputs = operation->get_number_of_input_sockets();
     for (int i = 0; i < num_inputs; i++) {
       NodeOperation *input_op = operation->get_input_operation(i);
@@ -246,38 +460,17 @@ void FullFrameExecutionModel::determine_reads(NodeOperation *output_op)
   }
 }
 
-void FullFrameExecutionModel::get_output_render_area(NodeOperation *output_op, rcti &r_area)
-{
-  BLI_assert(output_op->is_output_operation(context_.is_rendering()));
-
-  /* By default return operation bounds (no border). */
-  rcti canvas = output_op->get_canvas();
-  r_area = canvas;
-
-  const bool has_viewer_border = border_.use_viewer_border &&
-                                 (output_op->get_flags().is_viewer_operation ||
-                                  output_op->get_flags().is_preview_operation);
-  const bool has_render_border = border_.use_render_border;
-  if (has_viewer_border || has_render_border) {
-    /* Get border with normalized coordinates. */
-    const rctf *norm_border = has_viewer_border ? border_.viewer_border : border_.render_border;
-
-    /* Return denormalized border within canvas. */
-    const int w = output_op->get_width();
-    const int h = output_op->get_height();
-    r_area.xmin = canvas.xmin + norm_border->xmin * w;
-    r_area.xmax = canvas.xmin + norm_border->xmax * w;
-    r_area.ymin = canvas.ymin + norm_border->ymin * h;
-    r_area.ymax = canvas.ymin + norm_border->ymax * h;
-  }
-}
-
 void FullFrameExecutionModel::operation_finished(NodeOperation *operation)
 {
-  /* Report inputs reads so that buffers may be freed/reused. */
-  const int num_inputs = operation->get_number_of_input_sockets();
+  /* Report inputs reads so that buffers may be freed/reused. Cached operations read nothing. */
+  const int num_inputs = cached_buffers_.contains(operation) ?
+                             0 :
+                             operation->get_number_of_input_sockets();
   for (int i = 0; i < num_inputs; i++) {
-    active_buffers_.read_finished(operation->get_input_operation(i));
+    NodeOperation *input_op = operation->get_input_operation(i);
+    if (active_buffers_.read_finished(input_op)) {
+      live_buffers_bytes_ -= get_buffer_bytes(input_op);
+    }
   }
 
   num_operations_finished_++;
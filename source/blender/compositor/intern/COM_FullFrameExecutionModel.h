@@ -4,6 +4,12 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+
+#include "BLI_map.hh"
+#include "BLI_multi_value_map.hh"
+#include "BLI_threads.h"
 #include "BLI_vector.hh"
 
 #include "COM_Enums.h"
@@ -24,6 +30,9 @@ class SharedOperationBuffers;
 
 /**
  * Fully renders operations in order from inputs to outputs.
+ *
+ * Operations whose inputs are rendered are rendered concurrently, so that independent branches of
+ * the tree keep all threads busy even when their operations are small or mostly serial.
  */
 class FullFrameExecutionModel : public ExecutionModel {
  private:
@@ -43,20 +52,72 @@ class FullFrameExecutionModel : public ExecutionModel {
    */
   Vector<eCompositorPriority> priorities_;
 
+  /**
+   * Guards the active buffers, the progress and the scheduling state below, which are accessed by
+   * all threads rendering operations.
+   */
+  ThreadMutex mutex_;
+  /** Notified when an operation finishes rendering. */
+  ThreadCondition operation_finished_cond_;
+
+  /** Number of inputs not rendered yet of operations scheduled for rendering. */
+  Map<NodeOperation *, int> pending_inputs_;
+  /** Scheduled operations reading the key operation. */
+  MultiValueMap<NodeOperation *, NodeOperation *> scheduled_readers_;
+  /** Scheduled operations whose inputs are rendered, ready to start rendering. */
+  Vector<NodeOperation *> ready_operations_;
+  int num_scheduled_operations_left_;
+  int num_running_operations_;
+
+  /** Size of the operation buffers which are being rendered or have not been disposed yet. */
+  int64_t live_buffers_bytes_;
+  /**
+   * Live buffers size up to which operations may start rendering concurrently. An operation is
+   * always started when no other one is running, so the limit never prevents progress.
+   */
+  int64_t live_buffers_bytes_limit_;
+
+  /** Keys of operations in the #OperationCache, operations without a key can't be cached. */
+  Map<NodeOperation *, std::optional<uint64_t>> cache_keys_;
+  /** Buffers of operations found in the #OperationCache, these operations are not rendered. */
+  Map<NodeOperation *, std::shared_ptr<MemoryBuffer>> cached_buffers_;
+  /** Memory limit of the #OperationCache, zero when rendered buffers are not cached. */
+  int64_t cache_limit_bytes_;
+
  public:
   FullFrameExecutionModel(CompositorContext &context,
                           SharedOperationBuffers &shared_buffers,
                           Span<NodeOperation *> operations);
+  ~FullFrameExecutionModel();
 
   void execute(ExecutionSystem &exec_system) override;
 
  private:
   void determine_areas_to_render_and_reads();
+  /**
+   * Find buffers of operations cached by previous executions. Areas to render and reads are
+   * determined again so that operations only needed by cached ones are not rendered.
+   */
+  void lookup_cached_buffers();
   /**
    * Render output operations in order of priority.
    */
   void render_operations();
-  void render_output_dependencies(NodeOperation *output_op);
+  /**
+   * Render given output operations and their dependencies, running operations concurrently when
+   * their inputs are rendered.
+   */
+  void render_outputs(Span<NodeOperation *> output_ops);
+  /**
+   * Render scheduled operations until all of them are rendered. Run by all rendering threads.
+   */
+  void render_scheduled_operations();
+  static void *render_thread(void *data);
+  /**
+   * Pop the first ready operation that can start without exceeding the live buffers limit.
+   * Must be called with #mutex_ locked.
+   */
+  NodeOperation *pop_startable_operation();
   /**
    * Returns input buffers with an offset relative to given output coordinates.
    * Returned memory buffers must be deleted.
@@ -64,14 +125,16 @@ class FullFrameExecutionModel : public ExecutionModel {
   Vector<MemoryBuffer *> get_input_buffers(NodeOperation *op, int output_x, int output_y);
   MemoryBuffer *create_operation_buffer(NodeOperation *op, int output_x, int output_y);
   void render_operation(NodeOperation *op);
-
-  void operation_finished(NodeOperation *operation);
+  /**
+   * Size in bytes of the buffer rendered by given operation.
+   */
+  static int64_t get_buffer_bytes(NodeOperation *op);
 
   /**
-   * Calculates given output operation area to be rendered taking into account viewer and render
-   * borders.
+   * Reports an operation has finished rendering. Must be called with #mutex_ locked.
    */
-  void get_output_render_area(NodeOperation *output_op, rcti &r_area);
+  void operation_finished(NodeOperation *operation);
+
   /**
    * Determines all operations areas needed to render given output area.
    */
@@ -0,0 +1,142 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <optional>
+#include <typeinfo>
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+
+#include "COM_FusedPixelOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Number of pixels evaluated at once by every fused operation. Small enough for the intermediate
+ * results to stay in the CPU cache, large enough to keep the per band overhead negligible.
+ */
+static constexpr int BAND_PIXELS_NUM = 4096;
+
+FusedPixelOperation::FusedPixelOperation(Span<NodeOperation *> operations)
+{
+  Map<NodeOperation *, int> fused_indices;
+  Map<NodeOperationOutput *, int> input_indices;
+  for (NodeOperation *operation : operations) {
+    BLI_assert(operation->get_flags().is_pixel_wise);
+    Vector<InputSource> sources;
+    for (const int i : IndexRange(operation->get_number_of_input_sockets())) {
+      NodeOperationOutput *link = operation->get_input_socket(i)->get_link();
+      BLI_assert(link != nullptr);
+      const int fused_index = fused_indices.lookup_default(&link->get_operation(), -1);
+      if (fused_index != -1) {
+        sources.append({true, fused_index});
+        continue;
+      }
+      const int input_index = input_indices.lookup_or_add_cb(link, [&]() {
+        const int index = get_number_of_input_sockets();
+        add_input_socket(link->get_data_type(), ResizeMode::None);
+        get_input_socket(index)->set_link(link);
+        return index;
+      });
+      sources.append({false, input_index});
+    }
+    fused_indices.add_new(operation, operations_.size());
+    operations_.append(static_cast<MultiThreadedOperation *>(operation));
+    input_sources_.append(std::move(sources));
+  }
+
+  add_output_socket(operations.last()->get_output_socket()->get_data_type());
+  set_canvas(operations.last()->get_canvas());
+  flags_.can_be_tiled = true;
+}
+
+FusedPixelOperation::~FusedPixelOperation()
+{
+  for (MultiThreadedOperation *operation : operations_) {
+    delete operation;
+  }
+}
+
+void FusedPixelOperation::init_data()
+{
+  for (MultiThreadedOperation *operation : operations_) {
+    operation->init_data();
+  }
+}
+
+void FusedPixelOperation::init_execution()
+{
+  for (MultiThreadedOperation *operation : operations_) {
+    operation->init_execution();
+  }
+}
+
+void FusedPixelOperation::deinit_execution()
+{
+  for (MultiThreadedOperation *operation : operations_) {
+    operation->deinit_execution();
+  }
+}
+
+void FusedPixelOperation::hash_output_params()
+{
+  for (const int i : operations_.index_range()) {
+    const std::optional<size_t> params_hash = operations_[i]->generate_params_hash();
+    if (!params_hash) {
+      /* Mark the hash as not implemented, as for the fused operation. */
+      NodeOperation::hash_output_params();
+      return;
+    }
+    hash_params(typeid(*operations_[i]).hash_code(), *params_hash);
+    for (const InputSource &source : input_sources_[i]) {
+      hash_params(source.is_fused, source.index);
+    }
+  }
+}
+
+void FusedPixelOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                       const rcti &area,
+                                                       Span<MemoryBuffer *> inputs)
+{
+  if (BLI_rcti_is_empty(&area)) {
+    return;
+  }
+  const int width = BLI_rcti_size_x(&area);
+  const int band_height = std::clamp(BAND_PIXELS_NUM / width, 1, BLI_rcti_size_y(&area));
+
+  /* Results of all operations but the last one, which writes to the output. */
+  const int intermediates_num = operations_.size() - 1;
+  Array<Array<float>> intermediates_data(intermediates_num);
+  Array<std::optional<MemoryBuffer>> intermediates(intermediates_num);
+  for (const int i : IndexRange(intermediates_num)) {
+    const DataType data_type = operations_[i]->get_output_socket()->get_data_type();
+    intermediates_data[i].reinitialize(int64_t(width) * band_height *
+                                       COM_data_type_num_channels(data_type));
+  }
+
+  Vector<MemoryBuffer *> operation_inputs;
+  for (int y = area.ymin; y < area.ymax; y += band_height) {
+    rcti band;
+    BLI_rcti_init(&band, area.xmin, area.xmax, y, std::min(y + band_height, area.ymax));
+
+    for (const int i : operations_.index_range()) {
+      operation_inputs.clear();
+      for (const InputSource &source : input_sources_[i]) {
+        operation_inputs.append(source.is_fused ? &*intermediates[source.index] :
+                                                  inputs[source.index]);
+      }
+
+      MemoryBuffer *operation_output = output;
+      if (i < intermediates_num) {
+        const DataType data_type = operations_[i]->get_output_socket()->get_data_type();
+        intermediates[i].emplace(
+            intermediates_data[i].data(), COM_data_type_num_channels(data_type), band);
+        operation_output = &*intermediates[i];
+      }
+      operations_[i]->update_memory_buffer_partial(operation_output, band, operation_inputs);
+    }
+  }
+}
+
+}  // namespace blender::compositor
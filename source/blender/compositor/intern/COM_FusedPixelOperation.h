@@ -0,0 +1,61 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_vector.hh"
+
+#include "COM_MultiThreadedOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Evaluates a group of pixel-wise operations (see #NodeOperationFlags::is_pixel_wise) as a single
+ * operation. Instead of writing full frame buffers for every operation, the group is evaluated
+ * band by band of rows, passing intermediate results through small buffers that stay in cache.
+ *
+ * Inputs of the group that are not computed inside of it become inputs of this operation, the
+ * output of the last operation is the output of this operation.
+ */
+class FusedPixelOperation : public MultiThreadedOperation {
+ private:
+  /** Where an input of a fused operation is read from. */
+  struct InputSource {
+    /** Whether the input is the result of a previous fused operation or an input of this one. */
+    bool is_fused;
+    int index;
+  };
+
+  /** Fused operations in evaluation order, owned by this operation. */
+  Vector<MultiThreadedOperation *> operations_;
+  /** Sources of the inputs of every fused operation. */
+  Vector<Vector<InputSource>> input_sources_;
+
+ public:
+  /**
+   * \param operations: Pixel-wise operations with the same canvas, sorted so that operations come
+   * after the ones they read from. Only the last operation may be read by operations outside of
+   * the group. Links from operations outside of the group are moved to this operation.
+   */
+  FusedPixelOperation(Span<NodeOperation *> operations);
+  ~FusedPixelOperation();
+
+  Span<MultiThreadedOperation *> get_operations() const
+  {
+    return operations_;
+  }
+
+  void init_data() override;
+  void init_execution() override;
+  void deinit_execution() override;
+
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) final;
+
+ protected:
+  void hash_output_params() override;
+};
+
+}  // namespace blender::compositor
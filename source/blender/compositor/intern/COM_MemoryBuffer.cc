@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_MemoryBufferPool.h"
 
 #include "IMB_colormanagement.hh"
 #include "IMB_imbuf_types.hh"
@@ -33,8 +34,7 @@ MemoryBuffer::MemoryBuffer(DataType data_type, int width, int height)
   BLI_rcti_init(&rect_, 0, width, 0, height);
   is_a_single_elem_ = false;
   num_channels_ = COM_data_type_num_channels(data_type);
-  buffer_ = (float *)MEM_mallocN_aligned(
-      sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  buffer_ = MemoryBufferPool::get().acquire(get_memory_size_in_bytes());
   owns_data_ = true;
   datatype_ = data_type;
 
@@ -46,8 +46,7 @@ MemoryBuffer::MemoryBuffer(DataType data_type, const rcti &rect, bool is_a_singl
   rect_ = rect;
   is_a_single_elem_ = is_a_single_elem;
   num_channels_ = COM_data_type_num_channels(data_type);
-  buffer_ = (float *)MEM_mallocN_aligned(
-      sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  buffer_ = MemoryBufferPool::get().acquire(get_memory_size_in_bytes());
   owns_data_ = true;
   datatype_ = data_type;
 
@@ -160,7 +159,7 @@ float MemoryBuffer::get_max_value(const rcti &rect) const
 MemoryBuffer::~MemoryBuffer()
 {
   if (buffer_ && owns_data_) {
-    MEM_freeN(buffer_);
+    MemoryBufferPool::get().release(buffer_, get_memory_size_in_bytes());
     buffer_ = nullptr;
   }
 }
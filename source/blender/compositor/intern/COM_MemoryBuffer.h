@@ -378,6 +378,12 @@ class MemoryBuffer {
     return is_a_single_elem() ? 1 : get_height();
   }
 
+  /** Get the number of bytes of the elements in memory. */
+  int64_t get_memory_size_in_bytes() const
+  {
+    return buffer_len() * num_channels_ * sizeof(float);
+  }
+
   uint8_t get_num_channels() const
   {
     return num_channels_;
@@ -0,0 +1,113 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_math_base.h"
+#include "BLI_math_bits.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "COM_MemoryBufferPool.h"
+
+namespace blender::compositor {
+
+MemoryBufferPool::~MemoryBufferPool()
+{
+  clear();
+}
+
+MemoryBufferPool &MemoryBufferPool::get()
+{
+  static MemoryBufferPool pool;
+  return pool;
+}
+
+int64_t MemoryBufferPool::get_size_class(const int64_t size_in_bytes)
+{
+  if (size_in_bytes < MIN_POOLED_BYTES) {
+    return size_in_bytes;
+  }
+  const int highest_bit = 63 - bitscan_reverse_uint64(uint64_t(size_in_bytes));
+  const uint64_t class_step = (uint64_t(1) << highest_bit) / 4;
+  return int64_t(ceil_to_multiple_ul(uint64_t(size_in_bytes), class_step));
+}
+
+float *MemoryBufferPool::acquire(const int64_t size_in_bytes)
+{
+  const int64_t size_class = get_size_class(size_in_bytes);
+  if (size_class < MIN_POOLED_BYTES) {
+    return static_cast<float *>(MEM_mallocN_aligned(size_class, 16, "COM_MemoryBuffer"));
+  }
+
+  {
+    std::scoped_lock lock(mutex_);
+    stats_.used_bytes += size_class;
+    stats_.peak_used_bytes = std::max(stats_.peak_used_bytes, stats_.used_bytes);
+    Vector<IdleBuffer> *idle_buffers = idle_buffers_.lookup_ptr(size_class);
+    if (idle_buffers && !idle_buffers->is_empty()) {
+      stats_.idle_bytes -= size_class;
+      stats_.reused_bytes += size_class;
+      return idle_buffers->pop_last().buffer;
+    }
+    stats_.allocated_bytes += size_class;
+  }
+
+  return static_cast<float *>(MEM_mallocN_aligned(size_class, 16, "COM_MemoryBuffer"));
+}
+
+void MemoryBufferPool::release(float *buffer, const int64_t size_in_bytes)
+{
+  const int64_t size_class = get_size_class(size_in_bytes);
+  if (size_class < MIN_POOLED_BYTES) {
+    MEM_freeN(buffer);
+    return;
+  }
+
+  std::scoped_lock lock(mutex_);
+  stats_.used_bytes -= size_class;
+  stats_.idle_bytes += size_class;
+  idle_buffers_.lookup_or_add_default(size_class).append({buffer, execution_});
+}
+
+void MemoryBufferPool::execution_finished()
+{
+  std::scoped_lock lock(mutex_);
+  for (auto item : idle_buffers_.items()) {
+    Vector<IdleBuffer> &idle_buffers = item.value;
+    /* Buffers released in the current execution are kept until the end of the next one. */
+    idle_buffers.remove_if([&](const IdleBuffer &idle_buffer) {
+      if (idle_buffer.execution == execution_) {
+        return false;
+      }
+      MEM_freeN(idle_buffer.buffer);
+      stats_.idle_bytes -= item.key;
+      return true;
+    });
+  }
+  execution_++;
+}
+
+void MemoryBufferPool::clear()
+{
+  std::scoped_lock lock(mutex_);
+  for (Vector<IdleBuffer> &idle_buffers : idle_buffers_.values()) {
+    for (const IdleBuffer &idle_buffer : idle_buffers) {
+      MEM_freeN(idle_buffer.buffer);
+    }
+  }
+  idle_buffers_.clear();
+
+  /* Buffers still in use are released later on, keep accounting for them. */
+  const int64_t used_bytes = stats_.used_bytes;
+  stats_ = {};
+  stats_.used_bytes = used_bytes;
+  stats_.peak_used_bytes = used_bytes;
+}
+
+MemoryBufferPool::Stats MemoryBufferPool::get_stats()
+{
+  std::scoped_lock lock(mutex_);
+  return stats_;
+}
+
+}  // namespace blender::compositor
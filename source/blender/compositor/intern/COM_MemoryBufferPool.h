@@ -0,0 +1,89 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+/**
+ * Pool of the memory used by #MemoryBuffer, reused across operations and across executions to
+ * avoid the page faults of allocating large buffers again and again.
+ *
+ * Allocations are rounded up to size classes, four per power of two, so that buffers of similar
+ * but not equal sizes can be reused while wasting at most a quarter of their memory. Allocations
+ * smaller than #MIN_POOLED_BYTES are cheap and not pooled.
+ *
+ * Released memory is kept until the end of the next execution. Memory not acquired again by then
+ * isn't part of the working set anymore and is freed.
+ */
+class MemoryBufferPool {
+ public:
+  static constexpr int64_t MIN_POOLED_BYTES = 64 * 1024;
+
+  struct Stats {
+    /** Bytes of acquired memory, including the unused part of their size class. */
+    int64_t used_bytes = 0;
+    /** Bytes of released memory kept for reuse. */
+    int64_t idle_bytes = 0;
+    /** Maximum of #used_bytes since the last #clear. */
+    int64_t peak_used_bytes = 0;
+    /** Total bytes acquired from released memory since the last #clear. */
+    int64_t reused_bytes = 0;
+    /** Total bytes newly allocated since the last #clear. */
+    int64_t allocated_bytes = 0;
+  };
+
+ private:
+  struct IdleBuffer {
+    float *buffer;
+    /** Execution in which the buffer was released. */
+    uint64_t execution;
+  };
+
+  /** Released buffers by size class in bytes. */
+  Map<int64_t, Vector<IdleBuffer>> idle_buffers_;
+  Stats stats_;
+  uint64_t execution_ = 0;
+  std::mutex mutex_;
+
+ public:
+  ~MemoryBufferPool();
+
+  /** Pool shared by all compositor executions. */
+  static MemoryBufferPool &get();
+
+  /** Size class of an allocation, or the size itself when it isn't pooled. */
+  static int64_t get_size_class(int64_t size_in_bytes);
+
+  /**
+   * Get uninitialized memory of at least the given size, aligned to 16 bytes. It must be given
+   * back using #release with the same size.
+   */
+  float *acquire(int64_t size_in_bytes);
+  void release(float *buffer, int64_t size_in_bytes);
+
+  /** Free the memory that was released before the current execution and not acquired since. */
+  void execution_finished();
+
+  /** Free all released memory and reset statistics. */
+  void clear();
+
+  Stats get_stats();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBufferPool")
+#endif
+};
+
+}  // namespace blender::compositor
@@ -48,6 +48,9 @@ class MultiThreadedOperation : public NodeOperation {
   }
 
  private:
+  /* Evaluates fused pixel-wise operations. */
+  friend class FusedPixelOperation;
+
   void update_memory_buffer(MemoryBuffer *output,
                             const rcti &area,
                             Span<MemoryBuffer *> inputs) override;
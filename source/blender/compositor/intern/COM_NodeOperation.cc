@@ -38,7 +38,7 @@ const float *NodeOperation::get_constant_elem_default(const float *default_elem)
   return default_elem;
 }
 
-std::optional<NodeOperationHash> NodeOperation::generate_hash()
+std::optional<size_t> NodeOperation::generate_params_hash()
 {
   params_hash_ = get_default_hash(canvas_.xmin, canvas_.xmax);
 
@@ -54,8 +54,18 @@ std::optional<NodeOperationHash> NodeOperation::generate_hash()
     BLI_assert(outputs_.size() == 1);
     hash_param(this->get_output_socket()->get_data_type());
   }
+  return params_hash_;
+}
+
+std::optional<NodeOperationHash> NodeOperation::generate_hash()
+{
+  const std::optional<size_t> params_hash = generate_params_hash();
+  if (!params_hash) {
+    return std::nullopt;
+  }
+
   NodeOperationHash hash;
-  hash.params_hash_ = params_hash_;
+  hash.params_hash_ = *params_hash;
 
   hash.parents_hash_ = 0;
   for (NodeOperationInput &socket : inputs_) {
@@ -317,6 +327,12 @@ std::ostream &operator<<(std::ostream &os, const NodeOperationFlags &node_operat
   if (node_operation_flags.can_be_constant) {
     os << "can_be_constant,";
   }
+  if (node_operation_flags.is_pixel_wise) {
+    os << "pixel_wise,";
+  }
+  if (node_operation_flags.can_be_tiled) {
+    os << "can_be_tiled,";
+  }
 
   return os;
 }
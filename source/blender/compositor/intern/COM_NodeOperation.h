@@ -206,6 +206,21 @@ struct NodeOperationFlags {
    */
   bool can_be_constant : 1;
 
+  /**
+   * Whether operation is a #MultiThreadedOperation whose output pixels only depend on the input
+   * pixels at the same coordinates, computed in a single pass without any setup per pass. Chains
+   * of such operations are fused into a #FusedPixelOperation.
+   */
+  bool is_pixel_wise : 1;
+
+  /**
+   * Whether operation renders any area correctly from input buffers only covering the areas
+   * returned by #NodeOperation::get_area_of_interest, which extend the rendered area by a margin
+   * that doesn't depend on the canvas size. Implied for pixel-wise operations. Trees made only of
+   * such operations can be rendered tile by tile, see #TiledExecutionModel.
+   */
+  bool can_be_tiled : 1;
+
   NodeOperationFlags()
   {
     use_render_border = false;
@@ -217,6 +232,8 @@ struct NodeOperationFlags {
     use_datatype_conversion = true;
     is_constant_operation = false;
     can_be_constant = false;
+    is_pixel_wise = false;
+    can_be_tiled = false;
   }
 };
 
@@ -344,6 +361,12 @@ class NodeOperation {
    * If the operation parameters or its linked inputs change, the hash must be re-generated.
    */
   std::optional<NodeOperationHash> generate_hash();
+  /**
+   * Generate a hash of the operation parameters, canvas and output data type, not taking linked
+   * inputs into account. Requires `hash_output_params` to be implemented, otherwise
+   * `std::nullopt` is returned.
+   */
+  std::optional<size_t> generate_params_hash();
 
   unsigned int get_number_of_input_sockets() const
   {
@@ -522,8 +545,9 @@ class NodeOperation {
  protected:
   NodeOperation();
 
-  /* Overridden by subclasses to allow merging equal operations on compiling. Implementations must
-   * hash any subclass parameter that affects the output result using `hash_params` methods. */
+  /* Overridden by subclasses to allow merging equal operations on compiling and caching their
+   * results between executions. Implementations must hash any subclass parameter that affects the
+   * output result using `hash_params` methods. */
   virtual void hash_output_params()
   {
     is_hash_output_params_implemented_ = false;
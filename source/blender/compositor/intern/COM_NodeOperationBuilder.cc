@@ -5,11 +5,13 @@
 #include <set>
 
 #include "BLI_multi_value_map.hh"
+#include "BLI_set.hh"
 
 #include "BKE_node_runtime.hh"
 
 #include "COM_Converter.h"
 #include "COM_Debug.h"
+#include "COM_FusedPixelOperation.h"
 
 #include "COM_PreviewOperation.h"
 #include "COM_SetColorOperation.h"
@@ -99,6 +101,9 @@ void NodeOperationBuilder::convert_to_operations(ExecutionSystem *system)
   /* ensure topological (link-based) order of nodes */
   // sort_operations(); /* not needed yet. */
 
+  save_graphviz("compositor_prior_fusing");
+  fuse_pixel_wise_operations();
+
   /* transfer resulting operations to the system */
   system->set_operations(operations_);
 }
@@ -579,6 +584,119 @@ void NodeOperationBuilder::sort_operations()
   operations_ = sorted;
 }
 
+/**
+ * Whether a pixel-wise operation can be evaluated as part of a #FusedPixelOperation that outputs
+ * the given canvas.
+ */
+static bool can_fuse_operation(NodeOperation *op, const rcti &canvas, const bool is_rendering)
+{
+  if (!op->get_flags().is_pixel_wise || op->is_output_operation(is_rendering) ||
+      op->get_number_of_output_sockets() != 1 || !BLI_rcti_compare(&op->get_canvas(), &canvas))
+  {
+    return false;
+  }
+  for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+    if (!op->get_input_socket(i)->is_connected()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NodeOperationBuilder::fuse_pixel_wise_operations()
+{
+  const bool is_rendering = context_->is_rendering();
+
+  MultiValueMap<NodeOperation *, NodeOperation *> readers;
+  for (NodeOperation *op : operations_) {
+    for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+      if (NodeOperation *input_op = op->get_input_operation(i)) {
+        readers.add(input_op, op);
+      }
+    }
+  }
+
+  Vector<NodeOperation *> sorted;
+  Tags visited;
+  for (NodeOperation *op : operations_) {
+    sort_operations_recursive(sorted, visited, op);
+  }
+
+  /* Grow groups upstream starting from the last operations, so that chains are fused as a whole.
+   * An operation joins a group when all its readers are in the group, so only the result of the
+   * last operation of the group is read by other operations. */
+  Set<NodeOperation *> fused_ops;
+  Map<NodeOperationOutput *, NodeOperationOutput *> fused_outputs;
+  for (int64_t sorted_index = sorted.size() - 1; sorted_index >= 0; sorted_index--) {
+    NodeOperation *root = sorted[sorted_index];
+    if (fused_ops.contains(root) || BLI_rcti_is_empty(&root->get_canvas()) ||
+        !can_fuse_operation(root, root->get_canvas(), is_rendering))
+    {
+      continue;
+    }
+
+    Set<NodeOperation *> group = {root};
+    bool group_changed = true;
+    while (group_changed) {
+      group_changed = false;
+      for (NodeOperation *candidate : Vector<NodeOperation *>(group.begin(), group.end())) {
+        for (const int i : IndexRange(candidate->get_number_of_input_sockets())) {
+          NodeOperation *input_op = candidate->get_input_operation(i);
+          if (group.contains(input_op) || fused_ops.contains(input_op) ||
+              !can_fuse_operation(input_op, root->get_canvas(), is_rendering))
+          {
+            continue;
+          }
+          const Span<NodeOperation *> input_readers = readers.lookup(input_op);
+          if (std::all_of(input_readers.begin(), input_readers.end(), [&](NodeOperation *reader) {
+                return group.contains(reader);
+              }))
+          {
+            group.add_new(input_op);
+            group_changed = true;
+          }
+        }
+      }
+    }
+    if (group.size() < 2) {
+      continue;
+    }
+
+    /* Keep the topological order, the root comes last since it reads all other operations. */
+    Vector<NodeOperation *> group_ops;
+    for (NodeOperation *op : sorted) {
+      if (group.contains(op)) {
+        group_ops.append(op);
+        op->set_bnodetree(context_->get_bnodetree());
+      }
+    }
+    BLI_assert(group_ops.last() == root);
+    fused_ops.add_multiple(group_ops);
+
+    FusedPixelOperation *fused_op = new FusedPixelOperation(group_ops);
+    fused_op->set_id(root->get_id());
+    fused_op->set_name(root->get_name());
+    fused_op->set_node_instance_key(root->get_node_instance_key());
+    fused_op->set_execution_system(exec_system_);
+    fused_outputs.add_new(root->get_output_socket(), fused_op->get_output_socket());
+    operations_[operations_.first_index_of(root)] = fused_op;
+  }
+
+  operations_.remove_if([&](NodeOperation *op) { return fused_ops.contains(op); });
+
+  /* Read fused results from the fused operations, including inputs of other fused operations. */
+  for (NodeOperation *op : operations_) {
+    for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+      NodeOperationInput *input = op->get_input_socket(i);
+      if (NodeOperationOutput *fused_output = fused_outputs.lookup_default(input->get_link(),
+                                                                           nullptr))
+      {
+        input->set_link(fused_output);
+      }
+    }
+  }
+}
+
 void NodeOperationBuilder::save_graphviz(StringRefNull name)
 {
   if (COM_EXPORT_GRAPHVIZ) {
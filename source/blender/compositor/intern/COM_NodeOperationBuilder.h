@@ -137,6 +137,9 @@ class NodeOperationBuilder {
   /** Sort operations by link dependencies */
   void sort_operations();
 
+  /** Fuse groups of pixel-wise operations into single operations evaluated tile by tile. */
+  void fuse_pixel_wise_operations();
+
  private:
   PreviewOperation *make_preview_operation() const;
   void unlink_inputs_and_relink_outputs(NodeOperation *unlinked_op, NodeOperation *linked_op);
@@ -0,0 +1,133 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <typeinfo>
+
+#include "BLI_ghash.h"
+#include "BLI_hash.hh"
+#include "BLI_rect.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+#include "COM_OperationCache.h"
+
+namespace blender::compositor {
+
+OperationCache &OperationCache::get()
+{
+  static OperationCache cache;
+  return cache;
+}
+
+static std::optional<uint64_t> generate_key(NodeOperation *op,
+                                            Map<NodeOperation *, std::optional<uint64_t>> &keys)
+{
+  if (const std::optional<uint64_t> *key = keys.lookup_ptr(op)) {
+    return *key;
+  }
+
+  std::optional<uint64_t> key;
+  if (op->get_flags().is_constant_operation) {
+    /* Constants are identified by their value, which is all their readers depend on. */
+    const DataType data_type = op->get_output_socket()->get_data_type();
+    const float *elem = op->get_constant_elem_default(nullptr);
+    uint64_t constant_key = get_default_hash(data_type);
+    for (const int i : IndexRange(COM_data_type_num_channels(data_type))) {
+      constant_key = BLI_ghashutil_combine_hash(constant_key, get_default_hash(elem[i]));
+    }
+    key = constant_key;
+  }
+  else if (const std::optional<size_t> params_hash = op->generate_params_hash()) {
+    key = get_default_hash(typeid(*op).hash_code(), *params_hash);
+    for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      const std::optional<uint64_t> input_key = input_op ? generate_key(input_op, keys) :
+                                                           std::nullopt;
+      if (!input_key) {
+        key.reset();
+        break;
+      }
+      key = BLI_ghashutil_combine_hash(*key, *input_key);
+    }
+  }
+
+  keys.add(op, key);
+  return key;
+}
+
+Map<NodeOperation *, std::optional<uint64_t>> OperationCache::generate_keys(
+    Span<NodeOperation *> operations)
+{
+  Map<NodeOperation *, std::optional<uint64_t>> keys;
+  for (NodeOperation *op : operations) {
+    generate_key(op, keys);
+  }
+  return keys;
+}
+
+std::shared_ptr<MemoryBuffer> OperationCache::lookup(const uint64_t key,
+                                                     Span<rcti> areas_to_render)
+{
+  std::scoped_lock lock(mutex_);
+  Entry *entry = entries_.lookup_ptr(key);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  for (const rcti &area : areas_to_render) {
+    const bool is_rendered = std::any_of(
+        entry->rendered_areas.begin(), entry->rendered_areas.end(), [&](const rcti &rendered) {
+          return BLI_rcti_inside_rcti(&rendered, &area);
+        });
+    if (!is_rendered) {
+      return nullptr;
+    }
+  }
+  entry->last_used = ++use_clock_;
+  return entry->buffer;
+}
+
+void OperationCache::add(const uint64_t key,
+                         std::shared_ptr<MemoryBuffer> buffer,
+                         Span<rcti> rendered_areas,
+                         const int64_t limit_in_bytes)
+{
+  const int64_t size_in_bytes = buffer->get_memory_size_in_bytes();
+  if (size_in_bytes > limit_in_bytes) {
+    return;
+  }
+
+  std::scoped_lock lock(mutex_);
+  if (const Entry *previous_entry = entries_.lookup_ptr(key)) {
+    size_in_bytes_ -= previous_entry->size_in_bytes;
+  }
+  entries_.add_overwrite(
+      key, {std::move(buffer), Vector<rcti>(rendered_areas), size_in_bytes, ++use_clock_});
+  size_in_bytes_ += size_in_bytes;
+  free_least_recently_used(limit_in_bytes);
+}
+
+void OperationCache::free_least_recently_used(const int64_t limit_in_bytes)
+{
+  while (size_in_bytes_ > limit_in_bytes) {
+    const uint64_t *oldest_key = nullptr;
+    uint64_t oldest_use = UINT64_MAX;
+    for (const auto item : entries_.items()) {
+      if (item.value.last_used < oldest_use) {
+        oldest_use = item.value.last_used;
+        oldest_key = &item.key;
+      }
+    }
+    const uint64_t key = *oldest_key;
+    size_in_bytes_ -= entries_.pop(key).size_in_bytes;
+  }
+}
+
+void OperationCache::clear()
+{
+  std::scoped_lock lock(mutex_);
+  entries_.clear();
+  size_in_bytes_ = 0;
+}
+
+}  // namespace blender::compositor
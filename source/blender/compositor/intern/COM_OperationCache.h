@@ -0,0 +1,91 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "BLI_map.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_vec_types.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+class NodeOperation;
+
+/**
+ * Keeps rendered buffers of operations between executions, so that changing a node only renders
+ * again the operations that depend on it.
+ *
+ * Buffers are identified by a key combining the parameters of an operation with the keys of the
+ * operations linked to its inputs, so the key changes whenever anything upstream changes. Only
+ * operations implementing `NodeOperation::hash_output_params`, and whose inputs all have keys,
+ * can be cached. Least recently used buffers are freed to stay within the memory limit.
+ */
+class OperationCache {
+ private:
+  struct Entry {
+    std::shared_ptr<MemoryBuffer> buffer;
+    /** Areas of the operation canvas that were rendered in the buffer. */
+    Vector<rcti> rendered_areas;
+    int64_t size_in_bytes;
+    uint64_t last_used;
+  };
+
+  Map<uint64_t, Entry> entries_;
+  int64_t size_in_bytes_ = 0;
+  uint64_t use_clock_ = 0;
+  std::mutex mutex_;
+
+ public:
+  /** Cache shared by all compositor executions. */
+  static OperationCache &get();
+
+  /**
+   * Generate the cache keys of the given operations and the operations they depend on.
+   * Operations that can't be cached have no key.
+   */
+  static Map<NodeOperation *, std::optional<uint64_t>> generate_keys(
+      Span<NodeOperation *> operations);
+
+  /**
+   * Get the buffer cached for the given key if all given areas were rendered in it.
+   */
+  std::shared_ptr<MemoryBuffer> lookup(uint64_t key, Span<rcti> areas_to_render);
+
+  /**
+   * Cache the buffer rendered for the given key, then free least recently used buffers until the
+   * cache fits in the given limit. The buffer must not be modified afterwards.
+   */
+  void add(uint64_t key,
+           std::shared_ptr<MemoryBuffer> buffer,
+           Span<rcti> rendered_areas,
+           int64_t limit_in_bytes);
+
+  /** Free all cached buffers. */
+  void clear();
+
+  int64_t size_in_bytes() const
+  {
+    return size_in_bytes_;
+  }
+
+ private:
+  void free_least_recently_used(int64_t limit_in_bytes);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:OperationCache")
+#endif
+};
+
+}  // namespace blender::compositor
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "BLI_map.hh"
 #include "BLI_vector.hh"
 
@@ -27,7 +29,8 @@ class SharedOperationBuffers {
   typedef struct BufferData {
    public:
     BufferData();
-    std::unique_ptr<MemoryBuffer> buffer;
+    /** May be shared with the #OperationCache. */
+    std::shared_ptr<MemoryBuffer> buffer;
     blender::Vector<rcti> render_areas;
     int registered_reads;
     int received_reads;
@@ -66,7 +69,7 @@ class SharedOperationBuffers {
   /**
    * Stores given operation rendered buffer.
    */
-  void set_rendered_buffer(NodeOperation *op, std::unique_ptr<MemoryBuffer> buffer);
+  void set_rendered_buffer(NodeOperation *op, std::shared_ptr<MemoryBuffer> buffer);
   /**
    * Get given operation rendered buffer.
    */
@@ -75,8 +78,14 @@ class SharedOperationBuffers {
   /**
    * Reports an operation has finished reading given operation. If all given operation dependencies
    * have finished its buffer will be disposed.
+   * \return Whether the buffer has been disposed.
+   */
+  bool read_finished(NodeOperation *read_op);
+
+  /**
+   * Remove all registered areas, reads and buffers.
    */
-  void read_finished(NodeOperation *read_op);
+  void clear();
 
  private:
   BufferData &get_buffer_data(NodeOperation *op);
@@ -0,0 +1,320 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "COM_TiledExecutionModel.h"
+
+#include "BLI_set.hh"
+#include "BLI_string.h"
+#include "BLI_timeit.hh"
+
+#include "BLT_translation.hh"
+
+#include "COM_Debug.h"
+#include "COM_ViewerOperation.h"
+#include "COM_WorkScheduler.h"
+
+#include "COM_profiler.hh"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+TiledExecutionModel::TiledExecutionModel(CompositorContext &context,
+                                         Span<NodeOperation *> operations,
+                                         const int tile_size)
+    : ExecutionModel(context, operations),
+      tile_size_(std::max(tile_size, 1)),
+      num_tiles_(0),
+      num_tiles_finished_(0)
+{
+  priorities_.append(eCompositorPriority::High);
+  priorities_.append(eCompositorPriority::Medium);
+  priorities_.append(eCompositorPriority::Low);
+}
+
+TiledExecutionModel::~TiledExecutionModel() = default;
+
+/** Operations the given outputs depend on, including the outputs themselves. */
+static Vector<NodeOperation *> get_dependencies(Span<NodeOperation *> output_ops)
+{
+  Vector<NodeOperation *> dependencies;
+  Set<NodeOperation *> visited;
+  Vector<NodeOperation *> stack(output_ops);
+  while (!stack.is_empty()) {
+    NodeOperation *operation = stack.pop_last();
+    if (!visited.add(operation)) {
+      continue;
+    }
+    dependencies.append(operation);
+    for (const int i : IndexRange(operation->get_number_of_input_sockets())) {
+      stack.append(operation->get_input_operation(i));
+    }
+  }
+  return dependencies;
+}
+
+bool TiledExecutionModel::is_supported(const CompositorContext &context,
+                                       Span<NodeOperation *> operations)
+{
+  Vector<NodeOperation *> output_ops;
+  for (NodeOperation *op : operations) {
+    if (op->is_output_operation(context.is_rendering())) {
+      output_ops.append(op);
+    }
+  }
+  for (NodeOperation *op : get_dependencies(output_ops)) {
+    const NodeOperationFlags flags = op->get_flags();
+    if (!flags.is_constant_operation && !flags.is_pixel_wise && !flags.can_be_tiled) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Vector<NodeOperation *> TiledExecutionModel::get_output_operations()
+{
+  const bool is_rendering = context_.is_rendering();
+  Vector<NodeOperation *> output_ops;
+  for (eCompositorPriority priority : priorities_) {
+    for (NodeOperation *op : operations_) {
+      const bool has_size = op->get_width() > 0 && op->get_height() > 0;
+      const bool is_priority_output = op->is_output_operation(is_rendering) &&
+                                      op->get_render_priority() == priority;
+      if (is_priority_output && has_size) {
+        output_ops.append(op);
+      }
+      else if (is_priority_output && !has_size && op->is_active_viewer_output()) {
+        static_cast<ViewerOperation *>(op)->clear_display_buffer();
+      }
+    }
+  }
+  return output_ops;
+}
+
+/** Split the area in tiles of the given size, in rows from bottom to top. */
+static Vector<rcti> split_in_tiles(const rcti &area, const int tile_size)
+{
+  Vector<rcti> tiles;
+  for (int y = area.ymin; y < area.ymax; y += tile_size) {
+    for (int x = area.xmin; x < area.xmax; x += tile_size) {
+      rcti tile;
+      BLI_rcti_init(
+          &tile, x, std::min(x + tile_size, area.xmax), y, std::min(y + tile_size, area.ymax));
+      tiles.append(tile);
+    }
+  }
+  return tiles;
+}
+
+void TiledExecutionModel::execute(ExecutionSystem &exec_system)
+{
+  const bNodeTree *node_tree = this->context_.get_bnodetree();
+  node_tree->runtime->stats_draw(node_tree->runtime->sdh,
+                                 RPT_("Compositing | Initializing execution"));
+
+  DebugInfo::graphviz(&exec_system, "compositor_prior_rendering");
+
+  for (NodeOperation *op : operations_) {
+    op->set_bnodetree(node_tree);
+  }
+
+  const Vector<NodeOperation *> output_ops = get_output_operations();
+  Vector<Vector<rcti>> output_tiles;
+  for (NodeOperation *output_op : output_ops) {
+    rcti area;
+    get_output_render_area(output_op, area);
+    output_tiles.append(split_in_tiles(area, tile_size_));
+    num_tiles_ += output_tiles.last().size();
+  }
+
+  WorkScheduler::start();
+
+  /* Operations are initialized once for all tiles, as they may prepare whole images on
+   * initialization and write them on deinitialization, as output operations do. */
+  const Vector<NodeOperation *> dependencies = get_dependencies(output_ops);
+  for (NodeOperation *op : dependencies) {
+    op->init_execution();
+  }
+
+  for (NodeOperation *op : dependencies) {
+    if (op->get_flags().is_constant_operation) {
+      rcti area;
+      BLI_rcti_init(&area, 0, op->get_width(), 0, op->get_height());
+      const DataType data_type = op->get_output_socket()->get_data_type();
+      std::unique_ptr<MemoryBuffer> buffer = std::make_unique<MemoryBuffer>(data_type, area, true);
+      op->update_memory_buffer(buffer.get(), area, {});
+      constant_buffers_.add_new(op, std::move(buffer));
+    }
+  }
+
+  for (const int i : output_ops.index_range()) {
+    for (const rcti &tile : output_tiles[i]) {
+      if (exec_system.is_breaked()) {
+        break;
+      }
+      render_tile(output_ops[i], tile);
+      num_tiles_finished_++;
+      update_progress_bar();
+    }
+  }
+
+  for (NodeOperation *op : dependencies) {
+    op->deinit_execution();
+  }
+  constant_buffers_.clear();
+
+  WorkScheduler::stop();
+}
+
+void TiledExecutionModel::render_tile(NodeOperation *output_op, const rcti &tile)
+{
+  /* Determine the areas to render of all operations the tile depends on, in their canvas
+   * coordinates. Operations reached from several readers render the union of their areas. */
+  Map<NodeOperation *, rcti> areas;
+  Vector<std::pair<NodeOperation *, rcti>> stack;
+  stack.append({output_op, tile});
+  while (!stack.is_empty()) {
+    auto [operation, render_area] = stack.pop_last();
+    if (BLI_rcti_is_empty(&render_area) || operation->get_flags().is_constant_operation) {
+      continue;
+    }
+    if (rcti *area = areas.lookup_ptr(operation)) {
+      if (BLI_rcti_inside_rcti(area, &render_area)) {
+        continue;
+      }
+      BLI_rcti_union(area, &render_area);
+      render_area = *area;
+    }
+    else {
+      areas.add_new(operation, render_area);
+    }
+
+    for (const int i : IndexRange(operation->get_number_of_input_sockets())) {
+      NodeOperation *input_op = operation->get_input_operation(i);
+      rcti input_area;
+      operation->get_area_of_interest(i, render_area, input_area);
+      BLI_rcti_isect(&input_area, &input_op->get_canvas(), &input_area);
+      stack.append({input_op, input_area});
+    }
+  }
+
+  /* Order operations from inputs to outputs and count the reads of their buffers. */
+  Vector<NodeOperation *> render_order;
+  Map<NodeOperation *, int> reads;
+  Set<NodeOperation *> visited;
+  Vector<std::pair<NodeOperation *, bool>> order_stack;
+  order_stack.append({output_op, false});
+  while (!order_stack.is_empty()) {
+    auto [operation, inputs_ordered] = order_stack.pop_last();
+    if (inputs_ordered) {
+      render_order.append(operation);
+      continue;
+    }
+    if (!areas.contains(operation) || !visited.add(operation)) {
+      continue;
+    }
+    order_stack.append({operation, true});
+    for (const int i : IndexRange(operation->get_number_of_input_sockets())) {
+      NodeOperation *input_op = operation->get_input_operation(i);
+      reads.lookup_or_add(input_op, 0)++;
+      order_stack.append({input_op, false});
+    }
+  }
+
+  Map<NodeOperation *, std::unique_ptr<MemoryBuffer>> tile_buffers;
+  for (NodeOperation *op : render_order) {
+    const timeit::TimePoint before_time = timeit::Clock::now();
+    std::unique_ptr<MemoryBuffer> buffer = render_operation(op, areas.lookup(op), tile_buffers);
+    const timeit::TimePoint after_time = timeit::Clock::now();
+
+    const bNodeInstanceKey node_instance_key = op->get_node_instance_key();
+    if (context_.get_profiler() && node_instance_key != bke::NODE_INSTANCE_KEY_NONE) {
+      context_.get_profiler()->set_node_evaluation_time(node_instance_key,
+                                                        after_time - before_time);
+    }
+
+    /* Free input buffers once all their readers are rendered. */
+    for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      int &input_reads = reads.lookup(input_op);
+      input_reads--;
+      if (input_reads == 0) {
+        tile_buffers.remove(input_op);
+      }
+    }
+    if (buffer) {
+      tile_buffers.add_new(op, std::move(buffer));
+    }
+  }
+}
+
+std::unique_ptr<MemoryBuffer> TiledExecutionModel::render_operation(
+    NodeOperation *op,
+    const rcti &area,
+    const Map<NodeOperation *, std::unique_ptr<MemoryBuffer>> &tile_buffers)
+{
+  /* Buffers are relative to the canvas of their operation, as with full frame execution. */
+  const rcti &canvas = op->get_canvas();
+  rcti op_area = area;
+  BLI_rcti_translate(&op_area, -canvas.xmin, -canvas.ymin);
+
+  /* Wrap input buffers with an offset relative to the operation canvas. */
+  Vector<std::unique_ptr<MemoryBuffer>> inputs;
+  Vector<MemoryBuffer *> input_bufs;
+  for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+    NodeOperation *input_op = op->get_input_operation(i);
+    const int offset_x = input_op->get_canvas().xmin - canvas.xmin;
+    const int offset_y = input_op->get_canvas().ymin - canvas.ymin;
+    const std::unique_ptr<MemoryBuffer> *buf = constant_buffers_.lookup_ptr(input_op);
+    if (buf == nullptr) {
+      buf = tile_buffers.lookup_ptr(input_op);
+    }
+
+    std::unique_ptr<MemoryBuffer> input;
+    if (buf) {
+      rcti rect = (*buf)->get_rect();
+      BLI_rcti_translate(&rect, offset_x, offset_y);
+      input = std::make_unique<MemoryBuffer>(
+          (*buf)->get_buffer(), (*buf)->get_num_channels(), rect, (*buf)->is_a_single_elem());
+    }
+    else {
+      /* The input area of interest is outside its canvas, nothing of it is read. */
+      rcti rect;
+      BLI_rcti_init(&rect, 0, input_op->get_width(), 0, input_op->get_height());
+      BLI_rcti_translate(&rect, offset_x, offset_y);
+      input = std::make_unique<MemoryBuffer>(
+          input_op->get_output_socket()->get_data_type(), rect, true);
+      input->clear();
+    }
+    input_bufs.append(input.get());
+    inputs.append(std::move(input));
+  }
+
+  std::unique_ptr<MemoryBuffer> buffer;
+  if (op->get_number_of_output_sockets() > 0) {
+    buffer = std::make_unique<MemoryBuffer>(op->get_output_socket()->get_data_type(), op_area);
+  }
+  op->update_memory_buffer(buffer.get(), op_area, input_bufs);
+  return buffer;
+}
+
+void TiledExecutionModel::update_progress_bar()
+{
+  const bNodeTree *tree = context_.get_bnodetree();
+  if (tree) {
+    const float progress = num_tiles_finished_ / float(num_tiles_);
+    tree->runtime->progress(tree->runtime->prh, progress);
+
+    char buf[128];
+    SNPRINTF(buf,
+             RPT_("Compositing | Tile %i-%i"),
+             std::min(num_tiles_finished_ + 1, num_tiles_),
+             num_tiles_);
+    tree->runtime->stats_draw(tree->runtime->sdh, buf);
+  }
+}
+
+}  // namespace blender::compositor
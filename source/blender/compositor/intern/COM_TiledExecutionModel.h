@@ -0,0 +1,90 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include <memory>
+
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+
+#include "COM_Enums.h"
+#include "COM_ExecutionModel.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+/* Forward declarations. */
+class CompositorContext;
+class ExecutionSystem;
+class MemoryBuffer;
+class NodeOperation;
+
+/**
+ * Renders output operations tile by tile. For each tile, only the areas of interest of the
+ * operations it depends on are rendered, in order from inputs to outputs, and their buffers are
+ * freed as soon as their readers are rendered. Memory usage is then proportional to the tile size
+ * instead of the canvas size, at the cost of rendering again the margins shared by neighbor tiles.
+ *
+ * Only usable when all operations the outputs depend on can be tiled, see #is_supported.
+ */
+class TiledExecutionModel : public ExecutionModel {
+ private:
+  int tile_size_;
+
+  /**
+   * Order of priorities for output operations execution.
+   */
+  Vector<eCompositorPriority> priorities_;
+
+  /** Buffers of constant operations, rendered once for all tiles. */
+  Map<NodeOperation *, std::unique_ptr<MemoryBuffer>> constant_buffers_;
+
+  int num_tiles_;
+  int num_tiles_finished_;
+
+ public:
+  TiledExecutionModel(CompositorContext &context,
+                      Span<NodeOperation *> operations,
+                      int tile_size);
+  ~TiledExecutionModel();
+
+  /**
+   * Whether all operations the output operations depend on are constant, pixel-wise or can be
+   * tiled, see #NodeOperationFlags::can_be_tiled.
+   */
+  static bool is_supported(const CompositorContext &context, Span<NodeOperation *> operations);
+
+  void execute(ExecutionSystem &exec_system) override;
+
+ private:
+  /**
+   * Output operations with a size, in order of priority.
+   */
+  Vector<NodeOperation *> get_output_operations();
+  /**
+   * Render the given area of the output operation and the areas of interest of the operations
+   * it depends on.
+   */
+  void render_tile(NodeOperation *output_op, const rcti &tile);
+  /**
+   * Render the given operation area, with input buffers relative to its canvas.
+   * Returns nullptr for output operations.
+   */
+  std::unique_ptr<MemoryBuffer> render_operation(
+      NodeOperation *op,
+      const rcti &area,
+      const Map<NodeOperation *, std::unique_ptr<MemoryBuffer>> &tile_buffers);
+
+  void update_progress_bar();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:TiledExecutionModel")
+#endif
+};
+
+}  // namespace blender::compositor
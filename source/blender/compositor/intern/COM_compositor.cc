@@ -2,6 +2,8 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <cstdio>
+
 #include "BLI_threads.h"
 
 #include "BLT_translation.hh"
@@ -10,7 +12,10 @@
 #include "BKE_node_runtime.hh"
 #include "BKE_scene.hh"
 
+#include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_MemoryBufferPool.h"
+#include "COM_OperationCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.hh"
 
@@ -90,9 +95,26 @@ void COM_execute(Render *render,
 
     /* Execute. */
     const bool is_rendering = render_context != nullptr;
-    blender::compositor::ExecutionSystem system(
-        render_data, scene, node_tree, is_rendering, view_name, render_context, profiler);
-    system.execute();
+    {
+      blender::compositor::ExecutionSystem system(
+          render_data, scene, node_tree, is_rendering, view_name, render_context, profiler);
+      system.execute();
+    }
+
+    /* All buffers of the execution are released, free pooled memory it didn't need. */
+    blender::compositor::MemoryBufferPool &buffer_pool =
+        blender::compositor::MemoryBufferPool::get();
+    buffer_pool.execution_finished();
+    if (blender::compositor::COM_PRINT_BUFFER_POOL_STATS) {
+      const blender::compositor::MemoryBufferPool::Stats stats = buffer_pool.get_stats();
+      printf("Compositor buffer pool: %.1f MB used, %.1f MB idle, %.1f MB peak, "
+             "%.1f MB reused, %.1f MB allocated\n",
+             stats.used_bytes / (1024.0 * 1024.0),
+             stats.idle_bytes / (1024.0 * 1024.0),
+             stats.peak_used_bytes / (1024.0 * 1024.0),
+             stats.reused_bytes / (1024.0 * 1024.0),
+             stats.allocated_bytes / (1024.0 * 1024.0));
+    }
   }
 
   BLI_mutex_unlock(&g_compositor.mutex);
@@ -103,8 +125,16 @@ void COM_deinitialize()
   if (g_compositor.is_initialized) {
     BLI_mutex_lock(&g_compositor.mutex);
     blender::compositor::WorkScheduler::deinitialize();
+    blender::compositor::OperationCache::get().clear();
+    blender::compositor::MemoryBufferPool::get().clear();
     g_compositor.is_initialized = false;
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
   }
 }
+
+void COM_clear_caches()
+{
+  blender::compositor::OperationCache::get().clear();
+  blender::compositor::MemoryBufferPool::get().clear();
+}
@@ -38,4 +38,10 @@ void AlphaOverMixedOperation::update_memory_buffer_row(PixelCursor &p)
   }
 }
 
+void AlphaOverMixedOperation::hash_output_params()
+{
+  MixBaseOperation::hash_output_params();
+  hash_param(x_);
+}
+
 }  // namespace blender::compositor
@@ -179,4 +179,10 @@ void BokehImageOperation::determine_canvas(const rcti & /*preferred_area*/, rcti
   BLI_rcti_init(&r_area, 0, resolution_, 0, resolution_);
 }
 
+void BokehImageOperation::hash_output_params()
+{
+  hash_params(data_->angle, data_->flaps, data_->rounding);
+  hash_params(data_->catadioptric, data_->lensshift, resolution_);
+}
+
 }  // namespace blender::compositor
@@ -16,6 +16,7 @@ BrightnessOperation::BrightnessOperation()
   this->add_output_socket(DataType::Color);
   use_premultiply_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 void BrightnessOperation::set_use_premultiply(bool use_premultiply)
@@ -67,4 +68,9 @@ void BrightnessOperation::update_memory_buffer_partial(MemoryBuffer *output,
   }
 }
 
+void BrightnessOperation::hash_output_params()
+{
+  hash_param(use_premultiply_);
+}
+
 }  // namespace blender::compositor
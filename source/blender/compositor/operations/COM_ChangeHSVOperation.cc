@@ -14,6 +14,7 @@ ChangeHSVOperation::ChangeHSVOperation()
   this->add_input_socket(DataType::Value);
   this->add_output_socket(DataType::Color);
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 void ChangeHSVOperation::update_memory_buffer_partial(MemoryBuffer *output,
@@ -13,6 +13,7 @@ ConvolutionFilterOperation::ConvolutionFilterOperation()
   this->add_output_socket(DataType::Color);
   this->set_canvas_input_index(0);
   flags_.can_be_constant = true;
+  flags_.can_be_tiled = true;
 }
 
 void ConvolutionFilterOperation::set3x3Filter(
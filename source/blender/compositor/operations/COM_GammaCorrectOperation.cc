@@ -75,4 +75,8 @@ void GammaUncorrectOperation::update_memory_buffer_partial(MemoryBuffer *output,
   }
 }
 
+void GammaCorrectOperation::hash_output_params() {}
+
+void GammaUncorrectOperation::hash_output_params() {}
+
 }  // namespace blender::compositor
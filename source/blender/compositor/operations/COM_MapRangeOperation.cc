@@ -16,6 +16,7 @@ MapRangeOperation::MapRangeOperation()
   this->add_output_socket(DataType::Value);
   use_clamp_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 /* The code below assumes all data is inside range +- this, and that input buffer is single channel
@@ -11,6 +11,7 @@ MapValueOperation::MapValueOperation()
   this->add_input_socket(DataType::Value);
   this->add_output_socket(DataType::Value);
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 void MapValueOperation::update_memory_buffer_partial(MemoryBuffer *output,
@@ -18,6 +18,7 @@ MathBaseOperation::MathBaseOperation()
   this->add_output_socket(DataType::Value);
   use_clamp_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 void MathBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
@@ -363,4 +364,9 @@ void MathSmoothMaxOperation::update_memory_buffer_partial(BuffersIterator<float>
   }
 }
 
+void MathBaseOperation::hash_output_params()
+{
+  hash_param(use_clamp_);
+}
+
 }  // namespace blender::compositor
@@ -23,6 +23,7 @@ RenderLayersProg::RenderLayersProg(const char *pass_name, DataType type, int ele
   layer_buffer_ = nullptr;
 
   this->add_output_socket(type);
+  flags_.can_be_tiled = true;
 }
 
 void RenderLayersProg::init_execution()
@@ -63,6 +64,23 @@ void RenderLayersProg::deinit_execution()
   }
 }
 
+void RenderLayersProg::hash_output_params()
+{
+  /* The render result identifies the render slot. Pointers of freed results could be reused by
+   * newer renders, but compositor caches are cleared whenever a render result is created (see
+   * #ntreeCompositTagRender) and are not used while rendering. */
+  Scene *scene = this->get_scene();
+  Render *re = (scene) ? RE_GetSceneRender(scene) : nullptr;
+  const RenderResult *rr = (re) ? RE_AcquireResultRead(re) : nullptr;
+  hash_params(scene, rr);
+  if (re) {
+    RE_ReleaseResult(re);
+  }
+
+  hash_params(layer_id_, elementsize_, StringRef(pass_name_));
+  hash_param(StringRef(view_name_ ? view_name_ : ""));
+}
+
 void RenderLayersProg::determine_canvas(const rcti & /*preferred_area*/, rcti &r_area)
 {
   Scene *sce = this->get_scene();
@@ -115,6 +115,9 @@ class RenderLayersProg : public MultiThreadedOperation {
   virtual void update_memory_buffer_partial(MemoryBuffer *output,
                                             const rcti &area,
                                             Span<MemoryBuffer *> inputs) override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 class RenderLayersAOOperation : public RenderLayersProg {
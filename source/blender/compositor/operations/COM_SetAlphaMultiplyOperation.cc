@@ -13,6 +13,7 @@ SetAlphaMultiplyOperation::SetAlphaMultiplyOperation()
   this->add_output_socket(DataType::Color);
 
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 void SetAlphaMultiplyOperation::update_memory_buffer_partial(MemoryBuffer *output,
@@ -26,4 +27,6 @@ void SetAlphaMultiplyOperation::update_memory_buffer_partial(MemoryBuffer *outpu
   }
 }
 
+void SetAlphaMultiplyOperation::hash_output_params() {}
+
 }  // namespace blender::compositor
@@ -13,6 +13,7 @@ SetAlphaReplaceOperation::SetAlphaReplaceOperation()
   this->add_output_socket(DataType::Color);
 
   flags_.can_be_constant = true;
+  flags_.is_pixel_wise = true;
 }
 
 void SetAlphaReplaceOperation::update_memory_buffer_partial(MemoryBuffer *output,
@@ -27,4 +28,6 @@ void SetAlphaReplaceOperation::update_memory_buffer_partial(MemoryBuffer *output
   }
 }
 
+void SetAlphaReplaceOperation::hash_output_params() {}
+
 }  // namespace blender::compositor
@@ -130,6 +130,11 @@ void VariableSizeBokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *
   }
 }
 
+void VariableSizeBokehBlurOperation::hash_output_params()
+{
+  hash_params(max_blur_, threshold_, do_size_scale_);
+}
+
 #ifdef COM_DEFOCUS_SEARCH
 /* #InverseSearchRadiusOperation. */
 InverseSearchRadiusOperation::InverseSearchRadiusOperation()
@@ -0,0 +1,108 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "COM_ConvertOperation.h"
+#include "COM_FusedPixelOperation.h"
+#include "COM_InvertOperation.h"
+#include "COM_MathBaseOperation.h"
+
+namespace blender::compositor::tests {
+
+class InputOperation : public NodeOperation {
+ public:
+  InputOperation()
+  {
+    add_output_socket(DataType::Value);
+  }
+};
+
+static void link(NodeOperation &from, NodeOperation &to, const int input_index)
+{
+  to.get_input_socket(input_index)->set_link(from.get_output_socket());
+}
+
+TEST(FusedPixelOperation, chain)
+{
+  /* Tall enough to be evaluated in several bands, the last one being smaller. */
+  const rcti area = {0, 70, 0, 150};
+  InputOperation input_a, input_b, input_factor;
+
+  MathAddOperation *add = new MathAddOperation();
+  link(input_a, *add, 0);
+  link(input_b, *add, 1);
+  /* Unused third input of math operations, connected as it would be by the builder. */
+  link(input_b, *add, 2);
+  ConvertValueToColorOperation *to_color = new ConvertValueToColorOperation();
+  link(*add, *to_color, 0);
+  InvertOperation *invert = new InvertOperation();
+  link(input_factor, *invert, 0);
+  link(*to_color, *invert, 1);
+  invert->set_canvas(area);
+
+  FusedPixelOperation fused({add, to_color, invert});
+  ASSERT_EQ(fused.get_number_of_input_sockets(), 3);
+  EXPECT_EQ(fused.get_input_operation(0), &input_a);
+  EXPECT_EQ(fused.get_input_operation(1), &input_b);
+  EXPECT_EQ(fused.get_input_operation(2), &input_factor);
+  EXPECT_EQ(fused.get_output_socket()->get_data_type(), DataType::Color);
+  EXPECT_TRUE(BLI_rcti_compare(&fused.get_canvas(), &area));
+
+  MemoryBuffer buffer_a(DataType::Value, area);
+  MemoryBuffer buffer_b(DataType::Value, area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      *buffer_a.get_elem(x, y) = x * 0.01f;
+      *buffer_b.get_elem(x, y) = y * 0.001f;
+    }
+  }
+  const float factor = 0.25f;
+  MemoryBuffer buffer_factor(DataType::Value, area, true);
+  *buffer_factor.get_buffer() = factor;
+
+  MemoryBuffer output(DataType::Color, area);
+  fused.update_memory_buffer_partial(
+      &output, area, Span<MemoryBuffer *>{&buffer_a, &buffer_b, &buffer_factor});
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      const float sum = x * 0.01f + y * 0.001f;
+      const float expected = (1.0f - sum) * factor + sum * (1.0f - factor);
+      const float *result = output.get_elem(x, y);
+      EXPECT_FLOAT_EQ(result[0], expected);
+      EXPECT_FLOAT_EQ(result[2], expected);
+      EXPECT_FLOAT_EQ(result[3], 1.0f);
+    }
+  }
+}
+
+TEST(FusedPixelOperation, shared_input)
+{
+  const rcti area = {0, 3, 0, 2};
+  InputOperation input;
+
+  /* The same input read twice becomes a single input of the fused operation. */
+  MathAddOperation *add = new MathAddOperation();
+  link(input, *add, 0);
+  link(input, *add, 1);
+  link(input, *add, 2);
+  MathMultiplyOperation *multiply = new MathMultiplyOperation();
+  link(*add, *multiply, 0);
+  link(*add, *multiply, 1);
+  link(*add, *multiply, 2);
+  multiply->set_canvas(area);
+
+  FusedPixelOperation fused({add, multiply});
+  ASSERT_EQ(fused.get_number_of_input_sockets(), 1);
+
+  MemoryBuffer buffer(DataType::Value, area);
+  const float value = 1.5f;
+  buffer.fill(area, &value);
+  MemoryBuffer output(DataType::Value, area);
+  fused.update_memory_buffer_partial(&output, area, Span<MemoryBuffer *>{&buffer});
+  EXPECT_FLOAT_EQ(*output.get_elem(2, 1), 9.0f);
+}
+
+}  // namespace blender::compositor::tests
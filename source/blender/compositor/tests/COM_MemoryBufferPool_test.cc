@@ -0,0 +1,78 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "COM_MemoryBufferPool.h"
+
+namespace blender::compositor::tests {
+
+static constexpr int64_t MB = 1024 * 1024;
+
+TEST(MemoryBufferPool, size_class)
+{
+  EXPECT_EQ(MemoryBufferPool::get_size_class(16), 16);
+  EXPECT_EQ(MemoryBufferPool::get_size_class(MB), MB);
+  EXPECT_EQ(MemoryBufferPool::get_size_class(MB + 1), MB + MB / 4);
+  EXPECT_EQ(MemoryBufferPool::get_size_class(MB + MB / 4), MB + MB / 4);
+  EXPECT_EQ(MemoryBufferPool::get_size_class(2 * MB - 1), 2 * MB);
+  EXPECT_EQ(MemoryBufferPool::get_size_class(5 * MB), 5 * MB);
+  EXPECT_EQ(MemoryBufferPool::get_size_class(5 * MB + 1), 6 * MB);
+}
+
+TEST(MemoryBufferPool, reuse)
+{
+  MemoryBufferPool pool;
+  float *buffer_a = pool.acquire(MB);
+  pool.release(buffer_a, MB);
+
+  /* Released memory is reused by allocations of the same size class. */
+  float *buffer_b = pool.acquire(MB - 1024);
+  EXPECT_EQ(buffer_b, buffer_a);
+  float *buffer_c = pool.acquire(MB);
+  EXPECT_NE(buffer_c, buffer_a);
+
+  MemoryBufferPool::Stats stats = pool.get_stats();
+  EXPECT_EQ(stats.used_bytes, 2 * MB);
+  EXPECT_EQ(stats.idle_bytes, 0);
+  EXPECT_EQ(stats.peak_used_bytes, 2 * MB);
+  EXPECT_EQ(stats.reused_bytes, MB);
+  EXPECT_EQ(stats.allocated_bytes, 2 * MB);
+
+  pool.release(buffer_b, MB - 1024);
+  pool.release(buffer_c, MB);
+  stats = pool.get_stats();
+  EXPECT_EQ(stats.used_bytes, 0);
+  EXPECT_EQ(stats.idle_bytes, 2 * MB);
+
+  /* Small allocations are not pooled. */
+  float *small_buffer = pool.acquire(64);
+  pool.release(small_buffer, 64);
+  EXPECT_EQ(pool.get_stats().idle_bytes, 2 * MB);
+}
+
+TEST(MemoryBufferPool, execution_finished)
+{
+  MemoryBufferPool pool;
+  pool.release(pool.acquire(MB), MB);
+  pool.release(pool.acquire(2 * MB), 2 * MB);
+
+  /* Memory released in the last execution is kept for the next one. */
+  pool.execution_finished();
+  EXPECT_EQ(pool.get_stats().idle_bytes, 3 * MB);
+
+  /* Memory not used again by the next execution is freed. */
+  float *buffer = pool.acquire(MB);
+  pool.execution_finished();
+  EXPECT_EQ(pool.get_stats().idle_bytes, 0);
+
+  pool.release(buffer, MB);
+  pool.clear();
+  const MemoryBufferPool::Stats stats = pool.get_stats();
+  EXPECT_EQ(stats.idle_bytes, 0);
+  EXPECT_EQ(stats.reused_bytes, 0);
+  EXPECT_EQ(stats.allocated_bytes, 0);
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,106 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "COM_MathBaseOperation.h"
+#include "COM_OperationCache.h"
+#include "COM_SetValueOperation.h"
+
+namespace blender::compositor::tests {
+
+/** Operation that can't be cached, as it doesn't implement #hash_output_params. */
+class NonHashedInputOperation : public NodeOperation {
+ public:
+  NonHashedInputOperation()
+  {
+    add_output_socket(DataType::Value);
+  }
+};
+
+struct AddGraph {
+  SetValueOperation value_a;
+  SetValueOperation value_b;
+  NonHashedInputOperation non_hashed;
+  MathAddOperation add;
+
+  AddGraph(const float a, const float b)
+  {
+    value_a.set_value(a);
+    value_b.set_value(b);
+    add.get_input_socket(0)->set_link(value_a.get_output_socket());
+    add.get_input_socket(1)->set_link(value_b.get_output_socket());
+    /* Unused third input of math operations, connected as it would be by the builder. */
+    add.get_input_socket(2)->set_link(value_b.get_output_socket());
+    add.set_canvas({0, 10, 0, 10});
+  }
+};
+
+TEST(OperationCache, keys)
+{
+  AddGraph graph_a(1.0f, 2.0f);
+  AddGraph graph_b(1.0f, 2.0f);
+  AddGraph graph_c(3.0f, 2.0f);
+
+  auto key = [](NodeOperation &op) -> std::optional<uint64_t> {
+    return OperationCache::generate_keys({&op}).lookup(&op);
+  };
+
+  /* Equal graphs have equal keys, changing an input changes the key. */
+  ASSERT_TRUE(key(graph_a.add).has_value());
+  EXPECT_EQ(key(graph_a.add), key(graph_b.add));
+  EXPECT_NE(key(graph_a.add), key(graph_c.add));
+
+  /* Changing a parameter changes the key. */
+  graph_b.add.set_use_clamp(true);
+  EXPECT_NE(key(graph_a.add), key(graph_b.add));
+
+  /* Operations depending on operations that can't be cached have no key. */
+  graph_a.add.get_input_socket(1)->set_link(graph_a.non_hashed.get_output_socket());
+  EXPECT_FALSE(key(graph_a.non_hashed).has_value());
+  EXPECT_FALSE(key(graph_a.add).has_value());
+}
+
+TEST(OperationCache, lookup_rendered_areas)
+{
+  OperationCache cache;
+  const rcti canvas = {0, 10, 0, 10};
+  const rcti half = {0, 10, 0, 5};
+  cache.add(1, std::make_shared<MemoryBuffer>(DataType::Value, canvas), {half}, 1024 * 1024);
+
+  EXPECT_NE(cache.lookup(1, {half}), nullptr);
+  EXPECT_NE(cache.lookup(1, {rcti{2, 4, 1, 3}}), nullptr);
+  EXPECT_EQ(cache.lookup(1, {canvas}), nullptr);
+  EXPECT_EQ(cache.lookup(2, {half}), nullptr);
+}
+
+TEST(OperationCache, free_least_recently_used)
+{
+  OperationCache cache;
+  const rcti canvas = {0, 10, 0, 10};
+  const int64_t buffer_size = 10 * 10 * sizeof(float);
+  const int64_t limit = buffer_size * 2;
+  for (const uint64_t key : {1, 2}) {
+    cache.add(key, std::make_shared<MemoryBuffer>(DataType::Value, canvas), {canvas}, limit);
+  }
+  EXPECT_EQ(cache.size_in_bytes(), buffer_size * 2);
+
+  /* Using the first buffer makes the second one the least recently used. */
+  std::shared_ptr<MemoryBuffer> first = cache.lookup(1, {canvas});
+  cache.add(3, std::make_shared<MemoryBuffer>(DataType::Value, canvas), {canvas}, limit);
+  EXPECT_EQ(cache.size_in_bytes(), buffer_size * 2);
+  EXPECT_EQ(cache.lookup(1, {canvas}), first);
+  EXPECT_EQ(cache.lookup(2, {canvas}), nullptr);
+  EXPECT_NE(cache.lookup(3, {canvas}), nullptr);
+
+  /* Buffers larger than the limit are not cached. */
+  cache.add(4, std::make_shared<MemoryBuffer>(DataType::Color, canvas), {canvas}, limit);
+  EXPECT_EQ(cache.lookup(4, {canvas}), nullptr);
+
+  cache.clear();
+  EXPECT_EQ(cache.size_in_bytes(), 0);
+  EXPECT_EQ(cache.lookup(1, {canvas}), nullptr);
+}
+
+}  // namespace blender::compositor::tests
@@ -417,6 +417,7 @@ static int wm_obj_import_exec(bContext *C, wmOperator *op)
   import_params.collection_separator = separator[0];
   import_params.relative_paths = ((U.flag & USER_RELPATHS) != 0);
   import_params.clear_selection = true;
+  import_params.use_parallel_parse = RNA_boolean_get(op->ptr, "use_parallel_parse");
 
   import_params.reports = op->reports;
 
@@ -462,6 +463,7 @@ static void ui_obj_import_settings(const bContext *C, uiLayout *layout, PointerR
     uiItemR(col, ptr, "import_vertex_groups", UI_ITEM_NONE, nullptr, ICON_NONE);
     uiItemR(col, ptr, "validate_meshes", UI_ITEM_NONE, nullptr, ICON_NONE);
     uiItemR(col, ptr, "collection_separator", UI_ITEM_NONE, nullptr, ICON_NONE);
+    uiItemR(col, ptr, "use_parallel_parse", UI_ITEM_NONE, nullptr, ICON_NONE);
   }
 }
 
@@ -547,6 +549,11 @@ void WM_OT_obj_import(wmOperatorType *ot)
                  2,
                  "Path Separator",
                  "Character used to separate objects name into hierarchical structure");
+  RNA_def_boolean(ot->srna,
+                  "use_parallel_parse",
+                  true,
+                  "Parallel Parsing",
+                  "Read the file using multiple threads");
 
   /* Only show `.obj` or `.mtl` files by default. */
   prop = RNA_def_string(ot->srna, "filter_glob", "*.obj;*.mtl", 0, "Extension Filter", "");
@@ -315,7 +315,12 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
                     path.meta_dir.c_str(),
                     (frame_file_name + ".json").c_str());
       BLI_file_ensure_parent_dir_exists(meta_path);
-      bake::DiskBlobWriter blob_writer{path.blobs_dir, frame_file_name};
+      const NodesModifierBake *node_bake = nmd.find_bake(request.bake_id);
+      const bool use_compression = node_bake && (node_bake->flag & NODES_MODIFIER_BAKE_COMPRESS);
+      bake::DiskBlobWriter blob_writer{path.blobs_dir,
+                                       frame_file_name,
+                                       use_compression ? bake::BlobCompression::Zstd :
+                                                         bake::BlobCompression::None};
       fstream meta_file{meta_path, std::ios::out};
       bake::serialize_bake(frame_cache.state, blob_writer, *request.blob_sharing, meta_file);
     }
@@ -37,7 +37,8 @@ static void snap_object_data_mesh_get(const Mesh *mesh_eval,
                             mesh_eval,
                             skip_hidden ? BVHTREE_FROM_CORNER_TRIS_NO_HIDDEN :
                                           BVHTREE_FROM_CORNER_TRIS,
-                            4);
+                            4,
+                            BVH_BALANCE_WIDE);
 }
 
 /** \} */
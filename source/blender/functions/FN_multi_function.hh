@@ -119,6 +119,12 @@ class MultiFunction : NonCopyable, NonMovable {
      * educated guess about a good grain size.
      */
     bool uniform_execution_time = true;
+    /**
+     * Indicates that the multi-function has a significant setup cost for every call (e.g. building
+     * an acceleration structure or batching queries), so it should be called with the full mask
+     * instead of being called separately for many small chunks of it.
+     */
+    bool prefers_full_mask = false;
   };
 
   ExecutionHints execution_hints() const;
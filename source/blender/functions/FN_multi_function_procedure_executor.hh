@@ -12,14 +12,29 @@
 
 namespace blender::fn::multi_function {
 
-/** A multi-function that executes a procedure internally. */
+/**
+ * A multi-function that executes a procedure internally.
+ *
+ * Large masks are split into chunks that are processed by all instructions before continuing
+ * with the next chunk. This keeps intermediate buffers small enough to stay in cache and allows
+ * them to be reused for every chunk.
+ */
 class ProcedureExecutor : public MultiFunction {
  private:
   Signature signature_;
   const Procedure &procedure_;
+  /** Maximum number of indices processed at once. Zero disables chunked execution. */
+  int64_t chunk_size_;
+  /**
+   * Chunked execution requires that all parameters can be sliced and that no called function
+   * prefers to get the full mask.
+   */
+  bool supports_chunks_ = true;
 
  public:
-  ProcedureExecutor(const Procedure &procedure);
+  static constexpr int64_t default_chunk_size = 1024;
+
+  ProcedureExecutor(const Procedure &procedure, int64_t chunk_size = default_chunk_size);
 
   void call(const IndexMask &mask, Params params, Context context) const override;
 
@@ -140,17 +140,78 @@ static Set<GFieldRef> find_varying_fields(const FieldTreeInfo &field_tree_info,
   return found_fields;
 }
 
+/**
+ * \return All fields that don't vary, but that are used by varying fields. Those are computed
+ * once before the varying fields are evaluated, instead of for every chunk of indices that the
+ * procedure executor processes.
+ */
+static VectorSet<GFieldRef> find_fields_to_hoist(const Set<GFieldRef> &varying_fields)
+{
+  VectorSet<GFieldRef> fields_to_hoist;
+  for (const GFieldRef &field : varying_fields) {
+    const FieldNode &field_node = field.node();
+    if (field_node.node_type() != FieldNodeType::Operation) {
+      continue;
+    }
+    const FieldOperation &operation = static_cast<const FieldOperation &>(field_node);
+    for (const GFieldRef input_field : operation.inputs()) {
+      if (varying_fields.contains(input_field)) {
+        continue;
+      }
+      /* Inputs and constants are cheap to access already. */
+      if (input_field.node().node_type() == FieldNodeType::Operation) {
+        fields_to_hoist.add(input_field);
+      }
+    }
+  }
+  return fields_to_hoist;
+}
+
+/**
+ * Identifies a call of a multi-function with specific input variables. Field operations that
+ * result in the same call compute the same values, so only the first one has to be called. This
+ * happens a lot when a node group is used multiple times with the same inputs.
+ */
+struct FieldCallKey {
+  const mf::MultiFunction *fn;
+  Vector<mf::Variable *> inputs;
+
+  uint64_t hash() const
+  {
+    return get_default_hash(fn->hash(), inputs.hash());
+  }
+
+  friend bool operator==(const FieldCallKey &a, const FieldCallKey &b)
+  {
+    if (a.inputs != b.inputs) {
+      return false;
+    }
+    if (a.fn == b.fn) {
+      return true;
+    }
+    /* Functions with different hashes may not be comparable. */
+    return a.fn->hash() == b.fn->hash() && a.fn->equals(*b.fn);
+  }
+};
+
 /**
  * Builds the #procedure so that it computes the fields.
+ *
+ * \param precomputed_fields: Fields whose values are computed already. They are passed into the
+ * procedure as input parameters after the field inputs.
  */
 static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
                                                       ResourceScope &scope,
                                                       const FieldTreeInfo &field_tree_info,
-                                                      Span<GFieldRef> output_fields)
+                                                      Span<GFieldRef> output_fields,
+                                                      Span<GFieldRef> precomputed_fields = {})
 {
   mf::ProcedureBuilder builder{procedure};
   /* Every input, intermediate and output field corresponds to a variable in the procedure. */
   Map<GFieldRef, mf::Variable *> variable_by_field;
+  /* The output variables of every call, used to avoid calling the same function with the same
+   * inputs multiple times. Ignored outputs are null. */
+  Map<FieldCallKey, Vector<mf::Variable *>> outputs_by_call;
 
   /* Start by adding the field inputs as parameters to the procedure. */
   for (const FieldInput &field_input : field_tree_info.deduplicated_field_inputs) {
@@ -158,6 +219,11 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
         mf::DataType::ForSingle(field_input.cpp_type()), field_input.debug_name());
     variable_by_field.add_new({field_input, 0}, &variable);
   }
+  for (const GFieldRef &field : precomputed_fields) {
+    mf::Variable &variable = builder.add_input_parameter(
+        mf::DataType::ForSingle(field.cpp_type()));
+    variable_by_field.add_new(field, &variable);
+  }
 
   /* Utility struct that is used to do proper depth first search traversal of the tree below. */
   struct FieldWithIndex {
@@ -198,7 +264,42 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
             /* All inputs variables are ready, now gather all variables that are used by the
              * function and call it. */
             const mf::MultiFunction &multi_function = operation_node.multi_function();
+
+            FieldCallKey call_key{&multi_function, {}};
+            for (const GField &input_field : operation_inputs) {
+              call_key.inputs.append(variable_by_field.lookup(input_field));
+            }
+            auto is_output_used = [&](const GFieldRef output_field) {
+              return !field_tree_info.field_users.lookup(output_field).is_empty() ||
+                     output_fields.contains(output_field);
+            };
+
+            /* Reuse the outputs of an identical call if it computed all outputs that are used
+             * here. */
+            if (const Vector<mf::Variable *> *existing_outputs = outputs_by_call.lookup_ptr(
+                    call_key))
+            {
+              bool has_all_outputs = true;
+              for (const int output_index : existing_outputs->index_range()) {
+                if ((*existing_outputs)[output_index] == nullptr &&
+                    is_output_used({operation_node, output_index}))
+                {
+                  has_all_outputs = false;
+                  break;
+                }
+              }
+              if (has_all_outputs) {
+                for (const int output_index : existing_outputs->index_range()) {
+                  if (mf::Variable *variable = (*existing_outputs)[output_index]) {
+                    variable_by_field.add_new({operation_node, output_index}, variable);
+                  }
+                }
+                break;
+              }
+            }
+
             Vector<mf::Variable *> variables(multi_function.param_amount());
+            Vector<mf::Variable *> output_variables;
 
             int param_input_index = 0;
             int param_output_index = 0;
@@ -206,16 +307,12 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
               const mf::ParamType param_type = multi_function.param_type(param_index);
               const mf::ParamType::InterfaceType interface_type = param_type.interface_type();
               if (interface_type == mf::ParamType::Input) {
-                const GField &input_field = operation_inputs[param_input_index];
-                variables[param_index] = variable_by_field.lookup(input_field);
+                variables[param_index] = call_key.inputs[param_input_index];
                 param_input_index++;
               }
               else if (interface_type == mf::ParamType::Output) {
                 const GFieldRef output_field{operation_node, param_output_index};
-                const bool output_is_ignored =
-                    field_tree_info.field_users.lookup(output_field).is_empty() &&
-                    !output_fields.contains(output_field);
-                if (output_is_ignored) {
+                if (!is_output_used(output_field)) {
                   /* Ignored outputs don't need a variable. */
                   variables[param_index] = nullptr;
                 }
@@ -225,6 +322,7 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
                   variables[param_index] = &new_variable;
                   variable_by_field.add_new(output_field, &new_variable);
                 }
+                output_variables.append(variables[param_index]);
                 param_output_index++;
               }
               else {
@@ -232,6 +330,7 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
               }
             }
             builder.add_call_with_all_variables(multi_function, variables);
+            outputs_by_call.add_overwrite(std::move(call_key), std::move(output_variables));
           }
           break;
         }
@@ -239,8 +338,14 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
           const FieldConstant &constant_node = static_cast<const FieldConstant &>(field_node);
           const mf::MultiFunction &fn = procedure.construct_function<mf::CustomMF_GenericConstant>(
               constant_node.type(), constant_node.value().get(), false);
-          mf::Variable &new_variable = *builder.add_call<1>(fn)[0];
-          variable_by_field.add_new(field, &new_variable);
+          if (!constant_node.type().is_equality_comparable()) {
+            variable_by_field.add_new(field, builder.add_call<1>(fn)[0]);
+            break;
+          }
+          /* Constant functions compare their values, so equal constants share a variable. */
+          const Vector<mf::Variable *> &outputs = outputs_by_call.lookup_or_add_cb(
+              {&fn, {}}, [&]() { return Vector<mf::Variable *>{builder.add_call<1>(fn)[0]}; });
+          variable_by_field.add_new(field, outputs[0]);
           break;
         }
       }
@@ -261,13 +366,16 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
     builder.add_output_parameter(*variable);
   }
 
-  /* Remove the variables that should not be destructed from the map. */
-  for (const GFieldRef &field : output_fields) {
-    variable_by_field.remove(field);
-  }
-  /* Add destructor calls for the remaining variables. */
+  /* Add destructor calls for the remaining variables. Output variables must not be destructed.
+   * Multiple fields may share the same variable. */
+  Set<mf::Variable *> destructed_variables;
   for (mf::Variable *variable : variable_by_field.values()) {
-    builder.add_destruct(*variable);
+    if (already_output_variables.contains(variable)) {
+      continue;
+    }
+    if (destructed_variables.add(variable)) {
+      builder.add_destruct(*variable);
+    }
   }
 
   mf::ReturnInstruction &return_instr = builder.add_return();
@@ -365,12 +473,66 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     }
   }
 
+  /* Constant fields that varying fields depend on are evaluated together with the constant
+   * fields. The varying fields get their values as inputs. */
+  Vector<GFieldRef> hoisted_fields;
+  if (!varying_fields_to_evaluate.is_empty()) {
+    hoisted_fields.extend(find_fields_to_hoist(varying_fields).as_span());
+  }
+  Vector<GVArray> hoisted_varrays;
+
+  /* Evaluate constant fields if necessary. */
+  Vector<GFieldRef> constant_procedure_outputs = constant_fields_to_evaluate;
+  constant_procedure_outputs.extend(hoisted_fields);
+  if (!constant_procedure_outputs.is_empty()) {
+    /* Build the procedure for those fields. */
+    mf::Procedure procedure;
+    build_multi_function_procedure_for_fields(
+        procedure, scope, field_tree_info, constant_procedure_outputs);
+    mf::ProcedureExecutor procedure_executor{procedure};
+    const IndexMask mask(1);
+    mf::ParamsBuilder mf_params{procedure_executor, &mask};
+    mf::ContextBuilder mf_context;
+
+    /* Provide inputs to the procedure executor. */
+    for (const GVArray &varray : field_context_inputs) {
+      mf_params.add_readonly_single_input(varray);
+    }
+
+    for (const int i : constant_procedure_outputs.index_range()) {
+      const GFieldRef &field = constant_procedure_outputs[i];
+      const CPPType &type = field.cpp_type();
+      /* Allocate memory where the computed value will be stored in. */
+      void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
+
+      if (!type.is_trivially_destructible()) {
+        /* Destruct value in the end. */
+        scope.add_destruct_call([buffer, &type]() { type.destruct(buffer); });
+      }
+
+      /* Pass output buffer to the procedure executor. */
+      mf_params.add_uninitialized_single_output({type, buffer, 1});
+
+      /* Create virtual array that can be used after the procedure has been executed below. */
+      GVArray varray = GVArray::ForSingleRef(type, array_size, buffer);
+      if (i < constant_fields_to_evaluate.size()) {
+        const int out_index = constant_field_indices[i];
+        r_varrays[out_index] = std::move(varray);
+      }
+      else {
+        hoisted_varrays.append(std::move(varray));
+      }
+    }
+
+    procedure_executor.call(mask, mf_params, mf_context);
+  }
+
   /* Evaluate varying fields if necessary. */
   if (!varying_fields_to_evaluate.is_empty()) {
     /* Build the procedure for those fields. */
     mf::Procedure procedure;
     build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, varying_fields_to_evaluate);
+        procedure, scope, field_tree_info, varying_fields_to_evaluate, hoisted_fields);
     mf::ProcedureExecutor procedure_executor{procedure};
 
     mf::ParamsBuilder mf_params{procedure_executor, &mask};
@@ -380,6 +542,9 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     for (const GVArray &varray : field_context_inputs) {
       mf_params.add_readonly_single_input(varray);
     }
+    for (const GVArray &varray : hoisted_varrays) {
+      mf_params.add_readonly_single_input(varray);
+    }
 
     for (const int i : varying_fields_to_evaluate.index_range()) {
       const GFieldRef &field = varying_fields_to_evaluate[i];
@@ -417,44 +582,6 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     procedure_executor.call_auto(mask, mf_params, mf_context);
   }
 
-  /* Evaluate constant fields if necessary. */
-  if (!constant_fields_to_evaluate.is_empty()) {
-    /* Build the procedure for those fields. */
-    mf::Procedure procedure;
-    build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, constant_fields_to_evaluate);
-    mf::ProcedureExecutor procedure_executor{procedure};
-    const IndexMask mask(1);
-    mf::ParamsBuilder mf_params{procedure_executor, &mask};
-    mf::ContextBuilder mf_context;
-
-    /* Provide inputs to the procedure executor. */
-    for (const GVArray &varray : field_context_inputs) {
-      mf_params.add_readonly_single_input(varray);
-    }
-
-    for (const int i : constant_fields_to_evaluate.index_range()) {
-      const GFieldRef &field = constant_fields_to_evaluate[i];
-      const CPPType &type = field.cpp_type();
-      /* Allocate memory where the computed value will be stored in. */
-      void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
-
-      if (!type.is_trivially_destructible()) {
-        /* Destruct value in the end. */
-        scope.add_destruct_call([buffer, &type]() { type.destruct(buffer); });
-      }
-
-      /* Pass output buffer to the procedure executor. */
-      mf_params.add_uninitialized_single_output({type, buffer, 1});
-
-      /* Create virtual array that can be used after the procedure has been executed below. */
-      const int out_index = constant_field_indices[i];
-      r_varrays[out_index] = GVArray::ForSingleRef(type, array_size, buffer);
-    }
-
-    procedure_executor.call(mask, mf_params, mf_context);
-  }
-
   /* Copy data to supplied destination arrays if necessary. In some cases the evaluation above
    * has written the computed data in the right place already. */
   if (!dst_varrays.is_empty()) {
@@ -8,12 +8,23 @@
 
 namespace blender::fn::multi_function {
 
-ProcedureExecutor::ProcedureExecutor(const Procedure &procedure) : procedure_(procedure)
+ProcedureExecutor::ProcedureExecutor(const Procedure &procedure, const int64_t chunk_size)
+    : procedure_(procedure), chunk_size_(chunk_size)
 {
   SignatureBuilder builder("Procedure Executor", signature_);
 
   for (const ConstParameter &param : procedure.params()) {
     builder.add("Parameter", ParamType(param.type, param.variable->data_type()));
+    if (param.variable->data_type().is_vector()) {
+      /* Vector arrays passed in by the caller can't be sliced. */
+      supports_chunks_ = false;
+    }
+  }
+  for (const CallInstruction *instruction : procedure.call_instructions()) {
+    if (instruction->fn().execution_hints().prefers_full_mask) {
+      /* Calling the function for every chunk would repeat its setup work many times. */
+      supports_chunks_ = false;
+    }
   }
 
   this->set_signature(&signature_);
@@ -135,6 +146,12 @@ class ValueAllocator : NonCopyable, NonMovable {
    */
   std::array<Stack<VariableValue *>, tot_variable_value_types> variable_value_free_lists_;
 
+  /**
+   * Span buffers have at least this many elements. When the allocator is used for multiple chunks
+   * of a mask, this makes sure that buffers can be reused for all chunks.
+   */
+  int64_t min_span_size_;
+
   /**
    * The integer key is the size of one element (e.g. 4 for an integer buffer). All buffers are
    * aligned to #min_alignment bytes.
@@ -149,7 +166,10 @@ class ValueAllocator : NonCopyable, NonMovable {
   Map<const CPPType *, Stack<void *>> single_value_free_lists_;
 
  public:
-  ValueAllocator(LinearAllocator<> &linear_allocator) : linear_allocator_(linear_allocator) {}
+  ValueAllocator(LinearAllocator<> &linear_allocator, const int64_t min_span_size = 0)
+      : linear_allocator_(linear_allocator), min_span_size_(min_span_size)
+  {
+  }
 
   VariableValue_GVArray *obtain_GVArray(const GVArray &varray)
   {
@@ -166,9 +186,10 @@ class ValueAllocator : NonCopyable, NonMovable {
     return this->obtain<VariableValue_Span>(buffer, false);
   }
 
-  VariableValue_Span *obtain_Span(const CPPType &type, int size)
+  VariableValue_Span *obtain_Span(const CPPType &type, int64_t size)
   {
     void *buffer = nullptr;
+    size = std::max(size, min_span_size_);
 
     const int64_t element_size = type.size();
     const int64_t alignment = type.alignment();
@@ -813,17 +834,17 @@ class VariableState : NonCopyable, NonMovable {
 /** Keeps track of the states of all variables during evaluation. */
 class VariableStates {
  private:
-  ValueAllocator value_allocator_;
+  ValueAllocator &value_allocator_;
   const Procedure &procedure_;
   /** The state of every variable, indexed by #Variable::index_in_procedure(). */
   Array<VariableState> variable_states_;
   const IndexMask &full_mask_;
 
  public:
-  VariableStates(LinearAllocator<> &linear_allocator,
+  VariableStates(ValueAllocator &value_allocator,
                  const Procedure &procedure,
                  const IndexMask &full_mask)
-      : value_allocator_(linear_allocator),
+      : value_allocator_(value_allocator),
         procedure_(procedure),
         variable_states_(procedure.variables().size()),
         full_mask_(full_mask)
@@ -1157,19 +1178,18 @@ class InstructionScheduler {
   }
 };
 
-void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
+static void execute_procedure(const ProcedureExecutor &fn,
+                              const Procedure &procedure,
+                              const IndexMask &full_mask,
+                              Params params,
+                              const Context &context,
+                              ValueAllocator &value_allocator)
 {
-  BLI_assert(procedure_.validate());
-
-  AlignedBuffer<512, 64> local_buffer;
-  LinearAllocator<> linear_allocator;
-  linear_allocator.provide_buffer(local_buffer);
-
-  VariableStates variable_states{linear_allocator, procedure_, full_mask};
-  variable_states.add_initial_variable_states(*this, procedure_, params);
+  VariableStates variable_states{value_allocator, procedure, full_mask};
+  variable_states.add_initial_variable_states(fn, procedure, params);
 
   InstructionScheduler scheduler;
-  scheduler.add_referenced_indices(*procedure_.entry(), full_mask);
+  scheduler.add_referenced_indices(*procedure.entry(), full_mask);
 
   /* Loop until all indices got to a return instruction. */
   while (!scheduler.is_done()) {
@@ -1218,9 +1238,9 @@ void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context
     }
   }
 
-  for (const int param_index : this->param_indices()) {
-    const ParamType param_type = this->param_type(param_index);
-    const Variable *variable = procedure_.params()[param_index].variable;
+  for (const int param_index : fn.param_indices()) {
+    const ParamType param_type = fn.param_type(param_index);
+    const Variable *variable = procedure.params()[param_index].variable;
     VariableState &variable_state = variable_states.get_variable_state(*variable);
     switch (param_type.interface_type()) {
       case ParamType::Input: {
@@ -1241,6 +1261,85 @@ void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context
   }
 }
 
+/**
+ * Slices all parameters to the given range. Vector parameters are not supported, see
+ * #ProcedureExecutor::supports_chunks_.
+ */
+static void add_sliced_parameters(const ProcedureExecutor &fn,
+                                  Params &full_params,
+                                  const IndexRange slice_range,
+                                  ParamsBuilder &r_sliced_params)
+{
+  for (const int param_index : fn.param_indices()) {
+    const ParamType param_type = fn.param_type(param_index);
+    switch (param_type.category()) {
+      case ParamCategory::SingleInput: {
+        const GVArray &varray = full_params.readonly_single_input(param_index);
+        r_sliced_params.add_readonly_single_input(varray.slice(slice_range));
+        break;
+      }
+      case ParamCategory::SingleMutable: {
+        const GMutableSpan span = full_params.single_mutable(param_index);
+        r_sliced_params.add_single_mutable(span.slice(slice_range));
+        break;
+      }
+      case ParamCategory::SingleOutput: {
+        const GMutableSpan span = full_params.uninitialized_single_output(param_index);
+        r_sliced_params.add_uninitialized_single_output(span.slice(slice_range));
+        break;
+      }
+      case ParamCategory::VectorInput:
+      case ParamCategory::VectorMutable:
+      case ParamCategory::VectorOutput: {
+        BLI_assert_unreachable();
+        break;
+      }
+    }
+  }
+}
+
+void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
+{
+  BLI_assert(procedure_.validate());
+
+  AlignedBuffer<512, 64> local_buffer;
+  LinearAllocator<> linear_allocator;
+  linear_allocator.provide_buffer(local_buffer);
+
+  if (!supports_chunks_ || chunk_size_ <= 0 || full_mask.size() <= chunk_size_) {
+    ValueAllocator value_allocator{linear_allocator};
+    execute_procedure(*this, procedure_, full_mask, params, context, value_allocator);
+    return;
+  }
+
+  /* All chunks share the same allocator, so that intermediate buffers are reused for every chunk
+   * instead of allocating buffers for the entire mask. */
+  ValueAllocator value_allocator{linear_allocator, chunk_size_};
+
+  /* Chunks are built from ranges of indices rather than ranges of positions in the mask, so that
+   * the shifted chunk masks never need arrays larger than the chunk size. */
+  int64_t chunk_start = full_mask.first();
+  while (true) {
+    const IndexMask chunk_mask = full_mask.slice_content(chunk_start, chunk_size_);
+    BLI_assert(!chunk_mask.is_empty());
+
+    IndexMaskMemory memory;
+    const IndexMask shifted_mask = chunk_mask.shift(-chunk_start, memory);
+    const IndexRange slice_range{chunk_start, shifted_mask.min_array_size()};
+
+    ParamsBuilder sliced_params{*this, &shifted_mask};
+    add_sliced_parameters(*this, params, slice_range, sliced_params);
+    execute_procedure(*this, procedure_, shifted_mask, sliced_params, context, value_allocator);
+
+    const std::optional<index_mask::RawMaskIterator> next_it = full_mask.find_larger_equal(
+        chunk_start + chunk_size_);
+    if (!next_it) {
+      break;
+    }
+    chunk_start = full_mask[*next_it];
+  }
+}
+
 MultiFunction::ExecutionHints ProcedureExecutor::get_execution_hints() const
 {
   ExecutionHints hints;
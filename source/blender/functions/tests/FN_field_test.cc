@@ -4,6 +4,8 @@
 
 #include "testing/testing.h"
 
+#include <atomic>
+
 #include "BLI_cpp_type.hh"
 #include "FN_field.hh"
 #include "FN_multi_function_builder.hh"
@@ -281,4 +283,63 @@ TEST(field, IgnoredOutput)
   EXPECT_EQ(results.get(3), 5);
 }
 
+TEST(field, DeduplicateOperations)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+
+  std::atomic<int> evaluations = 0;
+  auto add_fn = mf::build::SI2_SO<int, int, int>("add", [&](int a, int b) {
+    evaluations++;
+    return a + b;
+  });
+  /* Separate operations that compute the same values, like in multiple node group instances. */
+  GField add_field_1{FieldOperation::Create(add_fn, {index_field, index_field}), 0};
+  GField add_field_2{FieldOperation::Create(add_fn, {index_field, index_field}), 0};
+  auto sub_fn = mf::build::SI2_SO<int, int, int>("sub", [](int a, int b) { return a - b; });
+  GField sub_field_1{FieldOperation::Create(sub_fn, {add_field_1, make_constant_field(3)}), 0};
+  GField sub_field_2{FieldOperation::Create(sub_fn, {add_field_2, make_constant_field(3)}), 0};
+
+  Array<int> result_1(10);
+  Array<int> result_2(10);
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, 10};
+  evaluator.add_with_destination(sub_field_1, result_1.as_mutable_span());
+  evaluator.add_with_destination(sub_field_2, result_2.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(10)) {
+    EXPECT_EQ(result_1[i], i * 2 - 3);
+    EXPECT_EQ(result_2[i], i * 2 - 3);
+  }
+  EXPECT_EQ(evaluations, 10);
+}
+
+TEST(field, HoistConstantOperations)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+
+  std::atomic<int> evaluations = 0;
+  auto square_fn = mf::build::SI1_SO<int, int>("square", [&](int a) {
+    evaluations++;
+    return a * a;
+  });
+  GField square_field{FieldOperation::Create(square_fn, {make_constant_field(4)}), 0};
+  auto add_fn = mf::build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  GField add_field{FieldOperation::Create(add_fn, {index_field, square_field}), 0};
+
+  /* Use enough indices so that the varying fields are evaluated in multiple chunks. */
+  const int size = 100000;
+  Array<int> result(size);
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, size};
+  evaluator.add_with_destination(add_field, result.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(result[i], i + 16);
+  }
+  /* The constant part is computed only once. */
+  EXPECT_EQ(evaluations, 1);
+}
+
 }  // namespace blender::fn::tests
@@ -423,4 +423,244 @@ TEST(multi_function_procedure, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+TEST(multi_function_procedure, ChunkedExecution)
+{
+  /**
+   * procedure(int in, int *out) {
+   *   int tmp = in * 3;
+   *   out = tmp - in;
+   *   bool condition = in > 50;
+   *   if (condition) {
+   *     out += 1000;
+   *   }
+   *   else {
+   *     out *= 2;
+   *   }
+   * }
+   */
+
+  auto mul_3_fn = build::SI1_SO<int, int>("mul 3", [](int a) { return a * 3; });
+  auto sub_fn = build::SI2_SO<int, int, int>("sub", [](int a, int b) { return a - b; });
+  auto greater_fn = build::SI1_SO<int, bool>("greater 50", [](int a) { return a > 50; });
+  auto add_1000_fn = build::SM<int>("add 1000", [](int &a) { a += 1000; });
+  auto double_fn = build::SM<int>("double", [](int &a) { a *= 2; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_in = &builder.add_single_input_parameter<int>();
+  auto [var_tmp] = builder.add_call<1>(mul_3_fn, {var_in});
+  auto [var_out] = builder.add_call<1>(sub_fn, {var_tmp, var_in});
+  auto [var_condition] = builder.add_call<1>(greater_fn, {var_in});
+  builder.add_destruct({var_in, var_tmp});
+  ProcedureBuilder::Branch branch = builder.add_branch(*var_condition);
+  branch.branch_true.add_destruct(*var_condition);
+  branch.branch_true.add_call(add_1000_fn, {var_out});
+  branch.branch_false.add_destruct(*var_condition);
+  branch.branch_false.add_call(double_fn, {var_out});
+  builder.set_cursor_after_branch(branch);
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  EXPECT_TRUE(procedure.validate());
+
+  const int size = 5000;
+  Array<int> inputs(size);
+  for (const int i : inputs.index_range()) {
+    inputs[i] = i % 101;
+  }
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(size), GrainSize(512), memory, [](const int64_t i) {
+        return i % 3 != 0 || (i > 3000 && i < 4000);
+      });
+
+  /* Compare with the result of the executor processing all indices at once. */
+  Array<int> expected(size, -1);
+  {
+    ProcedureExecutor procedure_fn{procedure, 0};
+    ParamsBuilder params{procedure_fn, &mask};
+    params.add_readonly_single_input(inputs.as_span());
+    params.add_uninitialized_single_output(expected.as_mutable_span());
+    ContextBuilder context;
+    procedure_fn.call(mask, params, context);
+  }
+  mask.foreach_index([&](const int64_t i) {
+    const int value = inputs[i];
+    EXPECT_EQ(expected[i], value > 50 ? value * 2 + 1000 : value * 4);
+  });
+
+  for (const int64_t chunk_size : {1, 7, 64, 1000, 1024, 100000}) {
+    ProcedureExecutor procedure_fn{procedure, chunk_size};
+    Array<int> results(size, -1);
+    ParamsBuilder params{procedure_fn, &mask};
+    params.add_readonly_single_input(inputs.as_span());
+    params.add_uninitialized_single_output(results.as_mutable_span());
+    ContextBuilder context;
+    procedure_fn.call(mask, params, context);
+    EXPECT_EQ_ARRAY(expected.data(), results.data(), size);
+  }
+}
+
+/** Adds one to every value and remembers the size of the masks it has been called with. */
+class FullMaskAddOneFunction : public MultiFunction {
+ public:
+  mutable Vector<int64_t> mask_sizes;
+
+  FullMaskAddOneFunction()
+  {
+    static const Signature signature = []() {
+      Signature signature;
+      SignatureBuilder builder{"Full Mask Add One", signature};
+      builder.single_input<int>("In");
+      builder.single_output<int>("Out");
+      return signature;
+    }();
+    this->set_signature(&signature);
+  }
+
+  void call(const IndexMask &mask, Params params, Context /*context*/) const override
+  {
+    mask_sizes.append(mask.size());
+    const VArray<int> &values = params.readonly_single_input<int>(0, "In");
+    MutableSpan<int> results = params.uninitialized_single_output<int>(1, "Out");
+    mask.foreach_index([&](const int64_t i) { results[i] = values[i] + 1; });
+  }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.prefers_full_mask = true;
+    return hints;
+  }
+};
+
+TEST(multi_function_procedure, PrefersFullMask)
+{
+  /**
+   * procedure(int in, int *out) {
+   *   int tmp = in * 3;
+   *   out = full_mask_add_one(tmp);
+   * }
+   */
+
+  auto mul_3_fn = build::SI1_SO<int, int>("mul 3", [](int a) { return a * 3; });
+  FullMaskAddOneFunction add_1_fn;
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_in = &builder.add_single_input_parameter<int>();
+  auto [var_tmp] = builder.add_call<1>(mul_3_fn, {var_in});
+  auto [var_out] = builder.add_call<1>(add_1_fn, {var_tmp});
+  builder.add_destruct({var_in, var_tmp});
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  EXPECT_TRUE(procedure.validate());
+
+  const int size = 100;
+  Array<int> inputs(size);
+  for (const int i : inputs.index_range()) {
+    inputs[i] = i;
+  }
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(size), GrainSize(512), memory, [](const int64_t i) { return i % 4 != 0; });
+
+  ProcedureExecutor procedure_fn{procedure, 7};
+  Array<int> results(size, -1);
+  ParamsBuilder params{procedure_fn, &mask};
+  params.add_readonly_single_input(inputs.as_span());
+  params.add_uninitialized_single_output(results.as_mutable_span());
+  ContextBuilder context;
+  procedure_fn.call(mask, params, context);
+
+  /* The function is called once with the full mask, even though the chunk size is smaller. */
+  ASSERT_EQ(add_1_fn.mask_sizes.size(), 1);
+  EXPECT_EQ(add_1_fn.mask_sizes[0], mask.size());
+
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(results[i], i % 4 != 0 ? i * 3 + 1 : -1);
+  }
+}
+
+}  // namespace blender::fn::multi_function::tests
+
+/* Disable benchmark by default. */
+#if 0
+
+#  include "BLI_timeit.hh"
+
+namespace blender::fn::multi_function::tests {
+
+TEST(multi_function_procedure, benchmark_chunked_execution)
+{
+  /**
+   * Chain of float math nodes, similar to what a long field expression in geometry nodes builds:
+   * procedure(float a, float b, float *out) {
+   *   out = a;
+   *   for 30 times {
+   *     float tmp = out * b;
+   *     out = tmp + a;
+   *   }
+   * }
+   */
+
+  auto mul_fn = build::SI2_SO<float, float, float>("mul", [](float a, float b) { return a * b; });
+  auto add_fn = build::SI2_SO<float, float, float>("add", [](float a, float b) { return a + b; });
+  auto copy_fn = build::SI1_SO<float, float>("copy", [](float a) { return a; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_a = &builder.add_single_input_parameter<float>();
+  Variable *var_b = &builder.add_single_input_parameter<float>();
+  Variable *var_out = builder.add_call<1>(copy_fn, {var_a})[0];
+  for ([[maybe_unused]] const int i : IndexRange(30)) {
+    auto [var_tmp] = builder.add_call<1>(mul_fn, {var_out, var_b});
+    builder.add_destruct(*var_out);
+    var_out = builder.add_call<1>(add_fn, {var_tmp, var_a})[0];
+    builder.add_destruct(*var_tmp);
+  }
+  builder.add_destruct({var_a, var_b});
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  EXPECT_TRUE(procedure.validate());
+
+  const int size = 10'000'000;
+  Array<float> a(size);
+  Array<float> b(size);
+  for (const int i : IndexRange(size)) {
+    a[i] = float(i % 1000) * 0.001f;
+    b[i] = 0.5f + float(i % 7) * 0.01f;
+  }
+  Array<float> results(size);
+  const IndexMask mask(size);
+
+  for (const int64_t chunk_size : {int64_t(0), ProcedureExecutor::default_chunk_size}) {
+    ProcedureExecutor procedure_fn{procedure, chunk_size};
+    for (const bool use_threading : {false, true}) {
+      ParamsBuilder params{procedure_fn, &mask};
+      params.add_readonly_single_input(a.as_span());
+      params.add_readonly_single_input(b.as_span());
+      params.add_uninitialized_single_output(results.as_mutable_span());
+      ContextBuilder context;
+      SCOPED_TIMER(std::string(chunk_size == 0 ? "Full mask" : "Chunked") +
+                   (use_threading ? ", threaded" : ", single thread"));
+      if (use_threading) {
+        procedure_fn.call_auto(mask, params, context);
+      }
+      else {
+        procedure_fn.call(mask, params, context);
+      }
+    }
+  }
+}
+
 }  // namespace blender::fn::multi_function::tests
+
+#endif
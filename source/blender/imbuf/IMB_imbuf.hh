@@ -392,7 +392,28 @@ void IMB_filtery(ImBuf *ibuf);
 
 ImBuf *IMB_onehalf(ImBuf *ibuf1);
 
+/** Filters for #IMB_scale. */
+enum eIMBScaleFilter {
+  /** Average of the covered pixels when shrinking, bilinear interpolation when enlarging. */
+  IMB_SCALE_BOX,
+  IMB_SCALE_BILINEAR,
+  /** Mitchell-Netravali cubic. */
+  IMB_SCALE_BICUBIC,
+  /** Lanczos windowed sinc with three lobes, the sharpest filter. */
+  IMB_SCALE_LANCZOS,
+};
+
 /**
+ * Scale the byte and float buffers of \a ibuf with a separable filter, one axis after the other,
+ * multi-threaded over rows. When shrinking, the filter is widened to the size of an output pixel
+ * to avoid aliasing.
+ *
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scale(ImBuf *ibuf, unsigned int newx, unsigned int newy, eIMBScaleFilter filter);
+
+/**
+ * Scale with #IMB_SCALE_BOX.
  * Return true if \a ibuf is modified.
  */
 bool IMB_scaleImBuf(ImBuf *ibuf, unsigned int newx, unsigned int newy);
@@ -402,6 +423,9 @@ bool IMB_scaleImBuf(ImBuf *ibuf, unsigned int newx, unsigned int newy);
  */
 bool IMB_scalefastImBuf(ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/**
+ * Scale with #IMB_SCALE_BILINEAR.
+ */
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
 bool IMB_saveiff(ImBuf *ibuf, const char *filepath, int flags);
@@ -6,15 +6,21 @@
  * \ingroup imbuf
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_simd.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
 #include "IMB_filter.hh"
 #include "IMB_imbuf.hh"
 #include "IMB_imbuf_types.hh"
-#include "IMB_interp.hh"
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
@@ -331,1113 +337,311 @@ ImBuf *IMB_onehalf(ImBuf *ibuf1)
   return ibuf2;
 }
 
-/* q_scale_linear_interpolation helper functions */
+/* ******** separable scaling ******** */
 
-static void enlarge_picture_byte(
-    uchar *src, uchar *dst, int src_width, int src_height, int dst_width, int dst_height)
-{
-  double ratiox = double(dst_width - 1.0) / double(src_width - 1.001);
-  double ratioy = double(dst_height - 1.0) / double(src_height - 1.001);
-  uintptr_t x_src, dx_src, x_dst;
-  uintptr_t y_src, dy_src, y_dst;
-
-  dx_src = 65536.0 / ratiox;
-  dy_src = 65536.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    uchar *line1 = src + (y_src >> 16) * 4 * src_width;
-    uchar *line2 = line1 + 4 * src_width;
-    uintptr_t weight1y = 65536 - (y_src & 0xffff);
-    uintptr_t weight2y = 65536 - weight1y;
-
-    if ((y_src >> 16) == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      uintptr_t weight1x = 65536 - (x_src & 0xffff);
-      uintptr_t weight2x = 65536 - weight1x;
-
-      ulong x = (x_src >> 16) * 4;
-
-      *dst++ = ((((line1[x] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 1] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 1] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 1] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 1] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 2] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 2] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 2] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 2] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 3] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 3] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 3] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 3] * weight2y) >> 16) * weight2x) >> 16);
-
-      x_src += dx_src;
-    }
-    y_src += dy_src;
-  }
-}
-
-struct scale_outpix_byte {
-  uintptr_t r;
-  uintptr_t g;
-  uintptr_t b;
-  uintptr_t a;
+namespace blender::imbuf {
 
-  uintptr_t weight;
+/**
+ * Filter weights of one axis: every output pixel is a weighted sum of #taps consecutive input
+ * pixels, starting at #first. Weights of pixels outside of the image are folded into the edge
+ * pixels, so no bounds checks are needed while filtering.
+ */
+struct ScaleAxis {
+  int taps = 0;
+  Array<int> first;
+  Array<float> weights;
 };
 
-static void shrink_picture_byte(
-    uchar *src, uchar *dst, int src_width, int src_height, int dst_width, int dst_height)
+/** Radius of the filter kernel in input pixels, before it is widened for shrinking. */
+static float scale_filter_radius(const eIMBScaleFilter filter)
 {
-  double ratiox = double(dst_width) / double(src_width);
-  double ratioy = double(dst_height) / double(src_height);
-  uintptr_t x_src, dx_dst, x_dst;
-  uintptr_t y_src, dy_dst, y_dst;
-  intptr_t y_counter;
-  uchar *dst_begin = dst;
-
-  scale_outpix_byte *dst_line1 = nullptr;
-  scale_outpix_byte *dst_line2 = nullptr;
-
-  dst_line1 = (scale_outpix_byte *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_byte),
-                                               "shrink_picture_byte 1");
-  dst_line2 = (scale_outpix_byte *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_byte),
-                                               "shrink_picture_byte 2");
-
-  dx_dst = 65536.0 * ratiox;
-  dy_dst = 65536.0 * ratioy;
-
-  y_dst = 0;
-  y_counter = 65536;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    uchar *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 65535 - (y_dst & 0xffff);
-    uintptr_t weight2y = 65535 - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 65535 - (x_dst & 0xffff);
-      uintptr_t weight2x = 65535 - weight1x;
-
-      uintptr_t x = x_dst >> 16;
-
-      uintptr_t w;
-
-      w = (weight1y * weight1x) >> 16;
-
-      /* Ensure correct rounding, without this you get ugly banding,
-       * or too low color values (ton). */
-      dst_line1[x].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x].weight += w;
-
-      w = (weight2y * weight1x) >> 16;
-
-      dst_line2[x].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x].weight += w;
-
-      w = (weight1y * weight2x) >> 16;
-
-      dst_line1[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x + 1].weight += w;
-
-      w = (weight2y * weight2x) >> 16;
-
-      dst_line2[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
-
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      int val;
-      uintptr_t x;
-      scale_outpix_byte *temp;
-
-      y_counter += 65536;
-
-      for (x = 0; x < dst_width; x++) {
-        uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-        *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-      }
-      memset(dst_line1, 0, dst_width * sizeof(scale_outpix_byte));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
-    }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    int val;
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-      *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-    }
-  }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
+  switch (filter) {
+    case IMB_SCALE_BOX:
+    case IMB_SCALE_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_BICUBIC:
+      return 2.0f;
+    case IMB_SCALE_LANCZOS:
+      return 3.0f;
+  }
+  BLI_assert_unreachable();
+  return 1.0f;
 }
 
-static void q_scale_byte(
-    uchar *in, uchar *out, int in_width, int in_height, int dst_width, int dst_height)
+static float sinc(const float x)
 {
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
+  if (x == 0.0f) {
+    return 1.0f;
   }
+  const float pi_x = float(M_PI) * x;
+  return sinf(pi_x) / pi_x;
 }
 
-static void enlarge_picture_float(
-    float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
+/**
+ * Weight of input pixel \a index for an output pixel at \a center, with the kernel widened by
+ * \a filter_scale.
+ */
+static float scale_filter_weight(const eIMBScaleFilter filter,
+                                 const int index,
+                                 const float center,
+                                 const float filter_scale)
 {
-  double ratiox = double(dst_width - 1.0) / double(src_width - 1.001);
-  double ratioy = double(dst_height - 1.0) / double(src_height - 1.001);
-  uintptr_t x_dst;
-  uintptr_t y_dst;
-  double x_src, dx_src;
-  double y_src, dy_src;
-
-  dx_src = 1.0 / ratiox;
-  dy_src = 1.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    float *line1 = src + int(y_src) * 4 * src_width;
-    const float *line2 = line1 + 4 * src_width;
-    const float weight1y = float(1.0 - (y_src - int(y_src)));
-    const float weight2y = 1.0f - weight1y;
-
-    if (int(y_src) == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      const float weight1x = float(1.0 - (x_src - int(x_src)));
-      const float weight2x = float(1.0f - weight1x);
-
-      const float w11 = weight1y * weight1x;
-      const float w21 = weight2y * weight1x;
-      const float w12 = weight1y * weight2x;
-      const float w22 = weight2y * weight2x;
-
-      uintptr_t x = int(x_src) * 4;
-
-      *dst++ = line1[x] * w11 + line2[x] * w21 + line1[4 + x] * w12 + line2[4 + x] * w22;
-
-      *dst++ = line1[x + 1] * w11 + line2[x + 1] * w21 + line1[4 + x + 1] * w12 +
-               line2[4 + x + 1] * w22;
-
-      *dst++ = line1[x + 2] * w11 + line2[x + 2] * w21 + line1[4 + x + 2] * w12 +
-               line2[4 + x + 2] * w22;
-
-      *dst++ = line1[x + 3] * w11 + line2[x + 3] * w21 + line1[4 + x + 3] * w12 +
-               line2[4 + x + 3] * w22;
-
-      x_src += dx_src;
-    }
-    y_src += dy_src;
-  }
+  if (filter == IMB_SCALE_BOX) {
+    /* Overlap of the input pixel with the footprint of the output pixel. When enlarging the
+     * footprint is one input pixel wide, which is the same as bilinear interpolation. */
+    const float overlap = std::min(index + 1.0f, center + filter_scale * 0.5f) -
+                          std::max(float(index), center - filter_scale * 0.5f);
+    return std::max(overlap, 0.0f);
+  }
+
+  const float x = fabsf((float(index) + 0.5f - center) / filter_scale);
+  switch (filter) {
+    case IMB_SCALE_BOX:
+    case IMB_SCALE_BILINEAR:
+      return std::max(1.0f - x, 0.0f);
+    case IMB_SCALE_BICUBIC:
+      /* Mitchell-Netravali with B = C = 1/3. */
+      if (x < 1.0f) {
+        return ((7.0f * x - 12.0f) * x * x + 16.0f / 3.0f) / 6.0f;
+      }
+      if (x < 2.0f) {
+        return (((-7.0f / 3.0f * x + 12.0f) * x - 20.0f) * x + 32.0f / 3.0f) / 6.0f;
+      }
+      return 0.0f;
+    case IMB_SCALE_LANCZOS:
+      return x < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+  }
+  BLI_assert_unreachable();
+  return 0.0f;
 }
 
-struct scale_outpix_float {
-  float r;
-  float g;
-  float b;
-  float a;
-
-  float weight;
-};
-
-static void shrink_picture_float(
-    const float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
+static ScaleAxis scale_axis_init(const eIMBScaleFilter filter,
+                                 const int src_size,
+                                 const int dst_size)
 {
-  double ratiox = double(dst_width) / double(src_width);
-  double ratioy = double(dst_height) / double(src_height);
-  uintptr_t x_src;
-  uintptr_t y_src;
-  float dx_dst, x_dst;
-  float dy_dst, y_dst;
-  float y_counter;
-  const float *dst_begin = dst;
-
-  scale_outpix_float *dst_line1;
-  scale_outpix_float *dst_line2;
-
-  dst_line1 = (scale_outpix_float *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_float),
-                                                "shrink_picture_float 1");
-  dst_line2 = (scale_outpix_float *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_float),
-                                                "shrink_picture_float 2");
-
-  dx_dst = ratiox;
-  dy_dst = ratioy;
-
-  y_dst = 0;
-  y_counter = 1.0;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    const float *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 1.0f - (y_dst - int(y_dst));
-    uintptr_t weight2y = 1.0f - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 1.0f - (x_dst - int(x_dst));
-      uintptr_t weight2x = 1.0f - weight1x;
-
-      uintptr_t x = int(x_dst);
-
-      float w;
-
-      w = weight1y * weight1x;
-
-      dst_line1[x].r += line[0] * w;
-      dst_line1[x].g += line[1] * w;
-      dst_line1[x].b += line[2] * w;
-      dst_line1[x].a += line[3] * w;
-      dst_line1[x].weight += w;
-
-      w = weight2y * weight1x;
-
-      dst_line2[x].r += line[0] * w;
-      dst_line2[x].g += line[1] * w;
-      dst_line2[x].b += line[2] * w;
-      dst_line2[x].a += line[3] * w;
-      dst_line2[x].weight += w;
-
-      w = weight1y * weight2x;
-
-      dst_line1[x + 1].r += line[0] * w;
-      dst_line1[x + 1].g += line[1] * w;
-      dst_line1[x + 1].b += line[2] * w;
-      dst_line1[x + 1].a += line[3] * w;
-      dst_line1[x + 1].weight += w;
-
-      w = weight2y * weight2x;
-
-      dst_line2[x + 1].r += line[0] * w;
-      dst_line2[x + 1].g += line[1] * w;
-      dst_line2[x + 1].b += line[2] * w;
-      dst_line2[x + 1].a += line[3] * w;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
+  const float scale = float(src_size) / float(dst_size);
+  /* When shrinking, the kernel is widened to cover a whole output pixel to avoid aliasing. */
+  const float filter_scale = std::max(scale, 1.0f);
+  const float support = filter == IMB_SCALE_BOX ? (filter_scale + 1.0f) * 0.5f :
+                                                  scale_filter_radius(filter) * filter_scale;
 
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      uintptr_t x;
-      scale_outpix_float *temp;
+  ScaleAxis axis;
+  axis.taps = std::min(int(ceilf(support * 2.0f)) + 1, src_size);
+  axis.first.reinitialize(dst_size);
+  axis.weights = Array<float>(int64_t(dst_size) * axis.taps, 0.0f);
 
-      y_counter += 1.0f;
+  for (const int i : IndexRange(dst_size)) {
+    const float center = (float(i) + 0.5f) * scale;
+    const int start = int(floorf(center - support));
+    const int end = int(ceilf(center + support));
+    const int first = std::clamp(start, 0, src_size - axis.taps);
+    float *weights = &axis.weights[int64_t(i) * axis.taps];
 
-      for (x = 0; x < dst_width; x++) {
-        float f = 1.0f / dst_line1[x].weight;
-        *dst++ = dst_line1[x].r * f;
-        *dst++ = dst_line1[x].g * f;
-        *dst++ = dst_line1[x].b * f;
-        *dst++ = dst_line1[x].a * f;
-      }
-      memset(dst_line1, 0, dst_width * sizeof(scale_outpix_float));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
+    float weight_sum = 0.0f;
+    for (int index = start; index < end; index++) {
+      const float weight = scale_filter_weight(filter, index, center, filter_scale);
+      weights[std::clamp(index, 0, src_size - 1) - first] += weight;
+      weight_sum += weight;
     }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      float f = 1.0f / dst_line1[x].weight;
-      *dst++ = dst_line1[x].r * f;
-      *dst++ = dst_line1[x].g * f;
-      *dst++ = dst_line1[x].b * f;
-      *dst++ = dst_line1[x].a * f;
+    if (weight_sum != 0.0f) {
+      for (const int tap : IndexRange(axis.taps)) {
+        weights[tap] /= weight_sum;
+      }
     }
+    axis.first[i] = first;
   }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
+
+  return axis;
 }
 
-static void q_scale_float(
-    float *in, float *out, int in_width, int in_height, int dst_width, int dst_height)
+/* Byte buffers are filtered as floats in the 0..255 range. */
+
+BLI_INLINE float scale_load(const float value)
 {
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_float(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_float(in, out, in_width, in_height, dst_width, dst_height);
-  }
+  return value;
 }
 
-/**
- * q_scale_linear_interpolation (derived from `ppmqscale`, http://libdv.sf.net)
- *
- * q stands for quick _and_ quality :)
- *
- * only handles common cases when we either
- *
- * scale both, x and y or
- * shrink both, x and y
- *
- * but that is pretty fast:
- * - does only blit once instead of two passes like the old code
- *   (fewer cache misses)
- * - uses fixed point integer arithmetic for byte buffers
- * - doesn't branch in tight loops
- *
- * Should be comparable in speed to the ImBuf ..._fast functions at least
- * for byte-buffers.
- *
- * NOTE: disabled, due to unacceptable inaccuracy and quality loss, see bug #18609 (ton)
- */
-static bool q_scale_linear_interpolation(ImBuf *ibuf, int newx, int newy)
+BLI_INLINE float scale_load(const uchar value)
 {
-  if ((newx >= ibuf->x && newy <= ibuf->y) || (newx <= ibuf->x && newy >= ibuf->y)) {
-    return false;
-  }
-
-  if (ibuf->byte_buffer.data) {
-    uchar *newrect = static_cast<uchar *>(MEM_mallocN(sizeof(int) * newx * newy, "q_scale rect"));
-    q_scale_byte(ibuf->byte_buffer.data, newrect, ibuf->x, ibuf->y, newx, newy);
-
-    IMB_assign_byte_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (ibuf->float_buffer.data) {
-    float *newrect = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newx * newy, "q_scale rectfloat"));
-    q_scale_float(ibuf->float_buffer.data, newrect, ibuf->x, ibuf->y, newx, newy);
-
-    IMB_assign_float_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
-  }
-
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  return true;
+  return float(value);
 }
 
-static ImBuf *scaledownx(ImBuf *ibuf, int newx)
+BLI_INLINE void scale_store(const float value, float *r_value)
 {
-  const bool do_rect = (ibuf->byte_buffer.data != nullptr);
-  const bool do_float = (ibuf->float_buffer.data != nullptr);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
-
-  rectf = _newrectf = newrectf = nullptr;
-  rect = _newrect = newrect = nullptr;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = static_cast<uchar *>(MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = ibuf->byte_buffer.data;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->float_buffer.data;
-    newrectf = _newrectf;
-  }
-
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += 4;
-      }
-
-      sample -= 1.0f;
-    }
-  }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ibuf->byte_buffer.data, rect_size);
-    BLI_assert((uchar *)rect - ibuf->byte_buffer.data == rect_size); /* see bug #26502. */
+  *r_value = value;
+}
 
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->float_buffer.data, rect_size);
-    BLI_assert((rectf - ibuf->float_buffer.data) == rect_size); /* see bug #26502. */
+BLI_INLINE void scale_store(const float value, uchar *r_value)
+{
+  /* Sharpening filters overshoot, clamp before rounding. */
+  *r_value = uchar(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+}
 
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
+#if BLI_HAVE_SSE2
+BLI_INLINE __m128 scale_load_4(const float *values)
+{
+  return _mm_loadu_ps(values);
+}
 
-  (void)rect_size; /* UNUSED in release builds */
+BLI_INLINE __m128 scale_load_4(const uchar *values)
+{
+  int32_t packed;
+  memcpy(&packed, values, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bytes = _mm_cvtsi32_si128(packed);
+  return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+}
 
-  ibuf->x = newx;
-  return ibuf;
+BLI_INLINE void scale_store_4(const __m128 values, float *r_values)
+{
+  _mm_storeu_ps(r_values, values);
 }
 
-static ImBuf *scaledowny(ImBuf *ibuf, int newy)
+BLI_INLINE void scale_store_4(const __m128 values, uchar *r_values)
 {
-  const bool do_rect = (ibuf->byte_buffer.data != nullptr);
-  const bool do_float = (ibuf->float_buffer.data != nullptr);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = nullptr;
-  rect = _newrect = newrect = nullptr;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
+  const __m128 clamped = _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+  __m128i result = _mm_cvttps_epi32(_mm_add_ps(clamped, _mm_set1_ps(0.5f)));
+  result = _mm_packs_epi32(result, result);
+  result = _mm_packus_epi16(result, result);
+  const int32_t packed = _mm_cvtsi128_si32(result);
+  memcpy(r_values, &packed, sizeof(packed));
+}
+#endif
 
-  if (do_rect) {
-    _newrect = static_cast<uchar *>(MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny"));
-    if (_newrect == nullptr) {
-      return ibuf;
+/** Filter one row horizontally. */
+template<typename InT, typename OutT>
+static void scale_row_x(const InT *src, OutT *dst, const int channels, const ScaleAxis &axis)
+{
+  const int dst_width = int(axis.first.size());
+#if BLI_HAVE_SSE2
+  if (channels == 4) {
+    for (const int x : IndexRange(dst_width)) {
+      const InT *pixel = src + int64_t(axis.first[x]) * 4;
+      const float *weights = &axis.weights[int64_t(x) * axis.taps];
+      __m128 sum = _mm_setzero_ps();
+      for (int tap = 0; tap < axis.taps; tap++, pixel += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(scale_load_4(pixel), _mm_set1_ps(weights[tap])));
+      }
+      scale_store_4(sum, dst + int64_t(x) * 4);
     }
+    return;
   }
-  if (do_float) {
-    _newrectf = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+#endif
+  for (const int x : IndexRange(dst_width)) {
+    const InT *pixel = src + int64_t(axis.first[x]) * channels;
+    const float *weights = &axis.weights[int64_t(x) * axis.taps];
+    for (const int channel : IndexRange(channels)) {
+      float sum = 0.0f;
+      for (const int tap : IndexRange(axis.taps)) {
+        sum += scale_load(pixel[tap * channels + channel]) * weights[tap];
       }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ibuf->byte_buffer.data + x;
-      newrect = _newrect + x;
+      scale_store(sum, dst + int64_t(x) * channels + channel);
     }
-    if (do_float) {
-      rectf = ibuf->float_buffer.data + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
-      }
-
-      sample -= 1.0f;
-    }
-  }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - byte_buffer.data, rect_size);
-    BLI_assert((uchar *)rect - ibuf->byte_buffer.data == rect_size); /* see bug #26502. */
-
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->float_buffer.data, rect_size);
-    BLI_assert((rectf - ibuf->float_buffer.data) == rect_size); /* see bug #26502. */
-
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
   }
-
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
 }
 
-static ImBuf *scaleupx(ImBuf *ibuf, int newx)
+/**
+ * Filter one row vertically, \a src points to the first input row of the filter and rows are
+ * \a row_size values apart.
+ */
+template<typename InT, typename OutT>
+static void scale_row_y(const InT *src,
+                        OutT *dst,
+                        const int64_t row_size,
+                        const float *weights,
+                        const int taps)
 {
-  uchar *rect, *_newrect = nullptr, *newrect;
-  float *rectf, *_newrectf = nullptr, *newrectf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  if (ibuf == nullptr) {
-    return nullptr;
-  }
-  if (ibuf->byte_buffer.data == nullptr && ibuf->float_buffer.data == nullptr) {
-    return ibuf;
-  }
-
-  if (ibuf->byte_buffer.data) {
-    do_rect = true;
-    _newrect = static_cast<uchar *>(MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (ibuf->float_buffer.data) {
-    do_float = true;
-    _newrectf = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+  int64_t i = 0;
+#if BLI_HAVE_SSE2
+  for (; i + 4 <= row_size; i += 4) {
+    const InT *value = src + i;
+    __m128 sum = _mm_setzero_ps();
+    for (int tap = 0; tap < taps; tap++, value += row_size) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(scale_load_4(value), _mm_set1_ps(weights[tap])));
     }
+    scale_store_4(sum, dst + i);
   }
-
-  rect = ibuf->byte_buffer.data;
-  rectf = ibuf->float_buffer.data;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  /* Special case, copy all columns, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see #70356. */
-  if (UNLIKELY(ibuf->x == 1)) {
-    if (do_rect) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrect, rect, sizeof(char[4]));
-          newrect += 4;
-        }
-        rect += 4;
-      }
-    }
-    if (do_float) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrectf, rectf, sizeof(float[4]));
-          newrectf += 4;
-        }
-        rectf += 4;
-      }
+#endif
+  for (; i < row_size; i++) {
+    float sum = 0.0f;
+    for (const int tap : IndexRange(taps)) {
+      sum += scale_load(src[tap * row_size + i]) * weights[tap];
     }
+    scale_store(sum, dst + i);
   }
-  else {
-    const float add = (ibuf->x - 1.001) / (newx - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (y = ibuf->y; y > 0; y--) {
-
-      sample = 0;
-
-      if (do_rect) {
-        val_a = rect[0];
-        nval_a = rect[4];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[5];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[6];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[7];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 8;
-      }
-      if (do_float) {
-        val_af = rectf[0];
-        nval_af = rectf[4];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[5];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[6];
-        diff_gf = nval_gf - val_gf;
-
-        val_rf = rectf[3];
-        nval_rf = rectf[7];
-        diff_rf = nval_rf - val_rf;
+}
 
-        rectf += 8;
-      }
-      for (x = newx; x > 0; x--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += 4;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += 4;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += 4;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += 4;
-        }
-        sample += add;
-      }
+template<typename InT, typename OutT>
+static void scale_pass_x(const InT *src,
+                         OutT *dst,
+                         const int src_width,
+                         const int height,
+                         const int channels,
+                         const ScaleAxis &axis)
+{
+  const int64_t src_row_size = int64_t(src_width) * channels;
+  const int64_t dst_row_size = axis.first.size() * channels;
+  threading::parallel_for(IndexRange(height), 16, [&](const IndexRange y_range) {
+    for (const int64_t y : y_range) {
+      scale_row_x(src + y * src_row_size, dst + y * dst_row_size, channels, axis);
     }
-  }
-
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
+  });
+}
 
-  ibuf->x = newx;
-  return ibuf;
+template<typename InT, typename OutT>
+static void scale_pass_y(
+    const InT *src, OutT *dst, const int width, const int channels, const ScaleAxis &axis)
+{
+  const int64_t row_size = int64_t(width) * channels;
+  threading::parallel_for(axis.first.index_range(), 16, [&](const IndexRange y_range) {
+    for (const int64_t y : y_range) {
+      scale_row_y(src + axis.first[y] * row_size,
+                  dst + y * row_size,
+                  row_size,
+                  &axis.weights[y * axis.taps],
+                  axis.taps);
+    }
+  });
 }
 
-static ImBuf *scaleupy(ImBuf *ibuf, int newy)
+/**
+ * Scale one buffer, an axis without taps keeps its size. When both axes change, the horizontal
+ * pass writes to a temporary float buffer which the vertical pass reads.
+ */
+template<typename T>
+static T *scale_buffer(const T *src,
+                       const int channels,
+                       const int2 src_size,
+                       const int2 dst_size,
+                       const ScaleAxis &axis_x,
+                       const ScaleAxis &axis_y)
 {
-  uchar *rect, *_newrect = nullptr, *newrect;
-  float *rectf, *_newrectf = nullptr, *newrectf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
+  T *dst = static_cast<T *>(MEM_mallocN(
+      sizeof(T) * size_t(channels) * size_t(dst_size.x) * size_t(dst_size.y), __func__));
 
-  if (ibuf == nullptr) {
-    return nullptr;
-  }
-  if (ibuf->byte_buffer.data == nullptr && ibuf->float_buffer.data == nullptr) {
-    return ibuf;
+  if (axis_x.taps == 0) {
+    scale_pass_y(src, dst, src_size.x, channels, axis_y);
   }
-
-  if (ibuf->byte_buffer.data) {
-    do_rect = true;
-    _newrect = static_cast<uchar *>(MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (ibuf->float_buffer.data) {
-    do_float = true;
-    _newrectf = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  rect = ibuf->byte_buffer.data;
-  rectf = ibuf->float_buffer.data;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  skipx = 4 * ibuf->x;
-
-  /* Special case, copy all rows, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see #70356. */
-  if (UNLIKELY(ibuf->y == 1)) {
-    if (do_rect) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrect, rect, sizeof(char) * skipx);
-        newrect += skipx;
-      }
-    }
-    if (do_float) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrectf, rectf, sizeof(float) * skipx);
-        newrectf += skipx;
-      }
-    }
+  else if (axis_y.taps == 0) {
+    scale_pass_x(src, dst, src_size.x, src_size.y, channels, axis_x);
   }
   else {
-    const float add = (ibuf->y - 1.001) / (newy - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (x = ibuf->x; x > 0; x--) {
-      sample = 0;
-      if (do_rect) {
-        rect = ibuf->byte_buffer.data + 4 * (x - 1);
-        newrect = _newrect + 4 * (x - 1);
-
-        val_a = rect[0];
-        nval_a = rect[skipx];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[skipx + 1];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[skipx + 2];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[skipx + 3];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 2 * skipx;
-      }
-      if (do_float) {
-        rectf = ibuf->float_buffer.data + 4 * (x - 1);
-        newrectf = _newrectf + 4 * (x - 1);
-
-        val_af = rectf[0];
-        nval_af = rectf[skipx];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[skipx + 1];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[skipx + 2];
-        diff_gf = nval_gf - val_gf;
-
-        val_rf = rectf[3];
-        nval_rf = rectf[skipx + 3];
-        diff_rf = nval_rf - val_rf;
-
-        rectf += 2 * skipx;
-      }
-
-      for (y = newy; y > 0; y--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += skipx;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += skipx;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += skipx;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += skipx;
-        }
-        sample += add;
-      }
-    }
+    float *tmp = static_cast<float *>(MEM_mallocN(
+        sizeof(float) * size_t(channels) * size_t(dst_size.x) * size_t(src_size.y), __func__));
+    scale_pass_x(src, tmp, src_size.x, src_size.y, channels, axis_x);
+    scale_pass_y(tmp, dst, dst_size.x, channels, axis_y);
+    MEM_freeN(tmp);
   }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
-
-  ibuf->y = newy;
-  return ibuf;
+  return dst;
 }
 
-bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
+}  // namespace blender::imbuf
+
+bool IMB_scale(ImBuf *ibuf, const uint newx, const uint newy, const eIMBScaleFilter filter)
 {
+  using namespace blender;
+  using namespace blender::imbuf;
   BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
 
   if (ibuf == nullptr) {
@@ -1446,33 +650,42 @@ bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
   if (ibuf->byte_buffer.data == nullptr && ibuf->float_buffer.data == nullptr) {
     return false;
   }
-
   if (newx == ibuf->x && newy == ibuf->y) {
     return false;
   }
 
-  /* try to scale common cases in a fast way */
-  /* disabled, quality loss is unacceptable, see report #18609  (ton) */
-  if (false && q_scale_linear_interpolation(ibuf, newx, newy)) {
-    return true;
-  }
+  const int2 src_size(ibuf->x, ibuf->y);
+  const int2 dst_size(newx, newy);
+  const ScaleAxis axis_x = src_size.x != dst_size.x ?
+                               scale_axis_init(filter, src_size.x, dst_size.x) :
+                               ScaleAxis();
+  const ScaleAxis axis_y = src_size.y != dst_size.y ?
+                               scale_axis_init(filter, src_size.y, dst_size.y) :
+                               ScaleAxis();
 
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
+  if (ibuf->byte_buffer.data) {
+    uchar *byte_buffer = scale_buffer(
+        ibuf->byte_buffer.data, 4, src_size, dst_size, axis_x, axis_y);
+    imb_freerectImBuf(ibuf);
+    IMB_assign_byte_buffer(ibuf, byte_buffer, IB_TAKE_OWNERSHIP);
   }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
+  if (ibuf->float_buffer.data) {
+    float *float_buffer = scale_buffer(
+        ibuf->float_buffer.data, ibuf->channels, src_size, dst_size, axis_x, axis_y);
+    imb_freerectfloatImBuf(ibuf);
+    IMB_assign_float_buffer(ibuf, float_buffer, IB_TAKE_OWNERSHIP);
   }
 
+  ibuf->x = newx;
+  ibuf->y = newy;
   return true;
 }
 
+bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
+{
+  return IMB_scale(ibuf, newx, newy, IMB_SCALE_BOX);
+}
+
 struct imbufRGBA {
   float r, g, b, a;
 };
@@ -1572,118 +785,7 @@ bool IMB_scalefastImBuf(ImBuf *ibuf, uint newx, uint newy)
   return true;
 }
 
-/* ******** threaded scaling ******** */
-
-struct ScaleTreadInitData {
-  ImBuf *ibuf;
-
-  uint newx;
-  uint newy;
-
-  uchar *byte_buffer;
-  float *float_buffer;
-};
-
-struct ScaleThreadData {
-  ImBuf *ibuf;
-
-  uint newx;
-  uint newy;
-
-  int start_line;
-  int tot_line;
-
-  uchar *byte_buffer;
-  float *float_buffer;
-};
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ScaleTreadInitData *init_data = (ScaleTreadInitData *)init_data_v;
-
-  data->ibuf = init_data->ibuf;
-
-  data->newx = init_data->newx;
-  data->newy = init_data->newy;
-
-  data->start_line = start_line;
-  data->tot_line = tot_line;
-
-  data->byte_buffer = init_data->byte_buffer;
-  data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-  using namespace blender::imbuf;
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ImBuf *ibuf = data->ibuf;
-  int i;
-  float factor_x = float(ibuf->x) / data->newx;
-  float factor_y = float(ibuf->y) / data->newy;
-
-  for (i = 0; i < data->tot_line; i++) {
-    int y = data->start_line + i;
-    int x;
-
-    for (x = 0; x < data->newx; x++) {
-      float u = float(x) * factor_x;
-      float v = float(y) * factor_y;
-      int offset = y * data->newx + x;
-
-      if (data->byte_buffer) {
-        interpolate_bilinear_border_byte(ibuf, data->byte_buffer + 4 * offset, u, v);
-      }
-
-      if (data->float_buffer) {
-        float *pixel = data->float_buffer + ibuf->channels * offset;
-        blender::math::interpolate_bilinear_border_fl(
-            ibuf->float_buffer.data, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-      }
-    }
-  }
-
-  return nullptr;
-}
-
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, uint newx, uint newy)
 {
-  BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
-
-  ScaleTreadInitData init_data = {nullptr};
-
-  /* prepare initialization data */
-  init_data.ibuf = ibuf;
-
-  init_data.newx = newx;
-  init_data.newy = newy;
-
-  if (ibuf->byte_buffer.data) {
-    init_data.byte_buffer = static_cast<uchar *>(
-        MEM_mallocN(4 * newx * newy * sizeof(char), "threaded scale byte buffer"));
-  }
-
-  if (ibuf->float_buffer.data) {
-    init_data.float_buffer = static_cast<float *>(
-        MEM_mallocN(ibuf->channels * newx * newy * sizeof(float), "threaded scale float buffer"));
-  }
-
-  /* actual scaling threads */
-  IMB_processor_apply_threaded(
-      newy, sizeof(ScaleThreadData), &init_data, scale_thread_init, do_scale_thread);
-
-  /* alter image buffer */
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  if (ibuf->byte_buffer.data) {
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, init_data.byte_buffer, IB_TAKE_OWNERSHIP);
-  }
-
-  if (ibuf->float_buffer.data) {
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, init_data.float_buffer, IB_TAKE_OWNERSHIP);
-  }
+  IMB_scale(ibuf, newx, newy, IMB_SCALE_BILINEAR);
 }
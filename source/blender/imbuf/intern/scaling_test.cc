@@ -0,0 +1,134 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_color.hh"
+#include "BLI_math_vector.h"
+#include "BLI_math_vector_types.hh"
+#include "IMB_imbuf.hh"
+
+namespace blender::imbuf::tests {
+
+static const eIMBScaleFilter all_filters[] = {
+    IMB_SCALE_BOX, IMB_SCALE_BILINEAR, IMB_SCALE_BICUBIC, IMB_SCALE_LANCZOS};
+
+static ImBuf *create_4x2_test_image()
+{
+  ImBuf *img = IMB_allocImBuf(4, 2, 32, IB_rect);
+  ColorTheme4b *col = reinterpret_cast<ColorTheme4b *>(img->byte_buffer.data);
+
+  /* Two 2x2 blocks, box filtering 2x smaller results in the average of each block. */
+  col[0] = ColorTheme4b(0, 0, 0, 255);
+  col[1] = ColorTheme4b(255, 0, 0, 255);
+  col[4] = ColorTheme4b(255, 255, 0, 255);
+  col[5] = ColorTheme4b(255, 255, 255, 255);
+
+  col[2] = ColorTheme4b(133, 55, 31, 13);
+  col[3] = ColorTheme4b(133, 55, 31, 15);
+  col[6] = ColorTheme4b(133, 55, 31, 17);
+  col[7] = ColorTheme4b(133, 55, 31, 19);
+
+  return img;
+}
+
+TEST(imbuf_scaling, box_2x_smaller)
+{
+  ImBuf *img = create_4x2_test_image();
+  EXPECT_TRUE(IMB_scale(img, 2, 1, IMB_SCALE_BOX));
+  EXPECT_EQ(img->x, 2);
+  EXPECT_EQ(img->y, 1);
+  const ColorTheme4b *got = reinterpret_cast<ColorTheme4b *>(img->byte_buffer.data);
+  EXPECT_EQ(got[0], ColorTheme4b(191, 128, 64, 255));
+  EXPECT_EQ(got[1], ColorTheme4b(133, 55, 31, 16));
+  IMB_freeImBuf(img);
+}
+
+TEST(imbuf_scaling, bilinear_2x_larger)
+{
+  ImBuf *img = IMB_allocImBuf(2, 1, 32, IB_rectfloat);
+  img->channels = 1;
+  img->float_buffer.data[0] = 0.0f;
+  img->float_buffer.data[1] = 1.0f;
+  EXPECT_TRUE(IMB_scale(img, 4, 1, IMB_SCALE_BILINEAR));
+  const float *got = img->float_buffer.data;
+  EXPECT_FLOAT_EQ(got[0], 0.0f);
+  EXPECT_FLOAT_EQ(got[1], 0.25f);
+  EXPECT_FLOAT_EQ(got[2], 0.75f);
+  EXPECT_FLOAT_EQ(got[3], 1.0f);
+  IMB_freeImBuf(img);
+}
+
+TEST(imbuf_scaling, constant_image)
+{
+  /* A constant image stays constant with every filter and size, including at the borders. */
+  for (const eIMBScaleFilter filter : all_filters) {
+    for (const int2 size : {int2(3, 2), int2(13, 11), int2(1, 1), int2(40, 3)}) {
+      ImBuf *img = IMB_allocImBuf(7, 5, 32, IB_rect | IB_rectfloat);
+      for (int i = 0; i < 7 * 5; i++) {
+        reinterpret_cast<ColorTheme4b *>(img->byte_buffer.data)[i] = ColorTheme4b(10, 20, 30, 40);
+        copy_v4_fl4(&img->float_buffer.data[i * 4], 0.1f, 0.2f, 0.3f, 0.4f);
+      }
+      EXPECT_TRUE(IMB_scale(img, size.x, size.y, filter));
+      for (int i = 0; i < size.x * size.y; i++) {
+        EXPECT_EQ(reinterpret_cast<ColorTheme4b *>(img->byte_buffer.data)[i],
+                  ColorTheme4b(10, 20, 30, 40));
+        EXPECT_NEAR(img->float_buffer.data[i * 4 + 0], 0.1f, 1e-6f);
+        EXPECT_NEAR(img->float_buffer.data[i * 4 + 3], 0.4f, 1e-6f);
+      }
+      IMB_freeImBuf(img);
+    }
+  }
+}
+
+TEST(imbuf_scaling, byte_overshoot_is_clamped)
+{
+  /* Sharp edges make the cubic and Lanczos filters overshoot, which must not wrap around. */
+  for (const eIMBScaleFilter filter : all_filters) {
+    ImBuf *img = IMB_allocImBuf(8, 1, 32, IB_rect);
+    for (int i = 0; i < 8; i++) {
+      const uchar value = i < 4 ? 0 : 255;
+      reinterpret_cast<ColorTheme4b *>(img->byte_buffer.data)[i] = ColorTheme4b(
+          value, value, value, value);
+    }
+    EXPECT_TRUE(IMB_scale(img, 28, 1, filter));
+    const ColorTheme4b *got = reinterpret_cast<ColorTheme4b *>(img->byte_buffer.data);
+    for (int i = 0; i < 28; i++) {
+      EXPECT_EQ(got[i].r >= 128, i >= 14) << "filter " << filter << " pixel " << i;
+    }
+    IMB_freeImBuf(img);
+  }
+}
+
+TEST(imbuf_scaling, float_channels)
+{
+  /* Single and three channel float images have no vectorized path for the horizontal pass. */
+  for (const int channels : {1, 3}) {
+    ImBuf *img = IMB_allocImBuf(6, 4, 32, IB_rectfloat);
+    img->channels = channels;
+    for (int i = 0; i < 6 * 4 * channels; i++) {
+      img->float_buffer.data[i] = float(i % channels) + float(i / channels % 6) * 0.5f;
+    }
+    EXPECT_TRUE(IMB_scale(img, 3, 2, IMB_SCALE_BOX));
+    for (int y = 0; y < 2; y++) {
+      for (int x = 0; x < 3; x++) {
+        for (int c = 0; c < channels; c++) {
+          /* Average of columns 2x and 2x+1. */
+          EXPECT_FLOAT_EQ(img->float_buffer.data[(y * 3 + x) * channels + c],
+                          float(c) + (float(x) * 2.0f + 0.5f) * 0.5f);
+        }
+      }
+    }
+    IMB_freeImBuf(img);
+  }
+}
+
+TEST(imbuf_scaling, same_size)
+{
+  ImBuf *img = create_4x2_test_image();
+  EXPECT_FALSE(IMB_scale(img, 4, 2, IMB_SCALE_LANCZOS));
+  IMB_freeImBuf(img);
+}
+
+}  // namespace blender::imbuf::tests
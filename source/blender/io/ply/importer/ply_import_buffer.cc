@@ -5,6 +5,7 @@
 #include "ply_import_buffer.hh"
 
 #include "BLI_fileops.h"
+#include "BLI_mmap.h"
 
 #include <cstdio>
 #include <cstring>
@@ -17,14 +18,21 @@ static inline bool is_newline(char ch)
 
 namespace blender::io::ply {
 
-PlyReadBuffer::PlyReadBuffer(const char *file_path, size_t read_buffer_size)
-    : buffer_(read_buffer_size), read_buffer_size_(read_buffer_size)
+PlyReadBuffer::PlyReadBuffer(const char *file_path,
+                             size_t read_buffer_size,
+                             bool use_memory_map)
+    : use_memory_map_(use_memory_map),
+      buffer_(read_buffer_size),
+      read_buffer_size_(read_buffer_size)
 {
   file_ = BLI_fopen(file_path, "rb");
 }
 
 PlyReadBuffer::~PlyReadBuffer()
 {
+  if (mmap_file_ != nullptr) {
+    BLI_mmap_free(mmap_file_);
+  }
   if (file_ != nullptr) {
     fclose(file_);
   }
@@ -33,6 +41,43 @@ PlyReadBuffer::~PlyReadBuffer()
 void PlyReadBuffer::after_header(bool is_binary)
 {
   is_binary_ = is_binary;
+  if (!is_binary || !use_memory_map_ || file_ == nullptr) {
+    return;
+  }
+  /* Binary data starts right after the header, which has been read through the buffer. */
+  const size_t data_offset = buffer_file_offset_ + pos_;
+  mmap_file_ = BLI_mmap_open(fileno(file_));
+  if (mmap_file_ == nullptr || BLI_mmap_get_length(mmap_file_) < data_offset) {
+    /* Fall back to buffered reading. */
+    if (mmap_file_ != nullptr) {
+      BLI_mmap_free(mmap_file_);
+      mmap_file_ = nullptr;
+    }
+    return;
+  }
+  mapped_begin_ = static_cast<const uint8_t *>(BLI_mmap_get_pointer(mmap_file_));
+  mapped_size_ = BLI_mmap_get_length(mmap_file_);
+  mapped_pos_ = data_offset;
+}
+
+Span<uint8_t> PlyReadBuffer::mapped_data() const
+{
+  if (mmap_file_ == nullptr) {
+    return {};
+  }
+  return Span<uint8_t>(mapped_begin_ + mapped_pos_, mapped_size_ - mapped_pos_);
+}
+
+void PlyReadBuffer::skip_mapped_bytes(size_t size)
+{
+  BLI_assert(mmap_file_ != nullptr);
+  BLI_assert(mapped_pos_ + size <= mapped_size_);
+  mapped_pos_ += size;
+}
+
+bool PlyReadBuffer::mapped_io_error() const
+{
+  return mmap_file_ != nullptr && BLI_mmap_any_io_error(mmap_file_);
 }
 
 Span<char> PlyReadBuffer::read_line()
@@ -62,6 +107,13 @@ Span<char> PlyReadBuffer::read_line()
 
 bool PlyReadBuffer::read_bytes(void *dst, size_t size)
 {
+  if (mmap_file_ != nullptr) {
+    if (!BLI_mmap_read(mmap_file_, dst, mapped_pos_, size)) {
+      return false;
+    }
+    mapped_pos_ += size;
+    return true;
+  }
   while (size > 0) {
     if (pos_ + size > buf_used_) {
       if (!refill_buffer()) {
@@ -95,6 +147,7 @@ bool PlyReadBuffer::refill_buffer()
   if (keep > 0) {
     memmove(buffer_.data(), buffer_.data() + pos_, keep);
   }
+  buffer_file_offset_ += pos_;
   /* Read in data from the file. */
   size_t read = fread(buffer_.data() + keep, 1, read_buffer_size_ - keep, file_) + keep;
   at_eof_ = read < read_buffer_size_;
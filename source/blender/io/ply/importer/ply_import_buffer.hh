@@ -13,20 +13,39 @@
 #include "BLI_array.hh"
 #include "BLI_span.hh"
 
+struct BLI_mmap_file;
+
 namespace blender::io::ply {
 
 /**
  * Reads underlying PLY file in large chunks, and provides interface for ascii/header
  * parsing to read individual lines, and for binary parsing to read chunks of bytes.
+ *
+ * Binary data is read straight from a memory mapping of the file when possible,
+ * which also allows decoding element rows directly from it (see #mapped_data).
  */
 class PlyReadBuffer {
  public:
-  PlyReadBuffer(const char *file_path, size_t read_buffer_size = 64 * 1024);
+  PlyReadBuffer(const char *file_path,
+                size_t read_buffer_size = 64 * 1024,
+                bool use_memory_map = true);
   ~PlyReadBuffer();
 
   /** After header is parsed, indicate whether the rest of reading will be ascii or binary. */
   void after_header(bool is_binary);
 
+  /**
+   * Binary data that has not been consumed yet, pointing into the memory mapped file.
+   * Empty when the file is not memory mapped.
+   */
+  Span<uint8_t> mapped_data() const;
+
+  /** Consume bytes of #mapped_data that were decoded directly. */
+  void skip_mapped_bytes(size_t size);
+
+  /** Whether an IO error occurred while accessing the memory mapped file. */
+  bool mapped_io_error() const;
+
   /**
    * Gets the next line from the file as a Span. The line does not include any newline characters.
    */
@@ -43,6 +62,14 @@ class PlyReadBuffer {
 
  private:
   FILE *file_ = nullptr;
+  BLI_mmap_file *mmap_file_ = nullptr;
+  const uint8_t *mapped_begin_ = nullptr;
+  size_t mapped_size_ = 0;
+  /** Offset of the next unconsumed byte in the memory mapped file. */
+  size_t mapped_pos_ = 0;
+  /** Offset in the file at which the buffer data starts. */
+  size_t buffer_file_offset_ = 0;
+  bool use_memory_map_ = true;
   Array<char> buffer_;
   int pos_ = 0;
   int buf_used_ = 0;
@@ -12,6 +12,7 @@
 
 #include "BLI_endian_switch.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 
 #include "fast_float.h"
 
@@ -190,22 +191,17 @@ template<typename T> static T get_binary_value(PlyDataTypes type, const uint8_t
   return val;
 }
 
-static const char *parse_row_binary(PlyReadBuffer &file,
-                                    const PlyHeader &header,
-                                    const PlyElement &element,
-                                    Vector<uint8_t> &r_scratch,
-                                    Vector<float> &r_values)
+/**
+ * Decode a row of a binary element with fixed stride. Big endian values are byte-swapped
+ * in place, so `row` must be a writable copy of the file data.
+ */
+static const char *decode_row_binary(const PlyHeader &header,
+                                     const PlyElement &element,
+                                     uint8_t *row,
+                                     MutableSpan<float> r_values)
 {
-  if (element.stride == 0) {
-    return "Vertex/Edge element contains list properties, this is not supported";
-  }
-  BLI_assert(r_scratch.size() == element.stride);
   BLI_assert(r_values.size() == element.properties.size());
-  if (!file.read_bytes(r_scratch.data(), r_scratch.size())) {
-    return "Could not read row of binary property";
-  }
-
-  const uint8_t *ptr = r_scratch.data();
+  const uint8_t *ptr = row;
   if (header.type == PlyFormatType::BINARY_LE) {
     /* Little endian: just read/convert the values. */
     for (int i = 0, n = int(element.properties.size()); i != n; i++) {
@@ -229,6 +225,62 @@ static const char *parse_row_binary(PlyReadBuffer &file,
   return nullptr;
 }
 
+static const char *parse_row_binary(PlyReadBuffer &file,
+                                    const PlyHeader &header,
+                                    const PlyElement &element,
+                                    Vector<uint8_t> &r_scratch,
+                                    Vector<float> &r_values)
+{
+  if (element.stride == 0) {
+    return "Vertex/Edge element contains list properties, this is not supported";
+  }
+  BLI_assert(r_scratch.size() == element.stride);
+  if (!file.read_bytes(r_scratch.data(), r_scratch.size())) {
+    return "Could not read row of binary property";
+  }
+  return decode_row_binary(header, element, r_scratch.data(), r_values);
+}
+
+/**
+ * Decode all rows of a binary element with fixed stride straight from the memory mapped file,
+ * in parallel over ranges of rows. Returns false if the file is not memory mapped.
+ */
+template<typename Fn>
+static bool decode_mapped_rows(PlyReadBuffer &file,
+                               const PlyHeader &header,
+                               const PlyElement &element,
+                               const char *&r_error,
+                               const Fn &store_row)
+{
+  const Span<uint8_t> mapped = file.mapped_data();
+  if (mapped.is_empty() || element.stride == 0 ||
+      !ELEM(header.type, PlyFormatType::BINARY_LE, PlyFormatType::BINARY_BE))
+  {
+    return false;
+  }
+  const size_t data_size = size_t(element.count) * size_t(element.stride);
+  if (size_t(mapped.size()) < data_size) {
+    r_error = "Could not read row of binary property";
+    return true;
+  }
+
+  threading::parallel_for(IndexRange(element.count), 4096, [&](const IndexRange range) {
+    Array<float, 32> values(element.properties.size());
+    Array<uint8_t, 256> row(element.stride);
+    for (const int64_t i : range) {
+      /* Copy the row, it might be unaligned and needs byte swapping for big endian files. */
+      memcpy(row.data(), mapped.data() + i * element.stride, element.stride);
+      decode_row_binary(header, element, row.data(), values);
+      store_row(i, values.as_span());
+    }
+  });
+  file.skip_mapped_bytes(data_size);
+  if (file.mapped_io_error()) {
+    r_error = "Could not read row of binary property";
+  }
+  return true;
+}
+
 static const char *load_vertex_element(PlyReadBuffer &file,
                                        const PlyHeader &header,
                                        const PlyElement &element,
@@ -266,15 +318,15 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     data->vertex_custom_attr.append(attr);
   }
 
-  data->vertices.reserve(element.count);
+  data->vertices.resize(element.count);
   if (has_color) {
-    data->vertex_colors.reserve(element.count);
+    data->vertex_colors.resize(element.count);
   }
   if (has_normal) {
-    data->vertex_normals.reserve(element.count);
+    data->vertex_normals.resize(element.count);
   }
   if (has_uv) {
-    data->uv_coordinates.reserve(element.count);
+    data->uv_coordinates.resize(element.count);
   }
 
   float4 color_norm = {1, 1, 1, 1};
@@ -287,31 +339,13 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     color_norm.w = data_type_normalizer[element.properties[alpha_index].type];
   }
 
-  Vector<float> value_vec(element.properties.size());
-  Vector<uint8_t> scratch;
-  if (header.type != PlyFormatType::ASCII) {
-    scratch.resize(element.stride);
-  }
-
-  for (int i = 0; i < element.count; i++) {
-
-    const char *error = nullptr;
-    if (header.type == PlyFormatType::ASCII) {
-      error = parse_row_ascii(file, value_vec);
-    }
-    else {
-      error = parse_row_binary(file, header, element, scratch, value_vec);
-    }
-    if (error != nullptr) {
-      return error;
-    }
-
+  auto store_row = [&](const int64_t i, const Span<float> value_vec) {
     /* Vertex coord */
     float3 vertex3;
     vertex3.x = value_vec[vertex_index.x];
     vertex3.y = value_vec[vertex_index.y];
     vertex3.z = value_vec[vertex_index.z];
-    data->vertices.append(vertex3);
+    data->vertices[i] = vertex3;
 
     /* Vertex color */
     if (has_color) {
@@ -325,7 +359,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       else {
         colors4.w = 1.0f;
       }
-      data->vertex_colors.append(colors4);
+      data->vertex_colors[i] = colors4;
     }
 
     /* If normals */
@@ -334,7 +368,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       normals3.x = value_vec[normal_index.x];
       normals3.y = value_vec[normal_index.y];
       normals3.z = value_vec[normal_index.z];
-      data->vertex_normals.append(normals3);
+      data->vertex_normals[i] = normals3;
     }
 
     /* If uv */
@@ -342,7 +376,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       float2 uvmap;
       uvmap.x = value_vec[uv_index.x];
       uvmap.y = value_vec[uv_index.y];
-      data->uv_coordinates.append(uvmap);
+      data->uv_coordinates[i] = uvmap;
     }
 
     /* Custom attributes */
@@ -350,6 +384,32 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       float value = value_vec[custom_attr_indices[ci]];
       data->vertex_custom_attr[ci].data[i] = value;
     }
+  };
+
+  const char *mapped_error = nullptr;
+  if (decode_mapped_rows(file, header, element, mapped_error, store_row)) {
+    return mapped_error;
+  }
+
+  Vector<float> value_vec(element.properties.size());
+  Vector<uint8_t> scratch;
+  if (header.type != PlyFormatType::ASCII) {
+    scratch.resize(element.stride);
+  }
+
+  for (int i = 0; i < element.count; i++) {
+
+    const char *error = nullptr;
+    if (header.type == PlyFormatType::ASCII) {
+      error = parse_row_ascii(file, value_vec);
+    }
+    else {
+      error = parse_row_binary(file, header, element, scratch, value_vec);
+    }
+    if (error != nullptr) {
+      return error;
+    }
+    store_row(i, value_vec);
   }
   return nullptr;
 }
@@ -385,6 +445,126 @@ static void skip_property(PlyReadBuffer &file,
   }
 }
 
+/** Read a single binary value of the given type from unaligned memory. */
+template<typename T>
+static T read_mapped_value(const uint8_t *src, const PlyDataTypes type, const bool big_endian)
+{
+  uint8_t value[8];
+  memcpy(value, src, data_type_size[type]);
+  if (big_endian) {
+    endian_switch(value, data_type_size[type]);
+  }
+  const uint8_t *ptr = value;
+  return get_binary_value<T>(type, ptr);
+}
+
+/**
+ * Advance `r_pos` past a property of a row in memory mapped data.
+ * Returns false if the data is truncated.
+ */
+static bool skip_mapped_property(const Span<uint8_t> data,
+                                 const PlyProperty &prop,
+                                 const bool big_endian,
+                                 size_t &r_pos)
+{
+  size_t count = 1;
+  if (prop.count_type != PlyDataTypes::NONE) {
+    if (r_pos + data_type_size[prop.count_type] > size_t(data.size())) {
+      return false;
+    }
+    count = read_mapped_value<uint32_t>(data.data() + r_pos, prop.count_type, big_endian);
+    r_pos += data_type_size[prop.count_type];
+  }
+  r_pos += count * data_type_size[prop.type];
+  return r_pos <= size_t(data.size());
+}
+
+/**
+ * Load face vertex indices straight from the memory mapped file. Rows have variable size,
+ * so a quick sequential pass finds the index lists, which are then decoded in parallel.
+ */
+static const char *load_face_element_mapped(PlyReadBuffer &file,
+                                            const PlyHeader &header,
+                                            const PlyElement &element,
+                                            const int prop_index,
+                                            PlyData *data)
+{
+  const Span<uint8_t> mapped = file.mapped_data();
+  const PlyProperty &prop = element.properties[prop_index];
+  const bool big_endian = header.type == PlyFormatType::BINARY_BE;
+  const int index_size = data_type_size[prop.type];
+  const char *truncated_error = "Could not read row of binary property";
+
+  /* Offsets of the vertex index lists of the faces that are kept. */
+  Vector<size_t> list_offsets;
+  list_offsets.reserve(element.count);
+  data->face_sizes.reserve(element.count);
+
+  size_t pos = 0;
+  for (int i = 0; i < element.count; i++) {
+    /* Skip any properties before vertex indices. */
+    for (int j = 0; j < prop_index; j++) {
+      if (!skip_mapped_property(mapped, element.properties[j], big_endian, pos)) {
+        return truncated_error;
+      }
+    }
+
+    /* Find vertex indices list. */
+    if (pos + data_type_size[prop.count_type] > size_t(mapped.size())) {
+      return truncated_error;
+    }
+    uint32_t count = read_mapped_value<uint32_t>(
+        mapped.data() + pos, prop.count_type, big_endian);
+    pos += data_type_size[prop.count_type];
+    if (count < 1 || count > 255) {
+      return "Invalid face size, must be between 1 and 255";
+    }
+    /* Previous python based importer was accepting faces with fewer
+     * than 3 vertices, and silently dropping them. */
+    if (count < 3) {
+      fprintf(stderr, "PLY Importer: ignoring face %i (%i vertices)\n", i, int(count));
+    }
+    else {
+      list_offsets.append(pos);
+      data->face_sizes.append(count);
+    }
+    pos += size_t(count) * index_size;
+    if (pos > size_t(mapped.size())) {
+      return truncated_error;
+    }
+
+    /* Skip any properties after vertex indices. */
+    for (int j = prop_index + 1; j < element.properties.size(); j++) {
+      if (!skip_mapped_property(mapped, element.properties[j], big_endian, pos)) {
+        return truncated_error;
+      }
+    }
+  }
+
+  Array<int64_t> face_starts(data->face_sizes.size() + 1);
+  face_starts[0] = 0;
+  for (const int64_t face : data->face_sizes.index_range()) {
+    face_starts[face + 1] = face_starts[face] + data->face_sizes[face];
+  }
+  data->face_vertices.resize(face_starts.last());
+
+  threading::parallel_for(list_offsets.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t face : range) {
+      const uint8_t *src = mapped.data() + list_offsets[face];
+      for (int64_t corner = face_starts[face]; corner < face_starts[face + 1]; corner++) {
+        data->face_vertices[corner] = read_mapped_value<uint32_t>(src, prop.type, big_endian);
+        src += index_size;
+      }
+    }
+  });
+
+  file.skip_mapped_bytes(pos);
+  if (file.mapped_io_error()) {
+    return truncated_error;
+  }
+  return nullptr;
+}
+
 static const char *load_face_element(PlyReadBuffer &file,
                                      const PlyHeader &header,
                                      const PlyElement &element,
@@ -405,6 +585,10 @@ static const char *load_face_element(PlyReadBuffer &file,
     return "Face element vertex indices property must be a list";
   }
 
+  if (header.type != PlyFormatType::ASCII && !file.mapped_data().is_empty()) {
+    return load_face_element_mapped(file, header, element, prop_index, data);
+  }
+
   data->face_vertices.reserve(element.count * 3);
   data->face_sizes.reserve(element.count);
 
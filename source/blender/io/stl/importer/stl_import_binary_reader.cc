@@ -6,12 +6,22 @@
  * \ingroup stl
  */
 
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <iostream>
 
+#include "BKE_lib_id.hh"
 #include "BKE_mesh.hh"
 
 #include "BLI_array.hh"
+#include "BLI_array_utils.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_mmap.h"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -22,6 +32,162 @@
 
 namespace blender::io::stl {
 
+/**
+ * Bit pattern of a position; positions with equal keys are merged into one vertex,
+ * like the vertex set of #STLMeshHelper does.
+ */
+using PositionKey = std::array<uint32_t, 3>;
+
+/**
+ * Decode the triangles straight from the memory mapped file, without copying them into a read
+ * buffer first. Instead of inserting every corner into a hash set one after another, vertices
+ * and triangles are deduplicated by sorting in parallel. Ties are broken by index, so the
+ * resulting mesh is the same as the one #STLMeshHelper creates.
+ */
+static Mesh *read_stl_binary_mapped(const uint8_t *tris_data,
+                                    const int64_t tris_num,
+                                    const bool use_custom_normals)
+{
+  const int64_t corners_num = tris_num * 3;
+  auto position_key = [&](const int64_t corner) {
+    PositionKey key;
+    memcpy(key.data(),
+           tris_data + (corner / 3) * BINARY_STRIDE + offsetof(PackedTriangle, vertices) +
+               (corner % 3) * sizeof(float3),
+           sizeof(key));
+    return key;
+  };
+  auto position_is_nan = [](const PositionKey &key) {
+    float3 position;
+    memcpy(&position, key.data(), sizeof(position));
+    return std::isnan(position.x) || std::isnan(position.y) || std::isnan(position.z);
+  };
+  /* NaN positions never compare equal, so each of them becomes a separate vertex. */
+  auto same_position = [&](const int64_t corner_a, const int64_t corner_b) {
+    const PositionKey key = position_key(corner_a);
+    return key == position_key(corner_b) && !position_is_nan(key);
+  };
+
+  /* For every corner, find the first corner with the same position. */
+  Array<int> corner_verts(corners_num);
+  {
+    Array<int> sorted_corners(corners_num);
+    array_utils::fill_index_range<int>(sorted_corners);
+    parallel_sort(sorted_corners.begin(), sorted_corners.end(), [&](const int a, const int b) {
+      const PositionKey key_a = position_key(a);
+      const PositionKey key_b = position_key(b);
+      if (key_a != key_b) {
+        return key_a < key_b;
+      }
+      return a < b;
+    });
+    threading::parallel_for(sorted_corners.index_range(), 4096, [&](const IndexRange range) {
+      /* Find the start of the group of equal positions the range begins in. */
+      int64_t group_start = range.first();
+      while (group_start > 0 &&
+             same_position(sorted_corners[group_start - 1], sorted_corners[range.first()]))
+      {
+        group_start--;
+      }
+      int first_corner = sorted_corners[group_start];
+      for (const int64_t i : range.drop_front(1)) {
+        if (!same_position(sorted_corners[i - 1], sorted_corners[i])) {
+          first_corner = sorted_corners[i];
+        }
+        corner_verts[sorted_corners[i]] = first_corner;
+      }
+      corner_verts[sorted_corners[range.first()]] = sorted_corners[group_start];
+    });
+  }
+
+  /* Number the vertices in order of first occurrence. The first corner of a group always has
+   * the lowest index, so its vertex index is known by the time other corners refer to it. */
+  Vector<float3> positions;
+  for (const int64_t corner : IndexRange(corners_num)) {
+    const int first_corner = corner_verts[corner];
+    if (first_corner == corner) {
+      const PositionKey key = position_key(corner);
+      float3 position;
+      memcpy(&position, key.data(), sizeof(position));
+      corner_verts[corner] = positions.append_and_get_index(position);
+    }
+    else {
+      corner_verts[corner] = corner_verts[first_corner];
+    }
+  }
+
+  /* Remove degenerate triangles, and triangles that use the same vertices as an earlier one. */
+  auto sorted_tri = [&](const int64_t tri) {
+    std::array<int, 3> verts = {
+        corner_verts[tri * 3], corner_verts[tri * 3 + 1], corner_verts[tri * 3 + 2]};
+    std::sort(verts.begin(), verts.end());
+    return verts;
+  };
+  Array<bool> keep_tri(tris_num);
+  Vector<int> sorted_tris;
+  for (const int64_t tri : IndexRange(tris_num)) {
+    const std::array<int, 3> verts = sorted_tri(tri);
+    keep_tri[tri] = verts[0] != verts[1] && verts[1] != verts[2];
+    if (keep_tri[tri]) {
+      sorted_tris.append(int(tri));
+    }
+  }
+  const int64_t degenerate_tris_num = tris_num - sorted_tris.size();
+  parallel_sort(sorted_tris.begin(), sorted_tris.end(), [&](const int a, const int b) {
+    const std::array<int, 3> verts_a = sorted_tri(a);
+    const std::array<int, 3> verts_b = sorted_tri(b);
+    if (verts_a != verts_b) {
+      return verts_a < verts_b;
+    }
+    return a < b;
+  });
+  threading::parallel_for(sorted_tris.index_range().drop_front(1), 4096, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      if (sorted_tri(sorted_tris[i - 1]) == sorted_tri(sorted_tris[i])) {
+        keep_tri[sorted_tris[i]] = false;
+      }
+    }
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask tris_to_keep = IndexMask::from_bools(keep_tri, memory);
+  const int64_t duplicate_tris_num = sorted_tris.size() - tris_to_keep.size();
+  if (degenerate_tris_num > 0) {
+    std::cout << "STL Importer: " << degenerate_tris_num << " degenerate triangles were removed"
+              << std::endl;
+  }
+  if (duplicate_tris_num > 0) {
+    std::cout << "STL Importer: " << duplicate_tris_num << " duplicate triangles were removed"
+              << std::endl;
+  }
+
+  const int faces_num = int(tris_to_keep.size());
+  Mesh *mesh = BKE_mesh_new_nomain(positions.size(), 0, faces_num, faces_num * 3);
+  mesh->vert_positions_for_write().copy_from(positions);
+  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
+  MutableSpan<int> mesh_corner_verts = mesh->corner_verts_for_write();
+  tris_to_keep.foreach_index(GrainSize(4096), [&](const int64_t tri, const int64_t face) {
+    mesh_corner_verts.slice(face * 3, 3).copy_from(corner_verts.as_span().slice(tri * 3, 3));
+  });
+
+  /* NOTE: edges must be calculated first before setting custom normals. */
+  bke::mesh_calc_edges(*mesh, false, false);
+
+  if (use_custom_normals) {
+    Array<float3> corner_normals(faces_num * 3);
+    tris_to_keep.foreach_index(GrainSize(4096), [&](const int64_t tri, const int64_t face) {
+      float3 normal;
+      memcpy(&normal,
+             tris_data + tri * BINARY_STRIDE + offsetof(PackedTriangle, normal),
+             sizeof(normal));
+      corner_normals.as_mutable_span().slice(face * 3, 3).fill(normal);
+    });
+    BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(corner_normals.data()));
+  }
+
+  return mesh;
+}
+
 Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
 {
   const int chunk_size = 1024;
@@ -36,6 +202,26 @@ Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
     return BKE_mesh_new_nomain(0, 0, 0, 0);
   }
 
+  const size_t data_offset = BINARY_HEADER_SIZE + sizeof(uint32_t);
+  if (BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file))) {
+    const uint8_t *data = static_cast<const uint8_t *>(BLI_mmap_get_pointer(mmap_file));
+    Mesh *mesh = nullptr;
+    if (BLI_mmap_get_length(mmap_file) >= data_offset + size_t(num_tris) * BINARY_STRIDE) {
+      mesh = read_stl_binary_mapped(data + data_offset, num_tris, use_custom_normals);
+      if (BLI_mmap_any_io_error(mmap_file)) {
+        fprintf(stderr, "STL Importer: failed to read file, IO error.\n");
+        BKE_id_free(nullptr, mesh);
+        mesh = nullptr;
+      }
+    }
+    BLI_mmap_free(mmap_file);
+    if (mesh != nullptr) {
+      return mesh;
+    }
+    /* Fall back to reading through a buffer. */
+    fseek(file, data_offset, SEEK_SET);
+  }
+
   Array<PackedTriangle> tris_buf(chunk_size);
   STLMeshHelper stl_mesh(num_tris, use_custom_normals);
   size_t num_read_tris;
@@ -80,6 +80,8 @@ struct OBJImportParams {
   bool validate_meshes = true;
   bool relative_paths = true;
   bool clear_selection = true;
+  /** Tokenize the file on multiple threads. */
+  bool use_parallel_parse = true;
 
   ReportList *reports = nullptr;
 };
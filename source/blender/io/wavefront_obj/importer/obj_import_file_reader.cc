@@ -14,6 +14,7 @@
 #include "BLI_math_vector_types.hh"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "obj_export_mtl.hh"
@@ -71,11 +72,30 @@ static Geometry *create_geometry(Geometry *const prev_geometry,
   return new_geometry();
 }
 
-static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static void add_vertex_color(const int vertex_index,
+                             const float3 &linear,
+                             GlobalVertices &r_global_vertices)
 {
-  float3 vert;
-  p = parse_floats(p, end, 0.0f, vert, 3);
-  r_global_vertices.vertices.append(vert);
+  auto &blocks = r_global_vertices.vertex_colors;
+  /* If we don't have vertex colors yet, or the previous vertex
+   * was without color, we need to start a new vertex colors block. */
+  if (blocks.is_empty() ||
+      (blocks.last().start_vertex_index + blocks.last().colors.size() != vertex_index))
+  {
+    GlobalVertices::VertexColorsBlock block;
+    block.start_vertex_index = vertex_index;
+    blocks.append(block);
+  }
+  blocks.last().colors.append(linear);
+}
+
+/**
+ * Parse a vertex position, and optionally its color.
+ * Returns true if the vertex has a valid color, which is then stored in linear space.
+ */
+static bool parse_vertex(const char *p, const char *end, float3 &r_vert, float3 &r_linear_color)
+{
+  p = parse_floats(p, end, 0.0f, r_vert, 3);
   /* OBJ extension: `xyzrgb` vertex colors, when the vertex position
    * is followed by 3 more RGB color components. See
    * http://paulbourke.net/dataformats/obj/colour.html */
@@ -83,23 +103,22 @@ static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_gl
     float3 srgb;
     p = parse_floats(p, end, -1.0f, srgb, 3);
     if (srgb.x >= 0 && srgb.y >= 0 && srgb.z >= 0) {
-      float3 linear;
-      srgb_to_linearrgb_v3_v3(linear, srgb);
-
-      auto &blocks = r_global_vertices.vertex_colors;
-      /* If we don't have vertex colors yet, or the previous vertex
-       * was without color, we need to start a new vertex colors block. */
-      if (blocks.is_empty() || (blocks.last().start_vertex_index + blocks.last().colors.size() !=
-                                r_global_vertices.vertices.size() - 1))
-      {
-        GlobalVertices::VertexColorsBlock block;
-        block.start_vertex_index = r_global_vertices.vertices.size() - 1;
-        blocks.append(block);
-      }
-      blocks.last().colors.append(linear);
+      srgb_to_linearrgb_v3_v3(r_linear_color, srgb);
+      return true;
     }
   }
   UNUSED_VARS(p);
+  return false;
+}
+
+static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+{
+  float3 vert, linear;
+  const bool has_color = parse_vertex(p, end, vert, linear);
+  r_global_vertices.vertices.append(vert);
+  if (has_color) {
+    add_vertex_color(r_global_vertices.vertices.size() - 1, linear, r_global_vertices);
+  }
 }
 
 static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices &r_global_vertices)
@@ -142,9 +161,7 @@ static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices
   }
 }
 
-static void geom_add_vertex_normal(const char *p,
-                                   const char *end,
-                                   GlobalVertices &r_global_vertices)
+static float3 parse_vertex_normal(const char *p, const char *end)
 {
   float3 normal;
   parse_floats(p, end, 0.0f, normal, 3);
@@ -152,14 +169,14 @@ static void geom_add_vertex_normal(const char *p,
    * making them ever-so-slightly non unit length. Make sure they are
    * normalized. */
   normalize_v3(normal);
-  r_global_vertices.vert_normals.append(normal);
+  return normal;
 }
 
-static void geom_add_uv_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static float2 parse_uv_vertex(const char *p, const char *end)
 {
   float2 uv;
   parse_floats(p, end, 0.0f, uv, 2);
-  r_global_vertices.uv_vertices.append(uv);
+  return uv;
 }
 
 /**
@@ -225,30 +242,16 @@ static void geom_add_polyline(Geometry *geom,
   }
 }
 
-static void geom_add_polygon(Geometry *geom,
-                             const char *p,
-                             const char *end,
-                             const GlobalVertices &global_vertices,
-                             const int material_index,
-                             const int group_index,
-                             const bool shaded_smooth)
+/**
+ * Parse the corners of a face line into raw (as spelled out in the file) indices.
+ * Parsing stops at a comment, or after the first corner without a valid vertex index,
+ * since the face is invalid at that point anyway.
+ */
+static void parse_face_corners(const char *p, const char *end, Vector<RawFaceCorner> &r_corners)
 {
-  FaceElem curr_face;
-  curr_face.shaded_smooth = shaded_smooth;
-  curr_face.material_index = material_index;
-  if (group_index >= 0) {
-    curr_face.vertex_group_index = group_index;
-    geom->has_vertex_groups_ = true;
-  }
-
-  const int orig_corners_size = geom->face_corners_.size();
-  curr_face.start_index_ = orig_corners_size;
-
-  bool face_valid = true;
   p = drop_whitespace(p, end);
-  while (p < end && face_valid) {
-    FaceCorner corner;
-    bool got_uv = false, got_normal = false;
+  while (p < end) {
+    RawFaceCorner corner;
     /* Parse vertex index. */
     p = parse_int(p, end, INT32_MAX, corner.vert_index, false);
 
@@ -257,21 +260,65 @@ static void geom_add_polygon(Geometry *geom,
       break;
     }
 
-    face_valid &= corner.vert_index != INT32_MAX;
     if (p < end && *p == '/') {
       /* Parse UV index. */
       ++p;
       if (p < end && *p != '/') {
         p = parse_int(p, end, INT32_MAX, corner.uv_vert_index, false);
-        got_uv = corner.uv_vert_index != INT32_MAX;
       }
       /* Parse normal index. */
       if (p < end && *p == '/') {
         ++p;
         p = parse_int(p, end, INT32_MAX, corner.vertex_normal_index, false);
-        got_normal = corner.vertex_normal_index != INT32_MAX;
       }
     }
+    r_corners.append(corner);
+    if (corner.vert_index == INT32_MAX) {
+      break;
+    }
+
+    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
+    p = drop_non_whitespace(p, end);
+    /* Skip whitespace to get to the next face corner. */
+    p = drop_whitespace(p, end);
+  }
+}
+
+/**
+ * Add a face from its raw corners. Relative indices are resolved against the vertex data
+ * that has been read so far, so this must be called in file order.
+ */
+static void geom_add_polygon(Geometry *geom,
+                             const Span<RawFaceCorner> raw_corners,
+                             const GlobalVertices &global_vertices,
+                             const int material_index,
+                             const int group_index,
+                             const bool shaded_smooth)
+{
+  FaceElem curr_face;
+  curr_face.shaded_smooth = shaded_smooth;
+  curr_face.material_index = material_index;
+  if (group_index >= 0) {
+    curr_face.vertex_group_index = group_index;
+    geom->has_vertex_groups_ = true;
+  }
+
+  const int orig_corners_size = geom->face_corners_.size();
+  curr_face.start_index_ = orig_corners_size;
+
+  bool face_valid = true;
+  for (const RawFaceCorner &raw_corner : raw_corners) {
+    FaceCorner corner;
+    corner.vert_index = raw_corner.vert_index;
+    const bool got_uv = raw_corner.uv_vert_index != INT32_MAX;
+    const bool got_normal = raw_corner.vertex_normal_index != INT32_MAX;
+    if (got_uv) {
+      corner.uv_vert_index = raw_corner.uv_vert_index;
+    }
+    if (got_normal) {
+      corner.vertex_normal_index = raw_corner.vertex_normal_index;
+    }
+
     /* Always keep stored indices non-negative and zero-based. */
     corner.vert_index += corner.vert_index < 0 ? global_vertices.vertices.size() : -1;
     if (corner.vert_index < 0 || corner.vert_index >= global_vertices.vertices.size()) {
@@ -312,13 +359,11 @@ static void geom_add_polygon(Geometry *geom,
         face_valid = false;
       }
     }
+    if (!face_valid) {
+      break;
+    }
     geom->face_corners_.append(corner);
     curr_face.corner_count_++;
-
-    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
-    p = drop_non_whitespace(p, end);
-    /* Skip whitespace to get to the next face corner. */
-    p = drop_whitespace(p, end);
   }
 
   if (face_valid) {
@@ -500,6 +545,347 @@ static void use_all_vertices_if_no_faces(Geometry *geom,
   }
 }
 
+/**
+ * Parser state that carries over from one line to the next. Once set, the values remain the
+ * same for the remaining elements in the object.
+ */
+struct OBJParseState {
+  Geometry *curr_geom = nullptr;
+  bool shaded_smooth = false;
+  string group_name;
+  int group_index = -1;
+  string material_name;
+  int material_index = -1;
+  size_t line_number = 0;
+};
+
+/**
+ * A line that has to be processed in file order after a chunk has been tokenized,
+ * together with the amount of chunk-local vertex data that precedes it.
+ */
+struct OBJParseEvent {
+  const char *p;
+  const char *end;
+  /** Range in #OBJParseChunk::face_corners, for face lines. */
+  IndexRange face_corners;
+  bool is_face;
+  int64_t vertices_num;
+  int64_t uv_vertices_num;
+  int64_t vert_normals_num;
+};
+
+/**
+ * Result of tokenizing a range of whole lines on a worker thread. Vertex data is stored in
+ * chunk-local arrays; everything else is recorded as events to be replayed in order.
+ */
+struct OBJParseChunk {
+  StringRef text;
+  Vector<float3> vertices;
+  Vector<float2> uv_vertices;
+  Vector<float3> vert_normals;
+  /** Linear `xyzrgb` vertex colors, with the chunk-local index of their vertex. */
+  Vector<std::pair<int64_t, float3>> vertex_colors;
+  Vector<RawFaceCorner> face_corners;
+  Vector<OBJParseEvent> events;
+  size_t line_count = 0;
+};
+
+/**
+ * When parsing on multiple threads, the file is read in bigger portions that are then split
+ * into chunks of about the read buffer size.
+ */
+static constexpr size_t PARALLEL_CHUNKS_PER_READ = 64;
+
+static void geom_add_face(OBJParseState &state,
+                          const Span<RawFaceCorner> raw_corners,
+                          const GlobalVertices &global_vertices)
+{
+  Geometry *geom = state.curr_geom;
+  /* If we don't have a material index assigned yet, get one.
+   * It means "usemtl" state came from the previous object. */
+  if (state.material_index == -1 && !state.material_name.empty() &&
+      geom->material_indices_.is_empty())
+  {
+    geom->material_indices_.add_new(state.material_name, 0);
+    geom->material_order_.append(state.material_name);
+    state.material_index = 0;
+  }
+
+  geom_add_polygon(geom,
+                   raw_corners,
+                   global_vertices,
+                   state.material_index,
+                   state.group_index,
+                   state.shaded_smooth);
+}
+
+void OBJParser::parse_state_line(const char *p,
+                                 const char *end,
+                                 OBJParseState &state,
+                                 Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                                 GlobalVertices &r_global_vertices)
+{
+  if (parse_keyword(p, end, "l")) {
+    geom_add_polyline(state.curr_geom, p, end, r_global_vertices);
+  }
+  /* Objects. */
+  else if (parse_keyword(p, end, "o")) {
+    if (import_params_.use_split_objects) {
+      geom_new_object(p,
+                      end,
+                      state.shaded_smooth,
+                      state.group_name,
+                      state.material_index,
+                      state.curr_geom,
+                      r_all_geometries);
+    }
+  }
+  /* Groups. */
+  else if (parse_keyword(p, end, "g")) {
+    if (import_params_.use_split_groups) {
+      geom_new_object(p,
+                      end,
+                      state.shaded_smooth,
+                      state.group_name,
+                      state.material_index,
+                      state.curr_geom,
+                      r_all_geometries);
+    }
+    else {
+      Geometry *geom = state.curr_geom;
+      geom_update_group(StringRef(p, end).trim(), state.group_name);
+      int new_index = geom->group_indices_.size();
+      state.group_index = geom->group_indices_.lookup_or_add(state.group_name, new_index);
+      if (new_index == state.group_index) {
+        geom->group_order_.append(state.group_name);
+      }
+    }
+  }
+  /* Smoothing groups. */
+  else if (parse_keyword(p, end, "s")) {
+    geom_update_smooth_group(p, end, state.shaded_smooth);
+  }
+  /* Materials and their libraries. */
+  else if (parse_keyword(p, end, "usemtl")) {
+    Geometry *geom = state.curr_geom;
+    state.material_name = StringRef(p, end).trim();
+    int new_mat_index = geom->material_indices_.size();
+    state.material_index = geom->material_indices_.lookup_or_add(state.material_name,
+                                                                 new_mat_index);
+    if (new_mat_index == state.material_index) {
+      geom->material_order_.append(state.material_name);
+    }
+  }
+  else if (parse_keyword(p, end, "mtllib")) {
+    add_mtl_library(StringRef(p, end).trim());
+  }
+  else if (parse_keyword(p, end, "#MRGB")) {
+    geom_add_mrgb_colors(p, end, r_global_vertices);
+  }
+  /* Comments. */
+  else if (*p == '#') {
+    /* Nothing to do. */
+  }
+  /* Curve related things. */
+  else if (parse_keyword(p, end, "cstype")) {
+    state.curr_geom = geom_set_curve_type(
+        state.curr_geom, p, end, state.group_name, r_all_geometries);
+  }
+  else if (parse_keyword(p, end, "deg")) {
+    geom_set_curve_degree(state.curr_geom, p, end);
+  }
+  else if (parse_keyword(p, end, "curv")) {
+    geom_add_curve_vertex_indices(state.curr_geom, p, end, r_global_vertices);
+  }
+  else if (parse_keyword(p, end, "parm")) {
+    geom_add_curve_parameters(state.curr_geom, p, end);
+  }
+  else if (StringRef(p, end).startswith("end")) {
+    /* End of curve definition, nothing else to do. */
+  }
+  else {
+    std::cout << "OBJ element not recognized: '" << std::string(p, end) << "'" << std::endl;
+  }
+}
+
+void OBJParser::parse_lines(StringRef buffer,
+                            OBJParseState &state,
+                            Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                            GlobalVertices &r_global_vertices)
+{
+  Vector<RawFaceCorner> face_corners;
+  while (!buffer.is_empty()) {
+    StringRef line = read_next_line(buffer);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    ++state.line_number;
+    if (p == end) {
+      continue;
+    }
+    /* Most common things that start with 'v': vertices, normals, UVs. */
+    if (*p == 'v') {
+      if (parse_keyword(p, end, "v")) {
+        geom_add_vertex(p, end, r_global_vertices);
+      }
+      else if (parse_keyword(p, end, "vn")) {
+        r_global_vertices.vert_normals.append(parse_vertex_normal(p, end));
+      }
+      else if (parse_keyword(p, end, "vt")) {
+        r_global_vertices.uv_vertices.append(parse_uv_vertex(p, end));
+      }
+    }
+    /* Faces. */
+    else if (parse_keyword(p, end, "f")) {
+      face_corners.clear();
+      parse_face_corners(p, end, face_corners);
+      geom_add_face(state, face_corners, r_global_vertices);
+    }
+    else {
+      parse_state_line(p, end, state, r_all_geometries, r_global_vertices);
+    }
+  }
+}
+
+/**
+ * Tokenize a chunk of whole lines. Only touches the chunk itself, so chunks can be
+ * processed concurrently.
+ */
+static void parse_chunk(OBJParseChunk &chunk)
+{
+  StringRef buffer = chunk.text;
+  while (!buffer.is_empty()) {
+    StringRef line = read_next_line(buffer);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    ++chunk.line_count;
+    if (p == end) {
+      continue;
+    }
+    const char *line_start = p;
+    if (*p == 'v') {
+      if (parse_keyword(p, end, "v")) {
+        float3 vert, linear;
+        if (parse_vertex(p, end, vert, linear)) {
+          chunk.vertex_colors.append({chunk.vertices.size(), linear});
+        }
+        chunk.vertices.append(vert);
+      }
+      else if (parse_keyword(p, end, "vn")) {
+        chunk.vert_normals.append(parse_vertex_normal(p, end));
+      }
+      else if (parse_keyword(p, end, "vt")) {
+        chunk.uv_vertices.append(parse_uv_vertex(p, end));
+      }
+      continue;
+    }
+
+    OBJParseEvent event;
+    event.vertices_num = chunk.vertices.size();
+    event.uv_vertices_num = chunk.uv_vertices.size();
+    event.vert_normals_num = chunk.vert_normals.size();
+    event.end = end;
+    if (parse_keyword(p, end, "f")) {
+      const int64_t corners_start = chunk.face_corners.size();
+      parse_face_corners(p, end, chunk.face_corners);
+      event.p = p;
+      event.is_face = true;
+      event.face_corners = IndexRange::from_begin_end(corners_start, chunk.face_corners.size());
+    }
+    else {
+      /* Plain comments do not need to be replayed; #MRGB colors do. */
+      if (*p == '#' && !StringRef(p, end).startswith("#MRGB")) {
+        continue;
+      }
+      event.p = line_start;
+      event.is_face = false;
+    }
+    chunk.events.append(event);
+  }
+}
+
+void OBJParser::stitch_chunk(const OBJParseChunk &chunk,
+                             OBJParseState &state,
+                             Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                             GlobalVertices &r_global_vertices)
+{
+  const int64_t vertices_start = r_global_vertices.vertices.size();
+  r_global_vertices.vertices.reserve(vertices_start + chunk.vertices.size());
+  r_global_vertices.uv_vertices.reserve(r_global_vertices.uv_vertices.size() +
+                                        chunk.uv_vertices.size());
+  r_global_vertices.vert_normals.reserve(r_global_vertices.vert_normals.size() +
+                                         chunk.vert_normals.size());
+
+  /* Chunk-local vertex data that has been appended to the global arrays so far. */
+  int64_t vertices_num = 0;
+  int64_t uv_vertices_num = 0;
+  int64_t vert_normals_num = 0;
+  int64_t vertex_colors_num = 0;
+  /* Grow the global arrays to what they were at this point of the file when parsing
+   * serially, so that relative indices and vertex colors resolve the same way. */
+  auto append_vertex_data = [&](const int64_t new_vertices_num,
+                                const int64_t new_uv_vertices_num,
+                                const int64_t new_vert_normals_num) {
+    r_global_vertices.vertices.extend(
+        chunk.vertices.as_span().slice(vertices_num, new_vertices_num - vertices_num));
+    r_global_vertices.uv_vertices.extend(
+        chunk.uv_vertices.as_span().slice(uv_vertices_num, new_uv_vertices_num - uv_vertices_num));
+    r_global_vertices.vert_normals.extend(chunk.vert_normals.as_span().slice(
+        vert_normals_num, new_vert_normals_num - vert_normals_num));
+    while (vertex_colors_num < chunk.vertex_colors.size() &&
+           chunk.vertex_colors[vertex_colors_num].first < new_vertices_num)
+    {
+      const std::pair<int64_t, float3> &color = chunk.vertex_colors[vertex_colors_num];
+      add_vertex_color(vertices_start + color.first, color.second, r_global_vertices);
+      vertex_colors_num++;
+    }
+    vertices_num = new_vertices_num;
+    uv_vertices_num = new_uv_vertices_num;
+    vert_normals_num = new_vert_normals_num;
+  };
+
+  for (const OBJParseEvent &event : chunk.events) {
+    append_vertex_data(event.vertices_num, event.uv_vertices_num, event.vert_normals_num);
+    if (event.is_face) {
+      geom_add_face(
+          state, chunk.face_corners.as_span().slice(event.face_corners), r_global_vertices);
+    }
+    else {
+      parse_state_line(event.p, event.end, state, r_all_geometries, r_global_vertices);
+    }
+  }
+  append_vertex_data(chunk.vertices.size(), chunk.uv_vertices.size(), chunk.vert_normals.size());
+  state.line_number += chunk.line_count;
+}
+
+void OBJParser::parse_lines_parallel(StringRef buffer,
+                                     OBJParseState &state,
+                                     Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                                     GlobalVertices &r_global_vertices)
+{
+  /* Split at line boundaries; the buffer always ends with a newline. */
+  Vector<OBJParseChunk> chunks;
+  const char *p = buffer.begin();
+  const char *end = buffer.end();
+  while (p < end) {
+    const char *chunk_end = p + std::min<size_t>(read_buffer_size_, end - p);
+    const void *newline = memchr(chunk_end - 1, '\n', end - chunk_end + 1);
+    chunk_end = newline ? static_cast<const char *>(newline) + 1 : end;
+    chunks.append_as();
+    chunks.last().text = StringRef(p, chunk_end);
+    p = chunk_end;
+  }
+
+  threading::parallel_for(chunks.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      parse_chunk(chunks[i]);
+    }
+  });
+
+  for (const OBJParseChunk &chunk : chunks) {
+    stitch_chunk(chunk, state, r_all_geometries, r_global_vertices);
+  }
+}
+
 void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
                       GlobalVertices &r_global_vertices)
 {
@@ -512,25 +898,21 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   STRNCPY(ob_name, BLI_path_basename(import_params_.filepath));
   BLI_path_extension_strip(ob_name);
 
-  Geometry *curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
+  OBJParseState state;
+  state.curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
 
-  /* State variables: once set, they remain the same for the remaining
-   * elements in the object. */
-  bool state_shaded_smooth = false;
-  string state_group_name;
-  int state_group_index = -1;
-  string state_material_name;
-  int state_material_index = -1;
+  const bool use_parallel = import_params_.use_parallel_parse;
+  const size_t read_size = use_parallel ? read_buffer_size_ * PARALLEL_CHUNKS_PER_READ :
+                                          read_buffer_size_;
 
   /* Read the input file in chunks. We need up to twice the possible chunk size,
    * to possibly store remainder of the previous input line that got broken mid-chunk. */
-  Array<char> buffer(read_buffer_size_ * 2);
+  Array<char> buffer(read_size * 2);
 
   size_t buffer_offset = 0;
-  size_t line_number = 0;
   while (true) {
     /* Read a chunk of input from the file. */
-    size_t bytes_read = fread(buffer.data() + buffer_offset, 1, read_buffer_size_, obj_file_);
+    size_t bytes_read = fread(buffer.data() + buffer_offset, 1, read_size, obj_file_);
     if (bytes_read == 0 && buffer_offset == 0) {
       break; /* No more data to read. */
     }
@@ -541,7 +923,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
                              buffer.data() + buffer_offset + bytes_read);
 
     /* Ensure buffer ends in a newline. */
-    if (bytes_read < read_buffer_size_) {
+    if (bytes_read < read_size) {
       if (bytes_read == 0 || buffer[buffer_offset + bytes_read - 1] != '\n') {
         buffer[buffer_offset + bytes_read] = '\n';
         bytes_read++;
@@ -565,8 +947,8 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
       /* Whole line did not fit into our read buffer. Warn and exit. */
       fprintf(stderr,
               "OBJ file contains a line #%zu that is too long (max. length %zu)\n",
-              line_number,
-              read_buffer_size_);
+              state.line_number,
+              read_size);
       break;
     }
     ++last_nl;
@@ -574,125 +956,11 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
     /* Parse the buffer (until last newline) that we have so far,
      * line by line. */
     StringRef buffer_str{buffer.data(), int64_t(last_nl)};
-    while (!buffer_str.is_empty()) {
-      StringRef line = read_next_line(buffer_str);
-      const char *p = line.begin(), *end = line.end();
-      p = drop_whitespace(p, end);
-      ++line_number;
-      if (p == end) {
-        continue;
-      }
-      /* Most common things that start with 'v': vertices, normals, UVs. */
-      if (*p == 'v') {
-        if (parse_keyword(p, end, "v")) {
-          geom_add_vertex(p, end, r_global_vertices);
-        }
-        else if (parse_keyword(p, end, "vn")) {
-          geom_add_vertex_normal(p, end, r_global_vertices);
-        }
-        else if (parse_keyword(p, end, "vt")) {
-          geom_add_uv_vertex(p, end, r_global_vertices);
-        }
-      }
-      /* Faces. */
-      else if (parse_keyword(p, end, "f")) {
-        /* If we don't have a material index assigned yet, get one.
-         * It means "usemtl" state came from the previous object. */
-        if (state_material_index == -1 && !state_material_name.empty() &&
-            curr_geom->material_indices_.is_empty())
-        {
-          curr_geom->material_indices_.add_new(state_material_name, 0);
-          curr_geom->material_order_.append(state_material_name);
-          state_material_index = 0;
-        }
-
-        geom_add_polygon(curr_geom,
-                         p,
-                         end,
-                         r_global_vertices,
-                         state_material_index,
-                         state_group_index,
-                         state_shaded_smooth);
-      }
-      /* Faces. */
-      else if (parse_keyword(p, end, "l")) {
-        geom_add_polyline(curr_geom, p, end, r_global_vertices);
-      }
-      /* Objects. */
-      else if (parse_keyword(p, end, "o")) {
-        if (import_params_.use_split_objects) {
-          geom_new_object(p,
-                          end,
-                          state_shaded_smooth,
-                          state_group_name,
-                          state_material_index,
-                          curr_geom,
-                          r_all_geometries);
-        }
-      }
-      /* Groups. */
-      else if (parse_keyword(p, end, "g")) {
-        if (import_params_.use_split_groups) {
-          geom_new_object(p,
-                          end,
-                          state_shaded_smooth,
-                          state_group_name,
-                          state_material_index,
-                          curr_geom,
-                          r_all_geometries);
-        }
-        else {
-          geom_update_group(StringRef(p, end).trim(), state_group_name);
-          int new_index = curr_geom->group_indices_.size();
-          state_group_index = curr_geom->group_indices_.lookup_or_add(state_group_name, new_index);
-          if (new_index == state_group_index) {
-            curr_geom->group_order_.append(state_group_name);
-          }
-        }
-      }
-      /* Smoothing groups. */
-      else if (parse_keyword(p, end, "s")) {
-        geom_update_smooth_group(p, end, state_shaded_smooth);
-      }
-      /* Materials and their libraries. */
-      else if (parse_keyword(p, end, "usemtl")) {
-        state_material_name = StringRef(p, end).trim();
-        int new_mat_index = curr_geom->material_indices_.size();
-        state_material_index = curr_geom->material_indices_.lookup_or_add(state_material_name,
-                                                                          new_mat_index);
-        if (new_mat_index == state_material_index) {
-          curr_geom->material_order_.append(state_material_name);
-        }
-      }
-      else if (parse_keyword(p, end, "mtllib")) {
-        add_mtl_library(StringRef(p, end).trim());
-      }
-      else if (parse_keyword(p, end, "#MRGB")) {
-        geom_add_mrgb_colors(p, end, r_global_vertices);
-      }
-      /* Comments. */
-      else if (*p == '#') {
-        /* Nothing to do. */
-      }
-      /* Curve related things. */
-      else if (parse_keyword(p, end, "cstype")) {
-        curr_geom = geom_set_curve_type(curr_geom, p, end, state_group_name, r_all_geometries);
-      }
-      else if (parse_keyword(p, end, "deg")) {
-        geom_set_curve_degree(curr_geom, p, end);
-      }
-      else if (parse_keyword(p, end, "curv")) {
-        geom_add_curve_vertex_indices(curr_geom, p, end, r_global_vertices);
-      }
-      else if (parse_keyword(p, end, "parm")) {
-        geom_add_curve_parameters(curr_geom, p, end);
-      }
-      else if (StringRef(p, end).startswith("end")) {
-        /* End of curve definition, nothing else to do. */
-      }
-      else {
-        std::cout << "OBJ element not recognized: '" << std::string(p, end) << "'" << std::endl;
-      }
+    if (use_parallel) {
+      parse_lines_parallel(buffer_str, state, r_all_geometries, r_global_vertices);
+    }
+    else {
+      parse_lines(buffer_str, state, r_all_geometries, r_global_vertices);
     }
 
     /* We might have a line that was cut in the middle by the previous buffer;
@@ -702,7 +970,7 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
     buffer_offset = left_size;
   }
 
-  use_all_vertices_if_no_faces(curr_geom, r_all_geometries, r_global_vertices);
+  use_all_vertices_if_no_faces(state.curr_geom, r_all_geometries, r_global_vertices);
   add_default_mtl_library();
 }
 
@@ -18,6 +18,8 @@
 namespace blender::io::obj {
 
 struct MTLMaterial;
+struct OBJParseChunk;
+struct OBJParseState;
 
 /* NOTE: the OBJ parser implementation is planned to get fairly large changes "soon",
  * so don't read too much into current implementation... */
@@ -47,6 +49,36 @@ class OBJParser {
   Span<std::string> mtl_libraries() const;
 
  private:
+  /**
+   * Parse a buffer that consists of whole lines, one line after another.
+   */
+  void parse_lines(StringRef buffer,
+                   OBJParseState &state,
+                   Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                   GlobalVertices &r_global_vertices);
+  /**
+   * Split a buffer that consists of whole lines into chunks at line boundaries and tokenize
+   * the chunks on multiple threads. The per-chunk results are then stitched together in file
+   * order, so that object/group state and relative indices resolve the same way as with
+   * #parse_lines.
+   */
+  void parse_lines_parallel(StringRef buffer,
+                            OBJParseState &state,
+                            Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                            GlobalVertices &r_global_vertices);
+  void stitch_chunk(const OBJParseChunk &chunk,
+                    OBJParseState &state,
+                    Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                    GlobalVertices &r_global_vertices);
+  /**
+   * Handle a single line that is not vertex data (`v`, `vn`, `vt`) nor a face.
+   * `p` points past any leading white-space.
+   */
+  void parse_state_line(const char *p,
+                        const char *end,
+                        OBJParseState &state,
+                        Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                        GlobalVertices &r_global_vertices);
   void add_mtl_library(StringRef path);
   void add_default_mtl_library();
 };
@@ -51,6 +51,16 @@ struct FaceCorner {
   int vertex_normal_index = -1;
 };
 
+/**
+ * A face's corner as spelled out in the OBJ file, before relative indices are resolved.
+ * INT32_MAX indicates an absent or unparsable index.
+ */
+struct RawFaceCorner {
+  int vert_index = INT32_MAX;
+  int uv_vert_index = INT32_MAX;
+  int vertex_normal_index = INT32_MAX;
+};
+
 struct FaceElem {
   int vertex_group_index = -1;
   int material_index = -1;
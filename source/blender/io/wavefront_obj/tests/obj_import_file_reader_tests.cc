@@ -0,0 +1,152 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_timeit.hh"
+
+#include "BKE_appdir.hh"
+
+#include "testing/testing.h"
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj {
+
+struct ParseResult {
+  Vector<std::unique_ptr<Geometry>> geometries;
+  GlobalVertices vertices;
+};
+
+class OBJParserTest : public testing::Test {
+ public:
+  std::string write_temp_file(const std::string &text)
+  {
+    BKE_tempdir_init(nullptr);
+    std::string tmp_file_path = std::string(BKE_tempdir_base()) + SEP_STR "obj_parser_test.obj";
+    FILE *tmp_file = BLI_fopen(tmp_file_path.c_str(), "wb");
+    fwrite(text.data(), 1, text.size(), tmp_file);
+    fclose(tmp_file);
+    return tmp_file_path;
+  }
+
+  ParseResult parse(const std::string &path, const bool use_parallel, const size_t buffer_size)
+  {
+    OBJImportParams params;
+    STRNCPY(params.filepath, path.c_str());
+    params.use_split_groups = true;
+    params.use_parallel_parse = use_parallel;
+    ParseResult result;
+    OBJParser parser{params, buffer_size};
+    parser.parse(result.geometries, result.vertices);
+    return result;
+  }
+
+  void expect_equal(const ParseResult &a, const ParseResult &b)
+  {
+    EXPECT_EQ(a.vertices.vertices.as_span(), b.vertices.vertices.as_span());
+    EXPECT_EQ(a.vertices.uv_vertices.as_span(), b.vertices.uv_vertices.as_span());
+    EXPECT_EQ(a.vertices.vert_normals.as_span(), b.vertices.vert_normals.as_span());
+    ASSERT_EQ(a.vertices.vertex_colors.size(), b.vertices.vertex_colors.size());
+    for (const int i : a.vertices.vertex_colors.index_range()) {
+      EXPECT_EQ(a.vertices.vertex_colors[i].start_vertex_index,
+                b.vertices.vertex_colors[i].start_vertex_index);
+      EXPECT_EQ(a.vertices.vertex_colors[i].colors.as_span(),
+                b.vertices.vertex_colors[i].colors.as_span());
+    }
+    ASSERT_EQ(a.geometries.size(), b.geometries.size());
+    for (const int i : a.geometries.index_range()) {
+      const Geometry &ga = *a.geometries[i];
+      const Geometry &gb = *b.geometries[i];
+      EXPECT_EQ(ga.geometry_name_, gb.geometry_name_);
+      EXPECT_EQ(ga.geom_type_, gb.geom_type_);
+      EXPECT_EQ(ga.get_vertex_count(), gb.get_vertex_count());
+      EXPECT_EQ(ga.vertex_index_min_, gb.vertex_index_min_);
+      EXPECT_EQ(ga.vertex_index_max_, gb.vertex_index_max_);
+      EXPECT_EQ(ga.edges_.as_span(), gb.edges_.as_span());
+      EXPECT_EQ(ga.material_order_.as_span(), gb.material_order_.as_span());
+      EXPECT_EQ(ga.total_corner_, gb.total_corner_);
+      EXPECT_EQ(ga.has_invalid_faces_, gb.has_invalid_faces_);
+      ASSERT_EQ(ga.face_corners_.size(), gb.face_corners_.size());
+      for (const int c : ga.face_corners_.index_range()) {
+        EXPECT_EQ(ga.face_corners_[c].vert_index, gb.face_corners_[c].vert_index);
+        EXPECT_EQ(ga.face_corners_[c].uv_vert_index, gb.face_corners_[c].uv_vert_index);
+        EXPECT_EQ(ga.face_corners_[c].vertex_normal_index,
+                  gb.face_corners_[c].vertex_normal_index);
+      }
+      ASSERT_EQ(ga.face_elements_.size(), gb.face_elements_.size());
+      for (const int f : ga.face_elements_.index_range()) {
+        EXPECT_EQ(ga.face_elements_[f].material_index, gb.face_elements_[f].material_index);
+        EXPECT_EQ(ga.face_elements_[f].shaded_smooth, gb.face_elements_[f].shaded_smooth);
+        EXPECT_EQ(ga.face_elements_[f].start_index_, gb.face_elements_[f].start_index_);
+        EXPECT_EQ(ga.face_elements_[f].corner_count_, gb.face_elements_[f].corner_count_);
+      }
+    }
+  }
+};
+
+/* Quads with relative (negative) indices, vertex colors and object/material state changes,
+ * so that chunk boundaries fall at many different points of the file. */
+static std::string make_test_obj(const int objects_num, const int quads_num)
+{
+  std::string text = "mtllib test.mtl\n";
+  for (int ob = 0; ob < objects_num; ob++) {
+    text += "g Object" + std::to_string(ob) + "\n";
+    text += "usemtl Material" + std::to_string(ob % 3) + "\n";
+    text += ob % 2 ? "s 1\n" : "s off\n";
+    for (int q = 0; q < quads_num; q++) {
+      const float x = float(q), y = float(ob);
+      char line[256];
+      SNPRINTF(line, "v %g %g 0\nv %g %g 0\n", x, y, x, y + 1.0f);
+      text += line;
+      SNPRINTF(line, "v %g %g 0 0.5 0.25 1.0\nv %g %g 0 1.0 0.5 0.25\n", x + 1, y, x + 1, y + 1);
+      text += line;
+      text += "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvn 0 0 1\n";
+      text += "f -4/-4/-1 -2/-3/-1 -1/-2/-1 -3/-1/-1 # comment\n";
+    }
+    /* Absolute indices into everything read so far, and one invalid face. */
+    text += "l 1 2 3\n";
+    text += "f 1 2 3\n";
+    text += "f 1 2 100000\n";
+  }
+  return text;
+}
+
+TEST_F(OBJParserTest, parallel_matches_serial)
+{
+  const std::string path = write_temp_file(make_test_obj(7, 40));
+  const ParseResult serial = parse(path, false, 256 * 1024);
+  EXPECT_EQ(serial.geometries.size(), 7);
+  EXPECT_EQ(serial.vertices.vertices.size(), 7 * 40 * 4);
+  for (const size_t buffer_size : {64, 100, 333, 1024, 256 * 1024}) {
+    const ParseResult parallel = parse(path, true, buffer_size);
+    expect_equal(serial, parallel);
+  }
+  BLI_delete(path.c_str(), false, false);
+}
+
+/* Disable benchmark by default. */
+#if 0
+TEST_F(OBJParserTest, benchmark_parallel_parse)
+{
+  const std::string text = make_test_obj(200, 50'000);
+  const std::string path = write_temp_file(text);
+  const double gigabytes = double(text.size()) / (1024.0 * 1024.0 * 1024.0);
+  for (const bool use_parallel : {false, true}) {
+    const timeit::TimePoint start = timeit::Clock::now();
+    ParseResult result = parse(path, use_parallel, 256 * 1024);
+    const timeit::Nanoseconds duration = timeit::Clock::now() - start;
+    const double seconds = double(duration.count()) / 1e9;
+    printf("%s parse: %.3f s, %.3f GB/s\n",
+           use_parallel ? "Parallel" : "Serial",
+           seconds,
+           gigabytes / seconds);
+  }
+  BLI_delete(path.c_str(), false, false);
+}
+#endif
+
+}  // namespace blender::io::obj
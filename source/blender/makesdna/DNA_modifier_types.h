@@ -2444,6 +2444,7 @@ typedef enum NodesModifierPanelFlag {
 typedef enum NodesModifierBakeFlag {
   NODES_MODIFIER_BAKE_CUSTOM_SIMULATION_FRAME_RANGE = 1 << 0,
   NODES_MODIFIER_BAKE_CUSTOM_PATH = 1 << 1,
+  NODES_MODIFIER_BAKE_COMPRESS = 1 << 2,
 } NodesModifierBakeFlag;
 
 typedef enum NodesModifierBakeMode {
@@ -129,6 +129,8 @@
     .ffcodecdata = _DNA_DEFAULT_FFMpegCodecData, \
  \
     .motion_blur_shutter = 0.5f, \
+ \
+    .compositor_tile_size = 512, \
   }
 
 #define _DNA_DEFAULT_AudioData \
@@ -831,6 +831,11 @@ typedef struct RenderData {
 
   /** Precision used by the GPU execution of the compositor tree. */
   int compositor_precision; /* eCompositorPrecision */
+
+  /** Options of the CPU execution of the compositor tree. */
+  int compositor_flag; /* eCompositorFlag */
+  /** Size in pixels of the tiles rendered when #SCE_COMPOSITOR_USE_TILES is set. */
+  int compositor_tile_size;
 } RenderData;
 
 /** #RenderData::quality_flag */
@@ -863,6 +868,11 @@ typedef enum eCompositorPrecision {
   SCE_COMPOSITOR_PRECISION_FULL = 1,
 } eCompositorPrecision;
 
+/** #RenderData::compositor_flag */
+typedef enum eCompositorFlag {
+  SCE_COMPOSITOR_USE_TILES = (1 << 0),
+} eCompositorFlag;
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -843,7 +843,11 @@ typedef struct UserDef {
   short versions;
   short dbl_click_time;
 
-  char _pad0[3];
+  /** Zstd compression level used when saving compressed .blend files. */
+  char file_compression_level;
+  /** #eUserPref_FileCompressionFlag. */
+  char file_compression_flag;
+  char _pad0[1];
   char mini_axis_type;
   /** #eUserpref_UI_Flag. */
   int uiflag;
@@ -969,7 +973,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of the compositor operations cache in megabytes, zero to disable it. */
+  int compositor_cache_limit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
@@ -1106,6 +1111,11 @@ typedef struct UserDef {
   int sequencer_disk_cache_size_limit;
   short sequencer_disk_cache_flag;
   short sequencer_proxy_setup; /* eUserpref_SeqProxySetup */
+  /** Number of frames the sequencer prefetches concurrently. */
+  short sequencer_prefetch_threads;
+  char _pad16[2];
+  /** Memory limit for frames prefetched ahead of the playhead in megabytes, 0 for no limit. */
+  int sequencer_prefetch_memory_limit;
 
   float collection_instance_empty_size;
   char text_flag;
@@ -1202,6 +1212,12 @@ typedef enum eUserPref_ExtensionFlag {
   USER_EXTENSION_FLAG_ONLINE_ACCESS_HANDLED = 1 << 0,
 } eUserPref_ExtensionFlag;
 
+/** #UserDef.file_compression_flag */
+typedef enum eUserPref_FileCompressionFlag {
+  /** Use Zstd long distance matching, with bigger frames. */
+  USER_FILE_COMPRESSION_LONG_DISTANCE = (1 << 0),
+} eUserPref_FileCompressionFlag;
+
 /** #UserDef.file_preview_type */
 typedef enum eUserpref_File_Preview_Type {
   USER_FILE_PREVIEW_NONE = 0,
@@ -1582,6 +1598,7 @@ typedef enum eUserpref_DiskCacheCompression {
   USER_SEQ_DISK_CACHE_COMPRESSION_NONE = 0,
   USER_SEQ_DISK_CACHE_COMPRESSION_LOW = 1,
   USER_SEQ_DISK_CACHE_COMPRESSION_HIGH = 2,
+  USER_SEQ_DISK_CACHE_COMPRESSION_FAST = 3,
 } eUserpref_DiskCacheCompression;
 
 typedef enum eUserpref_SeqProxySetup {
@@ -7504,6 +7504,23 @@ static void rna_def_scene_render_data(BlenderRNA *brna)
       prop, "Compositor Precision", "The precision of compositor intermediate result");
   RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_Scene_compositor_update");
 
+  prop = RNA_def_property(srna, "use_compositor_tiles", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "compositor_flag", SCE_COMPOSITOR_USE_TILES);
+  RNA_def_property_ui_text(
+      prop,
+      "Compositor Tiles",
+      "Render the CPU compositor tree tile by tile to reduce memory usage on large images. Only "
+      "used when all nodes of the tree support it, typically pixel-wise nodes and small filters");
+  RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_Scene_compositor_update");
+
+  prop = RNA_def_property(srna, "compositor_tile_size", PROP_INT, PROP_PIXEL);
+  RNA_def_property_int_sdna(prop, nullptr, "compositor_tile_size");
+  RNA_def_property_range(prop, 64, 16384);
+  RNA_def_property_ui_range(prop, 64, 4096, 64, -1);
+  RNA_def_property_ui_text(
+      prop, "Compositor Tile Size", "Size of the tiles rendered by the CPU compositor");
+  RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_Scene_compositor_update");
+
   /* Nestled Data. */
   /* *** Non-Animated *** */
   RNA_define_animate_sdna(false);
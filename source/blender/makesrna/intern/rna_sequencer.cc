@@ -1245,6 +1245,34 @@ static void rna_SequenceEditor_overlay_frame_set(PointerRNA *ptr, int value)
   }
 }
 
+static int rna_SequenceEditor_cache_statistic_clamp(const uint64_t value)
+{
+  return int(std::min<uint64_t>(value, INT_MAX));
+}
+
+static int rna_SequenceEditor_cache_hits_get(PointerRNA *ptr)
+{
+  const Scene *scene = (Scene *)ptr->owner_id;
+  return rna_SequenceEditor_cache_statistic_clamp(SEQ_cache_statistics_get(scene).hits);
+}
+
+static int rna_SequenceEditor_cache_misses_get(PointerRNA *ptr)
+{
+  const Scene *scene = (Scene *)ptr->owner_id;
+  return rna_SequenceEditor_cache_statistic_clamp(SEQ_cache_statistics_get(scene).misses);
+}
+
+static int rna_SequenceEditor_cache_evictions_get(PointerRNA *ptr)
+{
+  const Scene *scene = (Scene *)ptr->owner_id;
+  return rna_SequenceEditor_cache_statistic_clamp(SEQ_cache_statistics_get(scene).evictions);
+}
+
+static void rna_SequenceEditor_cache_statistics_reset(ID *id, Editing * /*ed*/)
+{
+  SEQ_cache_statistics_reset((Scene *)id);
+}
+
 static void rna_SequenceEditor_display_stack(ID *id,
                                              Editing *ed,
                                              ReportList *reports,
@@ -2518,6 +2546,28 @@ static void rna_def_editor(BlenderRNA *brna)
       "Render frames ahead of current frame in the background for faster playback");
   RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, nullptr);
 
+  /* cache statistics */
+
+  prop = RNA_def_property(srna, "cache_hits", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_hits_get", nullptr, nullptr);
+  RNA_def_property_ui_text(
+      prop, "Cache Hits", "Number of images that were found in the memory cache");
+
+  prop = RNA_def_property(srna, "cache_misses", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_misses_get", nullptr, nullptr);
+  RNA_def_property_ui_text(
+      prop, "Cache Misses", "Number of images that were not found in the memory cache");
+
+  prop = RNA_def_property(srna, "cache_evictions", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_evictions_get", nullptr, nullptr);
+  RNA_def_property_ui_text(prop,
+                           "Cache Evictions",
+                           "Number of images removed from the memory cache to make room for "
+                           "new images");
+
   /* functions */
 
   func = RNA_def_function(srna, "display_stack", "rna_SequenceEditor_display_stack");
@@ -2526,6 +2576,11 @@ static void rna_def_editor(BlenderRNA *brna)
   parm = RNA_def_pointer(
       func, "meta_sequence", "Sequence", "Meta Sequence", "Meta to display its stack");
   RNA_def_parameter_flags(parm, PropertyFlag(0), PARM_REQUIRED);
+
+  func = RNA_def_function(
+      srna, "cache_statistics_reset", "rna_SequenceEditor_cache_statistics_reset");
+  RNA_def_function_flag(func, FUNC_USE_SELF_ID);
+  RNA_def_function_ui_description(func, "Reset the memory cache hit, miss and eviction counters");
 }
 
 static void rna_def_filter_video(StructRNA *srna)
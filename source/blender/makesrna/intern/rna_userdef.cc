@@ -5981,6 +5981,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Light compression that is fast enough for high resolution playback from fast storage"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -6045,6 +6050,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "compositor_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "compositor_cache_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Compositor Cache Limit",
+                           "Memory limit for results of compositor nodes kept between executions, "
+                           "so that only nodes affected by a change are computed again (in "
+                           "megabytes), zero to disable the cache");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -6070,6 +6084,25 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       "Disk Cache Compression Level",
       "Smaller compression will result in larger files, but less decoding overhead");
 
+  /* Sequencer prefetch */
+
+  prop = RNA_def_property(srna, "sequencer_prefetch_threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "sequencer_prefetch_threads");
+  RNA_def_property_range(prop, 1, 16);
+  RNA_def_property_ui_text(
+      prop,
+      "Prefetch Threads",
+      "Number of frames rendered concurrently when prefetching, each thread evaluates its own "
+      "copy of the scene");
+
+  prop = RNA_def_property(srna, "sequencer_prefetch_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "sequencer_prefetch_memory_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Memory Limit",
+                           "Memory limit for frames prefetched ahead of the playhead (in "
+                           "megabytes), zero to only use the memory cache limit");
+
   /* Sequencer proxy setup */
 
   prop = RNA_def_property(srna, "sequencer_proxy_setup", PROP_ENUM, PROP_NONE);
@@ -7103,6 +7136,22 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Compress File", "Enable file compression when saving .blend files");
 
+  prop = RNA_def_property(srna, "file_compression_level", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "file_compression_level");
+  RNA_def_property_range(prop, 1, 19);
+  RNA_def_property_ui_text(prop,
+                           "Compression Level",
+                           "Compression level for compressed .blend files, higher levels give "
+                           "smaller files but take longer to save");
+
+  prop = RNA_def_property(srna, "use_file_compression_long_distance", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(
+      prop, nullptr, "file_compression_flag", USER_FILE_COMPRESSION_LONG_DISTANCE);
+  RNA_def_property_ui_text(prop,
+                           "Long Distance Matching",
+                           "Find repeated data further apart when compressing .blend files, "
+                           "which can give smaller files for big scenes at the cost of memory");
+
   prop = RNA_def_property(srna, "use_load_ui", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_negative_sdna(prop, nullptr, "flag", USER_FILENOUI);
   RNA_def_property_ui_text(prop, "Load UI", "Load user interface setup when loading .blend files");
@@ -226,6 +226,12 @@ void ntreeCompositTagRender(Scene *scene)
       }
     }
   }
+
+#ifdef WITH_COMPOSITOR_CPU
+  /* Cached results may have been computed from the previous render result. */
+  COM_clear_caches();
+#endif
+
   BKE_ntree_update_main(G_MAIN, nullptr);
 }
 
@@ -635,6 +635,12 @@ static void node_layout_ex(uiLayout *layout, bContext *C, PointerRNA *ptr)
       uiLayoutSetActive(subcol, ctx.bake->flag & NODES_MODIFIER_BAKE_CUSTOM_PATH);
       uiItemR(subcol, &ctx.bake_rna, "directory", UI_ITEM_NONE, IFACE_("Path"), ICON_NONE);
     }
+    uiItemR(settings_col,
+            &ctx.bake_rna,
+            "use_compression",
+            UI_ITEM_NONE,
+            IFACE_("Compress"),
+            ICON_NONE);
     if (!ctx.bake_still) {
       uiLayout *col = uiLayoutColumn(settings_col, true);
       uiItemR(col,
@@ -2,6 +2,7 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_kdopbvh.hh"
 #include "BLI_math_vector.h"
 #include "BLI_task.hh"
 
@@ -133,7 +134,7 @@ class ProximityFunction : public mf::MultiFunction {
               continue;
             }
             BVHTreeFromPointCloud &bvh = bvh_trees_[group_i].pointcloud_bvh;
-            BKE_bvhtree_from_pointcloud_get(pointcloud, group_mask, bvh);
+            BKE_bvhtree_from_pointcloud_get(pointcloud, group_mask, bvh, BVH_BALANCE_WIDE);
           }
         },
         threading::individual_task_sizes(
@@ -169,15 +170,15 @@ class ProximityFunction : public mf::MultiFunction {
             BVHTreeFromMesh &bvh = bvh_trees_[group_i].mesh_bvh;
             switch (type_) {
               case GEO_NODE_PROX_TARGET_POINTS: {
-                BKE_bvhtree_from_mesh_verts_init(mesh, group_mask, bvh);
+                BKE_bvhtree_from_mesh_verts_init(mesh, group_mask, bvh, BVH_BALANCE_WIDE);
                 break;
               }
               case GEO_NODE_PROX_TARGET_EDGES: {
-                BKE_bvhtree_from_mesh_edges_init(mesh, group_mask, bvh);
+                BKE_bvhtree_from_mesh_edges_init(mesh, group_mask, bvh, BVH_BALANCE_WIDE);
                 break;
               }
               case GEO_NODE_PROX_TARGET_FACES: {
-                BKE_bvhtree_from_mesh_tris_init(mesh, group_mask, bvh);
+                BKE_bvhtree_from_mesh_tris_init(mesh, group_mask, bvh, BVH_BALANCE_WIDE);
                 break;
               }
             }
@@ -213,53 +214,73 @@ class ProximityFunction : public mf::MultiFunction {
     MutableSpan<bool> is_valid_span = params.uninitialized_single_output_if_required<bool>(
         4, "Is Valid");
 
-    mask.foreach_index([&](const int i) {
-      const float3 sample_position = sample_positions[i];
-      const int sample_id = sample_ids[i];
-      const int group_index = group_indices_.index_of_try(sample_id);
+    const VArraySpan<float3> sample_positions_span(sample_positions);
+    Array<BVHTreeNearest> nearest(mask.min_array_size());
+
+    IndexMaskMemory memory;
+    VectorSet<int> sample_id_set;
+    const Vector<IndexMask, 4> sample_id_masks = IndexMask::from_group_ids(
+        mask, sample_ids, memory, sample_id_set);
+    for (const int sample_id_index : sample_id_masks.index_range()) {
+      const IndexMask &sample_mask = sample_id_masks[sample_id_index];
+      const int group_index = group_indices_.index_of_try(sample_id_set[sample_id_index]);
       if (group_index == -1) {
         if (!positions.is_empty()) {
-          positions[i] = float3(0, 0, 0);
+          index_mask::masked_fill(positions, float3(0, 0, 0), sample_mask);
         }
         if (!is_valid_span.is_empty()) {
-          is_valid_span[i] = false;
+          index_mask::masked_fill(is_valid_span, false, sample_mask);
         }
         if (!distances.is_empty()) {
-          distances[i] = 0.0f;
+          index_mask::masked_fill(distances, 0.0f, sample_mask);
         }
-        return;
+        continue;
       }
       const BVHTrees &trees = bvh_trees_[group_index];
-      BVHTreeNearest nearest;
+      sample_mask.foreach_index_optimized<int>(GrainSize(4096), [&](const int i) {
+        nearest[i].index = -1;
+        nearest[i].dist_sq = FLT_MAX;
+      });
       /* Take mesh and pointcloud bvh tree into account. The final result is the closer of the two.
        * First first bvhtree query will set `nearest.dist_sq` which is then passed into the second
        * query as a maximum distance. */
-      nearest.dist_sq = FLT_MAX;
       if (trees.mesh_bvh.tree != nullptr) {
-        BLI_bvhtree_find_nearest(trees.mesh_bvh.tree,
-                                 sample_position,
-                                 &nearest,
-                                 trees.mesh_bvh.nearest_callback,
-                                 const_cast<BVHTreeFromMesh *>(&trees.mesh_bvh));
+        kdopbvh::find_nearest_batch(*trees.mesh_bvh.tree,
+                                    sample_mask,
+                                    sample_positions_span,
+                                    nearest,
+                                    trees.mesh_bvh.nearest_callback,
+                                    const_cast<BVHTreeFromMesh *>(&trees.mesh_bvh));
       }
       if (trees.pointcloud_bvh.tree != nullptr) {
-        BLI_bvhtree_find_nearest(trees.pointcloud_bvh.tree,
-                                 sample_position,
-                                 &nearest,
-                                 trees.pointcloud_bvh.nearest_callback,
-                                 const_cast<BVHTreeFromPointCloud *>(&trees.pointcloud_bvh));
+        kdopbvh::find_nearest_batch(*trees.pointcloud_bvh.tree,
+                                    sample_mask,
+                                    sample_positions_span,
+                                    nearest,
+                                    trees.pointcloud_bvh.nearest_callback,
+                                    const_cast<BVHTreeFromPointCloud *>(&trees.pointcloud_bvh));
       }
 
-      if (!positions.is_empty()) {
-        positions[i] = nearest.co;
-      }
-      if (!is_valid_span.is_empty()) {
-        is_valid_span[i] = true;
-      }
-      if (!distances.is_empty()) {
-        distances[i] = std::sqrt(nearest.dist_sq);
-      }
-    });
+      sample_mask.foreach_index(GrainSize(4096), [&](const int i) {
+        if (!positions.is_empty()) {
+          positions[i] = nearest[i].co;
+        }
+        if (!is_valid_span.is_empty()) {
+          is_valid_span[i] = true;
+        }
+        if (!distances.is_empty()) {
+          distances[i] = std::sqrt(nearest[i].dist_sq);
+        }
+      });
+    }
+  }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    /* Larger batches of query positions are more coherent. */
+    hints.prefers_full_mask = true;
+    return hints;
   }
 };
 
@@ -4,6 +4,8 @@
 
 #include "DNA_mesh_types.h"
 
+#include "BLI_kdopbvh.hh"
+
 #include "BKE_attribute_math.hh"
 #include "BKE_bvhutils.hh"
 #include "BKE_mesh_sample.hh"
@@ -88,6 +90,32 @@ static void node_gather_link_searches(GatherLinkSearchOpParams &params)
   }
 }
 
+/**
+ * Batched ray-casts traverse the tree with packets of rays, which is only faster when the rays
+ * in a packet visit the same nodes. That is the case when they share an origin or point in
+ * similar directions, other rays are cast one by one.
+ */
+static bool rays_are_coherent(const IndexMask &mask,
+                              const VArray<float3> &ray_origins,
+                              const VArray<float3> &ray_directions)
+{
+  if (mask.is_empty()) {
+    return false;
+  }
+  if (ray_origins.is_single() || ray_directions.is_single()) {
+    return true;
+  }
+  /* All directions are within about 25 degrees of the first one. */
+  const float3 first_direction = ray_directions[mask.first()];
+  bool coherent = true;
+  mask.foreach_index([&](const int i) {
+    if (coherent && math::dot(ray_directions[i], first_direction) < 0.9f) {
+      coherent = false;
+    }
+  });
+  return coherent;
+}
+
 static void raycast_to_mesh(const IndexMask &mask,
                             const Mesh &mesh,
                             const VArray<float3> &ray_origins,
@@ -100,7 +128,8 @@ static void raycast_to_mesh(const IndexMask &mask,
                             const MutableSpan<float> r_hit_distances)
 {
   BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 4);
+  /* The wide tree is needed for the packet traversal of coherent rays. */
+  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 4, BVH_BALANCE_WIDE);
   BLI_SCOPED_DEFER([&]() { free_bvhtree_from_mesh(&tree_data); });
 
   if (tree_data.tree == nullptr) {
@@ -109,22 +138,8 @@ static void raycast_to_mesh(const IndexMask &mask,
   /* We shouldn't be rebuilding the BVH tree when calling this function in parallel. */
   BLI_assert(tree_data.cached);
 
-  mask.foreach_index([&](const int i) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = ray_directions[i];
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1)
-    {
+  const auto store_hit = [&](const int i, const BVHTreeRayHit &hit) {
+    if (hit.index != -1) {
       if (!r_hit.is_empty()) {
         r_hit[i] = hit.index >= 0;
       }
@@ -156,9 +171,41 @@ static void raycast_to_mesh(const IndexMask &mask,
         r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
       }
       if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
+        r_hit_distances[i] = ray_lengths[i];
       }
     }
+  };
+
+  if (rays_are_coherent(mask, ray_origins, ray_directions)) {
+    Array<BVHTreeRayHit> hits(mask.min_array_size());
+    mask.foreach_index_optimized<int>(GrainSize(4096), [&](const int i) {
+      hits[i].index = -1;
+      hits[i].dist = ray_lengths[i];
+    });
+    kdopbvh::ray_cast_batch(*tree_data.tree,
+                            mask,
+                            VArraySpan<float3>(ray_origins),
+                            VArraySpan<float3>(ray_directions),
+                            0.0f,
+                            hits,
+                            tree_data.raycast_callback,
+                            &tree_data);
+    mask.foreach_index([&](const int i) { store_hit(i, hits[i]); });
+    return;
+  }
+
+  mask.foreach_index([&](const int i) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = ray_lengths[i];
+    BLI_bvhtree_ray_cast(tree_data.tree,
+                         ray_origins[i],
+                         ray_directions[i],
+                         0.0f,
+                         &hit,
+                         tree_data.raycast_callback,
+                         &tree_data);
+    store_hit(i, hit);
   });
 }
 
@@ -202,6 +249,14 @@ class RaycastFunction : public mf::MultiFunction {
                     params.uninitialized_single_output_if_required<float3>(5, "Hit Normal"),
                     params.uninitialized_single_output_if_required<float>(6, "Distance"));
   }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    /* Rays are sorted into coherent packets, which works better for larger masks. */
+    hints.prefers_full_mask = true;
+    return hints;
+  }
 };
 
 static void node_geo_exec(GeoNodeExecParams params)
@@ -70,20 +70,19 @@ static void node_init(bNodeTree * /*tree*/, bNode *node)
   node->custom2 = int(AttrDomain::Point);
 }
 
-static void get_closest_pointcloud_points(const PointCloud &pointcloud,
+static void get_closest_pointcloud_points(const BVHTreeFromPointCloud &tree_data,
                                           const VArray<float3> &positions,
                                           const IndexMask &mask,
                                           MutableSpan<int> r_indices,
                                           MutableSpan<float> r_distances_sq)
 {
   BLI_assert(positions.size() >= r_indices.size());
-  BLI_assert(pointcloud.totpoint > 0);
 
-  BVHTreeFromPointCloud tree_data;
-  BKE_bvhtree_from_pointcloud_get(pointcloud, IndexMask(pointcloud.totpoint), tree_data);
   if (tree_data.tree == nullptr) {
-    r_indices.fill(0);
-    r_distances_sq.fill(0.0f);
+    index_mask::masked_fill(r_indices, 0, mask);
+    if (!r_distances_sq.is_empty()) {
+      index_mask::masked_fill(r_distances_sq, 0.0f, mask);
+    }
     return;
   }
 
@@ -91,15 +90,16 @@ static void get_closest_pointcloud_points(const PointCloud &pointcloud,
     BVHTreeNearest nearest;
     nearest.dist_sq = FLT_MAX;
     const float3 position = positions[i];
-    BLI_bvhtree_find_nearest(
-        tree_data.tree, position, &nearest, tree_data.nearest_callback, &tree_data);
+    BLI_bvhtree_find_nearest(tree_data.tree,
+                             position,
+                             &nearest,
+                             tree_data.nearest_callback,
+                             const_cast<BVHTreeFromPointCloud *>(&tree_data));
     r_indices[i] = nearest.index;
     if (!r_distances_sq.is_empty()) {
       r_distances_sq[i] = nearest.dist_sq;
     }
   });
-
-  free_bvhtree_from_pointcloud(&tree_data);
 }
 
 static void get_closest_mesh_points(const Mesh &mesh,
@@ -111,7 +111,7 @@ static void get_closest_mesh_points(const Mesh &mesh,
 {
   BLI_assert(mesh.verts_num > 0);
   BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_VERTS, 2);
+  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_VERTS, 2, BVH_BALANCE_WIDE);
   get_closest_in_bvhtree(tree_data, positions, mask, r_point_indices, r_distances_sq, r_positions);
   free_bvhtree_from_mesh(&tree_data);
 }
@@ -125,7 +125,7 @@ static void get_closest_mesh_edges(const Mesh &mesh,
 {
   BLI_assert(mesh.edges_num > 0);
   BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_EDGES, 2);
+  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_EDGES, 2, BVH_BALANCE_WIDE);
   get_closest_in_bvhtree(tree_data, positions, mask, r_edge_indices, r_distances_sq, r_positions);
   free_bvhtree_from_mesh(&tree_data);
 }
@@ -139,7 +139,7 @@ static void get_closest_mesh_tris(const Mesh &mesh,
 {
   BLI_assert(mesh.faces_num > 0);
   BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 2);
+  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 2, BVH_BALANCE_WIDE);
   get_closest_in_bvhtree(tree_data, positions, mask, r_tri_indices, r_distances_sq, r_positions);
   free_bvhtree_from_mesh(&tree_data);
 }
@@ -239,6 +239,9 @@ class SampleNearestFunction : public mf::MultiFunction {
 
   const GeometryComponent *src_component_;
 
+  /* Built once for all calls, since the function may be called for many chunks of samples. */
+  BVHTreeFromPointCloud pointcloud_bvh_ = {};
+
   mf::Signature signature_;
 
  public:
@@ -247,6 +250,11 @@ class SampleNearestFunction : public mf::MultiFunction {
   {
     source_.ensure_owns_direct_data();
     this->src_component_ = find_source_component(source_, domain_);
+    if (src_component_ && src_component_->type() == GeometryComponent::Type::PointCloud) {
+      const PointCloud &pointcloud = *source_.get_pointcloud();
+      BKE_bvhtree_from_pointcloud_get(
+          pointcloud, IndexMask(pointcloud.totpoint), pointcloud_bvh_, BVH_BALANCE_WIDE);
+    }
 
     mf::SignatureBuilder builder{"Sample Nearest", signature_};
     builder.single_input<float3>("Position");
@@ -254,6 +262,13 @@ class SampleNearestFunction : public mf::MultiFunction {
     this->set_signature(&signature_);
   }
 
+  ~SampleNearestFunction()
+  {
+    if (pointcloud_bvh_.tree) {
+      free_bvhtree_from_pointcloud(&pointcloud_bvh_);
+    }
+  }
+
   void call(const IndexMask &mask, mf::Params params, mf::Context /*context*/) const override
   {
     const VArray<float3> &positions = params.readonly_single_input<float3>(0, "Position");
@@ -286,10 +301,7 @@ class SampleNearestFunction : public mf::MultiFunction {
         break;
       }
       case GeometryComponent::Type::PointCloud: {
-        const PointCloudComponent &component = *static_cast<const PointCloudComponent *>(
-            src_component_);
-        const PointCloud &points = *component.get();
-        get_closest_pointcloud_points(points, positions, mask, indices, {});
+        get_closest_pointcloud_points(pointcloud_bvh_, positions, mask, indices, {});
         break;
       }
       default:
@@ -14,6 +14,7 @@
 
 #include "RNA_enum_types.hh"
 
+#include "BLI_kdopbvh.hh"
 #include "BLI_task.hh"
 
 #include "node_geometry_util.hh"
@@ -123,7 +124,7 @@ class SampleNearestSurfaceFunction : public mf::MultiFunction {
           for (const int group_i : range) {
             const IndexMask &group_mask = group_masks[group_i];
             BVHTreeFromMesh &bvh = bvh_trees_[group_i];
-            BKE_bvhtree_from_mesh_tris_init(mesh, group_mask, bvh);
+            BKE_bvhtree_from_mesh_tris_init(mesh, group_mask, bvh, BVH_BALANCE_WIDE);
           }
         },
         threading::individual_task_sizes(
@@ -147,35 +148,51 @@ class SampleNearestSurfaceFunction : public mf::MultiFunction {
     MutableSpan<bool> is_valid_span = params.uninitialized_single_output_if_required<bool>(
         4, "Is Valid");
 
-    mask.foreach_index([&](const int i) {
-      const float3 position = positions[i];
-      const int sample_id = sample_ids[i];
-      const int group_index = group_indices_.index_of_try(sample_id);
+    const VArraySpan<float3> positions_span(positions);
+    Array<BVHTreeNearest> nearest(mask.min_array_size());
+
+    IndexMaskMemory memory;
+    VectorSet<int> sample_id_set;
+    const Vector<IndexMask, 4> sample_id_masks = IndexMask::from_group_ids(
+        mask, sample_ids, memory, sample_id_set);
+    for (const int sample_id_index : sample_id_masks.index_range()) {
+      const IndexMask &sample_mask = sample_id_masks[sample_id_index];
+      const int group_index = group_indices_.index_of_try(sample_id_set[sample_id_index]);
       if (group_index == -1) {
-        triangle_index[i] = -1;
-        sample_position[i] = float3(0, 0, 0);
+        index_mask::masked_fill(triangle_index, -1, sample_mask);
+        index_mask::masked_fill(sample_position, float3(0, 0, 0), sample_mask);
         if (!is_valid_span.is_empty()) {
-          is_valid_span[i] = false;
+          index_mask::masked_fill(is_valid_span, false, sample_mask);
         }
-        return;
+        continue;
       }
       const BVHTreeFromMesh &bvh = bvh_trees_[group_index];
-      BVHTreeNearest nearest;
-      nearest.dist_sq = FLT_MAX;
-      BLI_bvhtree_find_nearest(
-          bvh.tree, position, &nearest, bvh.nearest_callback, const_cast<BVHTreeFromMesh *>(&bvh));
-      triangle_index[i] = nearest.index;
-      sample_position[i] = nearest.co;
-      if (!is_valid_span.is_empty()) {
-        is_valid_span[i] = true;
-      }
-    });
+      sample_mask.foreach_index_optimized<int>(GrainSize(4096), [&](const int i) {
+        nearest[i].index = -1;
+        nearest[i].dist_sq = FLT_MAX;
+      });
+      kdopbvh::find_nearest_batch(*bvh.tree,
+                                  sample_mask,
+                                  positions_span,
+                                  nearest,
+                                  bvh.nearest_callback,
+                                  const_cast<BVHTreeFromMesh *>(&bvh));
+      sample_mask.foreach_index(GrainSize(4096), [&](const int i) {
+        triangle_index[i] = nearest[i].index;
+        sample_position[i] = nearest[i].co;
+        if (!is_valid_span.is_empty()) {
+          is_valid_span[i] = true;
+        }
+      });
+    }
   }
 
   ExecutionHints get_execution_hints() const override
   {
     ExecutionHints hints;
     hints.min_grain_size = 512;
+    /* Samples are grouped by ID and sorted into batches for every call. */
+    hints.prefers_full_mask = true;
     return hints;
   }
 };
@@ -8,6 +8,8 @@
  * \ingroup sequencer
  */
 
+#include <cstdint>
+
 struct ListBase;
 struct Main;
 struct MovieClip;
@@ -54,6 +56,18 @@ void SEQ_relations_check_uids_unique_and_report(const Scene *scene);
 void SEQ_relations_session_uid_generate(Sequence *sequence);
 
 void SEQ_cache_cleanup(Scene *scene);
+
+struct SeqCacheStatistics {
+  uint64_t hits;
+  uint64_t misses;
+  /** Images removed to make room for new ones. */
+  uint64_t evictions;
+};
+/**
+ * Counters of the in-memory image cache, since the cache was created or the counters were reset.
+ */
+SeqCacheStatistics SEQ_cache_statistics_get(const Scene *scene);
+void SEQ_cache_statistics_reset(Scene *scene);
 void SEQ_cache_iterate(
     Scene *scene,
     void *userdata,
@@ -23,8 +23,11 @@ struct rctf;
 
 enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Prefetch threads use consecutive IDs, starting with this one. */
   SEQ_TASK_PREFETCH_RENDER,
+  SEQ_TASK_PREFETCH_RENDER_LAST = SEQ_TASK_PREFETCH_RENDER + 15,
 };
+#define SEQ_TASK_NUM (SEQ_TASK_PREFETCH_RENDER_LAST + 1)
 
 struct SeqRenderData {
   Main *bmain;
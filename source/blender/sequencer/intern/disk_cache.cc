@@ -6,10 +6,13 @@
  * \ingroup sequencer
  */
 
+#include <atomic>
 #include <cstddef>
 #include <ctime>
 #include <memory.h>
 
+#include <zstd.h>
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -19,6 +22,7 @@
 #include "IMB_imbuf.hh"
 #include "IMB_imbuf_types.hh"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
@@ -26,7 +30,10 @@
 #include "BLI_fileops_types.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "BKE_main.hh"
 
@@ -44,8 +51,13 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * ZLIB compression with user definable level can be used to compress image data(per image)
+ * ZSTD compression with user definable level can be used to compress image data(per image).
+ * Compressed images are split into blocks of whole rows, which are compressed and decompressed
+ * in parallel. The block size and compressed size of every block precede the compressed data.
  * Images are written in order in which they are rendered.
+ * Writing happens on a background thread, so that compression and I/O don't stall rendering.
+ * The number of images waiting to be written is limited, adding more images blocks until
+ * the writer caught up. Images waiting to be written can already be read from the cache.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
@@ -57,11 +69,22 @@
  * `<cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf`. */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 2
+#define DCACHE_CURRENT_VERSION 3
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in IMB intern. */
+/* Approximate uncompressed size of row blocks that are compressed independently. */
+#define DCACHE_BLOCK_SIZE (1024 * 1024)
+/* Maximum number of images waiting to be written. */
+#define DCACHE_WRITE_QUEUE_MAX 8
+
+enum eDiskCacheCodec {
+  DCACHE_CODEC_RAW = 0,
+  DCACHE_CODEC_ZSTD = 1,
+};
 
 struct DiskCacheHeaderEntry {
   uchar encoding;
+  uchar codec; /* #eDiskCacheCodec. */
+  char level;  /* Compression level of #DCACHE_CODEC_ZSTD, only for reference. */
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -73,12 +96,32 @@ struct DiskCacheHeader {
   DiskCacheHeaderEntry entry[DCACHE_IMAGES_PER_FILE];
 };
 
+/* Image waiting to be written by the background writer. */
+struct DiskCacheWriteItem {
+  DiskCacheWriteItem *next, *prev;
+  char filepath[FILE_MAX];
+  int cache_type;
+  float frame_index;
+  ImBuf *ibuf;
+  /* Set when the image was invalidated before it was written. */
+  bool is_invalid;
+};
+
 struct SeqDiskCache {
   Main *bmain;
   int64_t timestamp;
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /* Background writer. Lock `read_write_mutex` before `write_queue_mutex` if both are needed. */
+  TaskPool *write_pool;
+  ThreadMutex write_queue_mutex;
+  ThreadCondition write_queue_cond;
+  /* Images waiting to be written, and the image being written by the writer. */
+  ListBase write_queue;
+  int write_queue_len;
+  DiskCacheWriteItem *write_item;
 };
 
 struct DiskCacheFile {
@@ -107,6 +150,9 @@ static int seq_disk_cache_compression_level()
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+      /* Negative levels trade compression ratio for speed, similar to LZ4. */
+      return -4;
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -394,6 +440,55 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
   }
 }
 
+static void seq_disk_cache_write_item_free(DiskCacheWriteItem *item)
+{
+  IMB_freeImBuf(item->ibuf);
+  MEM_freeN(item);
+}
+
+/* Same as #seq_disk_cache_delete_invalid_files, for images that were not written yet. */
+static void seq_disk_cache_delete_invalid_writes(SeqDiskCache *disk_cache,
+                                                 Scene *scene,
+                                                 Sequence *seq,
+                                                 int invalidate_types,
+                                                 int range_start,
+                                                 int range_end)
+{
+  char cache_dir[FILE_MAX];
+  seq_disk_cache_get_dir(disk_cache, scene, seq, cache_dir, sizeof(cache_dir));
+  BLI_path_slash_ensure(cache_dir, sizeof(cache_dir));
+
+  auto is_invalid = [&](const DiskCacheWriteItem *item) {
+    if ((item->cache_type & invalidate_types) == 0) {
+      return false;
+    }
+    char dir[FILE_MAXDIR];
+    BLI_path_split_dir_part(item->filepath, dir, sizeof(dir));
+    if (!STREQ(cache_dir, dir)) {
+      return false;
+    }
+    const int start_frame = int(item->frame_index) / DCACHE_IMAGES_PER_FILE *
+                            DCACHE_IMAGES_PER_FILE;
+    const int timeline_frame_start = seq_cache_frame_index_to_timeline_frame(seq, start_frame);
+    return timeline_frame_start > range_start && timeline_frame_start <= range_end;
+  };
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  LISTBASE_FOREACH_MUTABLE (DiskCacheWriteItem *, item, &disk_cache->write_queue) {
+    if (is_invalid(item)) {
+      BLI_remlink(&disk_cache->write_queue, item);
+      disk_cache->write_queue_len--;
+      seq_disk_cache_write_item_free(item);
+    }
+  }
+  /* The image being compressed is checked again before it is written. */
+  if (disk_cache->write_item && is_invalid(disk_cache->write_item)) {
+    disk_cache->write_item->is_invalid = true;
+  }
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+}
+
 void seq_disk_cache_invalidate(SeqDiskCache *disk_cache,
                                Scene *scene,
                                Sequence *seq,
@@ -409,45 +504,173 @@ void seq_disk_cache_invalidate(SeqDiskCache *disk_cache,
   end = SEQ_time_right_handle_frame_get(scene, seq_changed);
 
   seq_disk_cache_delete_invalid_files(disk_cache, scene, seq, invalidate_types, start, end);
+  seq_disk_cache_delete_invalid_writes(disk_cache, scene, seq, invalidate_types, start, end);
 
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static void *seq_disk_cache_imbuf_data(ImBuf *ibuf)
 {
-  void *data = (ibuf->byte_buffer.data != nullptr) ? (void *)ibuf->byte_buffer.data :
-                                                     (void *)ibuf->float_buffer.data;
+  return (ibuf->byte_buffer.data != nullptr) ? (void *)ibuf->byte_buffer.data :
+                                               (void *)ibuf->float_buffer.data;
+}
+
+static uint64_t seq_disk_cache_imbuf_row_size(const ImBuf *ibuf)
+{
+  const uint64_t channel_size = ibuf->byte_buffer.data ? sizeof(uchar) : sizeof(float);
+  return uint64_t(ibuf->x) * ibuf->channels * channel_size;
+}
 
-  /* Apply compression if wanted, otherwise just write directly to the file. */
-  if (level > 0) {
-    return BLI_file_zstd_from_mem_at_pos(
-        data, header_entry->size_raw, file, header_entry->offset, level);
+static uint64_t seq_disk_cache_imbuf_size(const ImBuf *ibuf)
+{
+  return seq_disk_cache_imbuf_row_size(ibuf) * ibuf->y;
+}
+
+/* Size of blocks of whole rows that are compressed independently. */
+static uint64_t seq_disk_cache_block_size(const ImBuf *ibuf)
+{
+  const uint64_t row_size = seq_disk_cache_imbuf_row_size(ibuf);
+  return std::max<uint64_t>(DCACHE_BLOCK_SIZE / row_size, 1) * row_size;
+}
+
+/* Image data compressed in blocks, ready to be written to a cache file. */
+struct DiskCacheCompressedImage {
+  uint64_t block_size = 0;
+  blender::Array<blender::Vector<uchar>> blocks;
+};
+
+static bool seq_disk_cache_compress_imbuf(ImBuf *ibuf,
+                                          const uint64_t size_raw,
+                                          const int level,
+                                          DiskCacheCompressedImage &r_image)
+{
+  using namespace blender;
+  const uchar *data = static_cast<const uchar *>(seq_disk_cache_imbuf_data(ibuf));
+  r_image.block_size = seq_disk_cache_block_size(ibuf);
+  r_image.blocks.reinitialize(divide_ceil_ul(size_raw, r_image.block_size));
+
+  std::atomic<bool> success = true;
+  threading::parallel_for(r_image.blocks.index_range(), 1, [&](const IndexRange range) {
+    ZSTD_CCtx *ctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level);
+    for (const int64_t i : range) {
+      const uint64_t offset = i * r_image.block_size;
+      const uint64_t size = std::min(r_image.block_size, size_raw - offset);
+      Vector<uchar> &block = r_image.blocks[i];
+      block.resize(ZSTD_compressBound(size));
+      const size_t compressed_size = ZSTD_compress2(
+          ctx, block.data(), block.size(), data + offset, size);
+      if (ZSTD_isError(compressed_size)) {
+        success = false;
+        break;
+      }
+      block.resize(compressed_size);
+    }
+    ZSTD_freeCCtx(ctx);
+  });
+  return success;
+}
+
+/* Write the block table followed by the compressed blocks, returns the number of bytes written
+ * or zero on failure. */
+static size_t seq_disk_cache_write_compressed(FILE *file,
+                                              const DiskCacheCompressedImage &image,
+                                              const DiskCacheHeaderEntry *header_entry)
+{
+  blender::Array<uint64_t> table(image.blocks.size() + 2);
+  table[0] = image.block_size;
+  table[1] = image.blocks.size();
+  for (const int64_t i : image.blocks.index_range()) {
+    table[i + 2] = image.blocks[i].size();
   }
 
-  fseek(file, header_entry->offset, SEEK_SET);
-  return fwrite(data, 1, header_entry->size_raw, file);
+  BLI_fseek(file, header_entry->offset, SEEK_SET);
+  if (fwrite(table.data(), sizeof(uint64_t), table.size(), file) != table.size()) {
+    return 0;
+  }
+  size_t total_written = table.as_span().size_in_bytes();
+  for (const blender::Vector<uchar> &block : image.blocks) {
+    if (fwrite(block.data(), 1, block.size(), file) != block.size()) {
+      return 0;
+    }
+    total_written += block.size();
+  }
+  return total_written;
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+static size_t seq_disk_cache_read_compressed(ImBuf *ibuf,
+                                             FILE *file,
+                                             const DiskCacheHeaderEntry *header_entry)
 {
-  void *data = (ibuf->byte_buffer.data != nullptr) ? (void *)ibuf->byte_buffer.data :
-                                                     (void *)ibuf->float_buffer.data;
-  char header[4];
-  fseek(file, header_entry->offset, SEEK_SET);
-  if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
+  using namespace blender;
+  const uint64_t size_raw = header_entry->size_raw;
+  const uint64_t size_compressed = header_entry->size_compressed;
+  if (size_compressed < 2 * sizeof(uint64_t)) {
+    return 0;
+  }
+  Array<uchar> compressed(size_compressed, NoInitialization());
+  BLI_fseek(file, header_entry->offset, SEEK_SET);
+  if (fread(compressed.data(), 1, size_compressed, file) != size_compressed) {
     return 0;
   }
 
-  /* Check if the data is compressed or raw. */
-  if (BLI_file_magic_is_zstd(header)) {
-    return BLI_file_unzstd_to_mem_at_pos(data, header_entry->size_raw, file, header_entry->offset);
+  const bool switch_endian = (ENDIAN_ORDER == B_ENDIAN) && header_entry->encoding == 0;
+  auto read_table_value = [&](const uint64_t index) {
+    uint64_t value;
+    memcpy(&value, compressed.data() + index * sizeof(uint64_t), sizeof(value));
+    if (switch_endian) {
+      BLI_endian_switch_uint64(&value);
+    }
+    return value;
+  };
+
+  const uint64_t block_size = read_table_value(0);
+  const uint64_t blocks_num = read_table_value(1);
+  if (block_size == 0 || blocks_num != divide_ceil_ul(size_raw, block_size) ||
+      (blocks_num + 2) * sizeof(uint64_t) > size_compressed)
+  {
+    return 0;
+  }
+
+  /* Offsets of the compressed blocks in the file data. */
+  Array<uint64_t> block_offsets(blocks_num + 1);
+  block_offsets[0] = (blocks_num + 2) * sizeof(uint64_t);
+  for (const uint64_t i : IndexRange(blocks_num)) {
+    block_offsets[i + 1] = block_offsets[i] + read_table_value(i + 2);
+  }
+  if (block_offsets.last() != size_compressed) {
+    return 0;
   }
 
-  fseek(file, header_entry->offset, SEEK_SET);
-  return fread(data, 1, header_entry->size_raw, file);
+  uchar *data = static_cast<uchar *>(seq_disk_cache_imbuf_data(ibuf));
+  std::atomic<bool> success = true;
+  threading::parallel_for(IndexRange(blocks_num), 1, [&](const IndexRange range) {
+    ZSTD_DCtx *ctx = ZSTD_createDCtx();
+    for (const int64_t i : range) {
+      const uint64_t offset = i * block_size;
+      const uint64_t size = std::min(block_size, size_raw - offset);
+      const uchar *block = compressed.data() + block_offsets[i];
+      const uint64_t block_compressed_size = block_offsets[i + 1] - block_offsets[i];
+      const size_t decompressed_size = ZSTD_decompressDCtx(
+          ctx, data + offset, size, block, block_compressed_size);
+      if (decompressed_size != size) {
+        success = false;
+        break;
+      }
+    }
+    ZSTD_freeDCtx(ctx);
+  });
+  return success ? size_raw : 0;
+}
+
+static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+{
+  if (header_entry->codec == DCACHE_CODEC_ZSTD) {
+    return seq_disk_cache_read_compressed(ibuf, file, header_entry);
+  }
+
+  BLI_fseek(file, header_entry->offset, SEEK_SET);
+  return fread(seq_disk_cache_imbuf_data(ibuf), 1, header_entry->size_raw, file);
 }
 
 static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -478,7 +701,9 @@ static size_t seq_disk_cache_write_header(FILE *file, const DiskCacheHeader *hea
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(const float frame_index,
+                                           ImBuf *ibuf,
+                                           DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -511,16 +736,15 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   }
 
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->frame_index;
+  header->entry[i].frameno = frame_index;
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
+  header->entry[i].size_raw = seq_disk_cache_imbuf_size(ibuf);
   if (ibuf->byte_buffer.data) {
-    header->entry[i].size_raw = int64_t(ibuf->x) * ibuf->y * ibuf->channels;
     colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
   }
   else {
-    header->entry[i].size_raw = int64_t(ibuf->x) * ibuf->y * ibuf->channels * 4;
     colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
   }
   STRNCPY(header->entry[i].colorspace_name, colorspace_name);
@@ -539,13 +763,14 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, const DiskCacheHead
   return -1;
 }
 
-bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Write an image to its cache file, `image` is null for uncompressed images.
+ * Runs on the background writer with `read_write_mutex` locked. */
+static bool seq_disk_cache_write_item(SeqDiskCache *disk_cache,
+                                      const DiskCacheWriteItem *item,
+                                      const DiskCacheCompressedImage *image,
+                                      const int level)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
-
-  char filepath[FILE_MAX];
-
-  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
+  const char *filepath = item->filepath;
   BLI_file_ensure_parent_dir_exists(filepath);
 
   /* Touch the file. */
@@ -553,7 +778,6 @@ bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf
   if (!file) {
     file = BLI_fopen(filepath, "wb+");
     if (!file) {
-      BLI_mutex_unlock(&disk_cache->read_write_mutex);
       return false;
     }
     seq_disk_cache_add_file_to_list(disk_cache, filepath);
@@ -567,31 +791,128 @@ bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf
   if (cache_file->fstat.st_size != 0 && !seq_disk_cache_read_header(file, &header)) {
     fclose(file);
     seq_disk_cache_delete_file(disk_cache, cache_file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return false;
   }
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  int entry_index = seq_disk_cache_add_header_entry(item->frame_index, item->ibuf, &header);
+  DiskCacheHeaderEntry *header_entry = &header.entry[entry_index];
+
+  size_t bytes_written;
+  if (image) {
+    header_entry->codec = DCACHE_CODEC_ZSTD;
+    header_entry->level = level;
+    bytes_written = seq_disk_cache_write_compressed(file, *image, header_entry);
+  }
+  else {
+    header_entry->codec = DCACHE_CODEC_RAW;
+    BLI_fseek(file, header_entry->offset, SEEK_SET);
+    bytes_written = fwrite(
+        seq_disk_cache_imbuf_data(item->ibuf), 1, header_entry->size_raw, file);
+  }
 
   if (bytes_written != 0) {
     /* Last step is writing header, as image data can be overwritten,
      * but missing data would cause problems.
      */
-    header.entry[entry_index].size_compressed = bytes_written;
+    header_entry->size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
     seq_disk_cache_update_file(disk_cache, filepath);
     fclose(file);
-
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return true;
   }
 
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  fclose(file);
   return false;
 }
 
+static void seq_disk_cache_write_task(TaskPool *__restrict pool, void * /*taskdata*/)
+{
+  SeqDiskCache *disk_cache = static_cast<SeqDiskCache *>(BLI_task_pool_user_data(pool));
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  DiskCacheWriteItem *item = static_cast<DiskCacheWriteItem *>(
+      BLI_pophead(&disk_cache->write_queue));
+  if (item) {
+    disk_cache->write_queue_len--;
+    disk_cache->write_item = item;
+    BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  }
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+  /* The image may have been removed by invalidation. */
+  if (item == nullptr) {
+    return;
+  }
+
+  /* Compress without holding any lock, so reading from the cache isn't blocked. */
+  const int level = seq_disk_cache_compression_level();
+  DiskCacheCompressedImage image;
+  const bool use_compression = level != 0;
+  const bool is_compressed = use_compression &&
+                             seq_disk_cache_compress_imbuf(
+                                 item->ibuf, seq_disk_cache_imbuf_size(item->ibuf), level, image);
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  if (!item->is_invalid && (is_compressed || !use_compression)) {
+    seq_disk_cache_write_item(disk_cache, item, is_compressed ? &image : nullptr, level);
+  }
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  disk_cache->write_item = nullptr;
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  seq_disk_cache_write_item_free(item);
+  seq_disk_cache_enforce_limits(disk_cache);
+}
+
+bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  DiskCacheWriteItem *item = static_cast<DiskCacheWriteItem *>(
+      MEM_callocN(sizeof(DiskCacheWriteItem), "DiskCacheWriteItem"));
+  seq_disk_cache_get_file_path(disk_cache, key, item->filepath, sizeof(item->filepath));
+  item->cache_type = key->type;
+  item->frame_index = key->frame_index;
+  IMB_refImBuf(ibuf);
+  item->ibuf = ibuf;
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  while (disk_cache->write_queue_len >= DCACHE_WRITE_QUEUE_MAX) {
+    BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->write_queue_mutex);
+  }
+  BLI_addtail(&disk_cache->write_queue, item);
+  disk_cache->write_queue_len++;
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+  BLI_task_pool_push(disk_cache->write_pool, seq_disk_cache_write_task, nullptr, false, nullptr);
+  return true;
+}
+
+/* Images that are waiting to be written, or are being written, are returned directly. */
+static ImBuf *seq_disk_cache_find_pending_write(SeqDiskCache *disk_cache,
+                                                const char *filepath,
+                                                const float frame_index)
+{
+  auto matches = [&](const DiskCacheWriteItem *item) {
+    return item->frame_index == frame_index && !item->is_invalid &&
+           STREQ(item->filepath, filepath);
+  };
+
+  ImBuf *ibuf = nullptr;
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  if (disk_cache->write_item && matches(disk_cache->write_item)) {
+    ibuf = disk_cache->write_item->ibuf;
+  }
+  LISTBASE_FOREACH (DiskCacheWriteItem *, item, &disk_cache->write_queue) {
+    if (matches(item)) {
+      ibuf = item->ibuf;
+    }
+  }
+  if (ibuf) {
+    IMB_refImBuf(ibuf);
+  }
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+  return ibuf;
+}
+
 ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
 {
   BLI_mutex_lock(&disk_cache->read_write_mutex);
@@ -600,6 +921,12 @@ ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
   DiskCacheHeader header;
 
   seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
+
+  if (ImBuf *ibuf = seq_disk_cache_find_pending_write(disk_cache, filepath, key->frame_index)) {
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    return ibuf;
+  }
+
   BLI_file_ensure_parent_dir_exists(filepath);
 
   FILE *file = BLI_fopen(filepath, "rb");
@@ -668,6 +995,9 @@ SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene)
       MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache"));
   disk_cache->bmain = bmain;
   BLI_mutex_init(&disk_cache->read_write_mutex);
+  BLI_mutex_init(&disk_cache->write_queue_mutex);
+  BLI_condition_init(&disk_cache->write_queue_cond);
+  disk_cache->write_pool = BLI_task_pool_create_background_serial(disk_cache, TASK_PRIORITY_LOW);
   seq_disk_cache_handle_versioning(disk_cache);
   seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
   disk_cache->timestamp = scene->ed->disk_cache_timestamp;
@@ -677,7 +1007,21 @@ SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene)
 
 void seq_disk_cache_free(SeqDiskCache *disk_cache)
 {
+  /* Discard images that were not written yet, only wait for the one being written. */
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  LISTBASE_FOREACH_MUTABLE (DiskCacheWriteItem *, item, &disk_cache->write_queue) {
+    seq_disk_cache_write_item_free(item);
+  }
+  BLI_listbase_clear(&disk_cache->write_queue);
+  disk_cache->write_queue_len = 0;
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+  BLI_task_pool_work_and_wait(disk_cache->write_pool);
+  BLI_task_pool_free(disk_cache->write_pool);
+
   BLI_freelistN(&disk_cache->files);
+  BLI_condition_end(&disk_cache->write_queue_cond);
+  BLI_mutex_end(&disk_cache->write_queue_mutex);
   BLI_mutex_end(&disk_cache->read_write_mutex);
   MEM_freeN(disk_cache);
 }
@@ -23,6 +23,10 @@ SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene);
 void seq_disk_cache_free(SeqDiskCache *disk_cache);
 bool seq_disk_cache_is_enabled(Main *bmain);
 ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key);
+/**
+ * Queue the image to be written by a background thread, blocks while too many images are queued.
+ * Cache limits are enforced after writing.
+ */
 bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf);
 bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache);
 void seq_disk_cache_invalidate(SeqDiskCache *disk_cache,
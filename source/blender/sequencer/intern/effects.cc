@@ -20,6 +20,7 @@
 #include "BLI_math_vector_types.hh"
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
+#include "BLI_simd.hh"
 #include "BLI_string.h"
 #include "BLI_task.hh"
 #include "BLI_threads.h"
@@ -118,10 +119,61 @@ static void slice_get_float_buffers(const SeqRenderData *context,
   }
 }
 
+#if BLI_HAVE_SSE2
+/* Small helpers for SSE registers holding one float pixel, or two byte pixels widened to 16 bit.
+ * Kernels using them match the scalar code operation for operation, so results are identical. */
+
+static __m128 simd_splat_alpha(const __m128 pix)
+{
+  return _mm_shuffle_ps(pix, pix, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* Color channels from `col`, alpha from `alpha_src`. */
+static __m128 simd_with_alpha(const __m128 col, const __m128 alpha_src)
+{
+  const __m128 rgb_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+  return _mm_or_ps(_mm_and_ps(rgb_mask, col), _mm_andnot_ps(rgb_mask, alpha_src));
+}
+
+static __m128 simd_select(const __m128 mask, const __m128 a, const __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 simd_abs(const __m128 a)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+static __m128i simd_splat_alpha_u16(const __m128i pix)
+{
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pix, _MM_SHUFFLE(3, 3, 3, 3)),
+                             _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* Per channel `(fac * alpha * channel) >> 16`, where `fac * alpha` must fit in 16 bit. */
+static __m128i simd_scale_by_alpha_u16(const __m128i pix, const __m128i fac)
+{
+  return _mm_mulhi_epu16(_mm_mullo_epi16(simd_splat_alpha_u16(pix), fac), pix);
+}
+#endif
+
 static float4 load_premul_pixel(const uchar *ptr)
 {
   float4 res;
+#if BLI_HAVE_SSE2
+  /* Same as #straight_uchar_to_premul_float. */
+  int32_t packed;
+  memcpy(&packed, ptr, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i pix = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero),
+                                         zero);
+  const float alpha = ptr[3] * (1.0f / 255.0f);
+  const float fac = alpha * (1.0f / 255.0f);
+  _mm_storeu_ps(res, _mm_mul_ps(_mm_cvtepi32_ps(pix), _mm_setr_ps(fac, fac, fac, 1.0f / 255.0f)));
+#else
   straight_uchar_to_premul_float(res, ptr);
+#endif
   return res;
 }
 
@@ -132,7 +184,23 @@ static float4 load_premul_pixel(const float *ptr)
 
 static void store_premul_pixel(const float4 &pix, uchar *dst)
 {
+#if BLI_HAVE_SSE2
+  /* Same as #premul_float_to_straight_uchar, rounding and clamping like
+   * #unit_float_to_uchar_clamp. */
+  __m128 col = _mm_loadu_ps(pix);
+  if (pix.w != 0.0f && pix.w != 1.0f) {
+    const float alpha_inv = 1.0f / pix.w;
+    col = _mm_mul_ps(col, _mm_setr_ps(alpha_inv, alpha_inv, alpha_inv, 1.0f));
+  }
+  col = _mm_add_ps(_mm_mul_ps(col, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+  col = _mm_min_ps(_mm_max_ps(col, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+  const __m128i pix_i32 = _mm_cvttps_epi32(col);
+  const __m128i pix_i16 = _mm_packs_epi32(pix_i32, pix_i32);
+  const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(pix_i16, pix_i16));
+  memcpy(dst, &packed, sizeof(packed));
+#else
   premul_float_to_straight_uchar(dst, pix);
+#endif
 }
 
 static void store_premul_pixel(const float4 &pix, float *dst)
@@ -383,7 +451,7 @@ static void do_alphaunder_effect(const SeqRenderData *context,
 /** \name Cross Effect
  * \{ */
 
-static void do_cross_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
+void seq_effect_cross_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
 {
   uchar *rt1 = rect1;
   uchar *rt2 = rect2;
@@ -392,21 +460,44 @@ static void do_cross_effect_byte(float fac, int x, int y, uchar *rect1, uchar *r
   int temp_fac = int(256.0f * fac);
   int temp_mfac = 256 - temp_fac;
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      rt[0] = (temp_mfac * rt1[0] + temp_fac * rt2[0]) >> 8;
-      rt[1] = (temp_mfac * rt1[1] + temp_fac * rt2[1]) >> 8;
-      rt[2] = (temp_mfac * rt1[2] + temp_fac * rt2[2]) >> 8;
-      rt[3] = (temp_mfac * rt1[3] + temp_fac * rt2[3]) >> 8;
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
+  const int64_t pixels_num = int64_t(x) * y;
+  int64_t i = 0;
+
+#if BLI_HAVE_SSE2
+  /* Four pixels at a time, the sums fit in 16 bit for factors in the 0..1 range. */
+  if (temp_fac >= 0 && temp_fac <= 256) {
+    const __m128i fac_v = _mm_set1_epi16(short(temp_fac));
+    const __m128i mfac_v = _mm_set1_epi16(short(temp_mfac));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= pixels_num; i += 4) {
+      const __m128i col1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rt1));
+      const __m128i col2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rt2));
+      const __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(col1, zero), mfac_v),
+                                       _mm_mullo_epi16(_mm_unpacklo_epi8(col2, zero), fac_v));
+      const __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(col1, zero), mfac_v),
+                                       _mm_mullo_epi16(_mm_unpackhi_epi8(col2, zero), fac_v));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(rt),
+                       _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+      rt1 += 16;
+      rt2 += 16;
+      rt += 16;
     }
   }
+#endif
+
+  for (; i < pixels_num; i++) {
+    rt[0] = (temp_mfac * rt1[0] + temp_fac * rt2[0]) >> 8;
+    rt[1] = (temp_mfac * rt1[1] + temp_fac * rt2[1]) >> 8;
+    rt[2] = (temp_mfac * rt1[2] + temp_fac * rt2[2]) >> 8;
+    rt[3] = (temp_mfac * rt1[3] + temp_fac * rt2[3]) >> 8;
+
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
 }
 
-static void do_cross_effect_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
+void seq_effect_cross_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
 {
   float *rt1 = rect1;
   float *rt2 = rect2;
@@ -414,17 +505,24 @@ static void do_cross_effect_float(float fac, int x, int y, float *rect1, float *
 
   float mfac = 1.0f - fac;
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      rt[0] = mfac * rt1[0] + fac * rt2[0];
-      rt[1] = mfac * rt1[1] + fac * rt2[1];
-      rt[2] = mfac * rt1[2] + fac * rt2[2];
-      rt[3] = mfac * rt1[3] + fac * rt2[3];
+  const int64_t pixels_num = int64_t(x) * y;
+  for (int64_t i = 0; i < pixels_num; i++) {
+#if BLI_HAVE_SSE2
+    const __m128 col1 = _mm_loadu_ps(rt1);
+    const __m128 col2 = _mm_loadu_ps(rt2);
+    _mm_storeu_ps(rt,
+                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mfac), col1),
+                             _mm_mul_ps(_mm_set1_ps(fac), col2)));
+#else
+    rt[0] = mfac * rt1[0] + fac * rt2[0];
+    rt[1] = mfac * rt1[1] + fac * rt2[1];
+    rt[2] = mfac * rt1[2] + fac * rt2[2];
+    rt[3] = mfac * rt1[3] + fac * rt2[3];
+#endif
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
   }
 }
 
@@ -445,7 +543,7 @@ static void do_cross_effect(const SeqRenderData *context,
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_cross_effect_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_cross_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
   else {
     uchar *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
@@ -453,7 +551,7 @@ static void do_cross_effect(const SeqRenderData *context,
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_cross_effect_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_cross_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
 }
 
@@ -547,7 +645,7 @@ static void do_gammacross_effect(const SeqRenderData *context,
 /** \name Color Add Effect
  * \{ */
 
-static void do_add_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
+void seq_effect_add_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
 {
   uchar *cp1 = rect1;
   uchar *cp2 = rect2;
@@ -555,39 +653,65 @@ static void do_add_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rec
 
   int temp_fac = int(256.0f * fac);
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      const int temp_fac2 = temp_fac * int(cp2[3]);
-      rt[0] = min_ii(cp1[0] + ((temp_fac2 * cp2[0]) >> 16), 255);
-      rt[1] = min_ii(cp1[1] + ((temp_fac2 * cp2[1]) >> 16), 255);
-      rt[2] = min_ii(cp1[2] + ((temp_fac2 * cp2[2]) >> 16), 255);
-      rt[3] = cp1[3];
-
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
+  const int64_t pixels_num = int64_t(x) * y;
+  int64_t i = 0;
+
+#if BLI_HAVE_SSE2
+  if (temp_fac >= 0 && temp_fac <= 256) {
+    const __m128i fac_v = _mm_set1_epi16(short(temp_fac));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+    for (; i + 4 <= pixels_num; i += 4) {
+      const __m128i col1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cp1));
+      const __m128i col2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cp2));
+      const __m128i lo = simd_scale_by_alpha_u16(_mm_unpacklo_epi8(col2, zero), fac_v);
+      const __m128i hi = simd_scale_by_alpha_u16(_mm_unpackhi_epi8(col2, zero), fac_v);
+      const __m128i add = _mm_and_si128(_mm_packus_epi16(lo, hi), rgb_mask);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(rt), _mm_adds_epu8(col1, add));
+      cp1 += 16;
+      cp2 += 16;
+      rt += 16;
     }
   }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const int temp_fac2 = temp_fac * int(cp2[3]);
+    rt[0] = min_ii(cp1[0] + ((temp_fac2 * cp2[0]) >> 16), 255);
+    rt[1] = min_ii(cp1[1] + ((temp_fac2 * cp2[1]) >> 16), 255);
+    rt[2] = min_ii(cp1[2] + ((temp_fac2 * cp2[2]) >> 16), 255);
+    rt[3] = cp1[3];
+
+    cp1 += 4;
+    cp2 += 4;
+    rt += 4;
+  }
 }
 
-static void do_add_effect_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
+void seq_effect_add_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
 {
   float *rt1 = rect1;
   float *rt2 = rect2;
   float *rt = out;
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      const float temp_fac = (1.0f - (rt1[3] * (1.0f - fac))) * rt2[3];
-      rt[0] = rt1[0] + temp_fac * rt2[0];
-      rt[1] = rt1[1] + temp_fac * rt2[1];
-      rt[2] = rt1[2] + temp_fac * rt2[2];
-      rt[3] = rt1[3];
+  const int64_t pixels_num = int64_t(x) * y;
+  for (int64_t i = 0; i < pixels_num; i++) {
+    const float temp_fac = (1.0f - (rt1[3] * (1.0f - fac))) * rt2[3];
+#if BLI_HAVE_SSE2
+    const __m128 col1 = _mm_loadu_ps(rt1);
+    const __m128 col2 = _mm_loadu_ps(rt2);
+    const __m128 col = _mm_add_ps(col1, _mm_mul_ps(_mm_set1_ps(temp_fac), col2));
+    _mm_storeu_ps(rt, simd_with_alpha(col, col1));
+#else
+    rt[0] = rt1[0] + temp_fac * rt2[0];
+    rt[1] = rt1[1] + temp_fac * rt2[1];
+    rt[2] = rt1[2] + temp_fac * rt2[2];
+    rt[3] = rt1[3];
+#endif
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
   }
 }
 
@@ -608,7 +732,7 @@ static void do_add_effect(const SeqRenderData *context,
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_add_effect_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_add_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
   else {
     uchar *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
@@ -616,7 +740,7 @@ static void do_add_effect(const SeqRenderData *context,
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_add_effect_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_add_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
 }
 
@@ -626,7 +750,7 @@ static void do_add_effect(const SeqRenderData *context,
 /** \name Color Subtract Effect
  * \{ */
 
-static void do_sub_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
+void seq_effect_sub_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
 {
   uchar *cp1 = rect1;
   uchar *cp2 = rect2;
@@ -634,22 +758,42 @@ static void do_sub_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rec
 
   int temp_fac = int(256.0f * fac);
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      const int temp_fac2 = temp_fac * int(cp2[3]);
-      rt[0] = max_ii(cp1[0] - ((temp_fac2 * cp2[0]) >> 16), 0);
-      rt[1] = max_ii(cp1[1] - ((temp_fac2 * cp2[1]) >> 16), 0);
-      rt[2] = max_ii(cp1[2] - ((temp_fac2 * cp2[2]) >> 16), 0);
-      rt[3] = cp1[3];
-
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
+  const int64_t pixels_num = int64_t(x) * y;
+  int64_t i = 0;
+
+#if BLI_HAVE_SSE2
+  if (temp_fac >= 0 && temp_fac <= 256) {
+    const __m128i fac_v = _mm_set1_epi16(short(temp_fac));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+    for (; i + 4 <= pixels_num; i += 4) {
+      const __m128i col1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cp1));
+      const __m128i col2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cp2));
+      const __m128i lo = simd_scale_by_alpha_u16(_mm_unpacklo_epi8(col2, zero), fac_v);
+      const __m128i hi = simd_scale_by_alpha_u16(_mm_unpackhi_epi8(col2, zero), fac_v);
+      const __m128i sub = _mm_and_si128(_mm_packus_epi16(lo, hi), rgb_mask);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(rt), _mm_subs_epu8(col1, sub));
+      cp1 += 16;
+      cp2 += 16;
+      rt += 16;
     }
   }
+#endif
+
+  for (; i < pixels_num; i++) {
+    const int temp_fac2 = temp_fac * int(cp2[3]);
+    rt[0] = max_ii(cp1[0] - ((temp_fac2 * cp2[0]) >> 16), 0);
+    rt[1] = max_ii(cp1[1] - ((temp_fac2 * cp2[1]) >> 16), 0);
+    rt[2] = max_ii(cp1[2] - ((temp_fac2 * cp2[2]) >> 16), 0);
+    rt[3] = cp1[3];
+
+    cp1 += 4;
+    cp2 += 4;
+    rt += 4;
+  }
 }
 
-static void do_sub_effect_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
+void seq_effect_sub_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
 {
   float *rt1 = rect1;
   float *rt2 = rect2;
@@ -657,18 +801,25 @@ static void do_sub_effect_float(float fac, int x, int y, float *rect1, float *re
 
   float mfac = 1.0f - fac;
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      const float temp_fac = (1.0f - (rt1[3] * mfac)) * rt2[3];
-      rt[0] = max_ff(rt1[0] - temp_fac * rt2[0], 0.0f);
-      rt[1] = max_ff(rt1[1] - temp_fac * rt2[1], 0.0f);
-      rt[2] = max_ff(rt1[2] - temp_fac * rt2[2], 0.0f);
-      rt[3] = rt1[3];
+  const int64_t pixels_num = int64_t(x) * y;
+  for (int64_t i = 0; i < pixels_num; i++) {
+    const float temp_fac = (1.0f - (rt1[3] * mfac)) * rt2[3];
+#if BLI_HAVE_SSE2
+    const __m128 col1 = _mm_loadu_ps(rt1);
+    const __m128 col2 = _mm_loadu_ps(rt2);
+    const __m128 col = _mm_max_ps(_mm_sub_ps(col1, _mm_mul_ps(_mm_set1_ps(temp_fac), col2)),
+                                  _mm_setzero_ps());
+    _mm_storeu_ps(rt, simd_with_alpha(col, col1));
+#else
+    rt[0] = max_ff(rt1[0] - temp_fac * rt2[0], 0.0f);
+    rt[1] = max_ff(rt1[1] - temp_fac * rt2[1], 0.0f);
+    rt[2] = max_ff(rt1[2] - temp_fac * rt2[2], 0.0f);
+    rt[3] = rt1[3];
+#endif
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
   }
 }
 
@@ -689,7 +840,7 @@ static void do_sub_effect(const SeqRenderData *context,
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_sub_effect_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_sub_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
   else {
     uchar *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
@@ -697,7 +848,7 @@ static void do_sub_effect(const SeqRenderData *context,
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_sub_effect_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_sub_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
 }
 
@@ -711,7 +862,7 @@ static void do_sub_effect(const SeqRenderData *context,
 #define XOFF 8
 #define YOFF 8
 
-static void do_drop_effect_byte(float fac, int x, int y, uchar *rect2i, uchar *rect1i, uchar *outi)
+void seq_effect_drop_byte(float fac, int x, int y, uchar *rect2i, uchar *rect1i, uchar *outi)
 {
   const int xoff = min_ii(XOFF, x);
   const int yoff = min_ii(YOFF, y);
@@ -726,7 +877,27 @@ static void do_drop_effect_byte(float fac, int x, int y, uchar *rect2i, uchar *r
     rt1 += xoff * 4;
     out += xoff * 4;
 
-    for (int j = xoff; j < x; j++) {
+    int j = xoff;
+#if BLI_HAVE_SSE2
+    if (temp_fac >= 0 && temp_fac <= 256) {
+      const __m128i fac_v = _mm_set1_epi16(short(temp_fac));
+      const __m128i zero = _mm_setzero_si128();
+      for (; j + 4 <= x; j += 4) {
+        const __m128i col1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rt1));
+        const __m128i col2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rt2));
+        const __m128i lo = _mm_srli_epi16(
+            _mm_mullo_epi16(simd_splat_alpha_u16(_mm_unpacklo_epi8(col2, zero)), fac_v), 8);
+        const __m128i hi = _mm_srli_epi16(
+            _mm_mullo_epi16(simd_splat_alpha_u16(_mm_unpackhi_epi8(col2, zero)), fac_v), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                         _mm_subs_epu8(col1, _mm_packus_epi16(lo, hi)));
+        rt1 += 16;
+        rt2 += 16;
+        out += 16;
+      }
+    }
+#endif
+    for (; j < x; j++) {
       int temp_fac2 = ((temp_fac * rt2[3]) >> 8);
 
       *(out++) = std::max(0, *rt1 - temp_fac2);
@@ -744,8 +915,7 @@ static void do_drop_effect_byte(float fac, int x, int y, uchar *rect2i, uchar *r
   memcpy(out, rt1, sizeof(*out) * yoff * 4 * x);
 }
 
-static void do_drop_effect_float(
-    float fac, int x, int y, float *rect2i, float *rect1i, float *outi)
+void seq_effect_drop_float(float fac, int x, int y, float *rect2i, float *rect1i, float *outi)
 {
   const int xoff = min_ii(XOFF, x);
   const int yoff = min_ii(YOFF, y);
@@ -763,6 +933,12 @@ static void do_drop_effect_float(
     for (int j = xoff; j < x; j++) {
       float temp_fac2 = temp_fac * rt2[3];
 
+#if BLI_HAVE_SSE2
+      const __m128 col = _mm_sub_ps(_mm_loadu_ps(rt1), _mm_set1_ps(temp_fac2));
+      _mm_storeu_ps(out, _mm_max_ps(col, _mm_setzero_ps()));
+      out += 4;
+      rt1 += 4;
+#else
       *(out++) = std::max(0.0f, *rt1 - temp_fac2);
       rt1++;
       *(out++) = std::max(0.0f, *rt1 - temp_fac2);
@@ -771,6 +947,7 @@ static void do_drop_effect_float(
       rt1++;
       *(out++) = std::max(0.0f, *rt1 - temp_fac2);
       rt1++;
+#endif
       rt2 += 4;
     }
     rt2 += xoff * 4;
@@ -784,7 +961,7 @@ static void do_drop_effect_float(
 /** \name Multiply Effect
  * \{ */
 
-static void do_mul_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
+void seq_effect_mul_byte(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out)
 {
   uchar *rt1 = rect1;
   uchar *rt2 = rect2;
@@ -796,21 +973,52 @@ static void do_mul_effect_byte(float fac, int x, int y, uchar *rect1, uchar *rec
    * `fac * (a * b) + (1 - fac) * a => fac * a * (b - 1) + axaux = c * px + py * s;` // + centx
    * `yaux = -s * px + c * py;` // + centy */
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      rt[0] = rt1[0] + ((temp_fac * rt1[0] * (rt2[0] - 255)) >> 16);
-      rt[1] = rt1[1] + ((temp_fac * rt1[1] * (rt2[1] - 255)) >> 16);
-      rt[2] = rt1[2] + ((temp_fac * rt1[2] * (rt2[2] - 255)) >> 16);
-      rt[3] = rt1[3] + ((temp_fac * rt1[3] * (rt2[3] - 255)) >> 16);
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
+  const int64_t pixels_num = int64_t(x) * y;
+  int64_t i = 0;
+
+#if BLI_HAVE_SSE2
+  /* With `p = fac * a` and `q = 255 - b` the result is `a - ceil(p * q / 65536)`, which is
+   * computed from the high and low 16 bits of the product. */
+  if (temp_fac >= 0 && temp_fac <= 256) {
+    const __m128i fac_v = _mm_set1_epi16(short(temp_fac));
+    const __m128i max_v = _mm_set1_epi16(255);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    auto mul_u16 = [&](const __m128i col1, const __m128i col2) {
+      const __m128i p = _mm_mullo_epi16(fac_v, col1);
+      const __m128i q = _mm_sub_epi16(max_v, col2);
+      const __m128i product_hi = _mm_mulhi_epu16(p, q);
+      const __m128i product_lo = _mm_mullo_epi16(p, q);
+      const __m128i product_ceil = _mm_add_epi16(
+          product_hi, _mm_add_epi16(one, _mm_cmpeq_epi16(product_lo, zero)));
+      return _mm_sub_epi16(col1, product_ceil);
+    };
+    for (; i + 4 <= pixels_num; i += 4) {
+      const __m128i col1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rt1));
+      const __m128i col2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rt2));
+      const __m128i lo = mul_u16(_mm_unpacklo_epi8(col1, zero), _mm_unpacklo_epi8(col2, zero));
+      const __m128i hi = mul_u16(_mm_unpackhi_epi8(col1, zero), _mm_unpackhi_epi8(col2, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(rt), _mm_packus_epi16(lo, hi));
+      rt1 += 16;
+      rt2 += 16;
+      rt += 16;
     }
   }
+#endif
+
+  for (; i < pixels_num; i++) {
+    rt[0] = rt1[0] + ((temp_fac * rt1[0] * (rt2[0] - 255)) >> 16);
+    rt[1] = rt1[1] + ((temp_fac * rt1[1] * (rt2[1] - 255)) >> 16);
+    rt[2] = rt1[2] + ((temp_fac * rt1[2] * (rt2[2] - 255)) >> 16);
+    rt[3] = rt1[3] + ((temp_fac * rt1[3] * (rt2[3] - 255)) >> 16);
+
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
 }
 
-static void do_mul_effect_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
+void seq_effect_mul_float(float fac, int x, int y, float *rect1, float *rect2, float *out)
 {
   float *rt1 = rect1;
   float *rt2 = rect2;
@@ -819,17 +1027,25 @@ static void do_mul_effect_float(float fac, int x, int y, float *rect1, float *re
   /* Formula:
    * `fac * (a * b) + (1 - fac) * a => fac * a * (b - 1) + a`. */
 
-  for (int i = 0; i < y; i++) {
-    for (int j = 0; j < x; j++) {
-      rt[0] = rt1[0] + fac * rt1[0] * (rt2[0] - 1.0f);
-      rt[1] = rt1[1] + fac * rt1[1] * (rt2[1] - 1.0f);
-      rt[2] = rt1[2] + fac * rt1[2] * (rt2[2] - 1.0f);
-      rt[3] = rt1[3] + fac * rt1[3] * (rt2[3] - 1.0f);
+  const int64_t pixels_num = int64_t(x) * y;
+  for (int64_t i = 0; i < pixels_num; i++) {
+#if BLI_HAVE_SSE2
+    const __m128 col1 = _mm_loadu_ps(rt1);
+    const __m128 col2 = _mm_loadu_ps(rt2);
+    _mm_storeu_ps(rt,
+                  _mm_add_ps(col1,
+                             _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(fac), col1),
+                                        _mm_sub_ps(col2, _mm_set1_ps(1.0f)))));
+#else
+    rt[0] = rt1[0] + fac * rt1[0] * (rt2[0] - 1.0f);
+    rt[1] = rt1[1] + fac * rt1[1] * (rt2[1] - 1.0f);
+    rt[2] = rt1[2] + fac * rt1[2] * (rt2[2] - 1.0f);
+    rt[3] = rt1[3] + fac * rt1[3] * (rt2[3] - 1.0f);
+#endif
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
   }
 }
 
@@ -850,7 +1066,7 @@ static void do_mul_effect(const SeqRenderData *context,
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_mul_effect_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_mul_float(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
   else {
     uchar *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
@@ -858,7 +1074,7 @@ static void do_mul_effect(const SeqRenderData *context,
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_mul_effect_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
+    seq_effect_mul_byte(fac, context->rectx, total_lines, rect1, rect2, rect_out);
   }
 }
 
@@ -887,9 +1103,193 @@ static void apply_blend_function(
   }
 }
 
-static void do_blend_effect_float(
+#if BLI_HAVE_SSE2
+/* Vectorized #apply_blend_function for float buffers. The blend function gets both pixels and the
+ * alpha of `src2` multiplied by the effect factor, and returns the blended color. Alpha is always
+ * taken from `src1`. Expressions match #BLI_math_color_blend.h operation for operation. */
+template<typename Func>
+static void apply_blend_function_simd(float fac,
+                                      int width,
+                                      int height,
+                                      const float *src1,
+                                      const float *src2,
+                                      float *dst,
+                                      Func blend_function)
+{
+  const int64_t pixels_num = int64_t(width) * height;
+  for (int64_t i = 0; i < pixels_num; i++) {
+    const float t = src2[3] * fac;
+    const __m128 col1 = _mm_loadu_ps(src1);
+    if (t == 0.0f) {
+      _mm_storeu_ps(dst, col1);
+    }
+    else {
+      const __m128 col = blend_function(col1, _mm_loadu_ps(src2), t);
+      _mm_storeu_ps(dst, simd_with_alpha(col, col1));
+    }
+    src1 += 4;
+    src2 += 4;
+    dst += 4;
+  }
+}
+
+/* `temp * t + src1 * (1 - t)`, how most blend modes mix their result with the first input. */
+static __m128 blend_mix_simd(const __m128 temp, const __m128 src1, const float t)
+{
+  return _mm_add_ps(_mm_mul_ps(temp, _mm_set1_ps(t)), _mm_mul_ps(src1, _mm_set1_ps(1.0f - t)));
+}
+
+/** \return False if there is no vectorized version of the blend mode. */
+static bool do_blend_effect_float_simd(
+    float fac, int x, int y, const float *rect1, const float *rect2, int btype, float *out)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+
+  switch (btype) {
+    case SEQ_TYPE_ADD:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float) {
+        return _mm_add_ps(s1, _mm_mul_ps(s2, simd_splat_alpha(s1)));
+      });
+      return true;
+    case SEQ_TYPE_SUB:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float) {
+        return _mm_max_ps(_mm_sub_ps(s1, _mm_mul_ps(s2, simd_splat_alpha(s1))), zero);
+      });
+      return true;
+    case SEQ_TYPE_MUL:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.0f - t), s1),
+                          _mm_mul_ps(_mm_mul_ps(s1, s2), simd_splat_alpha(s1)));
+      });
+      return true;
+    case SEQ_TYPE_DARKEN:
+    case SEQ_TYPE_LIGHTEN: {
+      const bool is_darken = btype == SEQ_TYPE_DARKEN;
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 map_alpha = _mm_div_ps(simd_splat_alpha(s1), _mm_set1_ps(t));
+        const __m128 s2_mapped = _mm_mul_ps(s2, map_alpha);
+        const __m128 temp = is_darken ? _mm_min_ps(s1, s2_mapped) : _mm_max_ps(s1, s2_mapped);
+        return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.0f - t), s1),
+                          _mm_mul_ps(_mm_set1_ps(t), temp));
+      });
+      return true;
+    }
+    case SEQ_TYPE_COLOR_BURN:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 burn = _mm_max_ps(_mm_sub_ps(one, _mm_div_ps(_mm_sub_ps(one, s1), s2)), zero);
+        return blend_mix_simd(simd_select(_mm_cmpeq_ps(s2, zero), zero, burn), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_LINEAR_BURN:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        return blend_mix_simd(_mm_max_ps(_mm_sub_ps(_mm_add_ps(s1, s2), one), zero), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_SCREEN:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 screen = _mm_sub_ps(
+            one, _mm_mul_ps(_mm_sub_ps(one, s1), _mm_sub_ps(one, s2)));
+        return blend_mix_simd(_mm_max_ps(screen, zero), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_DODGE:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 dodge = _mm_min_ps(_mm_div_ps(s1, _mm_sub_ps(one, s2)), one);
+        return blend_mix_simd(simd_select(_mm_cmpge_ps(s2, one), one, dodge), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_OVERLAY:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 bright = _mm_sub_ps(
+            one,
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_sub_ps(s1, half))),
+                       _mm_sub_ps(one, s2)));
+        const __m128 dark = _mm_mul_ps(_mm_mul_ps(two, s1), s2);
+        const __m128 temp = simd_select(_mm_cmpgt_ps(s1, half), bright, dark);
+        return _mm_min_ps(blend_mix_simd(temp, s1, t), one);
+      });
+      return true;
+    case SEQ_TYPE_SOFT_LIGHT:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 s1_inv = _mm_sub_ps(one, s1);
+        const __m128 screen = _mm_sub_ps(one, _mm_mul_ps(s1_inv, _mm_sub_ps(one, s2)));
+        const __m128 soft_light = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(s1_inv, s2), screen), s1);
+        return blend_mix_simd(soft_light, s1, t);
+      });
+      return true;
+    case SEQ_TYPE_HARD_LIGHT:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 bright = _mm_sub_ps(
+            one,
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_sub_ps(s2, half))),
+                       _mm_sub_ps(one, s1)));
+        const __m128 dark = _mm_mul_ps(_mm_mul_ps(two, s2), s1);
+        const __m128 temp = simd_select(_mm_cmpgt_ps(s2, half), bright, dark);
+        return _mm_min_ps(blend_mix_simd(temp, s1, t), one);
+      });
+      return true;
+    case SEQ_TYPE_PIN_LIGHT:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 bright = _mm_max_ps(_mm_mul_ps(two, _mm_sub_ps(s2, half)), s1);
+        const __m128 dark = _mm_min_ps(_mm_mul_ps(two, s2), s1);
+        return blend_mix_simd(simd_select(_mm_cmpgt_ps(s2, half), bright, dark), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_LIN_LIGHT:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 bright = _mm_min_ps(
+            _mm_add_ps(s1, _mm_mul_ps(two, _mm_sub_ps(s2, half))), one);
+        const __m128 dark = _mm_max_ps(_mm_sub_ps(_mm_add_ps(s1, _mm_mul_ps(two, s2)), one),
+                                       zero);
+        return blend_mix_simd(simd_select(_mm_cmpgt_ps(s2, half), bright, dark), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_VIVID_LIGHT:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 bright = _mm_min_ps(
+            _mm_div_ps(_mm_mul_ps(s1, one), _mm_mul_ps(two, _mm_sub_ps(one, s2))), one);
+        const __m128 dark = _mm_max_ps(
+            _mm_sub_ps(one, _mm_div_ps(_mm_mul_ps(_mm_sub_ps(one, s1), one), _mm_mul_ps(two, s2))),
+            zero);
+        __m128 temp = simd_select(_mm_cmpgt_ps(s2, half), bright, dark);
+        temp = simd_select(
+            _mm_cmpeq_ps(s2, zero), simd_select(_mm_cmpeq_ps(s1, one), half, zero), temp);
+        temp = simd_select(
+            _mm_cmpeq_ps(s2, one), simd_select(_mm_cmpeq_ps(s1, zero), half, one), temp);
+        return blend_mix_simd(temp, s1, t);
+      });
+      return true;
+    case SEQ_TYPE_DIFFERENCE:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        return blend_mix_simd(simd_abs(_mm_sub_ps(s1, s2)), s1, t);
+      });
+      return true;
+    case SEQ_TYPE_EXCLUSION:
+      apply_blend_function_simd(fac, x, y, rect1, rect2, out, [&](__m128 s1, __m128 s2, float t) {
+        const __m128 temp = _mm_sub_ps(
+            half, _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(s1, half)), _mm_sub_ps(s2, half)));
+        return blend_mix_simd(temp, s1, t);
+      });
+      return true;
+    default:
+      /* Modes working in HSV space. */
+      return false;
+  }
+}
+#endif
+
+void seq_effect_blend_float(
     float fac, int x, int y, const float *rect1, float *rect2, int btype, float *out)
 {
+#if BLI_HAVE_SSE2
+  if (do_blend_effect_float_simd(fac, x, y, rect1, rect2, btype, out)) {
+    return;
+  }
+#endif
+
   switch (btype) {
     case SEQ_TYPE_ADD:
       apply_blend_function(fac, x, y, rect1, rect2, out, blend_color_add_float);
@@ -959,7 +1359,7 @@ static void do_blend_effect_float(
   }
 }
 
-static void do_blend_effect_byte(
+void seq_effect_blend_byte(
     float fac, int x, int y, uchar *rect1, uchar *rect2, int btype, uchar *out)
 {
   switch (btype) {
@@ -1046,14 +1446,14 @@ static void do_blend_mode_effect(const SeqRenderData *context,
     float *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
-    do_blend_effect_float(
+    seq_effect_blend_float(
         fac, context->rectx, total_lines, rect1, rect2, seq->blend_mode, rect_out);
   }
   else {
     uchar *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
-    do_blend_effect_byte(
+    seq_effect_blend_byte(
         fac, context->rectx, total_lines, rect1, rect2, seq->blend_mode, rect_out);
   }
 }
@@ -1097,14 +1497,14 @@ static void do_colormix_effect(const SeqRenderData *context,
     float *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
-    do_blend_effect_float(
+    seq_effect_blend_float(
         fac, context->rectx, total_lines, rect1, rect2, data->blend_effect, rect_out);
   }
   else {
     uchar *rect1 = nullptr, *rect2 = nullptr, *rect_out = nullptr;
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
-    do_blend_effect_byte(
+    seq_effect_blend_byte(
         fac, context->rectx, total_lines, rect1, rect2, data->blend_effect, rect_out);
   }
 }
@@ -2339,7 +2739,7 @@ static void do_overdrop_effect(const SeqRenderData *context,
     slice_get_float_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_drop_effect_float(fac, x, y, rect1, rect2, rect_out);
+    seq_effect_drop_float(fac, x, y, rect1, rect2, rect_out);
     do_alphaover_effect(fac, x, y, rect1, rect2, rect_out);
   }
   else {
@@ -2348,7 +2748,7 @@ static void do_overdrop_effect(const SeqRenderData *context,
     slice_get_byte_buffers(
         context, ibuf1, ibuf2, nullptr, out, start_line, &rect1, &rect2, nullptr, &rect_out);
 
-    do_drop_effect_byte(fac, x, y, rect1, rect2, rect_out);
+    seq_effect_drop_byte(fac, x, y, rect1, rect2, rect_out);
     do_alphaover_effect(fac, x, y, rect1, rect2, rect_out);
   }
 }
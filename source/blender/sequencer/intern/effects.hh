@@ -26,3 +26,40 @@ float seq_speed_effect_target_frame_get(Scene *scene,
                                         Sequence *seq,
                                         float timeline_frame,
                                         int input);
+/**
+ * Blend `rect2` over `rect1` with a blend mode (#SEQ_TYPE_SCREEN, #SEQ_TYPE_OVERLAY, ...), the
+ * way the blend mode and color mix effects do. Float buffers are premultiplied, byte buffers
+ * straight. The alpha of `rect2` is changed while blending and restored afterwards.
+ */
+void seq_effect_blend_float(
+    float fac, int x, int y, const float *rect1, float *rect2, int btype, float *out);
+void seq_effect_blend_byte(float fac,
+                           int x,
+                           int y,
+                           unsigned char *rect1,
+                           unsigned char *rect2,
+                           int btype,
+                           unsigned char *out);
+
+/**
+ * Kernels of the cross, add, subtract and multiply effects, mixing `rect2` into `rect1` for
+ * `x * y` pixels.
+ */
+void seq_effect_cross_float(float fac, int x, int y, float *rect1, float *rect2, float *out);
+void seq_effect_cross_byte(
+    float fac, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out);
+void seq_effect_add_float(float fac, int x, int y, float *rect1, float *rect2, float *out);
+void seq_effect_add_byte(
+    float fac, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out);
+void seq_effect_sub_float(float fac, int x, int y, float *rect1, float *rect2, float *out);
+void seq_effect_sub_byte(
+    float fac, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out);
+void seq_effect_mul_float(float fac, int x, int y, float *rect1, float *rect2, float *out);
+void seq_effect_mul_byte(
+    float fac, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out);
+/**
+ * Darken `rect1i` with a shadow cast by the alpha of `rect2i`, offset by a few pixels.
+ */
+void seq_effect_drop_float(float fac, int x, int y, float *rect2i, float *rect1i, float *outi);
+void seq_effect_drop_byte(
+    float fac, int x, int y, unsigned char *rect2i, unsigned char *rect1i, unsigned char *outi);
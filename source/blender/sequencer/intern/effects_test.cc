@@ -0,0 +1,439 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_color_blend.h"
+#include "BLI_rand.hh"
+
+#include "DNA_sequence_types.h"
+
+#include "effects.hh"
+
+namespace blender::seq::tests {
+
+using BlendFloatFn = void (*)(float dst[4], const float src1[4], const float src2[4]);
+using BlendByteFn = void (*)(uchar dst[4], const uchar src1[4], const uchar src2[4]);
+
+struct BlendMode {
+  int type;
+  BlendFloatFn float_fn;
+  BlendByteFn byte_fn;
+};
+
+static const BlendMode all_blend_modes[] = {
+    {SEQ_TYPE_ADD, blend_color_add_float, blend_color_add_byte},
+    {SEQ_TYPE_SUB, blend_color_sub_float, blend_color_sub_byte},
+    {SEQ_TYPE_MUL, blend_color_mul_float, blend_color_mul_byte},
+    {SEQ_TYPE_DARKEN, blend_color_darken_float, blend_color_darken_byte},
+    {SEQ_TYPE_COLOR_BURN, blend_color_burn_float, blend_color_burn_byte},
+    {SEQ_TYPE_LINEAR_BURN, blend_color_linearburn_float, blend_color_linearburn_byte},
+    {SEQ_TYPE_SCREEN, blend_color_screen_float, blend_color_screen_byte},
+    {SEQ_TYPE_LIGHTEN, blend_color_lighten_float, blend_color_lighten_byte},
+    {SEQ_TYPE_DODGE, blend_color_dodge_float, blend_color_dodge_byte},
+    {SEQ_TYPE_OVERLAY, blend_color_overlay_float, blend_color_overlay_byte},
+    {SEQ_TYPE_SOFT_LIGHT, blend_color_softlight_float, blend_color_softlight_byte},
+    {SEQ_TYPE_HARD_LIGHT, blend_color_hardlight_float, blend_color_hardlight_byte},
+    {SEQ_TYPE_PIN_LIGHT, blend_color_pinlight_float, blend_color_pinlight_byte},
+    {SEQ_TYPE_LIN_LIGHT, blend_color_linearlight_float, blend_color_linearlight_byte},
+    {SEQ_TYPE_VIVID_LIGHT, blend_color_vividlight_float, blend_color_vividlight_byte},
+    {SEQ_TYPE_BLEND_COLOR, blend_color_color_float, blend_color_color_byte},
+    {SEQ_TYPE_HUE, blend_color_hue_float, blend_color_hue_byte},
+    {SEQ_TYPE_SATURATION, blend_color_saturation_float, blend_color_saturation_byte},
+    {SEQ_TYPE_VALUE, blend_color_luminosity_float, blend_color_luminosity_byte},
+    {SEQ_TYPE_DIFFERENCE, blend_color_difference_float, blend_color_difference_byte},
+    {SEQ_TYPE_EXCLUSION, blend_color_exclusion_float, blend_color_exclusion_byte},
+};
+
+static const float all_factors[] = {0.0f, 0.35f, 1.0f};
+
+/* Odd size, so vectorized loops processing several pixels at once also run their tails. */
+static constexpr int width = 13;
+static constexpr int height = 3;
+static constexpr int channels_num = width * height * 4;
+
+/* Per pixel blending with the scalar functions, what the effect did before it was vectorized. */
+template<typename T, typename Func>
+static void blend_reference(float fac, const T *src1, const T *src2, T *dst, Func blend_function)
+{
+  for (int i = 0; i < width * height; i++) {
+    T src2_pixel[4] = {src2[0], src2[1], src2[2], T(src2[3] * fac)};
+    blend_function(dst, src1, src2_pixel);
+    dst[3] = src1[3];
+    src1 += 4;
+    src2 += 4;
+    dst += 4;
+  }
+}
+
+/* Premultiplied colors, including the values blend modes treat specially. */
+static Array<float> create_float_pixels(RandomNumberGenerator &rng, const int pixels_num)
+{
+  const float special_values[] = {0.0f, 0.5f, 1.0f, 1.25f};
+  Array<float> pixels(pixels_num * 4);
+  for (int i = 0; i < pixels.size(); i += 4) {
+    const float alpha = (i / 4) % 3 == 0 ? 1.0f : rng.get_float();
+    for (int c = 0; c < 3; c++) {
+      pixels[i + c] = rng.get_int32(4) == 0 ? special_values[rng.get_int32(4)] :
+                                              rng.get_float() * alpha;
+    }
+    pixels[i + 3] = alpha;
+  }
+  return pixels;
+}
+
+static Array<uchar> create_byte_pixels(RandomNumberGenerator &rng, const int pixels_num)
+{
+  const uchar special_values[] = {0, 127, 128, 255};
+  Array<uchar> pixels(pixels_num * 4);
+  for (int i = 0; i < pixels.size(); i++) {
+    pixels[i] = rng.get_int32(4) == 0 ? special_values[rng.get_int32(4)] :
+                                        uchar(rng.get_int32(256));
+  }
+  return pixels;
+}
+
+TEST(sequencer_effects, blend_float_matches_scalar)
+{
+  RandomNumberGenerator rng(0);
+  Array<float> src1 = create_float_pixels(rng, width * height);
+  Array<float> src2 = create_float_pixels(rng, width * height);
+  const Array<float> src2_orig = src2;
+
+  for (const BlendMode &mode : all_blend_modes) {
+    for (const float fac : all_factors) {
+      Array<float> expected(channels_num);
+      Array<float> result(channels_num);
+      blend_reference(fac, src1.data(), src2.data(), expected.data(), mode.float_fn);
+      seq_effect_blend_float(
+          fac, width, height, src1.data(), src2.data(), mode.type, result.data());
+
+      for (int i = 0; i < channels_num; i++) {
+        EXPECT_EQ(result[i], expected[i])
+            << "blend mode " << mode.type << ", factor " << fac << ", channel " << i;
+      }
+      EXPECT_EQ(src2.as_span(), src2_orig.as_span());
+    }
+  }
+}
+
+TEST(sequencer_effects, blend_byte_matches_scalar)
+{
+  RandomNumberGenerator rng(0);
+  Array<uchar> src1 = create_byte_pixels(rng, width * height);
+  Array<uchar> src2 = create_byte_pixels(rng, width * height);
+  const Array<uchar> src2_orig = src2;
+
+  for (const BlendMode &mode : all_blend_modes) {
+    for (const float fac : all_factors) {
+      Array<uchar> expected(channels_num);
+      Array<uchar> result(channels_num);
+      blend_reference(fac, src1.data(), src2.data(), expected.data(), mode.byte_fn);
+      seq_effect_blend_byte(
+          fac, width, height, src1.data(), src2.data(), mode.type, result.data());
+
+      for (int i = 0; i < channels_num; i++) {
+        EXPECT_EQ(int(result[i]), int(expected[i]))
+            << "blend mode " << mode.type << ", factor " << fac << ", channel " << i;
+      }
+      EXPECT_EQ(src2.as_span(), src2_orig.as_span());
+    }
+  }
+}
+
+/* Scalar versions of the mix effects for a single pixel, as they were before being vectorized. */
+
+static void cross_float_pixel(float fac, const float *src1, const float *src2, float *dst)
+{
+  const float mfac = 1.0f - fac;
+  for (int c = 0; c < 4; c++) {
+    dst[c] = mfac * src1[c] + fac * src2[c];
+  }
+}
+
+static void cross_byte_pixel(float fac, const uchar *src1, const uchar *src2, uchar *dst)
+{
+  const int temp_fac = int(256.0f * fac);
+  const int temp_mfac = 256 - temp_fac;
+  for (int c = 0; c < 4; c++) {
+    dst[c] = (temp_mfac * src1[c] + temp_fac * src2[c]) >> 8;
+  }
+}
+
+static void add_float_pixel(float fac, const float *src1, const float *src2, float *dst)
+{
+  const float temp_fac = (1.0f - (src1[3] * (1.0f - fac))) * src2[3];
+  for (int c = 0; c < 3; c++) {
+    dst[c] = src1[c] + temp_fac * src2[c];
+  }
+  dst[3] = src1[3];
+}
+
+static void add_byte_pixel(float fac, const uchar *src1, const uchar *src2, uchar *dst)
+{
+  const int temp_fac2 = int(256.0f * fac) * int(src2[3]);
+  for (int c = 0; c < 3; c++) {
+    dst[c] = min_ii(src1[c] + ((temp_fac2 * src2[c]) >> 16), 255);
+  }
+  dst[3] = src1[3];
+}
+
+static void sub_float_pixel(float fac, const float *src1, const float *src2, float *dst)
+{
+  const float temp_fac = (1.0f - (src1[3] * (1.0f - fac))) * src2[3];
+  for (int c = 0; c < 3; c++) {
+    dst[c] = max_ff(src1[c] - temp_fac * src2[c], 0.0f);
+  }
+  dst[3] = src1[3];
+}
+
+static void sub_byte_pixel(float fac, const uchar *src1, const uchar *src2, uchar *dst)
+{
+  const int temp_fac2 = int(256.0f * fac) * int(src2[3]);
+  for (int c = 0; c < 3; c++) {
+    dst[c] = max_ii(src1[c] - ((temp_fac2 * src2[c]) >> 16), 0);
+  }
+  dst[3] = src1[3];
+}
+
+static void mul_float_pixel(float fac, const float *src1, const float *src2, float *dst)
+{
+  for (int c = 0; c < 4; c++) {
+    dst[c] = src1[c] + fac * src1[c] * (src2[c] - 1.0f);
+  }
+}
+
+static void mul_byte_pixel(float fac, const uchar *src1, const uchar *src2, uchar *dst)
+{
+  const int temp_fac = int(256.0f * fac);
+  for (int c = 0; c < 4; c++) {
+    dst[c] = src1[c] + ((temp_fac * src1[c] * (src2[c] - 255)) >> 16);
+  }
+}
+
+using MixFloatFn = void (*)(float fac, int x, int y, float *rect1, float *rect2, float *out);
+using MixByteFn = void (*)(float fac, int x, int y, uchar *rect1, uchar *rect2, uchar *out);
+using MixFloatPixelFn = void (*)(float fac, const float *src1, const float *src2, float *dst);
+using MixBytePixelFn = void (*)(float fac, const uchar *src1, const uchar *src2, uchar *dst);
+
+struct MixEffect {
+  const char *name;
+  MixFloatFn float_fn;
+  MixByteFn byte_fn;
+  MixFloatPixelFn float_pixel_fn;
+  MixBytePixelFn byte_pixel_fn;
+};
+
+static const MixEffect all_mix_effects[] = {
+    {"cross", seq_effect_cross_float, seq_effect_cross_byte, cross_float_pixel, cross_byte_pixel},
+    {"add", seq_effect_add_float, seq_effect_add_byte, add_float_pixel, add_byte_pixel},
+    {"sub", seq_effect_sub_float, seq_effect_sub_byte, sub_float_pixel, sub_byte_pixel},
+    {"mul", seq_effect_mul_float, seq_effect_mul_byte, mul_float_pixel, mul_byte_pixel},
+};
+
+struct ImageSize {
+  int x;
+  int y;
+};
+
+/* Odd widths run the tail loops after the pixels processed several at a time. The larger sizes
+ * exceed the offset of the drop effect, so that it casts a shadow. */
+static const ImageSize all_sizes[] = {{1, 1}, {3, 2}, {13, 3}, {11, 10}, {21, 17}};
+
+/* Offset of the shadow of the drop effect in both directions. */
+static constexpr int drop_offset = 8;
+
+template<typename T, typename Func>
+static void mix_reference(
+    float fac, const ImageSize size, const T *src1, const T *src2, T *dst, Func pixel_fn)
+{
+  for (int i = 0; i < size.x * size.y; i++) {
+    pixel_fn(fac, src1 + i * 4, src2 + i * 4, dst + i * 4);
+  }
+}
+
+/* Scalar drop effect. The shadow of a pixel is cast by the pixel of `shadow_src` that is
+ * `drop_offset` pixels to the left and below it. */
+template<typename T, typename Func>
+static void drop_reference(
+    const ImageSize size, const T *shadow_src, const T *src, T *dst, Func shadow_fn)
+{
+  const int xoff = std::min(drop_offset, size.x);
+  const int yoff = std::min(drop_offset, size.y);
+  for (int y = 0; y < size.y; y++) {
+    for (int x = 0; x < size.x; x++) {
+      const int i = (y * size.x + x) * 4;
+      if (y >= size.y - yoff || x < xoff) {
+        std::copy_n(src + i, 4, dst + i);
+        continue;
+      }
+      const T shadow_alpha = shadow_src[((y + yoff) * size.x + (x - xoff)) * 4 + 3];
+      for (int c = 0; c < 4; c++) {
+        dst[i + c] = shadow_fn(src[i + c], shadow_alpha);
+      }
+    }
+  }
+}
+
+TEST(sequencer_effects, mix_float_matches_scalar)
+{
+  RandomNumberGenerator rng(0);
+  for (const ImageSize size : all_sizes) {
+    const int pixels_num = size.x * size.y;
+    Array<float> src1 = create_float_pixels(rng, pixels_num);
+    Array<float> src2 = create_float_pixels(rng, pixels_num);
+
+    for (const MixEffect &effect : all_mix_effects) {
+      for (const float fac : all_factors) {
+        Array<float> expected(pixels_num * 4);
+        Array<float> result(pixels_num * 4);
+        mix_reference(fac, size, src1.data(), src2.data(), expected.data(), effect.float_pixel_fn);
+        effect.float_fn(fac, size.x, size.y, src1.data(), src2.data(), result.data());
+
+        for (const int i : result.index_range()) {
+          EXPECT_FLOAT_EQ(result[i], expected[i])
+              << effect.name << ", size " << size.x << "x" << size.y << ", factor " << fac
+              << ", channel " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(sequencer_effects, mix_byte_matches_scalar)
+{
+  RandomNumberGenerator rng(0);
+  for (const ImageSize size : all_sizes) {
+    const int pixels_num = size.x * size.y;
+    Array<uchar> src1 = create_byte_pixels(rng, pixels_num);
+    Array<uchar> src2 = create_byte_pixels(rng, pixels_num);
+
+    for (const MixEffect &effect : all_mix_effects) {
+      for (const float fac : all_factors) {
+        Array<uchar> expected(pixels_num * 4);
+        Array<uchar> result(pixels_num * 4);
+        mix_reference(fac, size, src1.data(), src2.data(), expected.data(), effect.byte_pixel_fn);
+        effect.byte_fn(fac, size.x, size.y, src1.data(), src2.data(), result.data());
+
+        for (const int i : result.index_range()) {
+          EXPECT_EQ(int(result[i]), int(expected[i]))
+              << effect.name << ", size " << size.x << "x" << size.y << ", factor " << fac
+              << ", channel " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(sequencer_effects, drop_float_matches_scalar)
+{
+  RandomNumberGenerator rng(0);
+  for (const ImageSize size : all_sizes) {
+    const int pixels_num = size.x * size.y;
+    Array<float> shadow_src = create_float_pixels(rng, pixels_num);
+    Array<float> src = create_float_pixels(rng, pixels_num);
+
+    for (const float fac : all_factors) {
+      Array<float> expected(pixels_num * 4);
+      Array<float> result(pixels_num * 4);
+      drop_reference(
+          size, shadow_src.data(), src.data(), expected.data(), [&](float value, float alpha) {
+            return std::max(0.0f, value - 70.0f * fac * alpha);
+          });
+      seq_effect_drop_float(fac, size.x, size.y, shadow_src.data(), src.data(), result.data());
+
+      for (const int i : result.index_range()) {
+        EXPECT_FLOAT_EQ(result[i], expected[i])
+            << "size " << size.x << "x" << size.y << ", factor " << fac << ", channel " << i;
+      }
+    }
+  }
+}
+
+TEST(sequencer_effects, drop_byte_matches_scalar)
+{
+  RandomNumberGenerator rng(0);
+  for (const ImageSize size : all_sizes) {
+    const int pixels_num = size.x * size.y;
+    Array<uchar> shadow_src = create_byte_pixels(rng, pixels_num);
+    Array<uchar> src = create_byte_pixels(rng, pixels_num);
+
+    for (const float fac : all_factors) {
+      const int temp_fac = int(70.0f * fac);
+      Array<uchar> expected(pixels_num * 4);
+      Array<uchar> result(pixels_num * 4);
+      drop_reference(
+          size, shadow_src.data(), src.data(), expected.data(), [&](uchar value, uchar alpha) {
+            return uchar(std::max(0, value - ((temp_fac * alpha) >> 8)));
+          });
+      seq_effect_drop_byte(fac, size.x, size.y, shadow_src.data(), src.data(), result.data());
+
+      for (const int i : result.index_range()) {
+        EXPECT_EQ(int(result[i]), int(expected[i]))
+            << "size " << size.x << "x" << size.y << ", factor " << fac << ", channel " << i;
+      }
+    }
+  }
+}
+
+}  // namespace blender::seq::tests
+
+/* Disable benchmark by default. */
+#if 0
+
+#  include "BLI_timeit.hh"
+
+namespace blender::seq::tests {
+
+TEST(sequencer_effects, benchmark_mix_effects)
+{
+  const ImageSize size = {1920, 1080};
+  const int pixels_num = size.x * size.y;
+  RandomNumberGenerator rng(0);
+  Array<float> float_src1 = create_float_pixels(rng, pixels_num);
+  Array<float> float_src2 = create_float_pixels(rng, pixels_num);
+  Array<float> float_result(pixels_num * 4);
+  Array<uchar> byte_src1 = create_byte_pixels(rng, pixels_num);
+  Array<uchar> byte_src2 = create_byte_pixels(rng, pixels_num);
+  Array<uchar> byte_result(pixels_num * 4);
+
+  for (const MixEffect &effect : all_mix_effects) {
+    {
+      SCOPED_TIMER(std::string(effect.name) + " float");
+      for ([[maybe_unused]] const int i : IndexRange(10)) {
+        effect.float_fn(
+            0.5f, size.x, size.y, float_src1.data(), float_src2.data(), float_result.data());
+      }
+    }
+    {
+      SCOPED_TIMER(std::string(effect.name) + " byte");
+      for ([[maybe_unused]] const int i : IndexRange(10)) {
+        effect.byte_fn(
+            0.5f, size.x, size.y, byte_src1.data(), byte_src2.data(), byte_result.data());
+      }
+    }
+  }
+  {
+    SCOPED_TIMER("drop float");
+    for ([[maybe_unused]] const int i : IndexRange(10)) {
+      seq_effect_drop_float(
+          0.5f, size.x, size.y, float_src1.data(), float_src2.data(), float_result.data());
+    }
+  }
+  {
+    SCOPED_TIMER("drop byte");
+    for ([[maybe_unused]] const int i : IndexRange(10)) {
+      seq_effect_drop_byte(
+          0.5f, size.x, size.y, byte_src1.data(), byte_src2.data(), byte_result.data());
+    }
+  }
+}
+
+}  // namespace blender::seq::tests
+
+#endif
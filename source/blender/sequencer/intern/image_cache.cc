@@ -21,8 +21,12 @@
 
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
+#include "BLI_hash.h"
 #include "BLI_mempool.h"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "atomic_ops.h"
 
 #include "BKE_main.hh"
 
@@ -59,23 +63,47 @@
  * entries one by one in reverse order to their creation.
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
+ *
+ * Locking: Entries are spread over several hash tables (shards). Looking up an image only locks
+ * the shard that contains it, so render and prefetch threads don't contend on a single lock.
+ * Adding and removing entries, linking and recycling lock the whole cache (#seq_cache_lock)
+ * and additionally the shard that is modified.
+ *
+ * Recycling uses the clock (second chance) algorithm: Permanent entries are kept in an array
+ * that the clock hand sweeps. Entries that were used since the hand passed them last time are
+ * skipped once. Only entries at the end of a chain are recycled, together with their chain.
  */
 
 #define THUMB_CACHE_LIMIT 5000
+#define SEQ_CACHE_SHARDS_NUM 16
 
-struct SeqCache {
-  Main *bmain;
+struct SeqCacheShard {
   GHash *hash;
+  ThreadMutex mutex;
+};
+
+struct SeqCache {
+  Main *bmain = nullptr;
+  SeqCacheShard shards[SEQ_CACHE_SHARDS_NUM];
   ThreadMutex iterator_mutex;
-  BLI_mempool *keys_pool;
-  BLI_mempool *items_pool;
-  SeqCacheKey *last_key;
-  SeqDiskCache *disk_cache;
-  int thumbnail_count;
+  BLI_mempool *keys_pool = nullptr;
+  BLI_mempool *items_pool = nullptr;
+  /* Last key stored by each render task, entries of one frame are linked in a chain. */
+  SeqCacheKey *last_key[SEQ_TASK_NUM] = {};
+  SeqDiskCache *disk_cache = nullptr;
+  int thumbnail_count = 0;
+
+  /* Permanent entries that are candidates for recycling, see #SeqCacheKey.clock_index. */
+  blender::Vector<SeqCacheKey *> clock_keys;
+  int64_t clock_hand = 0;
+
+  /* Updated atomically, lookups don't lock the cache. */
+  SeqCacheStatistics statistics = {};
 };
 
 struct SeqCacheItem {
   SeqCache *cache_owner;
+  SeqCacheKey *key;
   ImBuf *ibuf;
 };
 
@@ -125,6 +153,12 @@ static bool seq_cache_hashcmp(const void *a_, const void *b_)
           seq_cmp_render_data(&a->context, &b->context));
 }
 
+static SeqCacheShard &seq_cache_shard_get(SeqCache *cache, const SeqCacheKey *key)
+{
+  /* Mix the hash, its low bits hardly vary between keys. */
+  return cache->shards[BLI_hash_int(seq_cache_hashhash(key)) % SEQ_CACHE_SHARDS_NUM];
+}
+
 static float seq_cache_timeline_frame_to_frame_index(Scene *scene,
                                                      Sequence *seq,
                                                      float timeline_frame,
@@ -195,6 +229,64 @@ static void seq_cache_valfree(void *val)
   BLI_mempool_free(item->cache_owner->items_pool, item);
 }
 
+static void seq_cache_clock_add(SeqCache *cache, SeqCacheKey *key)
+{
+  key->clock_index = int(cache->clock_keys.append_and_get_index(key));
+}
+
+static void seq_cache_clock_remove(SeqCache *cache, SeqCacheKey *key)
+{
+  if (key->clock_index == -1) {
+    return;
+  }
+  SeqCacheKey *last_key = cache->clock_keys.last();
+  cache->clock_keys[key->clock_index] = last_key;
+  last_key->clock_index = key->clock_index;
+  cache->clock_keys.remove_last();
+  key->clock_index = -1;
+}
+
+static void seq_cache_last_keys_clear(SeqCache *cache)
+{
+  for (SeqCacheKey *&last_key : cache->last_key) {
+    last_key = nullptr;
+  }
+}
+
+/* Remove and free an entry, the cache must be locked. */
+static void seq_cache_remove(SeqCache *cache, SeqCacheKey *key)
+{
+  seq_cache_clock_remove(cache, key);
+  SeqCacheShard &shard = seq_cache_shard_get(cache, key);
+  BLI_mutex_lock(&shard.mutex);
+  BLI_ghash_remove(shard.hash, key, seq_cache_keyfree, seq_cache_valfree);
+  BLI_mutex_unlock(&shard.mutex);
+}
+
+static bool seq_cache_haskey(SeqCache *cache, const SeqCacheKey *key)
+{
+  SeqCacheShard &shard = seq_cache_shard_get(cache, key);
+  BLI_mutex_lock(&shard.mutex);
+  const bool haskey = BLI_ghash_haskey(shard.hash, key);
+  BLI_mutex_unlock(&shard.mutex);
+  return haskey;
+}
+
+/* Call `fn` for every entry, `fn` may remove the entry. The cache must be locked. */
+template<typename Fn> static void seq_cache_foreach_key(SeqCache *cache, const Fn &fn)
+{
+  for (SeqCacheShard &shard : cache->shards) {
+    GHashIterator gh_iter;
+    BLI_ghashIterator_init(&gh_iter, shard.hash);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
+      BLI_ghashIterator_step(&gh_iter);
+      BLI_assert(key->cache_owner == cache);
+      fn(key);
+    }
+  }
+}
+
 static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
 {
   int flag;
@@ -217,6 +309,7 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   SeqCacheItem *item;
   item = static_cast<SeqCacheItem *>(BLI_mempool_alloc(cache->items_pool));
   item->cache_owner = cache;
+  item->key = key;
   item->ibuf = ibuf;
 
   const int stored_types_flag = get_stored_types_flag(scene, key);
@@ -224,44 +317,57 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   /* Item stored for later use. */
   if (stored_types_flag & key->type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = cache->last_key[key->task_id];
   }
 
-  BLI_assert(!BLI_ghash_haskey(cache->hash, key));
-  BLI_ghash_insert(cache->hash, key, item);
   IMB_refImBuf(ibuf);
+  SeqCacheShard &shard = seq_cache_shard_get(cache, key);
+  BLI_mutex_lock(&shard.mutex);
+  BLI_assert(!BLI_ghash_haskey(shard.hash, key));
+  BLI_ghash_insert(shard.hash, key, item);
+  BLI_mutex_unlock(&shard.mutex);
+
+  if (!key->is_temp_cache) {
+    seq_cache_clock_add(cache, key);
+  }
 
   /* Store pointer to last cached key. */
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = cache->last_key[key->task_id];
 
   if (!key->is_temp_cache || key->type != SEQ_CACHE_STORE_THUMBNAIL) {
-    cache->last_key = key;
+    cache->last_key[key->task_id] = key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
    * Item is already put in cache, so cache->last_key points to current key.
    */
   if (!key->is_temp_cache && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = cache->last_key[key->task_id];
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = nullptr;
+    cache->last_key[key->task_id] = nullptr;
   }
 }
 
+/* Doesn't require the cache to be locked. */
 static ImBuf *seq_cache_get_ex(SeqCache *cache, SeqCacheKey *key)
 {
-  SeqCacheItem *item = static_cast<SeqCacheItem *>(BLI_ghash_lookup(cache->hash, key));
+  SeqCacheShard &shard = seq_cache_shard_get(cache, key);
+  ImBuf *ibuf = nullptr;
 
+  BLI_mutex_lock(&shard.mutex);
+  SeqCacheItem *item = static_cast<SeqCacheItem *>(BLI_ghash_lookup(shard.hash, key));
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
-
-    return item->ibuf;
+    atomic_fetch_and_or_uint8(&item->key->clock_referenced, 1);
+    ibuf = item->ibuf;
   }
+  BLI_mutex_unlock(&shard.mutex);
 
-  return nullptr;
+  atomic_add_and_fetch_uint64(ibuf ? &cache->statistics.hits : &cache->statistics.misses, 1);
+  return ibuf;
 }
 
 static void seq_cache_key_unlink(SeqCacheKey *key)
@@ -276,80 +382,19 @@ static void seq_cache_key_unlink(SeqCacheKey *key)
   }
 }
 
-/* Choose a key out of 2 candidates(leftmost and rightmost items)
- * to recycle based on currently used strategy */
-static SeqCacheKey *seq_cache_choose_key(Scene *scene, SeqCacheKey *lkey, SeqCacheKey *rkey)
-{
-  SeqCacheKey *finalkey = nullptr;
-
-  /* Ideally, cache would not need to check the state of prefetching task
-   * that is tricky to do however, because prefetch would need to know,
-   * if a key, that is about to be created would be removed by itself.
-   *
-   * This can happen because only FINAL_OUT item insertion will trigger recycling
-   * but that is also the point, where prefetch can be suspended.
-   *
-   * We could use temp cache as a shield and later make it a non-temporary entry,
-   * but it is not worth of increasing system complexity.
-   */
-  if (scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE && seq_prefetch_job_is_running(scene)) {
-    int pfjob_start, pfjob_end;
-    seq_prefetch_get_time_range(scene, &pfjob_start, &pfjob_end);
-
-    if (lkey) {
-      if (lkey->timeline_frame < pfjob_start || lkey->timeline_frame > pfjob_end) {
-        return lkey;
-      }
-    }
-
-    if (rkey) {
-      if (rkey->timeline_frame < pfjob_start || rkey->timeline_frame > pfjob_end) {
-        return rkey;
-      }
-    }
-
-    return nullptr;
-  }
-
-  if (rkey && lkey) {
-    if (lkey->timeline_frame > rkey->timeline_frame) {
-      SeqCacheKey *swapkey = lkey;
-      lkey = rkey;
-      rkey = swapkey;
-    }
-
-    int l_diff = scene->r.cfra - lkey->timeline_frame;
-    int r_diff = rkey->timeline_frame - scene->r.cfra;
-
-    if (l_diff > r_diff) {
-      finalkey = lkey;
-    }
-    else {
-      finalkey = rkey;
-    }
-  }
-  else {
-    if (lkey) {
-      finalkey = lkey;
-    }
-    else {
-      finalkey = rkey;
-    }
-  }
-  return finalkey;
-}
-
-static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
+/* Returns the number of removed entries. */
+static int seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
   if (!cache) {
-    return;
+    return 0;
   }
 
   SeqCacheKey *next = base->link_next;
+  int removed_num = 0;
 
   while (base) {
-    if (!BLI_ghash_haskey(cache->hash, base)) {
+    if (!seq_cache_haskey(cache, base)) {
       break; /* Key has already been removed from cache. */
     }
 
@@ -361,14 +406,15 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
     }
 
     seq_cache_key_unlink(base);
-    BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
-    BLI_assert(base != cache->last_key);
+    seq_cache_remove(cache, base);
+    removed_num++;
+    BLI_assert(base != cache->last_key[base->task_id]);
     base = prev;
   }
 
   base = next;
   while (base) {
-    if (!BLI_ghash_haskey(cache->hash, base)) {
+    if (!seq_cache_haskey(cache, base)) {
       break; /* Key has already been removed from cache. */
     }
 
@@ -380,68 +426,63 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
     }
 
     seq_cache_key_unlink(base);
-    BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
-    BLI_assert(base != cache->last_key);
+    seq_cache_remove(cache, base);
+    removed_num++;
+    BLI_assert(base != cache->last_key[base->task_id]);
     base = next;
   }
+  return removed_num;
 }
 
 static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
-  SeqCacheKey *finalkey = nullptr;
-  /* Leftmost key. */
-  SeqCacheKey *lkey = nullptr;
-  /* Rightmost key. */
-  SeqCacheKey *rkey = nullptr;
-  SeqCacheKey *key = nullptr;
-
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  int total_count = 0;
-
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    SeqCacheItem *item = static_cast<SeqCacheItem *>(BLI_ghashIterator_getValue(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
+  blender::Vector<SeqCacheKey *> &keys = cache->clock_keys;
 
-    /* This shouldn't happen, but better be safe than sorry. */
-    if (!item->ibuf) {
-      seq_cache_recycle_linked(scene, key);
-      /* Can not continue iterating after linked remove. */
-      BLI_ghashIterator_init(&gh_iter, cache->hash);
-      continue;
+  /* Ideally, cache would not need to check the state of prefetching task
+   * that is tricky to do however, because prefetch would need to know,
+   * if a key, that is about to be created would be removed by itself.
+   *
+   * This can happen because only FINAL_OUT item insertion will trigger recycling
+   * but that is also the point, where prefetch can be suspended.
+   *
+   * We could use temp cache as a shield and later make it a non-temporary entry,
+   * but it is not worth of increasing system complexity.
+   */
+  int pfjob_start = 0, pfjob_end = -1;
+  if (scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE && seq_prefetch_job_is_running(scene)) {
+    seq_prefetch_get_time_range(scene, &pfjob_start, &pfjob_end);
+  }
+
+  /* Every entry is visited at most twice, the first visit may only clear its used flag. */
+  for (int64_t steps = keys.size() * 2; steps > 0 && !keys.is_empty(); steps--) {
+    if (cache->clock_hand >= keys.size()) {
+      cache->clock_hand = 0;
     }
+    SeqCacheKey *key = keys[cache->clock_hand];
+    BLI_assert(key->cache_owner == cache);
 
-    if (key->is_temp_cache || key->link_next != nullptr) {
+    /* Entries that became temporary are not candidates anymore. Removing moves the last entry to
+     * the current position, so don't advance. */
+    if (key->is_temp_cache) {
+      seq_cache_clock_remove(cache, key);
       continue;
     }
+    cache->clock_hand++;
 
-    total_count++;
-
-    if (lkey) {
-      if (key->timeline_frame < lkey->timeline_frame) {
-        lkey = key;
-      }
-    }
-    else {
-      lkey = key;
+    if (key->link_next != nullptr) {
+      continue;
     }
-    if (rkey) {
-      if (key->timeline_frame > rkey->timeline_frame) {
-        rkey = key;
-      }
+    if (key->timeline_frame >= pfjob_start && key->timeline_frame <= pfjob_end) {
+      continue;
     }
-    else {
-      rkey = key;
+    if (atomic_fetch_and_and_uint8(&key->clock_referenced, 0)) {
+      continue;
     }
+    return key;
   }
-  (void)total_count; /* Quiet set-but-unused warning (may be removed). */
 
-  finalkey = seq_cache_choose_key(scene, lkey, rkey);
-
-  return finalkey;
+  return nullptr;
 }
 
 bool seq_cache_recycle_item(Scene *scene)
@@ -457,7 +498,8 @@ bool seq_cache_recycle_item(Scene *scene)
     SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene);
 
     if (finalkey) {
-      seq_cache_recycle_linked(scene, finalkey);
+      const int removed_num = seq_cache_recycle_linked(scene, finalkey);
+      atomic_add_and_fetch_uint64(&cache->statistics.evictions, uint64_t(removed_num));
     }
     else {
       seq_cache_unlock(scene);
@@ -496,13 +538,14 @@ static void seq_cache_create(Main *bmain, Scene *scene)
 {
   BLI_mutex_lock(&cache_create_lock);
   if (scene->ed->cache == nullptr) {
-    SeqCache *cache = static_cast<SeqCache *>(MEM_callocN(sizeof(SeqCache), "SeqCache"));
+    SeqCache *cache = MEM_new<SeqCache>("SeqCache");
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
-    cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = nullptr;
+    for (SeqCacheShard &shard : cache->shards) {
+      shard.hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
+      BLI_mutex_init(&shard.mutex);
+    }
     cache->bmain = bmain;
-    cache->thumbnail_count = 0;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
 
@@ -530,6 +573,8 @@ static void seq_cache_populate_key(SeqCacheKey *key,
   key->link_next = nullptr;
   key->is_temp_cache = true;
   key->task_id = context->task_id;
+  key->clock_index = -1;
+  key->clock_referenced = 0;
 }
 
 static SeqCacheKey *seq_cache_allocate_key(SeqCache *cache,
@@ -554,13 +599,7 @@ void seq_cache_free_temp_cache(Scene *scene, short id, int timeline_frame)
 
   seq_cache_lock(scene);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
+  seq_cache_foreach_key(cache, [&](SeqCacheKey *key) {
     if (key->is_temp_cache && key->task_id == id && key->type != SEQ_CACHE_STORE_THUMBNAIL) {
       /* Use frame_index here to avoid freeing raw images if they are used for multiple frames. */
       float frame_index = seq_cache_timeline_frame_to_frame_index(
@@ -570,13 +609,13 @@ void seq_cache_free_temp_cache(Scene *scene, short id, int timeline_frame)
           timeline_frame < SEQ_time_left_handle_frame_get(scene, key->seq))
       {
         seq_cache_key_unlink(key);
-        BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
-        if (key == cache->last_key) {
-          cache->last_key = nullptr;
+        if (key == cache->last_key[key->task_id]) {
+          cache->last_key[key->task_id] = nullptr;
         }
+        seq_cache_remove(cache, key);
       }
     }
-  }
+  });
   seq_cache_unlock(scene);
 }
 
@@ -587,7 +626,10 @@ void seq_cache_destruct(Scene *scene)
     return;
   }
 
-  BLI_ghash_free(cache->hash, seq_cache_keyfree, seq_cache_valfree);
+  for (SeqCacheShard &shard : cache->shards) {
+    BLI_ghash_free(shard.hash, seq_cache_keyfree, seq_cache_valfree);
+    BLI_mutex_end(&shard.mutex);
+  }
   BLI_mempool_destroy(cache->keys_pool);
   BLI_mempool_destroy(cache->items_pool);
   BLI_mutex_end(&cache->iterator_mutex);
@@ -596,7 +638,7 @@ void seq_cache_destruct(Scene *scene)
     seq_disk_cache_free(cache->disk_cache);
   }
 
-  MEM_freeN(cache);
+  MEM_delete(cache);
   scene->ed->cache = nullptr;
 }
 
@@ -619,18 +661,11 @@ void SEQ_cache_cleanup(Scene *scene)
 
   seq_cache_lock(scene);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_assert(key->cache_owner == cache);
-
-    BLI_ghashIterator_step(&gh_iter);
-
+  seq_cache_foreach_key(cache, [&](SeqCacheKey *key) {
     /* NOTE: no need to call #seq_cache_key_unlink as all keys are removed. */
-    BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
-  }
-  cache->last_key = nullptr;
+    seq_cache_remove(cache, key);
+  });
+  seq_cache_last_keys_clear(cache);
   cache->thumbnail_count = 0;
   seq_cache_unlock(scene);
 }
@@ -664,29 +699,23 @@ void seq_cache_cleanup_sequence(Scene *scene,
   int invalidate_source = invalidate_types & (SEQ_CACHE_STORE_RAW | SEQ_CACHE_STORE_PREPROCESSED |
                                               SEQ_CACHE_STORE_COMPOSITE);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
+  seq_cache_foreach_key(cache, [&](SeqCacheKey *key) {
     /* Clean all final and composite in intersection of seq and seq_changed. */
     if (key->type & invalidate_composite && key->timeline_frame >= range_start &&
         key->timeline_frame <= range_end)
     {
       seq_cache_key_unlink(key);
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      seq_cache_remove(cache, key);
     }
     else if (key->type & invalidate_source && key->seq == seq &&
              key->timeline_frame >= SEQ_time_left_handle_frame_get(scene, seq_changed) &&
              key->timeline_frame <= SEQ_time_right_handle_frame_get(scene, seq_changed))
     {
       seq_cache_key_unlink(key);
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      seq_cache_remove(cache, key);
     }
-  }
-  cache->last_key = nullptr;
+  });
+  seq_cache_last_keys_clear(cache);
   seq_cache_unlock(scene);
 }
 
@@ -703,13 +732,7 @@ void seq_cache_thumbnail_cleanup(Scene *scene, rctf *view_area_safe)
     return;
   }
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
+  seq_cache_foreach_key(cache, [&](SeqCacheKey *key) {
     const int frame_index = key->timeline_frame - SEQ_time_left_handle_frame_get(scene, key->seq);
     const int frame_step = SEQ_render_thumbnails_guaranteed_set_frame_step_get(scene, key->seq);
     const int relative_base_frame = round_fl_to_int(frame_index / float(frame_step)) * frame_step;
@@ -717,7 +740,7 @@ void seq_cache_thumbnail_cleanup(Scene *scene, rctf *view_area_safe)
                                                  SEQ_time_left_handle_frame_get(scene, key->seq);
 
     if (nearest_guaranted_absolute_frame == key->timeline_frame) {
-      continue;
+      return;
     }
 
     if ((key->type & SEQ_CACHE_STORE_THUMBNAIL) &&
@@ -726,11 +749,11 @@ void seq_cache_thumbnail_cleanup(Scene *scene, rctf *view_area_safe)
          key->seq->machine < view_area_safe->ymin))
     {
       seq_cache_key_unlink(key);
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      seq_cache_remove(cache, key);
       cache->thumbnail_count--;
     }
-  }
-  cache->last_key = nullptr;
+  });
+  seq_cache_last_keys_clear(cache);
 }
 
 ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline_frame, int type)
@@ -756,17 +779,15 @@ ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline
     seq_cache_create(context->bmain, scene);
   }
 
-  seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   ImBuf *ibuf = nullptr;
   SeqCacheKey key;
 
-  /* Try RAM cache: */
+  /* Try RAM cache, this only locks the shard containing the key. */
   if (cache && seq) {
     seq_cache_populate_key(&key, context, seq, timeline_frame, type);
     ibuf = seq_cache_get_ex(cache, &key);
   }
-  seq_cache_unlock(scene);
 
   if (ibuf) {
     return ibuf;
@@ -786,8 +807,13 @@ ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline
 
     /* Store read image in RAM. Only recycle item for final type. */
     if (key.type != SEQ_CACHE_STORE_FINAL_OUT || seq_cache_recycle_item(scene)) {
-      SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-      seq_cache_put_ex(scene, new_key, ibuf);
+      seq_cache_lock(scene);
+      /* Another thread may have read or rendered the same image meanwhile. */
+      if (!seq_cache_haskey(cache, &key)) {
+        SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
+        seq_cache_put_ex(scene, new_key, ibuf);
+      }
+      seq_cache_unlock(scene);
     }
   }
 
@@ -814,8 +840,8 @@ bool seq_cache_put_if_possible(
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = nullptr;
+  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key[context->task_id]);
+  scene->ed->cache->last_key[context->task_id] = nullptr;
   return false;
 }
 
@@ -833,15 +859,18 @@ void seq_cache_thumbnail_put(const SeqRenderData *context,
 
   seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
-  SeqCacheKey *key = seq_cache_allocate_key(
-      cache, context, seq, timeline_frame, SEQ_CACHE_STORE_THUMBNAIL);
 
   /* Prevent reinserting, it breaks cache key linking. */
-  if (BLI_ghash_haskey(cache->hash, key)) {
+  SeqCacheKey lookup_key;
+  seq_cache_populate_key(&lookup_key, context, seq, timeline_frame, SEQ_CACHE_STORE_THUMBNAIL);
+  if (seq_cache_haskey(cache, &lookup_key)) {
     seq_cache_unlock(scene);
     return;
   }
 
+  SeqCacheKey *key = seq_cache_allocate_key(
+      cache, context, seq, timeline_frame, SEQ_CACHE_STORE_THUMBNAIL);
+
   /* Limit cache to THUMB_CACHE_LIMIT (5000) images stored. */
   if (cache->thumbnail_count >= THUMB_CACHE_LIMIT) {
     rctf view_area_safe = *view_area;
@@ -869,19 +898,24 @@ void seq_cache_put(
     BLI_assert(seq != nullptr);
   }
 
-  /* Prevent reinserting, it breaks cache key linking. */
-  ImBuf *test = seq_cache_get(context, seq, timeline_frame, type);
-  if (test) {
-    IMB_freeImBuf(test);
-    return;
-  }
-
   if (!scene->ed->cache) {
     seq_cache_create(context->bmain, scene);
   }
 
   seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
+
+  /* Prevent reinserting, it breaks cache key linking. Checked while locked, because another
+   * thread may store the same image between the check and the insertion. The caller keeps its
+   * reference to the image, so nothing needs to be freed here. This is not a lookup of the
+   * image, so it does not count as a hit or miss. */
+  SeqCacheKey lookup_key;
+  seq_cache_populate_key(&lookup_key, context, seq, timeline_frame, type);
+  if (seq_cache_haskey(cache, &lookup_key)) {
+    seq_cache_unlock(scene);
+    return;
+  }
+
   SeqCacheKey *key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
   seq_cache_put_ex(scene, key, i);
   seq_cache_unlock(scene);
@@ -889,11 +923,10 @@ void seq_cache_put(
   if (!key->is_temp_cache) {
     if (seq_disk_cache_is_enabled(context->bmain)) {
       if (cache->disk_cache == nullptr) {
-        seq_disk_cache_create(context->bmain, context->scene);
+        cache->disk_cache = seq_disk_cache_create(context->bmain, context->scene);
       }
 
       seq_disk_cache_write_file(cache->disk_cache, key, i);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
     }
   }
 }
@@ -910,15 +943,16 @@ void SEQ_cache_iterate(
   }
 
   seq_cache_lock(scene);
-  bool interrupt = callback_init(userdata, BLI_ghash_len(cache->hash));
-
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
+  size_t item_count = 0;
+  for (const SeqCacheShard &shard : cache->shards) {
+    item_count += BLI_ghash_len(shard.hash);
+  }
+  bool interrupt = callback_init(userdata, item_count);
 
-  while (!BLI_ghashIterator_done(&gh_iter) && !interrupt) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
+  seq_cache_foreach_key(cache, [&](SeqCacheKey *key) {
+    if (interrupt) {
+      return;
+    }
     int timeline_frame;
     if (key->type & SEQ_CACHE_STORE_FINAL_OUT) {
       timeline_frame = key->timeline_frame;
@@ -937,9 +971,9 @@ void SEQ_cache_iterate(
     }
 
     interrupt = callback_iter(userdata, key->seq, timeline_frame, key->type);
-  }
+  });
 
-  cache->last_key = nullptr;
+  seq_cache_last_keys_clear(cache);
   seq_cache_unlock(scene);
 }
 
@@ -947,3 +981,25 @@ bool seq_cache_is_full()
 {
   return seq_cache_get_mem_total() < MEM_get_memory_in_use();
 }
+
+SeqCacheStatistics SEQ_cache_statistics_get(const Scene *scene)
+{
+  SeqCacheStatistics statistics = {};
+  if (scene->ed && scene->ed->cache) {
+    SeqCacheStatistics &cache_statistics = scene->ed->cache->statistics;
+    statistics.hits = atomic_load_uint64(&cache_statistics.hits);
+    statistics.misses = atomic_load_uint64(&cache_statistics.misses);
+    statistics.evictions = atomic_load_uint64(&cache_statistics.evictions);
+  }
+  return statistics;
+}
+
+void SEQ_cache_statistics_reset(Scene *scene)
+{
+  if (scene->ed && scene->ed->cache) {
+    SeqCacheStatistics &cache_statistics = scene->ed->cache->statistics;
+    atomic_store_uint64(&cache_statistics.hits, 0);
+    atomic_store_uint64(&cache_statistics.misses, 0);
+    atomic_store_uint64(&cache_statistics.evictions, 0);
+  }
+}
@@ -31,6 +31,8 @@ struct SeqCacheKey {
   /* ID of task for assigning temp cache entries to particular task(thread, etc.) */
   eSeqTaskId task_id;
   int type;
+  int clock_index;          /* Index in #SeqCache.clock_keys, -1 if not a candidate for removal. */
+  uint8_t clock_referenced; /* Set when the image is used, cleared by the clock hand. */
 };
 
 ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline_frame, int type);
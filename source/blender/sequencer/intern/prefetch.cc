@@ -6,6 +6,7 @@
  * \ingroup bke
  */
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
@@ -16,8 +17,11 @@
 #include "DNA_screen_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_listbase.h"
+#include "BLI_map.hh"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.hh"
@@ -46,36 +50,58 @@
 #include "prefetch.hh"
 #include "render.hh"
 
-struct PrefetchJob {
-  PrefetchJob *next, *prev;
+#define SEQ_PREFETCH_THREADS_MAX (SEQ_TASK_PREFETCH_RENDER_LAST - SEQ_TASK_PREFETCH_RENDER + 1)
+
+struct PrefetchJob;
+
+/**
+ * Renders frames on its own evaluated copy of the scene, so that several frames can be prefetched
+ * concurrently. Animation evaluation modifies the copy, so it can't be shared between workers.
+ */
+struct PrefetchWorker {
+  PrefetchJob *pfjob = nullptr;
 
+  Main *bmain_eval = nullptr;
+  Scene *scene_eval = nullptr;
+  Depsgraph *depsgraph = nullptr;
+
+  /* context, each worker has its own task ID for temporary cache entries */
+  SeqRenderData context = {};
+  SeqRenderData context_cpy = {};
+
+  /* Frame that is being rendered and the generation of the prefetch area it was claimed in. */
+  float cfra = 0.0f;
+  int generation = 0;
+};
+
+struct PrefetchJob {
   Main *bmain;
-  Main *bmain_eval;
   Scene *scene;
-  Scene *scene_eval;
-  Depsgraph *depsgraph;
 
+  /* Protects the prefetch area and control variables while workers claim frames. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
+  blender::Array<PrefetchWorker> workers;
 
-  /* context */
-  SeqRenderData context;
-  SeqRenderData context_cpy;
-  ListBase *seqbasep;
-  ListBase *seqbasep_cpy;
-
-  /* prefetch area */
+  /* prefetch area, frames before `cfra + num_frames_prefetched` have been claimed by workers */
   float cfra;
   int num_frames_prefetched;
+  /* Incremented when the playhead jumps back, frames claimed before that are stale. */
+  int generation;
+  /* Memory used by final images of prefetched frames that are still ahead of the playhead. */
+  blender::Map<int, size_t> frame_sizes;
 
   /* control */
   bool running;
-  bool waiting;
+  int running_num;
+  int waiting_num;
   bool stop;
 };
 
+static void *seq_prefetch_frames(void *data);
+
 static bool seq_prefetch_is_playing(const Main *bmain)
 {
   for (bScreen *screen = static_cast<bScreen *>(bmain->screens.first); screen;
@@ -128,7 +154,7 @@ static bool seq_prefetch_job_is_waiting(Scene *scene)
     return false;
   }
 
-  return pfjob->waiting;
+  return pfjob->waiting_num > 0 && pfjob->waiting_num == pfjob->running_num;
 }
 
 static Sequence *sequencer_prefetch_get_original_sequence(Sequence *seq, ListBase *seqbase)
@@ -159,7 +185,7 @@ SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
-  return &pfjob->context;
+  return &pfjob->workers[context->task_id - SEQ_TASK_PREFETCH_RENDER].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -173,13 +199,14 @@ static bool seq_prefetch_is_cache_full(Scene *scene)
   return seq_cache_recycle_item(pfjob->scene) == false;
 }
 
+/* Next frame to be claimed by a worker. */
 static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
 }
 
 void seq_prefetch_get_time_range(Scene *scene, int *r_start, int *r_end)
@@ -190,37 +217,61 @@ void seq_prefetch_get_time_range(Scene *scene, int *r_start, int *r_end)
   *r_end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != nullptr) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != nullptr) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = nullptr;
-  pfjob->scene_eval = nullptr;
+  worker->depsgraph = nullptr;
+  worker->scene_eval = nullptr;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
-  Scene *scene = pfjob->scene;
+  Main *bmain = worker->bmain_eval;
+  Scene *scene = worker->pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  worker->cfra = worker->pfjob->cfra;
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+}
+
+static void seq_prefetch_workers_init(PrefetchJob *pfjob, const int threads_num)
+{
+  BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, threads_num);
+  pfjob->workers.reinitialize(threads_num);
+  for (PrefetchWorker &worker : pfjob->workers) {
+    worker.pfjob = pfjob;
+    worker.bmain_eval = BKE_main_new();
+  }
+}
+
+static void seq_prefetch_workers_free(PrefetchJob *pfjob)
+{
+  if (pfjob->workers.is_empty()) {
+    return;
+  }
+  BLI_threadpool_end(&pfjob->threads);
+  for (PrefetchWorker &worker : pfjob->workers) {
+    seq_prefetch_free_depsgraph(&worker);
+    BKE_main_free(worker.bmain_eval);
+  }
+  pfjob->workers = {};
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -242,6 +293,8 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
   if (cfra < pfjob->cfra) {
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched = 1;
+    pfjob->generation++;
+    pfjob->frame_sizes.clear();
   }
 }
 
@@ -267,7 +320,7 @@ void SEQ_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -276,32 +329,37 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
-                             pfjob->scene,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (const int i : pfjob->workers.index_range()) {
+    PrefetchWorker &worker = pfjob->workers[i];
+    const eSeqTaskId task_id = eSeqTaskId(SEQ_TASK_PREFETCH_RENDER + i);
+
+    SEQ_render_new_render_data(worker.bmain_eval,
+                               worker.depsgraph,
+                               worker.scene_eval,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker.context_cpy);
+    worker.context_cpy.is_prefetch_render = true;
+    worker.context_cpy.task_id = task_id;
+
+    SEQ_render_new_render_data(pfjob->bmain,
+                               worker.depsgraph,
+                               pfjob->scene,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker.context);
+    worker.context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for all threads.
+     */
+    worker.context.task_id = task_id;
+  }
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -313,21 +371,27 @@ static void seq_prefetch_update_scene(Scene *scene)
   }
 
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (PrefetchWorker &worker : pfjob->workers) {
+    seq_prefetch_free_depsgraph(&worker);
+    seq_prefetch_init_depsgraph(&worker);
+  }
 }
 
 static void seq_prefetch_update_active_seqbase(PrefetchJob *pfjob)
 {
   MetaStack *ms_orig = SEQ_meta_stack_active_get(SEQ_editing_get(pfjob->scene));
-  Editing *ed_eval = SEQ_editing_get(pfjob->scene_eval);
 
-  if (ms_orig != nullptr) {
-    Sequence *meta_eval = seq_prefetch_get_original_sequence(ms_orig->parseq, pfjob->scene_eval);
-    SEQ_seqbase_active_set(ed_eval, &meta_eval->seqbase);
-  }
-  else {
-    SEQ_seqbase_active_set(ed_eval, &ed_eval->seqbase);
+  for (PrefetchWorker &worker : pfjob->workers) {
+    Editing *ed_eval = SEQ_editing_get(worker.scene_eval);
+
+    if (ms_orig != nullptr) {
+      Sequence *meta_eval = seq_prefetch_get_original_sequence(ms_orig->parseq,
+                                                               worker.scene_eval);
+      SEQ_seqbase_active_set(ed_eval, &meta_eval->seqbase);
+    }
+    else {
+      SEQ_seqbase_active_set(ed_eval, &ed_eval->seqbase);
+    }
   }
 }
 
@@ -335,8 +399,8 @@ static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->waiting_num > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -349,22 +413,19 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_end(&pfjob->threads);
+  seq_prefetch_workers_free(pfjob);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
-  MEM_freeN(pfjob);
+  MEM_delete(pfjob);
   scene->ed->prefetch_job = nullptr;
 }
 
-static bool seq_prefetch_seq_has_disk_cache(PrefetchJob *pfjob,
+static bool seq_prefetch_seq_has_disk_cache(PrefetchWorker *worker,
                                             Sequence *seq,
                                             bool can_have_final_image)
 {
-  SeqRenderData *ctx = &pfjob->context_cpy;
-  float cfra = seq_prefetch_cfra(pfjob);
+  SeqRenderData *ctx = &worker->context_cpy;
+  float cfra = worker->cfra;
 
   ImBuf *ibuf = seq_cache_get(ctx, seq, cfra, SEQ_CACHE_STORE_PREPROCESSED);
   if (ibuf != nullptr) {
@@ -391,27 +452,27 @@ static bool seq_prefetch_seq_has_disk_cache(PrefetchJob *pfjob,
   return false;
 }
 
-static bool seq_prefetch_scene_strip_is_rendered(PrefetchJob *pfjob,
+static bool seq_prefetch_scene_strip_is_rendered(PrefetchWorker *worker,
                                                  ListBase *channels,
                                                  ListBase *seqbase,
                                                  blender::Span<Sequence *> scene_strips,
                                                  bool is_recursive_check)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
+  float cfra = worker->cfra;
   blender::Vector<Sequence *> strips = seq_get_shown_sequences(
-      pfjob->scene_eval, channels, seqbase, cfra, 0);
+      worker->scene_eval, channels, seqbase, cfra, 0);
 
   /* Iterate over rendered strips. */
   for (Sequence *seq : strips) {
     if (seq->type == SEQ_TYPE_META &&
-        seq_prefetch_scene_strip_is_rendered(pfjob, channels, &seq->seqbase, scene_strips, true))
+        seq_prefetch_scene_strip_is_rendered(worker, channels, &seq->seqbase, scene_strips, true))
     {
       return true;
     }
 
     /* Disable prefetching 3D scene strips, but check for disk cache. */
     if (seq->type == SEQ_TYPE_SCENE && (seq->flag & SEQ_SCENE_STRIPS) == 0 &&
-        !seq_prefetch_seq_has_disk_cache(pfjob, seq, !is_recursive_check))
+        !seq_prefetch_seq_has_disk_cache(worker, seq, !is_recursive_check))
     {
       return true;
     }
@@ -439,47 +500,130 @@ static blender::VectorSet<Sequence *> query_scene_strips(ListBase *seqbase)
 
 /* Prefetch must avoid rendering scene strips, because rendering in background locks UI and can
  * make it unresponsive for long time periods. */
-static bool seq_prefetch_must_skip_frame(PrefetchJob *pfjob, ListBase *channels, ListBase *seqbase)
+static bool seq_prefetch_must_skip_frame(PrefetchWorker *worker,
+                                         ListBase *channels,
+                                         ListBase *seqbase)
 {
   blender::VectorSet<Sequence *> scene_strips = query_scene_strips(seqbase);
-  if (seq_prefetch_scene_strip_is_rendered(pfjob, channels, seqbase, scene_strips, false)) {
+  if (seq_prefetch_scene_strip_is_rendered(worker, channels, seqbase, scene_strips, false)) {
     return true;
   }
   return false;
 }
 
+static bool seq_prefetch_is_memory_limit_exceeded(PrefetchJob *pfjob)
+{
+  if (U.sequencer_prefetch_memory_limit <= 0) {
+    return false;
+  }
+
+  /* Frames the playhead has passed don't count towards the limit anymore. */
+  const int cfra = pfjob->scene->r.cfra;
+  pfjob->frame_sizes.remove_if([&](const auto item) { return item.key < cfra; });
+
+  size_t size = 0;
+  for (const size_t frame_size : pfjob->frame_sizes.values()) {
+    size += frame_size;
+  }
+  return size > size_t(U.sequencer_prefetch_memory_limit) * 1024 * 1024;
+}
+
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra) ||
+         seq_prefetch_is_memory_limit_exceeded(pfjob);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+static bool seq_prefetch_is_enabled(PrefetchJob *pfjob)
 {
+  return (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop;
+}
+
+/**
+ * Claim the next frame to be rendered by the worker, suspending the thread while there is nothing
+ * to be prefetched.
+ *
+ * \return False when the job has to be terminated.
+ */
+static bool seq_prefetch_claim_frame(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+  bool claimed = false;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop)
-  {
-    pfjob->waiting = true;
-    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+  while (seq_prefetch_is_enabled(pfjob)) {
+    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+    if (pfjob->num_frames_prefetched > 5 && (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2)
+    {
+      break;
+    }
+
     seq_prefetch_update_area(pfjob);
+
+    if (!seq_prefetch_need_suspend(pfjob)) {
+      worker->cfra = seq_prefetch_cfra(pfjob);
+      worker->generation = pfjob->generation;
+      pfjob->num_frames_prefetched++;
+      claimed = true;
+      break;
+    }
+
+    pfjob->waiting_num++;
+    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->waiting_num--;
   }
-  pfjob->waiting = false;
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return claimed;
 }
 
-static void *seq_prefetch_frames(void *job)
+/**
+ * A frame is stale when the playhead jumped back since it was claimed, or moved past it. Frames
+ * can't be canceled while they are rendered, so this is checked before rendering starts.
+ */
+static bool seq_prefetch_frame_is_stale(PrefetchWorker *worker)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchJob *pfjob = worker->pfjob;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = nullptr;
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  seq_prefetch_update_area(pfjob);
+  const bool is_stale = !seq_prefetch_is_enabled(pfjob) ||
+                        worker->generation != pfjob->generation ||
+                        worker->cfra < pfjob->scene->r.cfra;
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+  return is_stale;
+}
+
+static void seq_prefetch_frame_done(PrefetchWorker *worker, ImBuf *ibuf)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+
+  if (ibuf == nullptr) {
+    return;
+  }
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  if (worker->generation == pfjob->generation && worker->cfra >= pfjob->scene->r.cfra) {
+    pfjob->frame_sizes.add_overwrite(int(worker->cfra), IMB_get_size_in_memory(ibuf));
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+}
+
+static void *seq_prefetch_frames(void *data)
+{
+  PrefetchWorker *worker = static_cast<PrefetchWorker *>(data);
+  PrefetchJob *pfjob = worker->pfjob;
+
+  while (seq_prefetch_claim_frame(worker)) {
+    worker->scene_eval->ed->prefetch_job = nullptr;
+
+    seq_prefetch_update_depsgraph(worker);
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
     BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+        &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -487,43 +631,34 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to nullptr before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    worker->scene_eval->ed->prefetch_job = pfjob;
 
-    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene_eval));
-    ListBase *channels = SEQ_channels_displayed_get(SEQ_editing_get(pfjob->scene_eval));
-    if (seq_prefetch_must_skip_frame(pfjob, channels, seqbase)) {
-      pfjob->num_frames_prefetched++;
-      /* Break instead of keep looping if the job should be terminated. */
-      if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-        break;
-      }
+    /* The playhead may have moved while the scene was evaluated. */
+    if (seq_prefetch_frame_is_stale(worker)) {
       continue;
     }
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-    IMB_freeImBuf(ibuf);
-
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
-
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 && (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2)
-    {
-      break;
-    }
-
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
+    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(worker->scene_eval));
+    ListBase *channels = SEQ_channels_displayed_get(SEQ_editing_get(worker->scene_eval));
+    if (seq_prefetch_must_skip_frame(worker, channels, seqbase)) {
+      continue;
     }
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+    ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+    seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+    seq_prefetch_frame_done(worker, ibuf);
+    IMB_freeImBuf(ibuf);
   }
 
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = nullptr;
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  worker->scene_eval->ed->prefetch_job = nullptr;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->running_num--;
+  if (pfjob->running_num == 0) {
+    pfjob->running = false;
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return nullptr;
 }
@@ -534,33 +669,43 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
 
   if (!pfjob) {
     if (context->scene->ed) {
-      pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
+      pfjob = MEM_new<PrefetchJob>("PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
-      pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
     }
   }
   pfjob->bmain = context->bmain;
 
+  /* The job is not running, so workers can be recreated when the number of threads changed. */
+  const int threads_num = std::clamp(
+      int(U.sequencer_prefetch_threads), 1, SEQ_PREFETCH_THREADS_MAX);
+  if (pfjob->workers.size() != threads_num) {
+    seq_prefetch_workers_free(pfjob);
+    seq_prefetch_workers_init(pfjob, threads_num);
+  }
+
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->generation++;
+  pfjob->frame_sizes.clear();
 
-  pfjob->waiting = false;
+  pfjob->waiting_num = 0;
   pfjob->stop = false;
+  pfjob->running_num = threads_num;
   pfjob->running = true;
 
   seq_prefetch_update_scene(context->scene);
   seq_prefetch_update_context(context);
   seq_prefetch_update_active_seqbase(pfjob);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (PrefetchWorker &worker : pfjob->workers) {
+    BLI_threadpool_remove(&pfjob->threads, &worker);
+    BLI_threadpool_insert(&pfjob->threads, &worker);
+  }
 
   return pfjob;
 }
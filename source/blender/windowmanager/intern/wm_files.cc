@@ -86,6 +86,8 @@
 
 #include "BLO_writefile.hh"
 
+#include "COM_compositor.hh"
+
 #include "RNA_access.hh"
 #include "RNA_define.hh"
 
@@ -648,6 +650,8 @@ static void wm_file_read_pre(bool use_data, bool /*use_userdef*/)
 {
   if (use_data) {
     BLI_timer_on_file_load();
+    /* Cached compositor results were computed from data of the previous file. */
+    COM_clear_caches();
   }
 
   /* Always do this as both startup and preferences may have loaded in many font's
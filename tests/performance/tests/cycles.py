@@ -7,10 +7,15 @@ import api
 
 def _run(args):
     import bpy
+    import os
 
     device_type = args['device_type']
     device_index = args['device_index']
 
+    if args['wavefront']:
+        # Read by Cycles when resetting its debug flags before rendering.
+        os.environ['CYCLES_CPU_WAVEFRONT'] = '1'
+
     scene = bpy.context.scene
     scene.render.engine = 'CYCLES'
     scene.render.filepath = args['render_filepath']
@@ -52,17 +57,20 @@ def _run(args):
 
 
 class CyclesTest(api.Test):
-    def __init__(self, filepath):
+    def __init__(self, filepath, wavefront=False):
         self.filepath = filepath
+        self.wavefront = wavefront
 
     def name(self):
         return self.filepath.stem
 
     def category(self):
-        return "cycles"
+        # Wavefront rendering on the CPU, to compare against the megakernel in the "cycles" category.
+        return "cycles_wavefront" if self.wavefront else "cycles"
 
     def use_device(self):
-        return True
+        # Wavefront rendering is only implemented for the CPU device.
+        return not self.wavefront
 
     def run(self, env, device_id):
         tokens = device_id.split('_')
@@ -70,6 +78,7 @@ class CyclesTest(api.Test):
         device_index = int(tokens[1]) if len(tokens) > 1 else 0
         args = {'device_type': device_type,
                 'device_index': device_index,
+                'wavefront': self.wavefront,
                 'render_filepath': str(env.log_file.parent / (env.log_file.stem + '.png'))}
 
         _, lines = env.run_in_blender(_run, args, ['--debug-cycles', '--verbose', '2', self.filepath])
@@ -109,4 +118,5 @@ class CyclesTest(api.Test):
 
 def generate(env):
     filepaths = env.find_blend_files('cycles/*')
-    return [CyclesTest(filepath) for filepath in filepaths]
+    return [CyclesTest(filepath) for filepath in filepaths] + \
+        [CyclesTest(filepath, wavefront=True) for filepath in filepaths]
@@ -18,9 +18,14 @@ except ImportError:
 SET_COMPOSITOR_DEVICE_SCRIPT = "import bpy; " \
     "bpy.data.scenes[0].render.compositor_device = 'CPU'"
 
+# Smallest tile size, so that test images are split in several tiles.
+SET_COMPOSITOR_TILES_SCRIPT = "import bpy; " \
+    "bpy.data.scenes[0].render.use_compositor_tiles = True; " \
+    "bpy.data.scenes[0].render.compositor_tile_size = 64"
 
-def get_arguments(filepath, output_filepath):
-    return [
+
+def get_arguments(filepath, output_filepath, tiled=False):
+    args = [
         "--background",
         "--factory-startup",
         "--enable-autoexec",
@@ -28,10 +33,18 @@ def get_arguments(filepath, output_filepath):
         "--debug-exit-on-error",
         filepath,
         "-P", os.path.realpath(__file__),
-        "--python-expr", SET_COMPOSITOR_DEVICE_SCRIPT,
+        "--python-expr", SET_COMPOSITOR_DEVICE_SCRIPT]
+    if tiled:
+        args.extend(["--python-expr", SET_COMPOSITOR_TILES_SCRIPT])
+    args.extend([
         "-o", output_filepath,
         "-F", "PNG",
-        "-f", "1"]
+        "-f", "1"])
+    return args
+
+
+def get_tiled_arguments(filepath, output_filepath):
+    return get_arguments(filepath, output_filepath, tiled=True)
 
 
 def create_argparse():
@@ -41,6 +54,8 @@ def create_argparse():
     parser.add_argument("-outdir", nargs=1)
     parser.add_argument("-oiiotool", nargs=1)
     parser.add_argument('--batch', default=False, action='store_true')
+    # Render tile by tile, results are compared with the same references as full-frame renders.
+    parser.add_argument('--tiled', default=False, action='store_true')
     return parser
 
 
@@ -54,7 +69,8 @@ def main():
     output_dir = args.outdir[0]
 
     from modules import render_report
-    report = render_report.Report("Compositor CPU", output_dir, oiiotool)
+    title = "Compositor CPU Tiled" if args.tiled else "Compositor CPU"
+    report = render_report.Report(title, output_dir, oiiotool)
     report.set_pixelated(True)
     report.set_reference_dir("compositor_cpu_renders")
 
@@ -69,7 +85,8 @@ def main():
         report.set_fail_threshold(0.06)
         report.set_fail_percent(2)
 
-    ok = report.run(test_dir, blender, get_arguments, batch=args.batch)
+    arguments_cb = get_tiled_arguments if args.tiled else get_arguments
+    ok = report.run(test_dir, blender, arguments_cb, batch=args.batch)
 
     sys.exit(not ok)
 
@@ -108,6 +108,7 @@ def create_argparse():
     parser.add_argument("-device", nargs=1)
     parser.add_argument("-blacklist", nargs="*")
     parser.add_argument('--batch', default=False, action='store_true')
+    parser.add_argument('--wavefront', default=False, action='store_true')
     return parser
 
 
@@ -121,6 +122,10 @@ def main():
     output_dir = args.outdir[0]
     device = args.device[0]
 
+    if args.wavefront:
+        # Inherited by the Blender processes, Cycles then renders with wavefront path scheduling.
+        os.environ['CYCLES_CPU_WAVEFRONT'] = '1'
+
     blacklist = BLACKLIST_ALL
     if device != 'CPU':
         blacklist += BLACKLIST_GPU